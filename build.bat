@@ -4,4 +4,5 @@ set "PATH=%MSYS2%\bin;%PATH%"
 set "PKG_CONFIG_PATH=%MSYS2%\lib\pkgconfig;%MSYS2%\share\pkgconfig"
 set "PKG_CONFIG_LIBDIR=%MSYS2%\lib\pkgconfig"
 make %*
+make native
 make bundle-ntldd
\ No newline at end of file
@@ -0,0 +1,550 @@
+# python/models/aifd_native.py
+"""
+ctypes binding for the native core in src/native (built with `make native`).
+Every entry point mirrors a header there; callers check `available()` and keep
+their sklearn/torch path as the fallback, like `_SK_OK` in models.py.
+"""
+from __future__ import annotations
+from typing import Callable, Optional
+from pathlib import Path
+import ctypes, math, os, sys
+
+import numpy as np
+
+_LIB_NAMES = ("aifd_native.dll", "libaifd_native.so", "aifd_native.so", "libaifd_native.dylib")
+_ROOT = Path(__file__).resolve().parents[2]
+
+# progress(user, step, total, value) -> nonzero cancels
+PROGRESS_FN = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_double)
+# fit(user, iter, total, loss, score) -> nonzero cancels
+FIT_FN = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_double, ctypes.c_double)
+
+_lib = None
+_load_error = ""
+
+class NativeError(RuntimeError):
+    pass
+
+def _candidates():
+    env = os.environ.get("AIFD_NATIVE_LIB")
+    if env:
+        yield Path(env)
+    for base in (_ROOT, Path.cwd(), Path(__file__).resolve().parent):
+        for name in _LIB_NAMES:
+            yield base / name
+
+def _load():
+    global _lib, _load_error
+    if _lib is not None or _load_error:
+        return _lib
+    for p in _candidates():
+        if not p.exists():
+            continue
+        try:
+            if os.name == "nt" and hasattr(os, "add_dll_directory"):
+                os.add_dll_directory(str(p.parent))  # libwinpthread next to the dll
+            lib = ctypes.CDLL(str(p))
+        except OSError as e:
+            _load_error = f"{p}: {e}"
+            continue
+        dp, i32, f64 = ctypes.c_void_p, ctypes.c_int, ctypes.c_double
+        lib.aifd_version.restype = i32
+        lib.aifd_simd_level.restype = i32
+        lib.aifd_pca.argtypes = [dp, i32, i32, dp, i32]
+        lib.aifd_pca.restype = i32
+        lib.aifd_tsne.argtypes = [dp, i32, i32, dp, f64, f64, i32, i32, ctypes.c_ulonglong, PROGRESS_FN, dp]
+        lib.aifd_tsne.restype = i32
+        lib.aifd_linear.argtypes = [dp, i32, i32, dp, i32, f64, i32, f64, i32, dp, dp, FIT_FN, dp]
+        lib.aifd_linear.restype = i32
+        lib.aifd_logreg.argtypes = [dp, i32, i32, dp, i32, f64, i32, i32, f64, i32, dp, FIT_FN, dp]
+        lib.aifd_logreg.restype = i32
+        lib.aifd_mlp_params.argtypes = [i32, i32, i32, i32]
+        lib.aifd_mlp_params.restype = ctypes.c_longlong
+        lib.aifd_mlp_train.argtypes = [dp, i32, i32, dp, i32, i32, i32, i32, i32, f64, i32, i32,
+                                       ctypes.c_ulonglong, i32, i32, dp, FIT_FN, dp]
+        lib.aifd_mlp_train.restype = i32
+        lib.aifd_mlp_infer.argtypes = [dp, i32, i32, i32, i32, i32, i32, dp, dp, i32]
+        lib.aifd_mlp_infer.restype = i32
+        lib.aifd_forest_train.argtypes = [dp, i32, i32, dp, i32, i32, i32, i32, f64, i32,
+                                          ctypes.c_ulonglong, i32, i32, FIT_FN, dp, ctypes.POINTER(i32)]
+        lib.aifd_forest_train.restype = dp
+        lib.aifd_forest_sizes.argtypes = [dp, dp]
+        lib.aifd_forest_export.argtypes = [dp, dp, dp, dp]
+        lib.aifd_forest_release.argtypes = [dp]
+        lib.aifd_forest_infer.argtypes = [dp, dp, dp, i32, i32, dp, i32, i32, dp, i32]
+        lib.aifd_forest_infer.restype = i32
+        lib.aifd_gbdt_train.argtypes = [dp, i32, i32, dp, i32, dp, i32, f64, i32, i32, i32, f64, i32,
+                                        FIT_FN, dp, ctypes.POINTER(i32)]
+        lib.aifd_gbdt_train.restype = dp
+        lib.aifd_gbdt_sizes.argtypes = [dp, dp]
+        lib.aifd_gbdt_export.argtypes = [dp, dp, dp, dp, dp]
+        lib.aifd_gbdt_release.argtypes = [dp]
+        lib.aifd_gbdt_infer.argtypes = [dp, dp, dp, i32, dp, i32, dp, i32, i32, i32, dp, i32]
+        lib.aifd_gbdt_infer.restype = i32
+        lib.aifd_knn_new.argtypes = [dp, i32, i32, i32, i32, i32, ctypes.c_ulonglong, i32, ctypes.POINTER(i32)]
+        lib.aifd_knn_new.restype = dp
+        lib.aifd_knn_algo.argtypes = [dp]
+        lib.aifd_knn_algo.restype = i32
+        lib.aifd_knn_search.argtypes = [dp, dp, i32, i32, i32, dp, dp, i32]
+        lib.aifd_knn_search.restype = i32
+        lib.aifd_knn_vote.argtypes = [dp, dp, i32, dp, i32, i32, i32, dp, i32]
+        lib.aifd_knn_vote.restype = i32
+        lib.aifd_knn_release.argtypes = [dp]
+        lib.aifd_csv_open.argtypes = [ctypes.c_char_p, i32, i32, i32, i32, i32, ctypes.POINTER(i32)]
+        lib.aifd_csv_open.restype = dp
+        lib.aifd_csv_shape.argtypes = [dp, dp, ctypes.POINTER(f64)]
+        lib.aifd_csv_name.argtypes = [dp, i32]
+        lib.aifd_csv_name.restype = ctypes.c_char_p
+        lib.aifd_csv_kind.argtypes = [dp, i32]
+        lib.aifd_csv_kind.restype = i32
+        lib.aifd_csv_data.argtypes = [dp, i32]
+        lib.aifd_csv_data.restype = dp
+        lib.aifd_csv_levels.argtypes = [dp, i32, ctypes.POINTER(i32), ctypes.POINTER(ctypes.c_longlong)]
+        lib.aifd_csv_levels.restype = dp
+        lib.aifd_csv_release.argtypes = [dp]
+        lib.aifd_prep_new.argtypes = [dp, i32, i32, i32, i32, i32, i32, ctypes.POINTER(i32)]
+        lib.aifd_prep_new.restype = dp
+        lib.aifd_prep_out_dim.argtypes = [dp]
+        lib.aifd_prep_out_dim.restype = i32
+        lib.aifd_prep_export.argtypes = [dp, dp, dp, dp, dp]
+        lib.aifd_prep_release.argtypes = [dp]
+        lib.aifd_prep_apply.argtypes = [dp, dp, dp, dp, i32, i32, dp, i32, i32, dp, i32, i32, i32]
+        lib.aifd_prep_apply.restype = i32
+        lib.aifd_onehot_new.argtypes = [dp, i32, ctypes.c_char_p, i32, i32, ctypes.POINTER(i32)]
+        lib.aifd_onehot_new.restype = dp
+        lib.aifd_onehot_width.argtypes = [dp]
+        lib.aifd_onehot_width.restype = i32
+        lib.aifd_onehot_export.argtypes = [dp, dp, dp]
+        lib.aifd_onehot_release.argtypes = [dp]
+        lib.aifd_onehot_apply.argtypes = [dp, i32, i32, dp, i32, dp, i32, i32, i32]
+        lib.aifd_onehot_apply.restype = i32
+        _lib, _load_error = lib, ""
+        return _lib
+    _load_error = _load_error or "library not found (run `make native`)"
+    return None
+
+def available() -> bool:
+    return _load() is not None
+
+def load_error() -> str:
+    _load()
+    return _load_error
+
+def _as_matrix(X) -> np.ndarray:
+    X = np.asarray(X, dtype=np.float64)
+    if X.ndim == 1:
+        X = X.reshape(-1, 1)
+    return np.ascontiguousarray(X)
+
+def _check(rc: int, what: str) -> bool:
+    """True when finished, False when cancelled through the progress callback."""
+    if rc < 0:
+        raise NativeError(f"{what} failed (rc={rc})")
+    return rc == 0
+
+def pca2(X, threads: int = 0) -> np.ndarray:
+    lib = _load()
+    if lib is None: raise NativeError(_load_error)
+    A = _as_matrix(X)
+    Z = np.zeros((A.shape[0], 2), dtype=np.float64)
+    _check(lib.aifd_pca(A.ctypes.data, A.shape[0], A.shape[1], Z.ctypes.data, int(threads)), "pca")
+    return Z
+
+def tsne2(X, perplexity: float = 30.0, theta: float = 0.5, max_iter: int = 1000,
+          threads: int = 0, seed: int = 42,
+          progress: Optional[Callable[[int, int, Optional[float]], bool]] = None) -> np.ndarray:
+    """
+    Barnes-Hut t-SNE with exact-PCA init. `progress(it, total, kl)` runs every
+    10 iterations (kl is None between the every-50-iterations estimates);
+    returning True stops early and the partial embedding is returned.
+    """
+    lib = _load()
+    if lib is None: raise NativeError(_load_error)
+    A = _as_matrix(X)
+    Y = np.zeros((A.shape[0], 2), dtype=np.float64)
+
+    def _cb(_user, it, total, kl):
+        if progress is None: return 0
+        try:
+            return 1 if progress(int(it), int(total), None if math.isnan(kl) else float(kl)) else 0
+        except Exception:
+            return 0
+    cb = PROGRESS_FN(_cb)  # keep a reference for the duration of the call
+    _check(lib.aifd_tsne(A.ctypes.data, A.shape[0], A.shape[1], Y.ctypes.data,
+                         float(perplexity), float(theta), int(max_iter), int(threads),
+                         int(seed) & 0xFFFFFFFFFFFFFFFF, cb, None), "tsne")
+    return Y
+
+def _fit_cb(progress):
+    """Wraps `progress(it, total, loss, score) -> bool` (True cancels) as a FIT_FN."""
+    def _cb(_user, it, total, loss, score):
+        if progress is None: return 0
+        try:
+            return 1 if progress(int(it), int(total), float(loss), float(score)) else 0
+        except Exception:
+            return 0
+    return FIT_FN(_cb)
+
+LINEAR_KINDS = {"linreg": 0, "ridge": 1, "lasso": 2}
+
+def linear_fit(X, y, kind: str = "linreg", alpha: float = 1.0, max_iter: int = 1000, tol: float = 1e-4,
+               threads: int = 0, progress=None):
+    """OLS/ridge (Cholesky) or lasso (coordinate descent), sklearn objectives. Returns (coef, intercept)."""
+    lib = _load()
+    if lib is None: raise NativeError(_load_error)
+    A = _as_matrix(X)
+    yv = np.ascontiguousarray(np.asarray(y, dtype=np.float64).reshape(-1))
+    w = np.zeros(A.shape[1], dtype=np.float64); b = ctypes.c_double(0.0)
+    cb = _fit_cb(progress)
+    _check(lib.aifd_linear(A.ctypes.data, A.shape[0], A.shape[1], yv.ctypes.data, LINEAR_KINDS[kind],
+                           float(alpha), int(max_iter), float(tol), int(threads),
+                           w.ctypes.data, ctypes.byref(b), cb, None), kind)
+    return w, float(b.value)
+
+def logreg_fit(X, y_idx, n_classes: int, C: float = 1.0, penalty: str = "L2", max_iter: int = 200,
+               tol: float = 1e-4, threads: int = 0, progress=None) -> np.ndarray:
+    """L-BFGS (L2) / OWL-QN (L1) logistic regression; y_idx in 0..n_classes-1.
+    Returns W of shape (1 if binary else n_classes, d+1); the last column is the intercept."""
+    lib = _load()
+    if lib is None: raise NativeError(_load_error)
+    A = _as_matrix(X)
+    yi = np.ascontiguousarray(np.asarray(y_idx).reshape(-1).astype(np.int32))
+    k = int(n_classes)
+    W = np.zeros((1 if k == 2 else k, A.shape[1] + 1), dtype=np.float64)
+    cb = _fit_cb(progress)
+    _check(lib.aifd_logreg(A.ctypes.data, A.shape[0], A.shape[1], yi.ctypes.data, k, float(C),
+                           1 if str(penalty).upper() == "L1" else 0, int(max_iter), float(tol), int(threads),
+                           W.ctypes.data, cb, None), "logreg")
+    return W
+
+MLP_ACTS = {"relu": 0, "tanh": 1}
+MLP_OPTS = {"adam": 0, "sgd": 1}
+
+def mlp_fit(X, y, n_classes: int = 0, hidden: int = 64, layers: int = 2, activation: str = "relu",
+            optimizer: str = "adam", lr: float = 1e-3, batch_size: int = 64, epochs: int = 100,
+            seed: int = 42, threads: int = 0, params: Optional[np.ndarray] = None, progress=None):
+    """
+    Dense MLP (same layout as mlp_reg/mlp_cls). n_classes = 0 for regression, else
+    y holds class indices. `params` (float32, from a previous call) warm-starts.
+    Returns (params, finished); `progress(epoch, epochs, loss, score)` True stops early.
+    """
+    lib = _load()
+    if lib is None: raise NativeError(_load_error)
+    A = _as_matrix(X)
+    yv = np.ascontiguousarray(np.asarray(y, dtype=np.float64).reshape(-1))
+    k, act = int(n_classes), MLP_ACTS[str(activation).lower()]
+    size = int(lib.aifd_mlp_params(A.shape[1], int(hidden), int(layers), k))
+    warm = params is not None and np.asarray(params).size == size
+    P = np.array(params, dtype=np.float32).reshape(-1) if warm else np.zeros(size, dtype=np.float32)
+    cb = _fit_cb(progress)
+    done = _check(lib.aifd_mlp_train(A.ctypes.data, A.shape[0], A.shape[1], yv.ctypes.data, k,
+                                     int(hidden), int(layers), act, MLP_OPTS[str(optimizer).lower()],
+                                     float(lr), int(batch_size), int(epochs), int(seed) & 0xFFFFFFFFFFFFFFFF,
+                                     int(threads), 1 if warm else 0, P.ctypes.data, cb, None), "mlp")
+    return P, done
+
+def mlp_predict(X, params: np.ndarray, n_classes: int = 0, hidden: int = 64, layers: int = 2,
+                activation: str = "relu", threads: int = 0) -> np.ndarray:
+    """Regression values (n,), P(class 1) (n,) for binary, or class probabilities (n, k)."""
+    lib = _load()
+    if lib is None: raise NativeError(_load_error)
+    A = _as_matrix(X)
+    P = np.ascontiguousarray(params, dtype=np.float32)
+    k = int(n_classes)
+    out = np.zeros((A.shape[0], k if k > 2 else 1), dtype=np.float64)
+    _check(lib.aifd_mlp_infer(A.ctypes.data, A.shape[0], A.shape[1], k, int(hidden), int(layers),
+                              MLP_ACTS[str(activation).lower()], P.ctypes.data, out.ctypes.data, int(threads)), "mlp")
+    return out if k > 2 else out[:, 0]
+
+# flat preorder nodes (left child = next node); feature < 0 marks a leaf whose `right` indexes values
+TREE_NODE = np.dtype([("feature", "<i4"), ("right", "<i4"), ("thr", "<f8")])
+
+def forest_fit(X, y, n_classes: int = 0, n_trees: int = 100, max_depth: Optional[int] = None,
+               min_samples_leaf: int = 1, max_features: float = 0.0, bootstrap: bool = True,
+               seed: int = 42, first_tree: int = 0, threads: int = 0, progress=None):
+    """
+    CART trees on quantile-binned features, built in parallel (one tree per task).
+    n_classes = 0 for regression, else y holds class indices. max_features is a
+    fraction of the columns (0 = sqrt for classes, all for regression). `first_tree`
+    continues the per-tree seeds, so two calls can be concatenated (warm start).
+    Returns (nodes, roots, values, finished); `progress(trees, total, oob_loss, oob_score)`.
+    """
+    lib = _load()
+    if lib is None: raise NativeError(_load_error)
+    A = _as_matrix(X)
+    yv = np.ascontiguousarray(np.asarray(y, dtype=np.float64).reshape(-1))
+    cb, rc = _fit_cb(progress), ctypes.c_int(0)
+    h = lib.aifd_forest_train(A.ctypes.data, A.shape[0], A.shape[1], yv.ctypes.data, int(n_classes),
+                              int(n_trees), int(max_depth or 0), int(min_samples_leaf), float(max_features),
+                              1 if bootstrap else 0, int(seed) & 0xFFFFFFFFFFFFFFFF, int(first_tree),
+                              int(threads), cb, None, ctypes.byref(rc))
+    done = _check(rc.value, "forest")
+    try:
+        sizes = np.zeros(3, dtype=np.int32)
+        lib.aifd_forest_sizes(h, sizes.ctypes.data)
+        nodes = np.zeros(int(sizes[1]), dtype=TREE_NODE)
+        roots = np.zeros(int(sizes[0]), dtype=np.int32)
+        values = np.zeros(int(sizes[2]), dtype=np.float64)
+        lib.aifd_forest_export(h, nodes.ctypes.data, roots.ctypes.data, values.ctypes.data)
+    finally:
+        lib.aifd_forest_release(h)
+    return nodes, roots, values, done
+
+def forest_concat(a, b):
+    """Appends forest b = (nodes, roots, values) to a, rebasing b's absolute indices."""
+    nodes = b[0].copy(); leaf = nodes["feature"] < 0
+    nodes["right"] += np.where(leaf, len(a[2]), len(a[0])).astype(np.int32)
+    return (np.concatenate([a[0], nodes]), np.concatenate([a[1], b[1] + len(a[0])]).astype(np.int32),
+            np.concatenate([a[2], b[2]]))
+
+def forest_predict(X, nodes, roots, values, n_classes: int = 0, threads: int = 0) -> np.ndarray:
+    """Mean over the trees: class probabilities (n, k) or regression values (n,)."""
+    lib = _load()
+    if lib is None: raise NativeError(_load_error)
+    A = _as_matrix(X)
+    nd = np.ascontiguousarray(nodes, dtype=TREE_NODE)
+    rt = np.ascontiguousarray(roots, dtype=np.int32)
+    vl = np.ascontiguousarray(values, dtype=np.float64)
+    k = int(n_classes)
+    out = np.zeros((A.shape[0], k) if k else A.shape[0], dtype=np.float64)
+    _check(lib.aifd_forest_infer(nd.ctypes.data, rt.ctypes.data, vl.ctypes.data, len(rt), k,
+                                 A.ctypes.data, A.shape[0], A.shape[1], out.ctypes.data, int(threads)), "forest")
+    return out
+
+def _gbdt_outputs(k: int) -> int:
+    return k if k > 2 else 1
+
+def gbdt_fit(X, y, n_classes: int = 0, rounds: int = 100, learning_rate: float = 0.1,
+             max_leaf_nodes: int = 31, max_depth: Optional[int] = None, min_samples_leaf: int = 20,
+             l2: float = 0.0, init: Optional[np.ndarray] = None, threads: int = 0, progress=None):
+    """
+    Histogram gradient boosting (leaf-wise trees on uint8 quantile bins). n_classes = 0
+    for squared loss, 2 for logistic, k > 2 for softmax (k trees per round). `init`
+    (n, K) raw scores from a previous model continue the boosting. Returns
+    (nodes, roots, values, base, finished); `progress(round, rounds, loss, score)`.
+    """
+    lib = _load()
+    if lib is None: raise NativeError(_load_error)
+    A = _as_matrix(X)
+    yv = np.ascontiguousarray(np.asarray(y, dtype=np.float64).reshape(-1))
+    k = int(n_classes); K = _gbdt_outputs(k)
+    F0 = None if init is None else np.ascontiguousarray(np.asarray(init, dtype=np.float64).reshape(A.shape[0], K))
+    cb, rc = _fit_cb(progress), ctypes.c_int(0)
+    h = lib.aifd_gbdt_train(A.ctypes.data, A.shape[0], A.shape[1], yv.ctypes.data, k,
+                            None if F0 is None else F0.ctypes.data, int(rounds), float(learning_rate),
+                            int(max_leaf_nodes), int(max_depth or 0), int(min_samples_leaf), float(l2),
+                            int(threads), cb, None, ctypes.byref(rc))
+    done = _check(rc.value, "gbdt")
+    try:
+        sizes = np.zeros(3, dtype=np.int32)
+        lib.aifd_gbdt_sizes(h, sizes.ctypes.data)
+        nodes = np.zeros(int(sizes[1]), dtype=TREE_NODE)
+        roots = np.zeros(int(sizes[0]), dtype=np.int32)
+        values = np.zeros(int(sizes[2]), dtype=np.float64)
+        base = np.zeros(K, dtype=np.float64)
+        lib.aifd_gbdt_export(h, nodes.ctypes.data, roots.ctypes.data, values.ctypes.data, base.ctypes.data)
+    finally:
+        lib.aifd_gbdt_release(h)
+    return nodes, roots, values, base, done
+
+def gbdt_predict(X, nodes, roots, values, base, n_classes: int = 0, raw: bool = False,
+                 threads: int = 0) -> np.ndarray:
+    """Regression values (n,), P(class 1) (n,) for binary, class probabilities (n, k); raw=True skips the link."""
+    lib = _load()
+    if lib is None: raise NativeError(_load_error)
+    A = _as_matrix(X)
+    nd = np.ascontiguousarray(nodes, dtype=TREE_NODE)
+    rt = np.ascontiguousarray(roots, dtype=np.int32)
+    vl = np.ascontiguousarray(values, dtype=np.float64)
+    bs = np.ascontiguousarray(base, dtype=np.float64)
+    k = int(n_classes); K = _gbdt_outputs(k)
+    out = np.zeros((A.shape[0], K), dtype=np.float64)
+    _check(lib.aifd_gbdt_infer(nd.ctypes.data, rt.ctypes.data, vl.ctypes.data, len(rt), bs.ctypes.data, k,
+                               A.ctypes.data, A.shape[0], A.shape[1], 1 if raw else 0,
+                               out.ctypes.data, int(threads)), "gbdt")
+    return out if K > 1 else out[:, 0]
+
+KNN_ALGOS = ("auto", "brute", "kd_tree", "hnsw")
+
+class KnnIndex:
+    """
+    Neighbour index over a copy of X: KD-tree (exact, low d), HNSW graph (approximate,
+    high d) or brute force; "auto" picks by n and d. Batch queries run across threads.
+    Holds a native handle, so it does not pickle; rebuild it from X instead.
+    """
+    def __init__(self, X, algorithm: str = "auto", M: int = 16, ef_construction: int = 100,
+                 seed: int = 42, threads: int = 0):
+        self._lib, self._h = _load(), None
+        if self._lib is None: raise NativeError(_load_error)
+        if algorithm not in KNN_ALGOS: raise ValueError(f"unknown knn algorithm {algorithm!r}")
+        A = _as_matrix(X)
+        rc = ctypes.c_int(0)
+        self._h = self._lib.aifd_knn_new(A.ctypes.data, A.shape[0], A.shape[1], KNN_ALGOS.index(algorithm),
+                                         int(M), int(ef_construction), int(seed) & 0xFFFFFFFFFFFFFFFF,
+                                         int(threads), ctypes.byref(rc))
+        _check(rc.value, "knn index")
+        self.n, self.d = A.shape
+        self.algorithm = KNN_ALGOS[self._lib.aifd_knn_algo(self._h)]
+    def __del__(self):
+        if getattr(self, "_h", None):
+            self._lib.aifd_knn_release(self._h)
+            self._h = None
+    def _queries(self, Q) -> np.ndarray:
+        A = _as_matrix(Q)
+        if A.shape[1] != self.d:
+            raise ValueError(f"index has {self.d} features, got {A.shape[1]}")
+        return A
+    def query(self, Q, k: int, ef: int = 0, threads: int = 0):
+        """(dist, idx), each (m, k) in ascending distance; ef widens the HNSW search."""
+        A = self._queries(Q)
+        idx = np.zeros((A.shape[0], int(k)), dtype=np.int32)
+        dist = np.zeros((A.shape[0], int(k)), dtype=np.float64)
+        _check(self._lib.aifd_knn_search(self._h, A.ctypes.data, A.shape[0], int(k), int(ef),
+                                         idx.ctypes.data, dist.ctypes.data, int(threads)), "knn")
+        return dist, idx
+    def vote(self, Q, y, k: int, n_classes: int = 0, ef: int = 0, threads: int = 0) -> np.ndarray:
+        """Uniform-weight neighbour vote: class probabilities (m, n_classes) or the mean of y (m,)."""
+        A = self._queries(Q)
+        yv = np.ascontiguousarray(np.asarray(y, dtype=np.float64).reshape(-1))
+        if len(yv) != self.n: raise ValueError("y does not match the indexed rows")
+        nc = int(n_classes)
+        out = np.zeros((A.shape[0], nc) if nc else A.shape[0], dtype=np.float64)
+        _check(self._lib.aifd_knn_vote(self._h, yv.ctypes.data, nc, A.ctypes.data, A.shape[0], int(k),
+                                       int(ef), out.ctypes.data, int(threads)), "knn")
+        return out
+
+CSV_KINDS = ("float", "int", "text")
+_BOOL_LEVELS = {"True": True, "False": False, "TRUE": True, "FALSE": False, "true": True, "false": False}
+
+def read_csv(path, delimiter: str = ",", float32: bool = False, threads: int = 0):
+    """
+    Multi-threaded CSV parse into (names, columns, seconds), with read_csv's defaults:
+    its NA markers, int64 for integer-only columns, bool for True/False columns,
+    object arrays of str (NaN = missing) for text. Column names as pandas gives them:
+    an empty header is "Unnamed: <index>", repeated names get ".1", ".2".
+    """
+    lib = _load()
+    if lib is None: raise NativeError(_load_error)
+    rc = ctypes.c_int(0)
+    h = lib.aifd_csv_open(os.fsencode(str(path)), ord(delimiter) if delimiter else 0, 1, 1 if float32 else 0,
+                          1, int(threads), ctypes.byref(rc))
+    _check(rc.value, f"csv {path}")
+    try:
+        shape, secs = np.zeros(3, dtype=np.int64), ctypes.c_double(0.0)
+        lib.aifd_csv_shape(h, shape.ctypes.data, ctypes.byref(secs))
+        rows, cols = int(shape[0]), int(shape[1])
+        names = [lib.aifd_csv_name(h, j).decode("utf-8", "replace") or f"Unnamed: {j}" for j in range(cols)]
+        header, seen = set(names), {}
+        for j, name in enumerate(names):   # pandas' C parser: the next ".k" not in the header and not used
+            base, count = name, seen.get(name, 0)
+            while count > 0:
+                seen[base] = count + 1
+                name = f"{base}.{count}"
+                count = count + 1 if name in header else seen.get(name, 0)
+            names[j] = name
+            seen[name] = count + 1
+        columns = []
+        for j in range(cols):
+            kind, ptr = CSV_KINDS[lib.aifd_csv_kind(h, j)], lib.aifd_csv_data(h, j)
+            if rows == 0:
+                columns.append(np.empty(0, dtype=object))   # header only: read_csv leaves object columns
+                continue
+            if kind != "text":
+                ct = ctypes.c_float if float32 else ctypes.c_double
+                col = np.ctypeslib.as_array(ctypes.cast(ptr, ctypes.POINTER(ct)), shape=(rows,)).copy()
+                columns.append(col.astype(np.int64) if kind == "int" else col)
+                continue
+            n, size = ctypes.c_int(0), ctypes.c_longlong(0)
+            lp = lib.aifd_csv_levels(h, j, ctypes.byref(n), ctypes.byref(size))
+            levels = [b.decode("utf-8", "replace") for b in ctypes.string_at(lp, size.value).split(b"\0")[:n.value]] \
+                if n.value else []
+            codes = np.ctypeslib.as_array(ctypes.cast(ptr, ctypes.POINTER(ctypes.c_int32)), shape=(rows,))
+            if levels and all(l in _BOOL_LEVELS for l in levels) and not (codes < 0).any():
+                columns.append(np.array([_BOOL_LEVELS[l] for l in levels], dtype=bool)[codes])
+                continue
+            table = np.empty(len(levels) + 1, dtype=object)
+            table[:len(levels)] = levels
+            table[len(levels)] = np.nan   # code -1
+            columns.append(table[codes])
+        return names, columns, secs.value
+    finally:
+        lib.aifd_csv_release(h)
+
+IMPUTES = ("mean", "median", "most_frequent", "zero")
+SCALES = ("none", "standard", "minmax")
+
+def _out_block(out: np.ndarray, n: int, width: int):
+    """(pointer, row stride, f32) of a C-ordered float block, possibly a column slice of a wider matrix."""
+    if out.dtype not in (np.float32, np.float64) or out.shape != (n, width) or (width and out.strides[1] != out.itemsize):
+        raise ValueError("output block must be float32/float64 (n, width) with contiguous rows")
+    return out.ctypes.data, (out.strides[0] // out.itemsize if n > 1 else width), 1 if out.dtype == np.float32 else 0
+
+def prep_fit(X, impute: str = "mean", scale: str = "standard", threads: int = 0) -> dict:
+    """
+    SimpleImputer + StandardScaler/MinMaxScaler statistics for the numeric columns
+    of X (NaN = missing): {"out", "fill", "a", "b", "scale", "out_dim"}, plain arrays.
+    out[j] = -1 marks an all-missing column, which sklearn drops (except impute=zero).
+    """
+    lib = _load()
+    if lib is None: raise NativeError(_load_error)
+    A = _as_matrix(X)
+    n, d = A.shape
+    rc = ctypes.c_int(0)
+    h = lib.aifd_prep_new(A.ctypes.data, n, d, d, IMPUTES.index(impute), SCALES.index(scale), int(threads),
+                          ctypes.byref(rc))
+    _check(rc.value, "prep")
+    try:
+        p = {"out": np.zeros(d, dtype=np.int32), "fill": np.zeros(d), "a": np.zeros(d), "b": np.zeros(d),
+             "scale": scale, "out_dim": int(lib.aifd_prep_out_dim(h))}
+        lib.aifd_prep_export(h, p["out"].ctypes.data, p["fill"].ctypes.data, p["a"].ctypes.data, p["b"].ctypes.data)
+    finally:
+        lib.aifd_prep_release(h)
+    return p
+
+def prep_apply(X, p: dict, out: Optional[np.ndarray] = None, threads: int = 0) -> np.ndarray:
+    """Imputed + scaled columns of X into `out` (n, out_dim); float32 out skips a float64 copy."""
+    lib = _load()
+    if lib is None: raise NativeError(_load_error)
+    A = _as_matrix(X)
+    if A.shape[1] != len(p["out"]): raise ValueError(f"prep fitted on {len(p['out'])} columns, got {A.shape[1]}")
+    if out is None: out = np.empty((A.shape[0], p["out_dim"]), dtype=np.float64)
+    ptr, ldo, f32 = _out_block(out, A.shape[0], p["out_dim"])
+    _check(lib.aifd_prep_apply(p["out"].ctypes.data, p["fill"].ctypes.data, p["a"].ctypes.data, p["b"].ctypes.data,
+                               A.shape[1], SCALES.index(p["scale"]), A.ctypes.data, A.shape[0], A.shape[1],
+                               ptr, ldo, f32, int(threads)), "prep")
+    return out
+
+def onehot_fit(codes, levels, impute: str = "most_frequent"):
+    """
+    One-hot layout for a text column given as codes into `levels` (-1 = missing):
+    (slot, order). slot[code] is the output column (-1 unseen), slot[len(levels)] the
+    column missing values go to; order[k] is the level of column k (-1 = the "" fill).
+    """
+    lib = _load()
+    if lib is None: raise NativeError(_load_error)
+    c = np.ascontiguousarray(codes, dtype=np.int32)
+    blob = b"".join(str(l).encode("utf-8") + b"\0" for l in levels)
+    rc = ctypes.c_int(0)
+    h = lib.aifd_onehot_new(c.ctypes.data, len(c), blob, len(levels), IMPUTES.index(impute), ctypes.byref(rc))
+    _check(rc.value, "onehot")
+    try:
+        slot = np.zeros(len(levels) + 1, dtype=np.int32)
+        order = np.zeros(int(lib.aifd_onehot_width(h)), dtype=np.int32)
+        lib.aifd_onehot_export(h, slot.ctypes.data, order.ctypes.data)
+    finally:
+        lib.aifd_onehot_release(h)
+    return slot, order
+
+def onehot_apply(codes, slot: np.ndarray, width: int, out: np.ndarray, threads: int = 0) -> np.ndarray:
+    """Writes the width one-hot columns into `out`; codes >= len(slot) - 1 are unknown (all zeros)."""
+    lib = _load()
+    if lib is None: raise NativeError(_load_error)
+    c = np.ascontiguousarray(codes, dtype=np.int32)
+    sl = np.ascontiguousarray(slot, dtype=np.int32)
+    ptr, ldo, f32 = _out_block(out, len(c), int(width))
+    _check(lib.aifd_onehot_apply(sl.ctypes.data, len(sl) - 1, int(width), c.ctypes.data, len(c),
+                                 ptr, ldo, f32, int(threads)), "onehot")
+    return out
+
+if __name__ == "__main__":
+    print("native:", available(), load_error() or f"simd={_load().aifd_simd_level()}", file=sys.stderr)
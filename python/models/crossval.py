@@ -0,0 +1,129 @@
+# python/models/crossval.py
+"""
+Pieces for `models.py --cv K`: fold indices (stratified for classifiers),
+arrays shared between the fold processes without copies or pickling, and the
+mean ± std report. The folds themselves are trained by models.py.
+"""
+from __future__ import annotations
+from typing import Dict, List, Optional, Sequence, Tuple
+from multiprocessing import shared_memory
+import numpy as np
+
+
+def kfold_indices(n: int, k: int, y_idx: Optional[np.ndarray] = None,
+                  seed: int = 123) -> List[Tuple[np.ndarray, np.ndarray]]:
+    """
+    (train, test) row indices for each of the k folds. With class indices the
+    rows of every class are dealt round-robin, so each fold keeps the class
+    proportions (StratifiedKFold without the sklearn dependency).
+    """
+    k = max(2, min(int(k), n))
+    rng = np.random.default_rng(seed)
+    fold_of = np.empty(n, dtype=np.int64)
+    if y_idx is None:
+        fold_of[rng.permutation(n)] = np.arange(n) % k
+    else:
+        offset = 0
+        for c in np.unique(y_idx):
+            rows = rng.permutation(np.flatnonzero(y_idx == c))
+            fold_of[rows] = (np.arange(rows.size) + offset) % k
+            offset += rows.size   # the next class continues where this one stopped: folds stay balanced
+    return [(np.flatnonzero(fold_of != f), np.flatnonzero(fold_of == f)) for f in range(k)]
+
+
+class SharedArray:
+    """
+    numpy array in a named shared-memory segment. `handle` is a small tuple
+    that pickles cheaply; attach() in another process maps the same pages.
+    """
+    def __init__(self, a: np.ndarray):
+        a = np.ascontiguousarray(a)
+        self.shm = shared_memory.SharedMemory(create=True, size=max(1, a.nbytes))
+        self.array = np.ndarray(a.shape, dtype=a.dtype, buffer=self.shm.buf)
+        self.array[...] = a
+        self.handle = (self.shm.name, a.shape, a.dtype.str)
+        self.nbytes = a.nbytes
+
+    @classmethod
+    def empty(cls, shape: Tuple[int, ...], dtype) -> "SharedArray":
+        """Uninitialised segment, filled in place by the caller (models.py --lean)."""
+        self = cls.__new__(cls)
+        dtype = np.dtype(dtype)
+        self.nbytes = int(np.prod(shape)) * dtype.itemsize
+        self.shm = shared_memory.SharedMemory(create=True, size=max(1, self.nbytes))
+        self.array = np.ndarray(shape, dtype=dtype, buffer=self.shm.buf)
+        self.handle = (self.shm.name, tuple(shape), dtype.str)
+        return self
+
+    @staticmethod
+    def attach(handle) -> Tuple[shared_memory.SharedMemory, np.ndarray]:
+        """(segment, view); keep the segment referenced while the view is in use."""
+        name, shape, dtype = handle
+        shm = shared_memory.SharedMemory(name=name)
+        return shm, np.ndarray(shape, dtype=np.dtype(dtype), buffer=shm.buf)
+
+    def release(self) -> None:
+        del self.array
+        self.shm.close()
+        self.shm.unlink()
+
+
+class SharedCSR:
+    """
+    scipy CSR matrix as three SharedArrays (data, indices, indptr), with the
+    same handle/release protocol; attach_matrix() maps either kind.
+    """
+    def __init__(self, X):
+        X = X.tocsr()
+        self.parts = [SharedArray(X.data), SharedArray(X.indices), SharedArray(X.indptr)]
+        self.handle = ("csr", X.shape, tuple(p.handle for p in self.parts))
+        self.nbytes = sum(p.nbytes for p in self.parts)
+
+    def release(self) -> None:
+        for p in self.parts:
+            p.release()
+
+
+def share_matrix(X):
+    return SharedCSR(X) if hasattr(X, "tocsr") else SharedArray(X)
+
+
+def attach_matrix(handle) -> Tuple[List[shared_memory.SharedMemory], object]:
+    """(segments, matrix) for a SharedArray or SharedCSR handle; close the segments once the matrix is dropped."""
+    if handle[0] != "csr":
+        shm, a = SharedArray.attach(handle)
+        return [shm], a
+    import scipy.sparse as sp
+    _, shape, parts = handle
+    maps = [SharedArray.attach(h) for h in parts]
+    return [m[0] for m in maps], sp.csr_matrix(tuple(m[1] for m in maps), shape=shape, copy=False)
+
+
+def confusion_scores(y_true: np.ndarray, y_pred: np.ndarray, n_classes: int) -> Dict[str, float]:
+    """Accuracy and macro precision/recall/F1 from class indices."""
+    cm = np.zeros((n_classes, n_classes), dtype=np.int64)
+    np.add.at(cm, (y_true.astype(np.int64), y_pred.astype(np.int64)), 1)
+    tp = np.diag(cm).astype(np.float64)
+    prec = tp / np.maximum(cm.sum(axis=0), 1)
+    rec = tp / np.maximum(cm.sum(axis=1), 1)
+    f1 = 2 * prec * rec / np.maximum(prec + rec, 1e-12)
+    present = cm.sum(axis=1) > 0   # classes absent from this fold don't drag the macro average
+    return {"accuracy": float(tp.sum() / max(1, cm.sum())),
+            "precision_macro": float(prec[present].mean()) if present.any() else 0.0,
+            "recall_macro": float(rec[present].mean()) if present.any() else 0.0,
+            "f1_macro": float(f1[present].mean()) if present.any() else 0.0}
+
+
+def report(folds: Sequence[Dict[str, float]], keys: Sequence[Tuple[str, str]], k: int,
+           stratified: bool, seconds: float, workers: int) -> str:
+    """Text for the Metrics panel: mean ± std per metric, then one line per fold."""
+    lines = [f"=== {k}-fold cross-validation{' (stratified)' if stratified else ''} ===",
+             f"{len(folds)}/{k} folds, {workers} worker(s), {seconds:.1f}s"]
+    for key, label in keys:
+        v = np.array([f[key] for f in folds], dtype=np.float64)
+        lines.append(f"{label:<10}: {v.mean():.6f} ± {v.std(ddof=1) if v.size > 1 else 0.0:.6f}")
+    lines.append("")
+    for f in sorted(folds, key=lambda f: f["fold"]):
+        lines.append(f"fold {f['fold'] + 1:>2}: " + "  ".join(f"{label.strip()} {f[key]:.4f}" for key, label in keys)
+                     + f"  ({f['seconds']:.1f}s)")
+    return "\n".join(lines)
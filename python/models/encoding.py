@@ -0,0 +1,120 @@
+# python/models/encoding.py
+"""
+Categorical encoding for `models.py --onehot` on high-cardinality columns:
+exact one-hot or feature hashing into a fixed number of buckets, built
+straight into a CSR matrix (numeric block first, as in build_preprocessor)
+so a column with 100k distinct IDs costs one stored value per row instead of
+100k dense columns. The numeric block comes from the caller's preprocessor.
+"""
+from __future__ import annotations
+from typing import Any, Dict, List, Optional
+import numpy as np
+import pandas as pd
+
+
+def hash_buckets(col: str, values, buckets: int) -> np.ndarray:
+    """Bucket of each "col=value" (pandas' siphash: stable across runs and platforms)."""
+    keys = np.asarray([f"{col}={v}" for v in values], dtype=object)
+    if keys.size == 0:
+        return np.zeros(0, dtype=np.int64)
+    return (pd.util.hash_array(keys, categorize=False) % np.uint64(buckets)).astype(np.int64)
+
+
+def csr_bytes(rows: int, width: int, nnz: int) -> int:
+    """float32 data + scipy's index arrays (int32 until nnz or width reach 2**31)."""
+    idx = 4 if max(nnz, width) < 2 ** 31 else 8
+    return nnz * (4 + idx) + (rows + 1) * idx
+
+
+class SparseEncoder:
+    """
+    fit/transform over a DataFrame. `numeric` is any fit/transform object for the
+    numeric columns (NativePreprocessor or a ColumnTransformer); categorical
+    columns are imputed like build_preprocessor ("" for zero, else the most
+    frequent value) and get one column per category (buckets = 0, categories
+    sorted like OneHotEncoder, unseen ones all zeros) or `buckets` shared hashed
+    columns. Plain attributes only, so it pickles into the preprocessing cache.
+    """
+    def __init__(self, impute: str, buckets: int = 0, numeric: Any = None):
+        self.impute = impute
+        self.buckets = max(0, int(buckets))
+        self.numeric = numeric
+
+    def fit(self, dfX: "pd.DataFrame") -> "SparseEncoder":
+        self.num_cols = [c for c in dfX.columns if pd.api.types.is_numeric_dtype(dfX[c])]
+        self.cat_cols = [c for c in dfX.columns if c not in self.num_cols]
+        self.num_width_ = 0
+        if self.num_cols:
+            num = dfX[self.num_cols]
+            self.numeric.fit(num)
+            self.num_width_ = int(np.asarray(self.numeric.transform(num.iloc[:1])).shape[1])
+        self.fill_: List[str] = []
+        self.categories_: List[List[str]] = []
+        for c in self.cat_cols:
+            s = dfX[c]
+            vc = s[s.notna()].astype(str).value_counts()
+            if self.impute == "zero" or vc.empty:
+                fill = ""
+            else:
+                fill = str(min(vc.index[vc.to_numpy() == vc.max()]))   # ties -> smallest, as SimpleImputer
+            self.fill_.append(fill)
+            if not self.buckets:
+                cats = set(vc.index)
+                if s.isna().any():
+                    cats.add(fill)
+                self.categories_.append(sorted(cats))
+        self.width = self.num_width_ + (self.buckets if self.buckets else sum(len(c) for c in self.categories_))
+        return self
+
+    def _ids(self, dfX: "pd.DataFrame") -> np.ndarray:
+        """(rows, categorical columns) output column per cell; -1 = unseen category."""
+        ids = np.empty((len(dfX), len(self.cat_cols)), dtype=np.int64)
+        off = self.num_width_
+        for j, c in enumerate(self.cat_cols):
+            codes, uniques = pd.factorize(dfX[c])
+            levels = [str(u) for u in uniques] + [self.fill_[j]]   # code -1 (missing) -> the fill value
+            if self.buckets:
+                table = off + hash_buckets(c, levels, self.buckets)
+            else:
+                where = {v: k for k, v in enumerate(self.categories_[j])}
+                table = np.array([off + where[v] if v in where else -1 for v in levels], dtype=np.int64)
+                off += len(self.categories_[j])
+            ids[:, j] = table[codes]
+        return ids
+
+    def transform(self, dfX: "pd.DataFrame", sparse: bool = True):
+        """CSR float32 (sparse=True) or the same matrix dense."""
+        import scipy.sparse as sp
+        n, dn = len(dfX), self.num_width_
+        k = dn + len(self.cat_cols)
+        data = np.zeros((n, k), dtype=np.float32)
+        cols = np.zeros((n, k), dtype=np.int64)
+        if dn:
+            data[:, :dn] = np.asarray(self.numeric.transform(dfX[self.num_cols]), dtype=np.float32)
+            cols[:, :dn] = np.arange(dn)
+        if self.cat_cols:
+            ids = self._ids(dfX)
+            hit = ids >= 0
+            data[:, dn:] = hit
+            cols[:, dn:] = np.where(hit, ids, 0)
+        idx = np.int32 if max(n * k, self.width) < 2 ** 31 else np.int64
+        X = sp.csr_matrix((data.ravel(), cols.ravel().astype(idx), np.arange(0, n * k + 1, k, dtype=idx)),
+                          shape=(n, self.width))
+        del data, cols
+        X.sum_duplicates()   # hashed columns that collide in a row add up
+        X.eliminate_zeros()
+        return X if sparse else X.toarray()
+
+    def fit_transform(self, dfX: "pd.DataFrame", sparse: bool = True):
+        return self.fit(dfX).transform(dfX, sparse)
+
+    def estimate(self, rows: int) -> Dict[str, int]:
+        """Output size before transforming: width, stored values (upper bound), dense and CSR bytes."""
+        nnz = rows * (self.num_width_ + len(self.cat_cols))
+        return {"width": self.width, "nnz": nnz, "dense_bytes": rows * self.width * 4,
+                "csr_bytes": csr_bytes(rows, self.width, nnz)}
+
+    def describe(self) -> str:
+        enc = f"hashed into {self.buckets} buckets" if self.buckets else \
+            "one-hot (" + ", ".join(f"{c}: {len(k)}" for c, k in zip(self.cat_cols, self.categories_)) + ")"
+        return f"{len(self.num_cols)} numeric + {len(self.cat_cols)} categorical {enc}"
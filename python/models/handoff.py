@@ -0,0 +1,60 @@
+# python/models/handoff.py
+"""
+Reader for the dataset segment the GTK client writes before it starts the
+trainer (`models.py --shm PATH`). Layout, little-endian:
+
+    b"AIFDSHM1" | u32 schema length | u32 reserved | schema JSON | pad to 64
+    data: X float64 rows x d (row-major, NaN = missing), then y float64 rows
+
+The schema names the CSV it came from (size + mtime in ns), the columns and, for a
+text target, the class names (y then holds class indices). The arrays are
+mapped read-only: no CSV parse and no copy.
+"""
+from __future__ import annotations
+from typing import List, Tuple
+import json, os
+import numpy as np
+import pandas as pd
+
+MAGIC = b"AIFDSHM1"
+
+
+class Segment:
+    def __init__(self, path: str):
+        self.path = path
+        self.mm = np.memmap(path, dtype=np.uint8, mode="r")
+        if bytes(self.mm[:8]) != MAGIC:
+            raise ValueError("not an AIFD dataset segment")
+        jlen = int(np.frombuffer(self.mm, dtype="<u4", count=1, offset=8)[0])
+        self.schema = json.loads(bytes(self.mm[16:16 + jlen]).decode("utf-8"))
+        base = (16 + jlen + 63) // 64 * 64
+        self.rows = int(self.schema["rows"])
+        x, y = self.schema["x"], self.schema.get("y")
+        self.x_names: List[str] = list(x["names"])
+        self.X = np.frombuffer(self.mm, dtype=np.dtype(x["dtype"]), count=self.rows * len(self.x_names),
+                               offset=base + int(x["offset"])).reshape(self.rows, len(self.x_names))
+        self.y_name = y["name"] if y else None
+        self.y = np.frombuffer(self.mm, dtype=np.dtype(y["dtype"]), count=self.rows,
+                               offset=base + int(y["offset"])) if y else None
+        self.y_classes = y.get("classes") if y else None
+
+    def matches(self, csv_path: str, x_names: List[str], y_names: List[str]) -> bool:
+        """Same file (size + nanosecond mtime) and every requested column present."""
+        st = os.stat(csv_path)
+        return (int(self.schema.get("csv_size", -1)) == st.st_size
+                and int(self.schema.get("csv_mtime_ns", -1)) == st.st_mtime_ns   # JSON string: exact past 2^53
+                and all(n in self.x_names for n in x_names)
+                and list(y_names) == [self.y_name])
+
+    def frames(self, x_names: List[str], y_names: List[str]) -> Tuple[pd.DataFrame, pd.DataFrame]:
+        """(dfX, dfY) over the mapped arrays; X is a view when the columns come in segment order."""
+        idx = [self.x_names.index(n) for n in x_names]
+        X = self.X if idx == list(range(len(self.x_names))) else self.X[:, idx]
+        dfX = pd.DataFrame(X, columns=list(x_names), copy=False)
+        y = self.y
+        if self.y_classes is not None:
+            labels = np.asarray(list(self.y_classes) + [np.nan], dtype=object)
+            y = labels[np.where(np.isnan(y), len(self.y_classes), y).astype(np.int64)]
+        elif not np.isnan(y).any() and np.all(y == np.round(y)):
+            y = y.astype(np.int64)   # what read_csv infers for a column of integers
+        return dfX, pd.DataFrame({y_names[0]: y})
@@ -2,7 +2,7 @@
 from __future__ import annotations
 from typing import Tuple, List, Optional, Dict, Any, Union
 from pathlib import Path
-import os, sys, json, time, argparse
+import os, sys, json, time, argparse, warnings, atexit, hashlib
 
 if os.name == "nt":
     try:
@@ -12,9 +12,16 @@ if os.name == "nt":
         pass
 
 import numpy as np
-import torch
-import torch.nn as nn
-import torch.optim as optim
+
+# --- torch is optional: without it the MLPs train on the native core (--engine native) ---
+_TORCH_OK = True
+try:
+    import torch
+    import torch.nn as nn
+    import torch.optim as optim
+except Exception:
+    _TORCH_OK = False
+    torch = nn = optim = None  # type: ignore
 
 import math
 
@@ -39,7 +46,8 @@ try:
     from sklearn.ensemble import RandomForestClassifier, RandomForestRegressor
     from sklearn.neighbors import KNeighborsClassifier, KNeighborsRegressor
     from sklearn.naive_bayes import GaussianNB
-    from sklearn.svm import SVC, SVR
+    from sklearn.svm import SVC, SVR, LinearSVC, LinearSVR
+    from sklearn.kernel_approximation import Nystroem, RBFSampler
     from sklearn.ensemble import GradientBoostingClassifier, GradientBoostingRegressor
     from sklearn.multiclass import OneVsRestClassifier
     # metrics
@@ -47,6 +55,19 @@ try:
 except Exception:
     _SK_OK = False
 
+# --- native core (src/native, `make native`); sklearn/torch stay as the fallback ---
+_NATIVE_OK = False
+try:
+    import aifd_native as _native
+    _NATIVE_OK = _native.available()
+except Exception:
+    _native = None  # type: ignore
+
+# per-process thread cap (sweep.py shares the cores out this way); -1 = every core
+N_JOBS = int(os.environ.get("AIFD_THREADS", "0") or 0) or -1
+if _TORCH_OK and N_JOBS > 0:
+    torch.set_num_threads(N_JOBS)
+
 # headless plotting
 import matplotlib
 matplotlib.use("Agg")
@@ -57,31 +78,35 @@ CACHE_PATH = Path("./cache")
 Tensorable = Union[np.ndarray, List[float], List[int], "DataFrame", "Series"]
 
 
-class MLPReg(torch.nn.Module):
-    def __init__(self, in_dim, hidden=64):
-        super().__init__()
-        self.net = torch.nn.Sequential(
-            torch.nn.Linear(in_dim, hidden),
-            torch.nn.ReLU(),
-            torch.nn.Linear(hidden, hidden),
-            torch.nn.ReLU(),
-            torch.nn.Linear(hidden, 1),
-        )
-    def forward(self, x): return self.net(x).squeeze(-1)
-
-class MLPCls(torch.nn.Module):
-    def __init__(self, in_dim, n_classes, hidden=64):
-        super().__init__()
-        self.net = torch.nn.Sequential(
-            torch.nn.Linear(in_dim, hidden),
-            torch.nn.ReLU(),
-            torch.nn.Linear(hidden, hidden),
-            torch.nn.ReLU(),
-            torch.nn.Linear(hidden, n_classes),
-        )
-    def forward(self, x): return self.net(x)
+if _TORCH_OK:
+    class MLPReg(torch.nn.Module):
+        def __init__(self, in_dim, hidden=64):
+            super().__init__()
+            self.net = torch.nn.Sequential(
+                torch.nn.Linear(in_dim, hidden),
+                torch.nn.ReLU(),
+                torch.nn.Linear(hidden, hidden),
+                torch.nn.ReLU(),
+                torch.nn.Linear(hidden, 1),
+            )
+        def forward(self, x): return self.net(x).squeeze(-1)
+
+    class MLPCls(torch.nn.Module):
+        def __init__(self, in_dim, n_classes, hidden=64):
+            super().__init__()
+            self.net = torch.nn.Sequential(
+                torch.nn.Linear(in_dim, hidden),
+                torch.nn.ReLU(),
+                torch.nn.Linear(hidden, hidden),
+                torch.nn.ReLU(),
+                torch.nn.Linear(hidden, n_classes),
+            )
+        def forward(self, x): return self.net(x)
 
 # ---------- small helpers (kept from your file) ----------
+def _is_torch(model: Any) -> bool:
+    return _TORCH_OK and isinstance(model, nn.Module)
+
 def _ensure_cache_dir(path: Path = CACHE_PATH) -> Path:
     path.mkdir(parents=True, exist_ok=True); return path
 
@@ -148,7 +173,7 @@ def _train(
     trainee: nn.Module,
     fit_params: Optional[Dict[str, Any]] = None,
     progress_cb: Optional[Any] = None,
-    pause_file: Optional[Path] = None,
+    control: Optional[TrainControl] = None,
     **_: Any,
 ) -> Tuple[nn.Module, float]:
     fp = dict(fit_params or {})
@@ -206,13 +231,22 @@ def _train(
     loader = torch.utils.data.DataLoader(torch.utils.data.TensorDataset(Xtr_t, ytr_t),
                                          batch_size=bs, shuffle=bool(fp.get("shuffle", True)))
 
-    # Training loop with callbacks and pause-file
-    for e in range(1, epochs + 1):
+    ckpt_path = Path(fp.get("checkpoint_path", CKPT_PATH / "train.pt"))
+    start = 1
+    if fp.get("resume") and ckpt_path.exists():
+        start = load_checkpoint(ckpt_path, trainee, optimizer)["epoch"] + 1
+    done_epoch = start - 1
+    snapshot = lambda: save_checkpoint(ckpt_path, trainee, optimizer, done_epoch)
+
+    # Training loop with callbacks and the control channel (checked once per batch)
+    score = 0.0
+    for e in range(start, epochs + 1):
         trainee.train()
         running = 0.0; batches = 0
         for xb, yb in loader:
-            if pause_file is not None:
-                while pause_file.exists(): time.sleep(0.2)
+            if control is not None and not control.poll(snapshot):
+                snapshot()
+                return trainee, float(score)
             optimizer.zero_grad(set_to_none=True)
             logits = trainee(xb)
             if task == "regression":
@@ -243,52 +277,383 @@ def _train(
             score = _accuracy(yte_np, y_pred)
 
         avg_loss = running / max(1, batches)
+        done_epoch = e
         if progress_cb:
             progress_cb(epoch=e, epochs=epochs, loss=avg_loss, score=score)
 
     return trainee, float(score)
 
+# -------- content-keyed model cache: cache/models/<key>/ (model, metrics, final plot) ---
+MODEL_CACHE_PATH = CACHE_PATH / "models"
+
+class ModelCache:
+    """
+    One directory per request key (dataset digest + features + preprocessing +
+    algorithm + hyperparameters + run settings). An identical request replays the
+    stored metrics and plot; requests that only differ in hyperparameters/epochs
+    share a `family` and can warm start from the newest sibling. Least-recently
+    used entries are evicted once the store grows past `cap_mb`.
+    """
+    def __init__(self, root: Path = MODEL_CACHE_PATH, cap_mb: float = 512.0):
+        self.root = root
+        self.request = ""   # fresh key of the running request; warm entries are stored under their own key
+        self.cap_bytes = int(max(0.0, cap_mb) * 1024 * 1024)
+
+    @staticmethod
+    def digest(obj: Any) -> str:
+        raw = obj if isinstance(obj, bytes) else json.dumps(obj, sort_keys=True, default=str).encode()
+        return hashlib.blake2b(raw, digest_size=12).hexdigest()
+
+    def dataset_digest(self, path: str) -> str:
+        """Hash of the CSV bytes, memoized by (size, mtime) so unchanged files are not re-read."""
+        st = os.stat(path)
+        idx_path = self.root / "datasets.json"
+        try:
+            idx = json.loads(idx_path.read_text(encoding="utf-8"))
+        except Exception:
+            idx = {}
+        ap = os.path.abspath(path)
+        ent = idx.get(ap)
+        if ent and ent.get("size") == st.st_size and ent.get("mtime_ns") == st.st_mtime_ns:
+            return ent["digest"]
+        h = hashlib.blake2b(digest_size=16)
+        with open(path, "rb") as f:
+            for chunk in iter(lambda: f.read(1 << 20), b""):
+                h.update(chunk)
+        idx[ap] = {"size": st.st_size, "mtime_ns": st.st_mtime_ns, "digest": h.hexdigest()}
+        try:
+            _ensure_cache_dir(self.root)
+            idx_path.write_text(json.dumps(idx), encoding="utf-8")
+        except Exception:
+            pass
+        return idx[ap]["digest"]
+
+    def _meta(self, entry: Path) -> Optional[Dict[str, Any]]:
+        try:
+            return json.loads((entry / "meta.json").read_text(encoding="utf-8"))
+        except Exception:
+            return None
+
+    def _touch(self, entry: Path) -> None:
+        try: os.utime(entry / "meta.json", None)
+        except OSError: pass
+
+    def lookup(self, key: str) -> Optional[Path]:
+        entry = self.root / key
+        if self._meta(entry) is None:
+            return None
+        self._touch(entry)
+        return entry
+
+    def replay(self, key: str, out_plot: str, out_metrics: str) -> Optional[Dict[str, Any]]:
+        """Copies the stored plot/metrics to the requested outputs; returns meta on a hit."""
+        entry = self.lookup(key)
+        if entry is None:
+            return None
+        import shutil
+        for src, dst in ((entry / "plot.png", out_plot), (entry / "metrics.txt", out_metrics)):
+            if dst and src.exists():
+                tmp = dst + ".tmp"
+                shutil.copyfile(src, tmp)
+                _safe_replace(tmp, dst)
+        if (entry / "metrics.txt").exists():
+            print("\n" + (entry / "metrics.txt").read_text(encoding="utf-8"), flush=True)
+        return self._meta(entry)
+
+    def store(self, key: str, family: str, model: Any, metrics_text: str,
+              plot_path: str, meta: Dict[str, Any]) -> Path:
+        import shutil, pickle
+        entry = _ensure_cache_dir(self.root / key)
+        try:
+            if _is_torch(model):
+                torch.save({"state_dict": model.state_dict()}, entry / "model.pt")
+            else:
+                with open(entry / "model.pkl", "wb") as f:
+                    pickle.dump(model, f, protocol=pickle.HIGHEST_PROTOCOL)
+        except Exception as e:
+            print(f"[cache] model not serialized: {e}", flush=True)
+        (entry / "metrics.txt").write_text(metrics_text or "", encoding="utf-8")
+        if plot_path and os.path.exists(plot_path):
+            shutil.copyfile(plot_path, entry / "plot.png")
+        m = dict(meta); m.update({"key": key, "request": self.request or key, "family": family, "created": time.time()})
+        (entry / "meta.json").write_text(json.dumps(m, indent=2, default=str), encoding="utf-8")  # written last = complete
+        self.evict(keep=key)
+        return entry
+
+    def _newest(self, family: str, request: str, same: bool) -> Optional[Path]:
+        best, best_t = None, -1.0
+        if not self.root.exists():
+            return None
+        for entry in self.root.iterdir():
+            m = self._meta(entry) if entry.is_dir() else None
+            if m and m.get("family") == family and (m.get("request", entry.name) == request) == same:
+                t = (entry / "meta.json").stat().st_mtime
+                if t > best_t: best, best_t = entry, t
+        return best
+
+    def find_request(self, family: str, request: str) -> Optional[Path]:
+        """Newest entry stored for this request, fresh or warm-started."""
+        return self._newest(family, request, True)
+
+    def find_warm(self, family: str, request: str) -> Optional[Path]:
+        """Newest entry of the same family (same data/features/preprocessing/model) from another request."""
+        return self._newest(family, request, False)
+
+    def evict(self, keep: str = "") -> None:
+        _evict_lru(self.cap_bytes, self.root / keep if keep else None)
+
+def _evict_lru(cap_bytes: int, keep: Optional[Path] = None) -> None:
+    """
+    One LRU over the whole disk cache, so --cache-cap-mb bounds the sum of the stores:
+    model and preprocessing entries (directories, last use = meta.json mtime) and
+    projection files (last use = mtime) are deleted oldest first until under cap.
+    """
+    if cap_bytes <= 0:
+        return
+    items = []
+    for root in (MODEL_CACHE_PATH, PREPROC_CACHE_PATH, PROJ_CACHE_PATH):
+        if not root.exists():
+            continue
+        for p in root.iterdir():
+            try:
+                if p.is_dir():
+                    size = sum(f.stat().st_size for f in p.iterdir() if f.is_file())
+                    try: used = (p / "meta.json").stat().st_mtime
+                    except OSError: used = 0.0  # incomplete entry: evicted first
+                elif root == PROJ_CACHE_PATH:
+                    st = p.stat(); size, used = st.st_size, st.st_mtime
+                else:
+                    continue  # datasets.json index
+            except OSError:
+                continue
+            items.append((used, size, p))
+    total = sum(sz for _, sz, _ in items)
+    import shutil
+    for used, size, p in sorted(items, key=lambda e: e[0]):
+        if total <= cap_bytes: break
+        if keep is not None and p == keep: continue
+        try:
+            if p.is_dir(): shutil.rmtree(p, ignore_errors=True)
+            else: p.unlink()
+        except OSError:
+            continue
+        total -= size
+
+PREPROC_CACHE_PATH = CACHE_PATH / "preproc"
+
+class PreprocCache:
+    """
+    Fitted ColumnTransformer plus the split train/test matrices for one
+    (dataset digest, features, scale, impute, onehot, split seed, train pct).
+    X is kept as float32 .npy and memory-mapped (copy-on-write) on load, so a
+    run that only changes the algorithm or hyperparameters skips read_csv,
+    the preprocessor fit and the split. CSR matrices (--onehot with
+    high-cardinality columns) are stored as uncompressed .npz.
+    """
+    ARRAYS = ("Xtr", "Xte", "ytr", "yte")
+
+    def __init__(self, root: Path = PREPROC_CACHE_PATH, cap_mb: float = 512.0):
+        self.root = root
+        self.cap_bytes = int(max(0.0, cap_mb) * 1024 * 1024)
+
+    def load(self, key: str) -> Optional[Dict[str, Any]]:
+        import pickle
+        entry = self.root / key
+        try:
+            meta = json.loads((entry / "meta.json").read_text(encoding="utf-8"))
+            out: Dict[str, Any] = {"meta": meta}
+            for name in self.ARRAYS:
+                path = entry / f"{name}.npy"
+                if (entry / f"{name}.npz").exists():
+                    import scipy.sparse as sp
+                    out[name] = sp.load_npz(entry / f"{name}.npz")
+                    continue
+                try:
+                    out[name] = np.load(path, mmap_mode="c")
+                except ValueError:  # object labels (e.g. strings) cannot be mapped
+                    out[name] = np.load(path, allow_pickle=True)
+            with open(entry / "pre.pkl", "rb") as f:
+                out["pre"] = pickle.load(f)
+        except Exception:
+            return None
+        os.utime(entry / "meta.json", None)
+        return out
+
+    def store(self, key: str, pre: Any, arrays: Dict[str, np.ndarray], meta: Dict[str, Any]) -> None:
+        import pickle
+        entry = _ensure_cache_dir(self.root / key)
+        for name in self.ARRAYS:
+            if hasattr(arrays[name], "tocsr"):
+                import scipy.sparse as sp
+                sp.save_npz(entry / f"{name}.npz", arrays[name].tocsr(), compressed=False)
+                continue
+            a = np.asarray(arrays[name])
+            if name.startswith("X"):
+                a = np.ascontiguousarray(a, dtype=np.float32)
+            np.save(entry / f"{name}.npy", a, allow_pickle=(a.dtype == object))
+        with open(entry / "pre.pkl", "wb") as f:
+            pickle.dump(pre, f, protocol=pickle.HIGHEST_PROTOCOL)
+        (entry / "meta.json").write_text(json.dumps(meta, default=str), encoding="utf-8")  # written last = complete
+        _evict_lru(self.cap_bytes, keep=self.root / key)
+
 def _cache_model(model: nn.Module, model_name: Optional[str] = None,
                  cache_path: Path = CACHE_PATH, extra_meta: Optional[Dict[str, Any]] = None) -> Path:
-    _ensure_cache_dir(cache_path)
     if model_name is None: model_name = model.__class__.__name__
-    out_bin = cache_path / f"model.{model_name}.cache.pt"
     meta = {"model_name": model_name}; meta.update(extra_meta or {})
-    # try saving state_dict; if it's not a torch Module, just write meta json
-    try:
-        torch.save({"state_dict": getattr(model, "state_dict", lambda: {})(), "meta": meta}, out_bin)
-    except Exception:
-        out_bin = cache_path / f"model.{model_name}.meta.json"
+    cache = ModelCache(cache_path / "models")
+    key = ModelCache.digest(meta)
+    return cache.store(key, ModelCache.digest({"model_name": model_name}), model, "", "", meta)
+
+def _emit(**payload) -> None:
+    """One JSON event per stdout line (the GTK side parses lines starting with '{')."""
+    print(json.dumps(payload), flush=True)
+
+class FramePacer:
+    """
+    Decides when the training loop may render a plot frame.
+    A frame is due every `interval` seconds of wall time, but only while the total
+    render time stays under `budget` x the time spent training; the last epoch
+    always gets a frame. Rendering therefore never dominates a fast model, and a
+    slow model still gets a frame every `interval` seconds.
+    """
+    def __init__(self, interval: float = 0.5, budget: float = 0.10, min_epochs: int = 1):
+        self.interval = max(0.0, float(interval))
+        self.budget = max(0.0, float(budget))
+        self.min_epochs = max(1, int(min_epochs))
+        self.train_s = 0.0; self.render_s = 0.0; self.last_render_s = 0.0
+        self.frames = 0; self.last_epoch = 0
+        self.last_t = -float("inf"); self.t0 = time.perf_counter()
+
+    def add_train(self, seconds: float) -> None:
+        self.train_s += seconds
+
+    def due(self, epoch: int, epochs: int) -> bool:
+        if epoch >= epochs: return True
+        if epoch - self.last_epoch < self.min_epochs: return False
+        if time.perf_counter() - self.last_t < self.interval: return False
+        return self.render_s + self.last_render_s <= self.budget * self.train_s
+
+    def rendered(self, epoch: int, seconds: float) -> None:
+        self.render_s += seconds; self.last_render_s = seconds
+        self.frames += 1; self.last_epoch = epoch; self.last_t = time.perf_counter()
+
+    def report(self, epoch: int) -> Dict[str, Any]:
+        wall = time.perf_counter() - self.t0
+        return {"frames": self.frames,
+                "epochs_per_frame": epoch / max(1, self.frames),
+                "seconds_per_frame": wall / max(1, self.frames),
+                "render_share": self.render_s / max(1e-9, self.train_s + self.render_s)}
+
+CKPT_PATH = CACHE_PATH / "checkpoints"
+
+class TrainControl:
+    """
+    Control channel from the GUI: one command per line on stdin
+    (pause, resume, cancel, checkpoint). A daemon thread parses the lines; the
+    training loop calls `poll()` once per optimizer step, which blocks while
+    paused, runs requested checkpoints and returns False once cancelled.
+    """
+    def __init__(self, stream=None):
+        import threading
+        self._cv = threading.Condition()
+        self.paused = self.cancelled = self._ckpt = False
+        if stream is not None:
+            threading.Thread(target=self._reader, args=(stream,), daemon=True).start()
+
+    def _reader(self, stream) -> None:
+        try:
+            for line in stream:
+                self.command(line.strip().lower())
+        except (OSError, ValueError):
+            pass  # pipe closed: keep training with the last state
+
+    def command(self, cmd: str) -> None:
+        with self._cv:
+            if   cmd == "pause":      self.paused = True
+            elif cmd == "resume":     self.paused = False
+            elif cmd == "cancel":     self.cancelled, self.paused = True, False
+            elif cmd == "checkpoint": self._ckpt = True
+            else: return
+            self._cv.notify_all()
+
+    def poll(self, checkpoint: Optional[Any] = None) -> bool:
+        announced = False
+        while True:
+            with self._cv:
+                want_ckpt, self._ckpt = self._ckpt, False
+                if not want_ckpt:
+                    if self.cancelled or not self.paused:
+                        break
+                    if not announced:
+                        _emit(event="control", state="paused"); announced = True
+                    self._cv.wait()
+                    continue
+            if checkpoint is not None:
+                checkpoint()  # outside the lock: may take a while
+        if announced and not self.cancelled:
+            _emit(event="control", state="running")
+        return not self.cancelled
+
+def save_checkpoint(path: Path, model: nn.Module, opt: Any, epoch: int, **extra: Any) -> Path:
+    """Resumable snapshot: weights, optimizer state, last finished epoch and every RNG."""
+    import random
+    _ensure_cache_dir(path.parent)
+    state = {"state_dict": model.state_dict(), "optimizer": opt.state_dict() if opt is not None else None,
+             "epoch": int(epoch), "rng": {"torch": torch.get_rng_state(), "numpy": np.random.get_state(),
+                                          "python": random.getstate()}}
+    state.update(extra)
+    tmp = path.with_suffix(".tmp")
+    torch.save(state, tmp)
+    os.replace(tmp, path)
+    return path
+
+def load_checkpoint(path: Path, model: nn.Module, opt: Any) -> Dict[str, Any]:
+    import random
     try:
-        (cache_path / f"model.{model_name}.meta.json").write_text(json.dumps(meta, indent=2), encoding="utf-8")
-    except Exception:
-        pass
-    return out_bin
+        state = torch.load(path, map_location="cpu", weights_only=False)  # RNG states are not plain tensors
+    except TypeError:  # torch < 1.13
+        state = torch.load(path, map_location="cpu")
+    model.load_state_dict(state["state_dict"])
+    if opt is not None and state.get("optimizer") is not None:
+        opt.load_state_dict(state["optimizer"])
+    rng = state.get("rng") or {}
+    if "torch" in rng:  torch.set_rng_state(rng["torch"])
+    if "numpy" in rng:  np.random.set_state(rng["numpy"])
+    if "python" in rng: random.setstate(rng["python"])
+    return state
 
 def _train_and_cache(
     dataX: Tensorable, dataY: Tensorable, testX: Tensorable, testY: Tensorable,
     trainee: Any, model_name: Optional[str] = None, cache_path: Path = CACHE_PATH,
-    fit_params: Optional[Dict[str, Any]] = None, pause_file: Optional[Path] = None, **kwargs: Any,
+    fit_params: Optional[Dict[str, Any]] = None, control: Optional[TrainControl] = None, **kwargs: Any,
 ) -> Tuple[Any, float, Path]:
     fp = fit_params or {}
     task = fp.get("task", None)
     Xnp = _to_numpy(dataX);  Xnp = Xnp.reshape(-1, 1) if Xnp.ndim == 1 else Xnp
 
-    def emit(**payload): print(json.dumps(payload), flush=True)
+    emit = _emit
 
     emit(event="begin", task=task, input_dim=int(Xnp.shape[1]), params=fp)
 
-    if isinstance(trainee, nn.Module):
+    if _is_torch(trainee):
         model, score = _train(
             dataX, dataY, testX, testY, trainee,
-            fit_params=fp, pause_file=pause_file,
+            fit_params=fp, control=control,
             progress_cb=lambda **p: emit(event="epoch", **p)
         )
     else:
-        # sklearn-like: fit once, compute a single 'epoch' event for consistency
+        # sklearn-like: forests/boosting grow in stages (one real 'epoch' event each);
+        # anything else fits once and gets a single 'epoch' event for consistency
         Xtr = _to_numpy(dataX); ytr = _to_numpy(dataY)
         Xte = _to_numpy(testX); yte = _to_numpy(testY)
-        model = trainee.fit(Xtr, ytr)
+        staged = hasattr(trainee, "warm_start") and hasattr(trainee, "n_estimators") and ytr.ndim == 1
+        if staged:
+            def stage_progress(it, total, loss, score):
+                emit(event="epoch", epoch=it, epochs=total, loss=loss, score=score)
+                return control is not None and not control.poll()
+            model, _, _ = fit_in_stages(trainee, Xtr, ytr, task == "classification", progress=stage_progress)
+        else:
+            model = trainee.fit(Xtr, ytr)
         # derive a simple score for the progress line
         if fp.get("task") == "classification" and yte.ndim == 1:
             yhat = model.predict(Xte)
@@ -300,7 +665,8 @@ def _train_and_cache(
         else:
             yhat = np.asarray(model.predict(Xte)).reshape(-1)
             score = float(_r2_score(yte.reshape(-1), yhat))
-        emit(event="epoch", epoch=fp.get("epochs", 1), epochs=fp.get("epochs", 1), loss=0.0, score=score)
+        if not staged:
+            emit(event="epoch", epoch=fp.get("epochs", 1), epochs=fp.get("epochs", 1), loss=0.0, score=score)
 
     saved = _cache_model(model, model_name=model_name, cache_path=cache_path, extra_meta={
         "task": task,
@@ -323,15 +689,85 @@ def is_binary_series(s: pd.Series) -> bool:
         return len(uniq) == 2 and set(uniq).issubset({0,1})
     return False
 
-def train_test_split(X, y, train_pct: float, seed: int = 123):
-    n = X.shape[0]
+def split_order(n: int, train_pct: float, seed: int = 123) -> Tuple[np.ndarray, int]:
+    """Shuffled row order and the train count: rows order[:k] train, order[k:] test."""
     idx = np.arange(n)
     rng = np.random.default_rng(seed)
     rng.shuffle(idx)
-    k = max(1, min(n-1, int(round(train_pct * n))))
+    return idx, max(1, min(n-1, int(round(train_pct * n))))
+
+def train_test_split(X, y, train_pct: float, seed: int = 123):
+    idx, k = split_order(X.shape[0], train_pct, seed)
     train_idx, test_idx = idx[:k], idx[k:]
     return X[train_idx], X[test_idx], y[train_idx], y[test_idx]
 
+class MemoryReport:
+    """
+    Resident memory per stage of a run: "[mem]" lines with the peak reached during
+    the stage and the RSS at its end. Linux resets the high-water mark between
+    stages (/proc/self/clear_refs), so each peak is the stage's own; elsewhere it
+    is the process peak so far (Windows: GetProcessMemoryInfo).
+    """
+    def __init__(self):
+        self.resettable = self._reset()
+        self.stages: List[Tuple[str, float]] = []
+
+    @staticmethod
+    def _reset() -> bool:
+        try:
+            with open("/proc/self/clear_refs", "w") as f:
+                f.write("5")
+            return True
+        except OSError:
+            return False
+
+    @staticmethod
+    def sample() -> Tuple[float, float]:
+        """(rss, peak) in MB; zeros when the platform offers neither."""
+        try:
+            with open("/proc/self/status") as f:
+                kv = dict(line.split(":", 1) for line in f if ":" in line)
+            return int(kv["VmRSS"].split()[0]) / 1024.0, int(kv["VmHWM"].split()[0]) / 1024.0
+        except (OSError, KeyError, ValueError):
+            pass
+        if sys.platform == "win32":
+            import ctypes
+            from ctypes import wintypes
+            class PMC(ctypes.Structure):
+                _fields_ = [("cb", wintypes.DWORD), ("PageFaultCount", wintypes.DWORD),
+                            ("PeakWorkingSetSize", ctypes.c_size_t), ("WorkingSetSize", ctypes.c_size_t),
+                            ("QuotaPeakPagedPoolUsage", ctypes.c_size_t), ("QuotaPagedPoolUsage", ctypes.c_size_t),
+                            ("QuotaPeakNonPagedPoolUsage", ctypes.c_size_t), ("QuotaNonPagedPoolUsage", ctypes.c_size_t),
+                            ("PagefileUsage", ctypes.c_size_t), ("PeakPagefileUsage", ctypes.c_size_t)]
+            pmc = PMC(); pmc.cb = ctypes.sizeof(PMC)
+            k32 = ctypes.windll.kernel32
+            k32.GetCurrentProcess.restype = wintypes.HANDLE
+            if ctypes.windll.psapi.GetProcessMemoryInfo(k32.GetCurrentProcess(), ctypes.byref(pmc), pmc.cb):
+                return pmc.WorkingSetSize / 2 ** 20, pmc.PeakWorkingSetSize / 2 ** 20
+            return 0.0, 0.0
+        try:
+            import resource
+            peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+            peak = peak / 2 ** 20 if sys.platform == "darwin" else peak / 1024.0   # bytes on macOS, KB elsewhere
+            return peak, peak
+        except Exception:
+            return 0.0, 0.0
+
+    def stage(self, name: str) -> None:
+        rss, peak = self.sample()
+        if peak <= 0.0:
+            return
+        self.stages.append((name, peak))
+        print(f"[mem] {name:<10} peak {peak:8.1f} MB  rss {rss:8.1f} MB", flush=True)
+        if self.resettable:
+            self._reset()
+
+    def summary(self) -> str:
+        if not self.stages:
+            return ""
+        top = max(self.stages, key=lambda s: s[1])
+        return f"peak memory {top[1]:.0f} MB ({top[0]}); " + ", ".join(f"{n} {p:.0f}" for n, p in self.stages)
+
 def ascii_confusion(y_true, y_pred):
     # expects 0/1
     y_true = y_true.astype(int)
@@ -356,8 +792,8 @@ def classification_metrics(tp, tn, fp, fn):
     return acc, prec, rec, f1
 
 def regression_metrics(y_true, y_pred):
-    y_true = y_true.astype(float)
-    y_pred = y_pred.astype(float)
+    y_true = np.asarray(y_true).astype(float).reshape(-1)   # (N,1) vs (N,) would broadcast to (N,N)
+    y_pred = np.asarray(y_pred).astype(float).reshape(-1)
     mae = np.mean(np.abs(y_true - y_pred))
     mse = np.mean((y_true - y_pred)**2)
     rmse = math.sqrt(mse)
@@ -367,18 +803,78 @@ def regression_metrics(y_true, y_pred):
     r2 = 1.0 - (ss_res / max(1e-12, ss_tot))
     return r2, mae, mse, rmse
 
-# -------- 2D projection (kept) ----------
+def _val_score(yhat, y, is_clf: bool) -> float:
+    """--val-frac rows, same metric as the test score: accuracy (multilabel: exact match) or R²."""
+    yhat, y = np.asarray(yhat), np.asarray(y)
+    if not is_clf:
+        return float(regression_metrics(y, yhat)[0])
+    if y.ndim == 2 and y.shape[1] > 1:
+        return float((yhat == y).all(axis=1).mean())
+    a, b = yhat.reshape(-1), y.reshape(-1)
+    if a.dtype.kind in "biuf" and b.dtype.kind in "biuf":
+        return float(np.mean(a.astype(float) == b.astype(float)))
+    return float(np.mean(a.astype(str) == b.astype(str)))
+
+# -------- 2D projections, cached by matrix content + method (memory + cache/projections) ---
+_PROJ_MEM: Dict[str, np.ndarray] = {}
+PROJ_CACHE_PATH = CACHE_PATH / "projections"
+CACHE_CAP_MB = float(os.environ.get("AIFD_MODEL_CACHE_MB", 512))   # main() sets it from --cache-cap-mb
+
+def _proj_key(X: np.ndarray, method: str) -> str:
+    """Content key: the (already preprocessed) matrix covers dataset, features and preprocessing."""
+    A = np.ascontiguousarray(X, dtype=np.float32)
+    h = hashlib.blake2b(digest_size=16)
+    h.update(f"{method}|{A.shape}".encode()); h.update(A.tobytes())
+    return f"{method}.{h.hexdigest()}"
+
+def _compute_projection(X: np.ndarray, method: str) -> np.ndarray:
+    if method == "pca2":
+        from sklearn.decomposition import PCA
+        return PCA(n_components=2).fit_transform(X)
+    if _NATIVE_OK:
+        # Barnes-Hut t-SNE in C (all cores); progress goes to the client as JSON events
+        def progress(it, total, kl):
+            if it % 50 == 0 or it == total:
+                _emit(event="projection", method=method, iter=it, iters=total, kl=kl)
+            return False
+        try:
+            return _native.tsne2(X, progress=progress)
+        except Exception as e:
+            print(f"[native] t-SNE failed, falling back to sklearn: {e}", flush=True)
+    from sklearn.manifold import TSNE
+    return TSNE(n_components=2, init="pca", learning_rate="auto").fit_transform(X)
+
+def _cached_projection(X: np.ndarray, method: str) -> np.ndarray:
+    key = _proj_key(X, method)
+    Z = _PROJ_MEM.get(key)
+    if Z is not None:
+        return Z
+    f = PROJ_CACHE_PATH / f"proj.{key}.npy"
+    try:
+        Z = np.load(f) if f.exists() else None
+        if Z is not None:
+            os.utime(f, None)   # LRU: a hit counts as a use
+    except Exception:
+        Z = None  # corrupted/partial file -> recompute
+    if Z is None or Z.shape != (len(X), 2):
+        Z = _compute_projection(X, method).astype(np.float32)
+        try:
+            _ensure_cache_dir(PROJ_CACHE_PATH)
+            tmp = str(f) + ".tmp.npy"
+            np.save(tmp, Z); _safe_replace(tmp, str(f))
+            _evict_lru(int(CACHE_CAP_MB * 1024 * 1024), keep=f)
+        except Exception:
+            pass
+    if len(_PROJ_MEM) >= 8: _PROJ_MEM.clear()
+    _PROJ_MEM[key] = Z
+    return Z
+
 def project_2d(X, method="pca2"):
     X = np.asarray(X)
     if X.ndim == 1:
         return X.reshape(-1,1), np.zeros_like(X)
-    if method == "pca2":
-        from sklearn.decomposition import PCA
-        Z = PCA(n_components=2).fit_transform(X)
-        return Z[:,0], Z[:,1]
-    elif method == "tsne2":
-        from sklearn.manifold import TSNE
-        Z = TSNE(n_components=2, init="pca", learning_rate="auto").fit_transform(X)
+    if method in ("pca2", "tsne2"):
+        Z = _cached_projection(X, method)
         return Z[:,0], Z[:,1]
     else:
         # none -> take first two features (pad if needed)
@@ -443,6 +939,99 @@ def _predict_scores_or_probs(model: Any, X: np.ndarray) -> Tuple[np.ndarray, int
     # regression final fallback
     return logits.squeeze().cpu().numpy(), 1, "reg"  # type: ignore
 
+# -------- adaptive (quadtree) decision-boundary grid ----------
+_BOUNDARY_PREV: Dict[Any, Dict[str, np.ndarray]] = {}
+
+def _grid_labels(S: np.ndarray, mode: str) -> np.ndarray:
+    if mode == "probs": return S.reshape(S.shape[0], -1).argmax(1)
+    return (S.reshape(-1) >= 0.5).astype(np.int64)
+
+def _predict_grid_adaptive(model: Any, xs: np.ndarray, ys: np.ndarray, coarse: int = 8,
+                           reuse_tol: float = 2e-3, tag: str = "") -> Tuple[np.ndarray, int, str]:
+    """
+    Same result layout as _predict_scores_or_probs(model, c_[xx.ravel(), yy.ravel()])
+    for xx, yy = meshgrid(xs, ys), but only cells whose corners disagree on the
+    predicted class are subdivided (quadtree). Each refinement level is one batched
+    predict call; uniform cells are filled by bilinear interpolation of their corners.
+    If the coarse lattice barely moved since the previous frame, that frame is reused.
+    """
+    nx, ny = len(xs), len(ys)
+    ix = np.unique(np.r_[np.arange(0, nx, coarse), nx - 1])
+    iy = np.unique(np.r_[np.arange(0, ny, coarse), ny - 1])
+    JJ, II = np.meshgrid(ix, iy)
+    S0, C_eff, mode = _predict_scores_or_probs(model, np.c_[xs[JJ.ravel()], ys[II.ravel()]].astype(np.float32))
+    if mode == "reg":  # no classes to compare corners with -> plain full grid
+        xx, yy = np.meshgrid(xs, ys)
+        return _predict_scores_or_probs(model, np.c_[xx.ravel(), yy.ravel()].astype(np.float32))
+    S0 = np.asarray(S0, dtype=np.float32)
+
+    key = (tag, id(model), nx, ny, float(xs[0]), float(xs[-1]), float(ys[0]), float(ys[-1]))
+    prev = _BOUNDARY_PREV.get(key)
+    if prev is not None and prev["coarse"].shape == S0.shape \
+            and float(np.max(np.abs(prev["coarse"] - S0))) <= reuse_tol:
+        return prev["S"], C_eff, mode
+
+    width = S0.shape[1] if S0.ndim == 2 else 1
+    S = np.zeros((ny, nx, width), dtype=np.float32)
+    known = np.zeros((ny, nx), dtype=bool)
+    lab = np.full((ny, nx), -1, dtype=np.int64)
+    S[II, JJ] = S0.reshape(len(iy), len(ix), width)
+    known[II, JJ] = True
+    lab[II, JJ] = _grid_labels(S0, mode).reshape(len(iy), len(ix))
+
+    # cells as parallel index arrays: rows [i0,i1] x cols [j0,j1]
+    i0 = np.repeat(iy[:-1], len(ix) - 1); i1 = np.repeat(iy[1:], len(ix) - 1)
+    j0 = np.tile(ix[:-1], len(iy) - 1);   j1 = np.tile(ix[1:], len(iy) - 1)
+    uniform = []
+    while i0.size:
+        l00 = lab[i0, j0]
+        mixed = (l00 != lab[i0, j1]) | (l00 != lab[i1, j0]) | (l00 != lab[i1, j1])
+        uniform.append((i0[~mixed], i1[~mixed], j0[~mixed], j1[~mixed]))
+        split = mixed & (((i1 - i0) > 1) | ((j1 - j0) > 1))
+        i0, i1, j0, j1 = i0[split], i1[split], j0[split], j1[split]
+        if not i0.size:
+            break
+        im = (i0 + i1) // 2; jm = (j0 + j1) // 2
+
+        # new nodes of this level (edge midpoints + centre), one batch for all cells
+        ni = np.concatenate([i0, im, im, im, i1]); nj = np.concatenate([jm, j0, jm, j1, jm])
+        flat = np.unique((ni * nx + nj)[~known[ni, nj]])
+        if flat.size:
+            ni, nj = flat // nx, flat % nx
+            Sn, _, _ = _predict_scores_or_probs(model, np.c_[xs[nj], ys[ni]].astype(np.float32))
+            Sn = np.asarray(Sn, dtype=np.float32).reshape(-1, width)
+            S[ni, nj] = Sn; known[ni, nj] = True
+            lab[ni, nj] = _grid_labels(Sn if width > 1 else Sn[:, 0], mode)
+
+        # children: a zero-height/width half only exists when the side is > 1
+        always = np.ones(i0.size, dtype=bool)
+        rows = [(i0, im, im > i0), (im, i1, always)]
+        cols = [(j0, jm, jm > j0), (jm, j1, always)]
+        parts = [(ra[rv & cv], rb[rv & cv], ca[rv & cv], cb[rv & cv])
+                 for ra, rb, rv in rows for ca, cb, cv in cols]
+        i0, i1, j0, j1 = (np.concatenate(p) for p in zip(*parts))
+
+    # fill uniform cells, grouped by size so each group is a single vectorized op
+    for u0, u1, v0, v1 in uniform:
+        for h, w in set(zip((u1 - u0).tolist(), (v1 - v0).tolist())):
+            sel = ((u1 - u0) == h) & ((v1 - v0) == w)
+            a, b = u0[sel], v0[sel]
+            ty = (np.arange(h + 1, dtype=np.float32) / h)[None, :, None, None]
+            tx = (np.arange(w + 1, dtype=np.float32) / w)[None, None, :, None]
+            c00 = S[a, b][:, None, None, :];     c01 = S[a, b + w][:, None, None, :]
+            c10 = S[a + h, b][:, None, None, :]; c11 = S[a + h, b + w][:, None, None, :]
+            vals = (1 - ty) * ((1 - tx) * c00 + tx * c01) + ty * ((1 - tx) * c10 + tx * c11)
+            rr = a[:, None, None] + np.arange(h + 1)[None, :, None]
+            cc = b[:, None, None] + np.arange(w + 1)[None, None, :]
+            rr, cc = np.broadcast_to(rr, vals.shape[:3]), np.broadcast_to(cc, vals.shape[:3])
+            m = ~known[rr, cc]
+            S[rr[m], cc[m]] = vals[m]
+
+    out = S.reshape(ny * nx, width) if S0.ndim == 2 else S.reshape(-1)
+    if len(_BOUNDARY_PREV) > 8: _BOUNDARY_PREV.clear()
+    _BOUNDARY_PREV[key] = {"coarse": S0, "S": out}
+    return out, C_eff, mode
+
 # ---------------- plots (tweaked to accept sklearn models) --------------------
 def save_plot_regression(X, y, model, epoch, n_epochs, out_path,
                          x_label=None, y_label=None, proj="pca2", color_by="residual"):
@@ -543,12 +1132,10 @@ def save_plot_classification(X, y_idx_or_multi, model, epoch, epochs, out_path,
     elif d == 2:
         x0, x1 = X[:, 0], X[:, 1]
         xpad = (x0.max()-x0.min()+1e-9)*0.07; ypad=(x1.max()-x1.min()+1e-9)*0.07
-        xx, yy = np.meshgrid(
-            np.linspace(float(x0.min()-xpad), float(x0.max()+xpad), 300, dtype=np.float32),
-            np.linspace(float(x1.min()-ypad), float(x1.max()+ypad), 300, dtype=np.float32)
-        )
-        grid = np.c_[xx.ravel(), yy.ravel()]
-        S, C_eff, mode = _predict_scores_or_probs(model, grid)
+        gx = np.linspace(float(x0.min()-xpad), float(x0.max()+xpad), 300, dtype=np.float32)
+        gy = np.linspace(float(x1.min()-ypad), float(x1.max()+ypad), 300, dtype=np.float32)
+        xx, yy = np.meshgrid(gx, gy)
+        S, C_eff, mode = _predict_grid_adaptive(model, gx, gy, tag="modern")
 
         if is_multilabel:
             ax1 = plt.subplot(1,2,1)
@@ -774,13 +1361,11 @@ def _retro95_datafit(ax, X, y_info, model, is_clf, feat_names, classes=None, pro
         if not projected:
             xpad = (x.max() - x.min() + 1e-9) * 0.07
             ypad = (y.max() - y.min() + 1e-9) * 0.07
-            xx, yy = np.meshgrid(
-                np.linspace(float(x.min()-xpad), float(x.max()+xpad), 240, dtype=np.float32),
-                np.linspace(float(y.min()-ypad), float(y.max()+ypad), 240, dtype=np.float32)
-            )
-            grid = np.c_[xx.ravel(), yy.ravel()].astype(np.float32)
+            gx = np.linspace(float(x.min()-xpad), float(x.max()+xpad), 240, dtype=np.float32)
+            gy = np.linspace(float(y.min()-ypad), float(y.max()+ypad), 240, dtype=np.float32)
+            xx, yy = np.meshgrid(gx, gy)
 
-            S, C_eff, mode = _predict_scores_or_probs(model, grid)
+            S, C_eff, mode = _predict_grid_adaptive(model, gx, gy, tag="retro95")
             if C_eff > 2 and mode == "probs":
                 cls = S.argmax(1).reshape(xx.shape)
                 ax.pcolormesh(xx, yy, cls, cmap=cmap, alpha=0.20, shading="nearest")
@@ -891,6 +1476,32 @@ def lev_search(a: list, b: str):
     full = {i: lev(i, b) for i in a}
     return min(full, key=lambda k: full[k])
 
+def read_table(path: str, float32: bool = False) -> "pd.DataFrame":
+    """
+    pd.read_csv(path) through the native multi-threaded parser when the library is
+    built (same dtypes and NA markers); AIFD_CSV=pandas or any failure falls back.
+    float32 (--lean) parses the float columns straight to float32.
+    """
+    if _NATIVE_OK and os.environ.get("AIFD_CSV", "native") != "pandas":
+        try:
+            t0 = time.perf_counter()
+            names, cols, secs = _native.read_csv(path, float32=float32)
+            df = pd.DataFrame(dict(zip(names, cols)), copy=False)
+            mb = os.path.getsize(path) / 1e6
+            print(f"[csv] {len(df)} rows x {len(names)} columns, {mb:.1f} MB in {time.perf_counter() - t0:.2f}s"
+                  f" (native parse {mb / max(secs, 1e-9):.0f} MB/s)", flush=True)
+            return df
+        except Exception as e:
+            print(f"[csv] native parser failed ({e}); using pandas", flush=True)
+    if float32:
+        # float dtypes guessed from the first rows; a column that turns out to hold text re-reads as usual
+        head = pd.read_csv(path, nrows=1000)
+        try:
+            return pd.read_csv(path, dtype={c: np.float32 for c in head.columns if head[c].dtype == np.float64})
+        except ValueError:
+            pass
+    return pd.read_csv(path)
+
 # -------------------- data treatment --------------------
 def build_preprocessor(dfX: "pd.DataFrame", scale: str, impute: str, onehot: bool) -> ColumnTransformer:
     num_cols = [c for c in dfX.columns if pd.api.types.is_numeric_dtype(dfX[c])]
@@ -926,6 +1537,133 @@ def build_preprocessor(dfX: "pd.DataFrame", scale: str, impute: str, onehot: boo
         return ColumnTransformer([("id", "passthrough", list(dfX.columns))])
     return ColumnTransformer(transformers)
 
+PREP_BLOCK_MB = 64   # float64 staging for the native preprocessor: column groups (fit), row blocks (transform)
+
+class NativePreprocessor:
+    """
+    build_preprocessor's transform on the native core (src/native/prep.h): numeric
+    columns imputed + scaled, then each categorical column one-hot, float32 out.
+    The numeric columns reach C as float64 in PREP_BLOCK_MB pieces, never as one
+    n x d copy. Holds plain arrays, so it pickles into the preprocessing cache
+    like the ColumnTransformer it replaces.
+    """
+    def __init__(self, scale: str, impute: str, onehot: bool):
+        self.scale = scale if scale in _native.SCALES else "standard"
+        self.impute = impute if impute in _native.IMPUTES else "mean"
+        self.onehot = bool(onehot)
+
+    @staticmethod
+    def supports(dfX: "pd.DataFrame", onehot: bool) -> bool:
+        return bool(onehot) or all(pd.api.types.is_numeric_dtype(dfX[c]) for c in dfX.columns)
+
+    @staticmethod
+    def _block(dfX: "pd.DataFrame", rows, cols: List[int]) -> np.ndarray:
+        return dfX.iloc[rows, cols].to_numpy(dtype=np.float64, na_value=np.nan)
+
+    def _fit_numeric(self, dfX: "pd.DataFrame") -> Optional[dict]:
+        """prep_fit over groups of columns (the statistics are per column), merged into one layout."""
+        if not self.num_cols:
+            return None
+        pos = [dfX.columns.get_loc(c) for c in self.num_cols]
+        step = max(1, PREP_BLOCK_MB * 2 ** 20 // (8 * max(1, len(dfX))))
+        parts = [_native.prep_fit(self._block(dfX, slice(None), pos[g:g + step]), self.impute, self.scale)
+                 for g in range(0, len(pos), step)]
+        p = {k: np.concatenate([q[k] for q in parts]) for k in ("fill", "a", "b")}
+        outs, off = [], 0
+        for q in parts:
+            outs.append(np.where(q["out"] >= 0, q["out"] + off, -1).astype(np.int32))
+            off += q["out_dim"]
+        p.update(out=np.concatenate(outs), scale=self.scale, out_dim=off)
+        return p
+
+    def fit(self, dfX: "pd.DataFrame") -> "NativePreprocessor":
+        self.num_cols = [c for c in dfX.columns if pd.api.types.is_numeric_dtype(dfX[c])]
+        self.cat_cols = [c for c in dfX.columns if c not in self.num_cols]
+        self.num_ = self._fit_numeric(dfX)
+        self.cat_: List[Tuple[List[str], int]] = []   # (categories in column order, column of the fill value)
+        cat_impute = "zero" if self.impute == "zero" else "most_frequent"
+        for c in self.cat_cols:
+            codes, uniques = pd.factorize(dfX[c])
+            levels = [str(u) for u in uniques]
+            slot, order = _native.onehot_fit(codes, levels, cat_impute)
+            self.cat_.append(([levels[o] if o >= 0 else "" for o in order], int(slot[-1])))
+        self.out_dim = (self.num_["out_dim"] if self.num_ else 0) + sum(len(c) for c, _ in self.cat_)
+        return self
+
+    def transform(self, dfX: "pd.DataFrame", out: Optional[np.ndarray] = None, rows=None) -> np.ndarray:
+        """float32 (rows, out_dim); `rows` picks and orders the rows, `out` receives them (--lean)."""
+        n = len(dfX) if rows is None else len(rows)
+        if out is None:
+            out = np.empty((n, self.out_dim), dtype=np.float32)
+        col = 0
+        if self.num_:
+            col = self.num_["out_dim"]
+            pos = [dfX.columns.get_loc(c) for c in self.num_cols]
+            step = max(1, PREP_BLOCK_MB * 2 ** 20 // (8 * len(pos)))
+            for b in range(0, n, step):
+                r = slice(b, min(n, b + step)) if rows is None else rows[b:b + step]
+                _native.prep_apply(self._block(dfX, r, pos), self.num_, out[b:b + step, :col])
+        for c, (cats, fill) in zip(self.cat_cols, self.cat_):
+            codes, uniques = pd.factorize(dfX[c])
+            where = {s: k for k, s in enumerate(cats)}
+            slot = np.array([where.get(str(u), -1) for u in uniques] + [fill], dtype=np.int32)
+            _native.onehot_apply(codes if rows is None else codes[rows], slot, len(cats), out[:, col:col + len(cats)])
+            col += len(cats)
+        return out
+
+    def fit_transform(self, dfX: "pd.DataFrame") -> np.ndarray:
+        return self.fit(dfX).transform(dfX)
+
+# models that train on CSR input (the sklearn ones; torch and the native engines take dense float32)
+SPARSE_MODELS = {"dt_cls", "dt_reg", "rf_cls", "rf_reg", "knn_cls", "knn_reg", "svm_cls", "svm_reg", "gb_cls", "gb_reg"}
+SPARSE_AUTO_DENSITY = 0.10   # --sparse auto: CSR when at most this share of the cells is non-zero
+PLOT_DENSE_MB = 64           # CSR rows expanded for the plot frames, at most this much float32
+
+def _plot_rows(X, y, seed: int = 123):
+    """(X, y) for the plot frames: a CSR matrix becomes a dense sample of its rows."""
+    if not hasattr(X, "tocsr"):
+        return X, y
+    cap = max(100, int(PLOT_DENSE_MB * 1024 * 1024 // (4 * max(1, X.shape[1]))))
+    keep = np.sort(np.random.default_rng(seed).permutation(X.shape[0])[:cap])
+    return X[keep].toarray(), y[keep]
+
+def build_torch_model(name: str, in_dim: int, ncls: int, hp: Dict[str, Any]) -> Tuple[Any, Any, Any, float]:
+    """
+    Single-label torch model + loss + optimizer for `name` (ncls = 0 for regression).
+    Returns (model, loss_fn, opt, l1_lambda); two classes use one logit with BCE.
+    """
+    l1_lambda = 0.0
+    out_dim = 1 if ncls <= 2 else ncls
+    if name in ("mlp_cls", "mlp_reg"):
+        hidden  = int(hp.get("hidden", max(8 if name == "mlp_cls" else 16, in_dim * 2)))
+        layers  = int(hp.get("layers", 2))
+        actname = str(hp.get("activation", "relu")).lower()
+        Act = nn.ReLU if actname == "relu" else nn.Tanh
+        seq: list[nn.Module] = [nn.Linear(in_dim, hidden), Act()]
+        for _ in range(max(0, layers - 1)):
+            seq += [nn.Linear(hidden, hidden), Act()]
+        seq += [nn.Linear(hidden, out_dim)]
+        model = nn.Sequential(*seq)
+        opt = optim.Adam(model.parameters(), lr=float(hp.get("lr", 5e-2 if name == "mlp_cls" else 5e-3)))
+    elif name == "logreg":
+        C        = float(hp.get("C", 1.0))
+        penalty  = str(hp.get("penalty", "L2")).upper()
+        weight_decay = (1.0 / C) if penalty == "L2" else 0.0
+        l1_lambda    = (1.0 / C) if penalty == "L1" else 0.0
+        model = nn.Sequential(nn.Linear(in_dim, out_dim))
+        opt = optim.Adam(model.parameters(), lr=float(hp.get("lr", 5e-2)), weight_decay=weight_decay)
+    else:  # linreg / ridge / lasso
+        alpha    = float(hp.get("alpha", 1e-2))
+        weight_decay = alpha if name == "ridge" else 0.0
+        l1_lambda    = alpha if name == "lasso" else 0.0
+        model = nn.Sequential(nn.Linear(in_dim, 1))
+        opt = optim.Adam(model.parameters(), lr=float(hp.get("lr", 5e-2)), weight_decay=weight_decay)
+    if ncls == 0:
+        loss_fn = nn.MSELoss()
+    else:
+        loss_fn = nn.BCEWithLogitsLoss() if out_dim == 1 else nn.CrossEntropyLoss()
+    return model, loss_fn, opt, l1_lambda
+
 # ---------- simple NB "regressor" via binning (to satisfy nb_reg variant) ----
 class GaussianNBRegressor:
     def __init__(self, n_bins: int = 10):
@@ -953,12 +1691,457 @@ class GaussianNBRegressor:
         b = self.clf.predict(X).astype(int)
         return self.bin_means_[b]
 
-def print_classification_report(y_true_idx, y_pred_idx, classes, stream=None):
+SVM_APPROX_ROWS = 20000  # exact kernel SVMs are O(n²)-O(n³); above this many training rows "auto" approximates
+
+def _svm_gamma(gamma, X) -> float:
+    """sklearn's 'scale'/'auto' gamma resolved to a number (the feature maps need one)."""
+    if gamma in (None, "scale"):
+        if hasattr(X, "toarray"):  # sparse one-hot output
+            mu = float(X.mean()); var = float(X.multiply(X).mean()) - mu * mu
+        else:
+            var = float(np.asarray(X, dtype=np.float64).var())
+        return 1.0 / (X.shape[1] * var) if var > 0 else 1.0
+    if gamma == "auto":
+        return 1.0 / X.shape[1]
+    return float(gamma)
+
+def svm_approx(m: str, hp: dict, X) -> Tuple[Optional[Any], str]:
+    """
+    Approximate-kernel SVM for svm_cls/svm_reg: an explicit feature map (Nyström, or
+    random Fourier features for rbf) followed by a linear SVM, O(n·components).
+    hp["approx"]: auto (on above SVM_APPROX_ROWS rows) | off | nystroem | rff;
+    hp["n_components"] is the feature count. Returns (None, "") for the exact SVM.
+    """
+    mode, n = str(hp.get("approx", "auto")).lower(), X.shape[0]
+    if mode == "auto":
+        mode = "nystroem" if n > SVM_APPROX_ROWS else "off"
+    if mode not in ("nystroem", "rff"):
+        return None, ""
+    kernel, seed = hp.get("kernel", "rbf"), int(hp.get("seed", 42))
+    comps = max(1, min(int(hp.get("n_components", 1000)), n))
+    gamma = _svm_gamma(hp.get("gamma", "scale"), X)
+    if mode == "rff" and kernel != "rbf":
+        mode = "nystroem"  # random Fourier features only approximate the rbf kernel
+    if mode == "rff":
+        feat = RBFSampler(gamma=gamma, n_components=comps, random_state=seed)
+    else:
+        feat = Nystroem(kernel=kernel, gamma=None if kernel == "linear" else gamma,
+                        n_components=comps, random_state=seed)
+    C = float(hp.get("C", 1.0))
+    if m == "svm_cls":
+        lin = LinearSVC(C=C, dual=False)
+    else:
+        lin = LinearSVR(C=C, epsilon=float(hp.get("epsilon", 0.1)), dual=True, max_iter=5000)
+    name = "Nyström" if mode == "nystroem" else "random Fourier features"
+    note = (f"SVM approximation: {name} ({comps} components, {kernel} kernel, gamma={gamma:.4g}) + linear SVM"
+            f" on {n} training rows" + (f" (exact kernel above {SVM_APPROX_ROWS} rows is skipped)"
+                                        if str(hp.get("approx", "auto")).lower() == "auto" else ""))
+    return Pipeline([("features", feat), ("svm", lin)]), note
+
+class NativeMLP:
+    """
+    sklearn-style wrapper over aifd_native.mlp_fit: the mlp_reg/mlp_cls network
+    trained in C (minibatch Adam/SGD, blocked SIMD GEMM), no torch needed.
+    `progress(epoch, epochs, loss, score)` returning True stops after that epoch.
+    """
+    def __init__(self, classify: bool, hidden: int = 64, layers: int = 2, activation: str = "relu",
+                 optimizer: str = "adam", lr: float = 1e-3, batch_size: int = 64, epochs: int = 100,
+                 seed: int = 42, progress=None):
+        self.classify, self.hidden, self.layers = bool(classify), int(hidden), int(layers)
+        self.activation, self.optimizer = str(activation).lower(), str(optimizer).lower()
+        self.lr, self.batch_size, self.epochs, self.seed = float(lr), int(batch_size), int(epochs), int(seed)
+        self.progress = progress
+        self.params_: Optional[np.ndarray] = None
+        self.classes_: Optional[np.ndarray] = None
+        self.finished_ = False
+    def __getstate__(self):
+        state = dict(self.__dict__); state["progress"] = None  # callbacks don't pickle
+        return state
+    def _k(self) -> int:
+        return len(self.classes_) if self.classify else 0
+    def fit(self, X, y):
+        y = np.asarray(y).reshape(-1)
+        if self.classify:
+            classes, target = np.unique(y, return_inverse=True)
+            if self.classes_ is None or len(classes) != len(self.classes_) or np.any(classes != self.classes_):
+                self.params_ = None  # different label set: warm weights don't apply
+            self.classes_ = classes
+            if len(classes) < 2:
+                raise ValueError("mlp_cls needs at least 2 classes")
+        else:
+            target = y.astype(np.float64)
+        self.params_, self.finished_ = _native.mlp_fit(
+            X, target, self._k(), self.hidden, self.layers, self.activation, self.optimizer, self.lr,
+            self.batch_size, self.epochs, self.seed, params=self.params_, progress=self.progress)
+        return self
+    def _raw(self, X):
+        return _native.mlp_predict(X, self.params_, self._k(), self.hidden, self.layers, self.activation)
+    def predict_proba(self, X):
+        P = self._raw(X)
+        return np.column_stack([1.0 - P, P]) if P.ndim == 1 else P
+    def predict(self, X):
+        if not self.classify:
+            return self._raw(X)
+        return self.classes_[np.argmax(self.predict_proba(X), axis=1)]
+
+class NativeForest:
+    """
+    sklearn-style wrapper over aifd_native.forest_fit: dt_*/rf_* built in C
+    (histogram splits, one tree per pool task, flat node arrays that pickle).
+    `progress(trees, total, loss, score)` gets the out-of-bag loss/score after each
+    finished tree (training-set values without bootstrap); True stops there.
+    """
+    def __init__(self, classify: bool, n_estimators: int = 100, max_depth: Optional[int] = None,
+                 min_samples_leaf: int = 1, max_features: float = 0.0, bootstrap: bool = True,
+                 seed: int = 42, progress=None):
+        self.classify, self.n_estimators = bool(classify), int(n_estimators)
+        self.max_depth = int(max_depth) if max_depth else None
+        self.min_samples_leaf, self.max_features = int(min_samples_leaf), float(max_features)
+        self.bootstrap, self.seed, self.progress = bool(bootstrap), int(seed), progress
+        self.forest_: Optional[tuple] = None   # (nodes, roots, values)
+        self.classes_: Optional[np.ndarray] = None
+        self.finished_ = False
+    def __getstate__(self):
+        state = dict(self.__dict__); state["progress"] = None
+        return state
+    def settings(self) -> tuple:
+        return (self.classify, self.max_depth, self.min_samples_leaf, self.max_features, self.bootstrap, self.seed)
+    def _k(self) -> int:
+        return len(self.classes_) if self.classify else 0
+    def stages_(self) -> int:
+        """Trees fitted so far."""
+        return 0 if self.forest_ is None else len(self.forest_[1])
+    def fit(self, X, y):
+        y = np.asarray(y).reshape(-1)
+        if self.classify:
+            classes, target = np.unique(y, return_inverse=True)
+            if self.classes_ is None or len(classes) != len(self.classes_) or np.any(classes != self.classes_):
+                self.forest_ = None  # different label set: the old trees don't apply
+            self.classes_ = classes
+            if len(classes) < 2:
+                raise ValueError("tree classifiers need at least 2 classes")
+        else:
+            target = y.astype(np.float64)
+        have = self.stages_()
+        if have >= self.n_estimators:
+            self.finished_ = True
+            return self
+        prog = None if self.progress is None else (lambda i, total, loss, score: self.progress(have + i, have + total, loss, score))
+        nodes, roots, values, self.finished_ = _native.forest_fit(
+            X, target, self._k(), self.n_estimators - have, self.max_depth, self.min_samples_leaf,
+            self.max_features, self.bootstrap, self.seed, first_tree=have, progress=prog)
+        new = (nodes, roots, values)
+        self.forest_ = _native.forest_concat(self.forest_, new) if have else new
+        return self
+    def predict_proba(self, X):
+        return _native.forest_predict(X, *self.forest_, n_classes=self._k())
+    def predict(self, X):
+        if not self.classify:
+            return _native.forest_predict(X, *self.forest_)
+        return self.classes_[np.argmax(self.predict_proba(X), axis=1)]
+
+class NativeGBDT:
+    """
+    sklearn-style wrapper over aifd_native.gbdt_fit: gb_cls/gb_reg as histogram
+    gradient boosting (uint8 quantile bins, leaf-wise trees, histogram subtraction).
+    `progress(round, rounds, loss, score)` runs after each boosting round with the
+    training loss/score; True stops there. A warm fit continues from the old trees.
+    """
+    def __init__(self, classify: bool, n_estimators: int = 100, learning_rate: float = 0.1,
+                 max_leaf_nodes: int = 31, max_depth: Optional[int] = None, min_samples_leaf: int = 20,
+                 l2_regularization: float = 0.0, progress=None):
+        self.classify, self.n_estimators, self.learning_rate = bool(classify), int(n_estimators), float(learning_rate)
+        self.max_leaf_nodes, self.max_depth = int(max_leaf_nodes), (int(max_depth) if max_depth else None)
+        self.min_samples_leaf, self.l2_regularization = int(min_samples_leaf), float(l2_regularization)
+        self.progress = progress
+        self.forest_: Optional[tuple] = None   # (nodes, roots, values, base)
+        self.classes_: Optional[np.ndarray] = None
+        self.finished_ = False
+    def __getstate__(self):
+        state = dict(self.__dict__); state["progress"] = None
+        return state
+    def settings(self) -> tuple:
+        return (self.classify, self.learning_rate, self.max_leaf_nodes, self.max_depth,
+                self.min_samples_leaf, self.l2_regularization)
+    def _k(self) -> int:
+        return len(self.classes_) if self.classify else 0
+    def stages_(self) -> int:
+        """Boosting rounds fitted so far."""
+        if self.forest_ is None:
+            return 0
+        return len(self.forest_[1]) // (self._k() if self._k() > 2 else 1)
+    def fit(self, X, y):
+        y = np.asarray(y).reshape(-1)
+        if self.classify:
+            classes, target = np.unique(y, return_inverse=True)
+            if self.classes_ is None or len(classes) != len(self.classes_) or np.any(classes != self.classes_):
+                self.forest_ = None
+            self.classes_ = classes
+            if len(classes) < 2:
+                raise ValueError("gradient boosting classifiers need at least 2 classes")
+        else:
+            target = y.astype(np.float64)
+        have = self.stages_()
+        if have >= self.n_estimators:
+            self.finished_ = True
+            return self
+        init = None if not have else _native.gbdt_predict(X, *self.forest_, n_classes=self._k(), raw=True)
+        prog = None if self.progress is None else (lambda i, total, loss, score: self.progress(have + i, have + total, loss, score))
+        nodes, roots, values, base, self.finished_ = _native.gbdt_fit(
+            X, target, self._k(), self.n_estimators - have, self.learning_rate, self.max_leaf_nodes,
+            self.max_depth, self.min_samples_leaf, self.l2_regularization, init=init, progress=prog)
+        if have:
+            self.forest_ = _native.forest_concat(self.forest_[:3], (nodes, roots, values)) + (self.forest_[3],)
+        else:
+            self.forest_ = (nodes, roots, values, base)
+        return self
+    def predict_proba(self, X):
+        P = _native.gbdt_predict(X, *self.forest_, n_classes=self._k())
+        return np.column_stack([1.0 - P, P]) if P.ndim == 1 else P
+    def predict(self, X):
+        if not self.classify:
+            return _native.gbdt_predict(X, *self.forest_)
+        return self.classes_[np.argmax(self.predict_proba(X), axis=1)]
+
+class NativeKNN:
+    """
+    sklearn-style wrapper over aifd_native.KnnIndex: knn_cls/knn_reg answered by a
+    KD-tree (low d, exact) or an HNSW graph (high d, approximate), batch queries on
+    all cores. Only X/y pickle; the index is rebuilt on first use after loading.
+    """
+    def __init__(self, classify: bool, n_neighbors: int = 7, algorithm: str = "auto", ef: int = 64):
+        self.classify, self.n_neighbors = bool(classify), int(n_neighbors)
+        self.algorithm, self.ef = str(algorithm), int(ef)
+        self.X_: Optional[np.ndarray] = None
+        self.y_: Optional[np.ndarray] = None
+        self.classes_: Optional[np.ndarray] = None
+        self.finished_ = False
+        self._index = None
+    def __getstate__(self):
+        state = dict(self.__dict__); state["_index"] = None
+        return state
+    def _idx(self):
+        if self._index is None:
+            self._index = _native.KnnIndex(self.X_, self.algorithm)
+        return self._index
+    def fit(self, X, y):
+        y = np.asarray(y).reshape(-1)
+        if self.classify:
+            self.classes_, target = np.unique(y, return_inverse=True)
+        else:
+            target = y
+        self.X_ = np.ascontiguousarray(np.asarray(X, dtype=np.float64))
+        self.y_ = np.asarray(target, dtype=np.float64)
+        self._index = None
+        print(f"[native] knn index: {self._idx().algorithm} over {len(self.X_)} rows", flush=True)
+        self.finished_ = True
+        return self
+    def predict_proba(self, X):
+        return self._idx().vote(X, self.y_, self.n_neighbors, len(self.classes_), ef=self.ef)
+    def predict(self, X):
+        if not self.classify:
+            return self._idx().vote(X, self.y_, self.n_neighbors, ef=self.ef)
+        return self.classes_[np.argmax(self.predict_proba(X), axis=1)]
+
+ENSEMBLE_STAGES = 20  # forests/boosting grow in this many warm-start stages (one metrics event each)
+
+def _stage_eval(model, X, y, is_clf: bool) -> Tuple[float, float]:
+    """(loss, score): error rate/accuracy for classes, MSE/R² for regression."""
+    yhat = np.asarray(model.predict(X)).reshape(-1)
+    y = np.asarray(y).reshape(-1)
+    if is_clf:
+        acc = float(np.mean(yhat == y))
+        return 1.0 - acc, acc
+    r2, _, mse, _ = regression_metrics(y, yhat)
+    return float(mse), float(r2)
+
+def fit_in_stages(model, X, y, is_clf: bool, progress=None, early_stopping: bool = False,
+                  validation_fraction: float = 0.1, n_iter_no_change: int = 3, seed: int = 42,
+                  stages: int = ENSEMBLE_STAGES):
+    """
+    Grows an ensemble to its n_estimators in warm-start stages: sklearn forests and
+    boosting via warm_start, NativeForest/NativeGBDT by continuing their trees. sklearn
+    models report progress(trees, total, loss, score) once per stage (boosting: training
+    loss; forests: a fixed 5000-row training subsample, far cheaper than sklearn's OOB
+    pass over the whole forest at every stage; or the validation split); native ones
+    keep their per-tree events. A True from progress stops between stages.
+    early_stopping holds out validation_fraction of the rows and stops after
+    n_iter_no_change stages without a better validation score.
+    Returns (model, finished, note).
+    """
+    native = isinstance(model, (NativeForest, NativeGBDT))
+    total, n = int(model.n_estimators), X.shape[0]
+    rng = np.random.default_rng(seed)
+    Xv = yv = None
+    if early_stopping and n >= 20:
+        idx = rng.permutation(n)
+        nv = min(n - 10, max(1, int(round(validation_fraction * n))))
+        Xv, yv, X, y = X[idx[:nv]], y[idx[:nv]], X[idx[nv:]], y[idx[nv:]]
+    if Xv is None:
+        sub = rng.choice(X.shape[0], min(X.shape[0], 5000), replace=False)
+        Xm, ym = X[sub], y[sub]
+    else:
+        Xm, ym = Xv, yv
+    if native:
+        have, tree_progress = model.stages_(), model.progress
+        if tree_progress is not None:  # per-tree events against the whole run, not the stage
+            model.progress = lambda it, _stage_total, loss, score: tree_progress(it, total, loss, score)
+    else:
+        have = len(getattr(model, "estimators_", []))
+        model.set_params(warm_start=True)
+    step = max(1, -(-total // max(1, stages)))
+    best, bad, finished, note = -np.inf, 0, True, ""
+    try:
+        while have < total:
+            have = min(total, have + step)
+            if native:
+                model.n_estimators = have
+            else:
+                model.set_params(n_estimators=have)
+            model.fit(X, y)
+            if native and not model.finished_:
+                finished = False
+                break
+            if native and Xv is None:
+                continue
+            loss, score = _stage_eval(model, Xm, ym, is_clf)
+            if not native and Xv is None and hasattr(model, "train_score_"):
+                loss = float(model.train_score_[-1])
+            if Xv is not None:
+                print(f"[stage] {have}/{total} trees  validation score {score:.4f}", flush=True)
+            if not native and progress is not None and progress(have, total, loss, score):
+                finished = have >= total
+                break
+            if Xv is not None:
+                if score > best + 1e-4:
+                    best, bad = score, 0
+                else:
+                    bad += 1
+                if bad >= n_iter_no_change and have < total:
+                    note = (f"early stopping: {have} of {total} trees, validation score {best:.4f} "
+                            f"did not improve for {n_iter_no_change} stages")
+                    print("[stage] " + note, flush=True)
+                    break
+    finally:
+        if native:
+            model.progress = tree_progress
+    return model, finished, note
+
+def make_classical_model(m: str, hp: Dict[str, Any], Xtr: np.ndarray, is_multilabel: bool, epochs: int,
+                         native_mlp: bool = False, native_tree: bool = False, native_knn: bool = False,
+                         progress=None) -> Tuple[Any, str]:
+    """
+    Unfitted sklearn (or native) estimator for the classical models and the native MLP.
+    Returns (model, approx_note); the note is non-empty when the SVM is approximated.
+    """
+    in_dim = Xtr.shape[1]
+    approx_model, approx_note = svm_approx(m, hp, Xtr) if m in ("svm_cls", "svm_reg") else (None, "")
+    sk_knn_algo = {"kd_tree": "kd_tree", "brute": "brute"}.get(str(hp.get("algorithm", "auto")), "auto")
+    if native_mlp:
+        model = NativeMLP(
+            classify=(m == "mlp_cls"),
+            hidden=int(hp.get("hidden", max(8 if m == "mlp_cls" else 16, in_dim * 2))),
+            layers=int(hp.get("layers", 2)),
+            activation=str(hp.get("activation", "relu")),
+            optimizer=str(hp.get("optimizer", "adam")),
+            lr=float(hp.get("lr", 5e-2 if m == "mlp_cls" else 5e-3)),
+            batch_size=int(hp.get("batch_size", 0) or 0) or 64,   # 0 from the panel = the engine's default
+            epochs=epochs,
+            seed=int(hp.get("seed", 42)),
+            progress=progress)
+    elif native_tree and m in ("gb_cls", "gb_reg"):
+        model = NativeGBDT(
+            classify=(m == "gb_cls"),
+            n_estimators=int(hp.get("n_estimators", 100)),
+            learning_rate=float(hp.get("learning_rate", 0.1)),
+            max_leaf_nodes=int(hp.get("max_leaf_nodes", 31)),
+            max_depth=hp.get("max_depth", None),
+            min_samples_leaf=int(hp.get("min_samples_leaf", 20)),
+            l2_regularization=float(hp.get("l2_regularization", 0.0)),
+            progress=progress)
+    elif native_knn:
+        model = NativeKNN(
+            classify=(m == "knn_cls"),
+            n_neighbors=int(hp.get("n_neighbors", 7)),
+            algorithm=str(hp.get("algorithm", "auto")),
+            ef=int(hp.get("ef", 64)))
+    elif native_tree:
+        rf = m in ("rf_cls", "rf_reg")
+        model = NativeForest(
+            classify=(m in ("dt_cls", "rf_cls")),
+            n_estimators=int(hp.get("n_estimators", 200)) if rf else 1,
+            max_depth=hp.get("max_depth", None),
+            min_samples_leaf=int(hp.get("min_samples_leaf", 1)),
+            max_features=float(hp.get("max_features", 0.0)) if rf else 1.0,
+            bootstrap=rf,
+            seed=int(hp.get("seed", 42)),
+            progress=progress)
+    elif m == "dt_cls":
+        base = DecisionTreeClassifier(random_state=int(hp.get("seed", 42)))
+        model = OneVsRestClassifier(base) if is_multilabel else base
+    elif m == "dt_reg":
+        model = DecisionTreeRegressor(random_state=int(hp.get("seed", 42)))
+    elif m == "rf_cls":
+        base = RandomForestClassifier(
+            n_estimators=int(hp.get("n_estimators", 200)),
+            max_depth=hp.get("max_depth", None),
+            random_state=int(hp.get("seed", 42)),
+            n_jobs=N_JOBS
+        )
+        model = OneVsRestClassifier(base) if is_multilabel else base
+    elif m == "rf_reg":
+        model = RandomForestRegressor(
+            n_estimators=int(hp.get("n_estimators", 200)),
+            max_depth=hp.get("max_depth", None),
+            random_state=int(hp.get("seed", 42)),
+            n_jobs=N_JOBS
+        )
+    elif m == "knn_cls":
+        base = KNeighborsClassifier(n_neighbors=int(hp.get("n_neighbors", 7)), algorithm=sk_knn_algo,
+                                    n_jobs=N_JOBS)
+        model = OneVsRestClassifier(base) if is_multilabel else base
+    elif m == "knn_reg":
+        model = KNeighborsRegressor(n_neighbors=int(hp.get("n_neighbors", 7)), algorithm=sk_knn_algo,
+                                    n_jobs=N_JOBS)
+    elif m == "nb_cls":
+        base = GaussianNB()
+        model = OneVsRestClassifier(base) if is_multilabel else base
+    elif m == "nb_reg":
+        model = GaussianNBRegressor(n_bins=int(hp.get("nb_reg_bins", 10)))
+    elif m in ("svm_cls", "svm_reg") and approx_model is not None:
+        model = OneVsRestClassifier(approx_model) if is_multilabel else approx_model
+    elif m == "svm_cls":
+        base = SVC(kernel=hp.get("kernel", "rbf"),
+                   C=float(hp.get("C", 1.0)),
+                   gamma=hp.get("gamma", "scale"),
+                   probability=True,
+                   random_state=int(hp.get("seed", 42)))
+        model = OneVsRestClassifier(base) if is_multilabel else base
+    elif m == "svm_reg":
+        model = SVR(kernel=hp.get("kernel", "rbf"),
+                    C=float(hp.get("C", 1.0)),
+                    gamma=hp.get("gamma", "scale"),
+                    epsilon=float(hp.get("epsilon", 0.1)))
+    elif m == "gb_cls":
+        base = GradientBoostingClassifier(n_estimators=int(hp.get("n_estimators", 100)),
+                                          learning_rate=float(hp.get("learning_rate", 0.1)),
+                                          random_state=int(hp.get("seed", 42)))
+        model = OneVsRestClassifier(base) if is_multilabel else base
+    elif m == "gb_reg":
+        model = GradientBoostingRegressor(n_estimators=int(hp.get("n_estimators", 100)),
+                                          learning_rate=float(hp.get("learning_rate", 0.1)),
+                                          random_state=int(hp.get("seed", 42)))
+    else:
+        raise SystemExit(f"Unknown model {m}")
+    return model, approx_note
+
+def print_classification_report(y_true_idx, y_pred_idx, classes, stream=None, cm=None):
     """
     Pretty text report (and confusion matrix) for single-label classification.
     - y_true_idx, y_pred_idx: 1-D integer arrays (0..C-1) OR raw labels; we coerce safely.
     - classes: list/array of class names in index order.
     - stream: file-like to write into; if None -> print().
+    - cm: a confusion matrix accumulated elsewhere (--stream); the label arrays are then ignored.
     Returns the assembled string.
     """
     import numpy as _np
@@ -967,7 +2150,9 @@ def print_classification_report(y_true_idx, y_pred_idx, classes, stream=None):
     cls    = _np.asarray(list(classes))
 
     # If labels aren’t integers 0..C-1, coerce them together to indices.
-    if y_true.dtype.kind in "OUS" or y_pred.dtype.kind in "OUS":
+    if cm is not None:
+        y_true = y_pred = _np.zeros(0, dtype=int)
+    elif y_true.dtype.kind in "OUS" or y_pred.dtype.kind in "OUS":
         all_labels = _np.unique(_np.concatenate([y_true.astype(str), y_pred.astype(str)]))
         map2 = {s:i for i, s in enumerate(all_labels)}
         y_true = _np.vectorize(map2.get)(y_true.astype(str)).astype(int)
@@ -988,6 +2173,8 @@ def print_classification_report(y_true_idx, y_pred_idx, classes, stream=None):
 
     # Try scikit-learn for detailed metrics; otherwise fallback to a manual summary.
     try:
+        if cm is not None:
+            raise LookupError  # counts only: the manual summary below works from cm
         from sklearn.metrics import classification_report, confusion_matrix, accuracy_score
         rep = classification_report(
             y_true, y_pred,
@@ -1002,12 +2189,14 @@ def print_classification_report(y_true_idx, y_pred_idx, classes, stream=None):
         lines.append(rep.rstrip())
     except Exception:
         # Manual confusion + per-class precision/recall/F1
-        cm = _np.zeros((C, C), dtype=int)
-        for t, p in zip(y_true, y_pred):
-            if 0 <= t < C and 0 <= p < C:
-                cm[t, p] += 1
+        streamed = cm is not None
+        if not streamed:
+            cm = _np.zeros((C, C), dtype=int)
+            for t, p in zip(y_true, y_pred):
+                if 0 <= t < C and 0 <= p < C:
+                    cm[t, p] += 1
         acc = (cm.trace() / max(1, cm.sum())).item()
-        lines.append("=== Classification Report (fallback) ===")
+        lines.append("=== Classification Report (streamed) ===" if streamed else "=== Classification Report (fallback) ===")
         lines.append(f"accuracy: {acc:.4f}")
         # per-class
         header = f"{'class':<18} {'prec':>7} {'rec':>7} {'f1':>7} {'support':>8}"
@@ -1044,7 +2233,382 @@ def print_classification_report(y_true_idx, y_pred_idx, classes, stream=None):
         print(text, flush=True)
     return text
 
+# -------------------- out-of-core training (--stream) --------------------
+STREAM_AUTO_MB = float(os.environ.get("AIFD_STREAM_MB", 1024))   # --stream auto: files above this stream
+STREAM_MODELS = {"linreg", "ridge", "lasso", "logreg", "mlp_cls", "mlp_reg", "nb_cls"}
+
+def train_streaming(args, hp: Dict[str, Any], cache: Optional["ModelCache"], cache_key: str,
+                    cache_family: str, warm_source, run_key: str) -> None:
+    """
+    Trains without ever holding the dataset: pass 1 fits the preprocessor (and the
+    class list) chunk by chunk, then every epoch re-reads the file and runs minibatch
+    Adam over each chunk (GaussianNB: one partial_fit pass). Rows are split by a hash
+    of their row number, so the test rows never reach the optimizer. The plot uses a
+    reservoir sample of the training rows.
+    """
+    import streaming as st
+    split_seed = 123
+    cols = st.read_columns(args.csv)
+    x_cols = [c if c in cols else lev_search(cols, c) for c in (s.strip() for s in args.x.split(",")) if c]
+    y_cols = [c if c in cols else lev_search(cols, c) for c in (s.strip() for s in args.y.split(",")) if c]
+    if len(y_cols) != 1:
+        raise SystemExit("--stream trains single-target models; pass one --y column")
+    y_col = y_cols[0]
+    use = list(dict.fromkeys(x_cols + [y_col]))
+    is_clf = args.model in ("logreg", "mlp_cls", "nb_cls")
+    chunks = lambda: st.iter_chunks(args.csv, use, args.chunk_rows)
+
+    # pass 1: preprocessing statistics + classes
+    pre = st.StreamingPreprocessor(args.scale, args.impute, args.onehot, seed=split_seed,
+                                   buckets=args.hash_buckets if args.onehot else 0)
+    labels: set = set()
+    t0 = time.perf_counter()
+    for chunk in chunks():
+        pre.partial_fit(chunk[x_cols])
+        if is_clf:
+            labels.update(chunk[y_col].astype(str).unique().tolist())
+            if len(labels) > 1000:
+                raise SystemExit(f"--stream: '{y_col}' has over 1000 classes; is this a regression target?")
+    pre.finalize()
+    classes = np.array(sorted(labels)) if is_clf else None
+    ncls = len(classes) if is_clf else 0
+    in_dim = pre.out_dim
+    print(f"[stream] {pre.rows} rows in chunks of {args.chunk_rows}, dim={in_dim}, "
+          f"statistics pass {time.perf_counter() - t0:.1f}s", flush=True)
+    _emit(event="stream", rows=int(pre.rows), chunk_rows=int(args.chunk_rows), input_dim=int(in_dim))
+
+    def prepared(chunk, train: bool, start: int):
+        m = st.train_mask(start, len(chunk), args.train_pct, split_seed)
+        if train and args.train_frac < 1.0:   # row budget: the rows hashing lowest inside the training share
+            m = st.train_mask(start, len(chunk), args.train_pct * max(0.0, args.train_frac), split_seed)
+        part = chunk[m if train else ~m]
+        if is_clf:
+            y = np.searchsorted(classes, part[y_col].astype(str).to_numpy()).astype(np.int64)
+        else:
+            y = pd.to_numeric(part[y_col], errors="coerce").to_numpy(dtype=np.float64)
+            keep = ~np.isnan(y)
+            part, y = part[keep], y[keep]
+        return pre.transform(part[x_cols]), y
+
+    torch_model = args.model != "nb_cls"
+    if torch_model and not _TORCH_OK:
+        raise SystemExit("--stream trains the torch models; install torch")
+    if not torch_model and not _SK_OK:
+        raise SystemExit("--stream nb_cls needs scikit-learn")
+    epochs = args.epochs if torch_model else 1
+    bs = int(hp.get("batch_size", 0) or 0) or 256   # 0 from the panel = 256-row minibatches
+    if torch_model:
+        model, loss_fn, opt, l1_lambda = build_torch_model(args.model, in_dim, ncls, hp)
+        l1_lambda = float(hp.get("l1_lambda", l1_lambda))
+        src = warm_source("model.pt")
+        if src is not None:
+            try:
+                model.load_state_dict(torch.load(src / "model.pt", map_location="cpu")["state_dict"])
+                print(f"[cache] warm start from {src.name}", flush=True)
+                _emit(event="cache", hit=False, warm=True, key=src.name)
+            except Exception as e:
+                print(f"[cache] warm start skipped (different architecture?): {e}", flush=True)
+    else:
+        model, opt = GaussianNB(), None
+
+    def predict(Xc: np.ndarray) -> np.ndarray:
+        if not torch_model:
+            return model.predict(Xc)
+        with torch.no_grad():
+            out = model(torch.from_numpy(Xc))
+        if not is_clf:
+            return out.view(-1).numpy()
+        return (out.argmax(dim=1) if out.shape[1] > 1 else (out.view(-1) >= 0.0).long()).numpy()
+
+    pacer = FramePacer(args.frame_interval, args.frame_budget, args.frame_every)
+    control = TrainControl(sys.stdin if args.control == "stdin" else None)
+    ckpt_path = Path(args.checkpoint) if args.checkpoint else CKPT_PATH / f"{run_key}.pt"
+    hist_vals: List[float] = []
+    done_epoch = 0
+    def snapshot() -> None:
+        if torch_model:
+            save_checkpoint(ckpt_path, model, opt, done_epoch, hist_vals=hist_vals, model_name=args.model)
+            print(f"[checkpoint] epoch {done_epoch} -> {ckpt_path}", flush=True)
+            _emit(event="checkpoint", epoch=done_epoch, path=str(ckpt_path))
+    if torch_model and args.resume and ckpt_path.exists():
+        try:
+            state = load_checkpoint(ckpt_path, model, opt)
+            done_epoch = int(state["epoch"]); hist_vals[:] = list(state.get("hist_vals", []))
+            print(f"[checkpoint] resumed at epoch {done_epoch} from {ckpt_path}", flush=True)
+            _emit(event="control", state="resumed", epoch=done_epoch)
+        except Exception as e:
+            print(f"[checkpoint] cannot resume ({e}); starting over", flush=True)
+            done_epoch = 0
+
+    sample = st.Reservoir(st.PLOT_SAMPLE, seed=split_seed)
+    rng = np.random.default_rng(int(hp.get("seed", 42)))
+    _emit(event="begin", task=("classification" if is_clf else "regression"), input_dim=int(in_dim),
+          params=hp, stream=True)
+    for epoch in range(done_epoch + 1, epochs + 1):
+        t_epoch = time.perf_counter()
+        fit = st.StreamMetrics(ncls)
+        loss_sum, seen, start = 0.0, 0, 0
+        for chunk in chunks():
+            if not control.poll(snapshot):
+                snapshot()
+                _emit(event="control", state="cancelled", epoch=done_epoch)
+                print(f"[control] cancelled during epoch {epoch}; rerun with --resume to continue", flush=True)
+                return
+            Xc, yc = prepared(chunk, True, start)
+            start += len(chunk)
+            if not len(yc):
+                continue
+            if sample.seen < pre.rows and epoch == done_epoch + 1:
+                sample.add(np.hstack([Xc, yc.reshape(-1, 1).astype(np.float32)]))
+            if not torch_model:
+                model.partial_fit(Xc, yc, classes=np.arange(ncls))
+                fit.update(yc, model.predict(Xc)); seen += len(yc)
+                continue
+            order = rng.permutation(len(yc))
+            for b in range(0, len(order), bs):
+                idx = order[b:b + bs]
+                xb = torch.from_numpy(Xc[idx])
+                if isinstance(loss_fn, nn.CrossEntropyLoss):
+                    yb = torch.from_numpy(yc[idx])
+                else:
+                    yb = torch.from_numpy(yc[idx].astype(np.float32)).view(-1, 1)
+                opt.zero_grad()
+                out = model(xb)
+                loss = loss_fn(out, yb)
+                if l1_lambda > 0.0:
+                    loss = loss + l1_lambda * sum(p.abs().sum() for p in model.parameters())
+                loss.backward(); opt.step()
+                loss_sum += float(loss.item()) * len(idx); seen += len(idx)
+                out = out.detach()
+                if not is_clf:
+                    yhat = out.view(-1).numpy()
+                elif out.shape[1] > 1:
+                    yhat = out.argmax(dim=1).numpy()
+                else:
+                    yhat = (out.view(-1) >= 0.0).long().numpy()
+                fit.update(yc[idx], yhat)
+        score = fit.accuracy() if is_clf else max(0.0, min(1.0, fit.regression()[0]))
+        hist_vals.append(score)
+        metric_label = f"Training {'accuracy' if is_clf else 'R²'}: {score*100:.1f}%"
+        pacer.add_train(time.perf_counter() - t_epoch)
+
+        if args.out_plot and pacer.due(epoch, epochs) and sample.seen:
+            t_frame = time.perf_counter()
+            S = sample.sample()
+            Xs, ys = S[:, :-1], (S[:, -1].astype(np.int64) if is_clf else S[:, -1].astype(float))
+            if args.plot_style == "retro95":
+                save_plot_combo_retro95(hist_vals, epoch, epochs, Xs, ys, model, is_clf, x_cols,
+                                        args.out_plot, metric_label,
+                                        classes=(classes if is_clf else None), proj=args.proj)
+            elif is_clf:
+                save_plot_classification(Xs, ys, model, epoch, epochs, args.out_plot,
+                                         feature_names=x_cols, device="cpu", proj=args.proj)
+            else:
+                save_plot_regression(Xs, ys, model, epoch, epochs, args.out_plot,
+                                     x_label=(args.x_label or x_cols[0] if len(x_cols) == 1 else "X"),
+                                     y_label=(args.y_label or y_col), proj=args.proj, color_by=args.color_by)
+            pacer.rendered(epoch, time.perf_counter() - t_frame)
+            _emit(event="cadence", epoch=epoch, **pacer.report(epoch))
+
+        loss_ep = loss_sum / max(1, seen)
+        rps = seen / max(1e-9, time.perf_counter() - t_epoch)
+        print(f"[stream] epoch {epoch}: {seen} training rows, {rps:,.0f} rows/s", flush=True)
+        _emit(event="epoch", epoch=epoch, epochs=epochs, loss=loss_ep, score=float(score))
+        done_epoch = epoch
+
+    if ckpt_path.exists():
+        ckpt_path.unlink()
+
+    # test pass: the held-out rows, chunk by chunk
+    if torch_model:
+        model.eval()
+    test = st.StreamMetrics(ncls)
+    start = 0
+    for chunk in chunks():
+        Xc, yc = prepared(chunk, False, start)
+        start += len(chunk)
+        if len(yc):
+            test.update(yc, predict(Xc))
+    note = f"[stream] {pre.rows} rows read in chunks of {args.chunk_rows}"
+    if is_clf:
+        from io import StringIO
+        buf = StringIO()
+        print_classification_report(None, None, classes, stream=buf, cm=test.cm)
+        text = buf.getvalue()
+        final_score = test.accuracy()
+    else:
+        r2, mae, mse, rmse = test.regression()
+        final_score = float(r2)
+        text = "\n".join([
+            "=== Regression Metrics ===",
+            f"R²  : {r2:.6f}",
+            f"MAE  : {mae:.6f}",
+            f"MSE  : {mse:.6f}",
+            f"RMSE : {rmse:.6f}",
+        ])
+    text += "\n\n" + note
+    print("\n" + text, flush=True)
+
+    if args.out_metrics:
+        tmp = args.out_metrics + ".tmp"
+        with open(tmp, "w", encoding="utf-8") as f:
+            f.write(text)
+        os.replace(tmp, args.out_metrics)
+    saved = ""
+    if cache is not None:
+        saved = str(cache.store(cache_key, cache_family, model, text, args.out_plot,
+                                {"model": args.model, "hparams": hp, "score": final_score}))
+    _emit(event="done", score=final_score, path=saved)
+
 # -------------------- main --------------------
+TORCH_MODELS = ("linreg", "ridge", "lasso", "logreg", "mlp_cls", "mlp_reg")
+
+def _cv_fold(job: Dict[str, Any]) -> Dict[str, float]:
+    """One --cv fold in a worker process: maps the shared matrix, fits on the other folds, scores this one."""
+    from crossval import SharedArray, attach_matrix, confusion_scores
+    global N_JOBS
+    N_JOBS = job["threads"]
+    if _TORCH_OK:
+        torch.set_num_threads(job["threads"])
+    t0 = time.perf_counter()
+    shm_x, X = attach_matrix(job["X"])
+    shm_y, y = SharedArray.attach(job["y"])
+    tr, te = job["train"], job["test"]
+    Xtr, Xte, ytr, yte = X[tr], X[te], y[tr], y[te]   # fancy indexing copies: the views can go now
+    in_dim = X.shape[1]
+    del X, y
+    for shm in shm_x:
+        shm.close()
+    shm_y.close()
+
+    m, hp, ncls = job["model"], job["hp"], job["n_classes"]
+    if m in TORCH_MODELS and not job["native"][0]:
+        # same full-batch loop as main(), without frames or the control channel
+        model, loss_fn, opt, l1_lambda = build_torch_model(m, in_dim, ncls, hp)
+        Xt = torch.from_numpy(Xtr)
+        if isinstance(loss_fn, nn.CrossEntropyLoss):
+            yt = torch.from_numpy(ytr.astype(np.int64))
+        else:
+            yt = torch.from_numpy(ytr.astype(np.float32)).view(-1, 1)
+        l1 = float(hp.get("l1_lambda", l1_lambda)) if m == "lasso" else \
+             float(hp.get("l1_lambda", 0.0)) if m == "logreg" else 0.0
+        for _ in range(job["epochs"]):
+            opt.zero_grad()
+            loss = loss_fn(model(Xt), yt)
+            if l1 > 0.0:
+                loss = loss + l1 * sum(p.abs().sum() for p in model.parameters())
+            loss.backward(); opt.step()
+        with torch.no_grad():
+            out = model(torch.from_numpy(Xte))
+        if ncls == 0:
+            pred = out.numpy().reshape(-1)
+        elif out.dim() == 2 and out.shape[1] > 1:
+            pred = torch.argmax(out, dim=1).numpy()
+        else:
+            pred = (out.view(-1) >= 0.0).numpy().astype(np.int64)
+    else:
+        model, _ = make_classical_model(m, hp, Xtr, False, job["epochs"], *job["native"])
+        pred = np.asarray(model.fit(Xtr, ytr).predict(Xte)).reshape(-1)
+
+    if ncls:
+        res = confusion_scores(yte, pred, ncls)
+    else:
+        r2, mae, mse, rmse = regression_metrics(yte, pred)
+        res = {"r2": float(r2), "mae": float(mae), "mse": float(mse), "rmse": float(rmse)}
+    res.update(fold=job["fold"], seconds=time.perf_counter() - t0)
+    return res
+
+def run_cv(args, hp: Dict[str, Any], X: np.ndarray, Y: np.ndarray, native: Tuple[bool, bool, bool]) -> None:
+    """
+    --cv K: X is preprocessed once (by the caller) and copied into shared memory
+    once; K folds train in worker processes that map it instead of receiving
+    pickled copies. Reports mean ± std per metric to the Metrics panel.
+    """
+    import multiprocessing as mp
+    from concurrent.futures import ProcessPoolExecutor, wait, FIRST_COMPLETED
+    import crossval as cv
+
+    is_clf = args.model == "logreg" or args.model.endswith("_cls")
+    y = np.asarray(Y)
+    if y.ndim == 2 and y.shape[1] > 1:
+        raise SystemExit("--cv: multi-column targets are not supported; use the train/test split")
+    y = y.reshape(-1)
+    if is_clf:
+        classes, y_idx = np.unique(y.astype(str), return_inverse=True)
+        y_shared, ncls = y_idx.astype(np.int64), len(classes)
+    else:
+        y_shared, ncls = y.astype(np.float64), 0
+    folds = cv.kfold_indices(len(y_shared), args.cv, y_shared if is_clf else None, seed=123)
+    k = len(folds)
+    if 0.0 < args.train_frac < 1.0:   # row budget (sweep.py halving): a nested subset of each training fold
+        rng = np.random.default_rng(123)
+        folds = [(np.sort(rng.permutation(tr)[:max(1, int(round(len(tr) * args.train_frac)))]), te) for tr, te in folds]
+
+    cores = N_JOBS if N_JOBS > 0 else (os.cpu_count() or 1)
+    workers = max(1, min(k, cores))
+    threads = max(1, cores // workers)
+    keys = [("accuracy", "Accuracy"), ("precision_macro", "Precision"), ("recall_macro", "Recall"),
+            ("f1_macro", "F1 (macro)")] if is_clf else \
+           [("r2", "R²"), ("mae", "MAE"), ("mse", "MSE"), ("rmse", "RMSE")]
+    score_key = keys[0][0]
+
+    if isinstance(X, cv.SharedArray):   # --lean: the caller preprocessed straight into shared memory
+        sx, X = X, X.array
+    else:
+        sx = cv.share_matrix(X if hasattr(X, "tocsr") else np.asarray(X, dtype=np.float32))
+    sy = cv.SharedArray(y_shared)
+    jobs = [{"fold": i, "train": tr, "test": te, "X": sx.handle, "y": sy.handle, "model": args.model, "hp": hp,
+             "epochs": args.epochs, "n_classes": ncls, "native": tuple(native), "threads": threads}
+            for i, (tr, te) in enumerate(folds)]
+    print(f"[cv] {k} folds{' (stratified)' if is_clf else ''} on {len(y_shared)} rows x {X.shape[1]} features, "
+          f"{workers} worker(s) x {threads} thread(s), {sx.nbytes / 1e6:.1f} MB shared", flush=True)
+    _emit(event="begin", task=("classification" if is_clf else "regression"), input_dim=int(X.shape[1]),
+          params=hp, folds=k)
+
+    results: List[Dict[str, float]] = []
+    cancelled = False
+    t0 = time.perf_counter()
+    start = "fork" if "fork" in mp.get_all_start_methods() else "spawn"
+    try:
+        with ProcessPoolExecutor(max_workers=workers, mp_context=mp.get_context(start)) as pool:
+            pending = {pool.submit(_cv_fold, j) for j in jobs}
+            control = TrainControl(sys.stdin if args.control == "stdin" else None)   # after the fork
+            while pending:
+                done, pending = wait(pending, timeout=0.2, return_when=FIRST_COMPLETED)
+                for f in done:
+                    r = f.result()
+                    results.append(r)
+                    print(f"[cv] fold {r['fold'] + 1}/{k}: {score_key} {r[score_key]:.4f} ({r['seconds']:.1f}s)", flush=True)
+                    _emit(event="epoch", epoch=len(results), epochs=k, loss=0.0, score=float(r[score_key]))
+                if pending and not control.poll():
+                    for f in pending:
+                        f.cancel()   # queued folds are dropped; running ones finish
+                    cancelled = True
+                    _emit(event="control", state="cancelled", epoch=len(results))
+                    done, _ = wait(pending)
+                    results += [f.result() for f in done if not f.cancelled()]
+                    break
+    finally:
+        sx.release(); sy.release()
+    wall = time.perf_counter() - t0
+    if not results:
+        print("[cv] cancelled before any fold finished", flush=True)
+        return
+
+    text = cv.report(results, keys, k, is_clf, wall, workers)
+    if cancelled:
+        text += "\n\n(cancelled: partial result)"
+    busy = sum(r["seconds"] for r in results)
+    text += f"\n\nfold time {busy:.1f}s over {wall:.1f}s wall ({busy / max(wall, 1e-9):.1f}x)"
+    print("\n" + text, flush=True)
+    if args.out_metrics:
+        tmp = args.out_metrics + ".tmp"
+        with open(tmp, "w", encoding="utf-8") as f:
+            f.write(text)
+        os.replace(tmp, args.out_metrics)
+    _emit(event="done", score=float(np.mean([r[score_key] for r in results])), path="")
+
+
 def main():
     ap = argparse.ArgumentParser()
     ap.add_argument("--csv", required=True)
@@ -1068,7 +2632,9 @@ def main():
     ap.add_argument("--train-pct", type=float, default=0.70)
     ap.add_argument("--proj", choices=["none","pca2","tsne2"], default="pca2")
     ap.add_argument("--color-by", type=str, default="residual")
-    ap.add_argument("--frame-every", type=int, default=1)
+    ap.add_argument("--frame-every", type=int, default=1)          # minimum epochs between frames
+    ap.add_argument("--frame-interval", type=float, default=0.5)   # target seconds between frames
+    ap.add_argument("--frame-budget", type=float, default=0.10)    # max render time / training time
     ap.add_argument("--out-plot", default="")
     ap.add_argument("--out-metrics", default="")
     ap.add_argument("--plot-every", type=int, default=1)
@@ -1079,6 +2645,25 @@ def main():
     ap.add_argument("--scale", default="standard", choices=["none","standard","minmax"])
     ap.add_argument("--impute", default="mean", choices=["mean","median","most_frequent","zero"])
     ap.add_argument("--onehot", action="store_true")
+    ap.add_argument("--hash-buckets", type=int, default=0)   # --onehot: hash categories into N shared columns (0 = one per category)
+    ap.add_argument("--sparse", choices=["auto", "on", "off"], default="auto")  # CSR X for the sklearn models; auto = when mostly zeros
+    # model cache
+    ap.add_argument("--no-cache", action="store_true")
+    ap.add_argument("--warm-start", action="store_true")   # init from the newest run of the same family
+    ap.add_argument("--cache-cap-mb", type=float, default=float(os.environ.get("AIFD_MODEL_CACHE_MB", 512)))  # one budget: models + preproc + projections
+    # control channel + resumable snapshots
+    ap.add_argument("--control", choices=["stdin", "none"], default="stdin")  # pause/resume/cancel/checkpoint lines
+    ap.add_argument("--checkpoint", default="")   # snapshot path (default: cache/checkpoints/<request key>.pt)
+    ap.add_argument("--resume", action="store_true")
+    ap.add_argument("--engine", choices=["auto", "torch", "native"], default="auto")  # MLPs/trees/KNN: auto = torch/sklearn if installed
+    ap.add_argument("--stream", choices=["auto", "on", "off"], default="auto")  # out-of-core; auto = files over STREAM_AUTO_MB
+    ap.add_argument("--chunk-rows", type=int, default=65536)   # rows per chunk read when streaming
+    ap.add_argument("--train-frac", type=float, default=1.0)   # row budget: share of the training rows used (sweep.py halving)
+    ap.add_argument("--val-frac", type=float, default=0.0)     # share of the training rows held out; "done" adds val_score (sweep.py ranks on it)
+    ap.add_argument("--shm", default="")   # dataset segment written by the GUI (handoff.py); falls back to --csv
+    ap.add_argument("--cv", type=int, default=0)   # k-fold cross-validation instead of the train/test split (0/1 = off)
+    ap.add_argument("--workers", type=int, default=1)   # torch models: data-parallel training over N local processes (gloo)
+    ap.add_argument("--lean", action="store_true")   # float32 parse, no DataFrame copies, X built once in split order
 
     args = ap.parse_args()
 
@@ -1093,36 +2678,274 @@ def main():
     if pd is None:
         raise SystemExit("pandas is required to load CSVs")
 
-    df = pd.read_csv(args.csv)
-    feat_names = [s.strip() for s in args.x.split(",") if s.strip()]
-    y_feats    = [s.strip() for s in args.y.split(",") if s.strip()]
-    df_cols = list(df.columns)
-
-    fixed_feat_names = []
-    for name in feat_names:
-        fixed_feat_names.append(name if name in df_cols else lev_search(df_cols, name))
-    feat_names = fixed_feat_names
-
-    fixed_y_feats = []
-    for name in y_feats:
-        fixed_y_feats.append(name if name in df_cols else lev_search(df_cols, name))
-    y_feats = fixed_y_feats
-
-    dfX = df[feat_names].copy()
-    dfY = df[y_feats].copy()
-
-    # ---- data treatment (applied to X only; we keep y as-is) ----
-    if _SK_OK:
-        pre = build_preprocessor(dfX, args.scale, args.impute, args.onehot)
-        X = np.asarray(pre.fit_transform(dfX), dtype=np.float32)
-        X_feature_names = feat_names  # after onehot we lose names; keep originals for labels
+    # MLPs, trees and KNN train on the native core when asked to, or when torch/sklearn isn't installed
+    native_mlp = args.model in ("mlp_reg", "mlp_cls") and (
+        args.engine == "native" or (args.engine == "auto" and not _TORCH_OK))
+    native_tree = args.model in ("dt_cls", "dt_reg", "rf_cls", "rf_reg", "gb_cls", "gb_reg") and (
+        args.engine == "native" or (args.engine == "auto" and not _SK_OK))
+    native_knn = args.model in ("knn_cls", "knn_reg") and (
+        args.engine == "native" or (args.engine == "auto" and not _SK_OK))
+    # CSR input only reaches models that accept it; everything else gets the dense matrix
+    csr_ok = args.sparse != "off" and args.model in SPARSE_MODELS and not (native_tree or native_knn)
+    if args.sparse == "on" and not csr_ok:
+        print(f"[sparse] {args.model} takes dense input; --sparse on is ignored", flush=True)
+    if args.workers > 1 and (args.model not in TORCH_MODELS or native_mlp or args.cv > 1):
+        print(f"[dp] --workers applies to the torch trainer without --cv; {args.model} trains as usual", flush=True)
+    if (native_mlp or native_tree or native_knn) and not _NATIVE_OK:
+        raise SystemExit("native engine unavailable: " + (_native.load_error() if _native else "aifd_native not importable"))
+    if not _TORCH_OK and not native_mlp and args.model in ("linreg", "ridge", "lasso", "logreg", "mlp_reg", "mlp_cls"):
+        raise SystemExit(f"{args.model} needs torch (pip install torch); MLPs can use --engine native")
+
+    # ---- --stream: decided up front, streamed runs are their own cache family ----
+    stream = args.stream == "on" or (args.stream == "auto" and os.path.exists(args.csv)
+                                      and os.path.getsize(args.csv) > STREAM_AUTO_MB * 1024 * 1024)
+    if stream and args.model not in STREAM_MODELS:
+        if args.stream == "on":
+            raise SystemExit(f"--stream: {args.model} has no incremental fit; "
+                             f"streaming supports {', '.join(sorted(STREAM_MODELS))}")
+        print(f"[stream] {args.model} needs the whole dataset in memory; loading it", flush=True)
+        stream = False
+    if stream and args.cv > 1:
+        if args.stream == "on":
+            raise SystemExit("--cv needs the whole dataset in memory; drop --stream on")
+        stream = False
+    if stream and (native_mlp or native_tree or native_knn):
+        if args.stream == "auto":
+            stream = False   # the native engines fit in memory
+        else:
+            print("[stream] the native engine has no incremental fit; training the torch model", flush=True)
+            native_mlp = native_tree = native_knn = False
+
+    # ---- model cache: an identical request replays metrics + plot without training ----
+    global CACHE_CAP_MB
+    CACHE_CAP_MB = args.cache_cap_mb
+    cache = None if args.no_cache else ModelCache(cap_mb=args.cache_cap_mb)
+    def request_keys(data: str) -> Tuple[str, str]:
+        """(family, request key) for the dataset identity `data`."""
+        family = ModelCache.digest({
+            "data": data, "x": args.x, "y": args.y,
+            "scale": args.scale, "impute": args.impute, "onehot": bool(args.onehot),
+            **({"hash_buckets": args.hash_buckets} if args.onehot and args.hash_buckets > 0 else {}),
+            **({"csr": True} if csr_ok else {}),
+            "model": args.model, "train_pct": args.train_pct, **({"engine": "native"} if (native_mlp or native_tree or native_knn) else {}),
+            **({"stream": True} if stream else {}),
+            **({"train_frac": args.train_frac} if args.train_frac < 1.0 else {}),
+            **({"cv": args.cv} if args.cv > 1 else {}),
+            **({"val_frac": args.val_frac} if 0.0 < args.val_frac < 1.0 else {}),
+            **({"lean": True} if args.lean else {})})
+        return family, ModelCache.digest({
+            "family": family, "hparams": hp, "epochs": args.epochs,
+            "proj": args.proj, "color_by": args.color_by, "plot_style": args.plot_style})
+
+    cache_key = cache_family = data_digest = ""
+    warm_from: Optional[Path] = None
+    if cache is not None:
+        try:
+            data_digest = cache.dataset_digest(args.csv)
+            cache_family, cache_key = request_keys(data_digest)
+            cache.request = cache_key
+            hit = cache.replay(cache_key, args.out_plot, args.out_metrics)
+            if hit is None and args.warm_start:
+                # an earlier warm run of this same request replays too; otherwise continue from the
+                # newest entry of another request. The result depends on that source, so it gets its
+                # own key (request + source entry) and never stands in for a fresh fit
+                prev = cache.find_request(cache_family, cache_key)
+                if prev is not None:
+                    cache_key = prev.name
+                    hit = cache.replay(cache_key, args.out_plot, args.out_metrics)
+                else:
+                    warm_from = cache.find_warm(cache_family, cache_key)
+                    if warm_from is not None:
+                        cache_key = ModelCache.digest({"fresh": cache_key, "warm_start": True,
+                                                       "warm_from": warm_from.name})
+        except Exception as e:
+            print(f"[cache] disabled for this run: {e}", flush=True)
+            cache, hit, warm_from = None, None, None
+        if hit is not None:
+            _emit(event="cache", hit=True, key=cache_key)
+            _emit(event="done", score=float(hit.get("score", 0.0)), path=str(cache.root / cache_key),
+                  **({"val_score": hit["val_score"]} if hit.get("val_score") is not None else {}))
+            return
+
+    def warm_source(filename: str) -> Optional[Path]:
+        return warm_from if (warm_from is not None and (warm_from / filename).exists()) else None
+
+    # checkpoint name: the request key, also with --no-cache (the file then stands in for the content
+    # digest), so an unrelated run never resumes another run's snapshot
+    run_key = cache_key
+    if not run_key:
+        st = os.stat(args.csv)
+        run_key = request_keys(f"{os.path.abspath(args.csv)}|{st.st_size}|{st.st_mtime_ns}")[1]
+
+    if stream:  # out-of-core: the file is read in chunks and never held whole
+        if 0.0 < args.val_frac < 1.0:
+            print("[val] --stream has no validation split: only the test score is reported", flush=True)
+        train_streaming(args, hp, cache, cache_key, cache_family, warm_source, run_key)
+        return
+
+    mem = MemoryReport()   # [mem] per stage; the training stage and the summary print at exit
+    atexit.register(lambda: (mem.stage("train"), print(f"[mem] {mem.summary()}", flush=True)))
+
+    # ---- preprocessing cache: same data + features + treatment + split -> no refit ----
+    split_seed = 123
+    pcache = PreprocCache(cap_mb=args.cache_cap_mb) if (cache is not None and _SK_OK) else None
+    prep_key = ModelCache.digest({
+        "data": data_digest, "x": args.x, "y": args.y, "scale": args.scale, "impute": args.impute,
+        "onehot": bool(args.onehot), "seed": split_seed, "train_pct": args.train_pct,
+        **({"hash_buckets": args.hash_buckets} if args.onehot and args.hash_buckets > 0 else {}),
+        **({"csr": True} if csr_ok else {}),
+        **({"lean": True} if args.lean else {})}) if pcache else ""
+    prep = pcache.load(prep_key) if (pcache and args.cv < 2) else None   # the cache holds split matrices
+
+    if prep is not None:
+        pre = prep["pre"]
+        Xtr, Xte, ytr, yte = prep["Xtr"], prep["Xte"], prep["ytr"], prep["yte"]
+        feat_names = X_feature_names = prep["meta"]["x"]
+        y_feats = prep["meta"]["y"]
+        is_multilabel = bool(prep["meta"]["multilabel"])
+        in_dim = Xtr.shape[1]
+        print(f"[cache] preprocessing reused ({prep_key})", flush=True)
     else:
-        X = dfX.to_numpy(dtype=np.float32)
-        X_feature_names = feat_names
+        feat_names = [s.strip() for s in args.x.split(",") if s.strip()]
+        y_feats    = [s.strip() for s in args.y.split(",") if s.strip()]
+
+        # --shm: the GUI already parsed these columns into a shared segment; map it instead of the CSV
+        seg = None
+        if args.shm:
+            try:
+                import handoff
+                seg = handoff.Segment(args.shm)
+                if not seg.matches(args.csv, feat_names, y_feats):
+                    print("[shm] segment is for other columns or an older file; reading the CSV", flush=True)
+                    seg = None
+            except Exception as e:
+                print(f"[shm] cannot map {args.shm} ({e}); reading the CSV", flush=True)
+                seg = None
+        if seg is not None:
+            dfX, dfY = seg.frames(feat_names, y_feats)
+            print(f"[shm] {seg.rows} rows x {len(feat_names)} columns mapped from {args.shm}", flush=True)
+        else:
+            df = read_table(args.csv, float32=args.lean)
+            df_cols = list(df.columns)
+
+            fixed_feat_names = []
+            for name in feat_names:
+                fixed_feat_names.append(name if name in df_cols else lev_search(df_cols, name))
+            feat_names = fixed_feat_names
+
+            fixed_y_feats = []
+            for name in y_feats:
+                fixed_y_feats.append(name if name in df_cols else lev_search(df_cols, name))
+            y_feats = fixed_y_feats
+
+            if args.lean:   # column selections without copies; the frame itself goes
+                dfX, dfY = df[feat_names], df[y_feats]
+                del df
+            else:
+                dfX = df[feat_names].copy()
+                dfY = df[y_feats].copy()
+        mem.stage("read")
+
+        # ---- data treatment (applied to X only; we keep y as-is) ----
+        native_prep = _NATIVE_OK and os.environ.get("AIFD_PREP", "native") != "sklearn"
+        has_cat = not all(pd.api.types.is_numeric_dtype(dfX[c]) for c in dfX.columns)
+        order = None   # --lean: rows of X in split order (train first)
+        if args.onehot and has_cat and (args.hash_buckets > 0 or csr_ok) and (native_prep or _SK_OK):
+            # high-cardinality one-hot: hashed and/or CSR, the numeric block from the usual preprocessor
+            import encoding
+            num_pre = NativePreprocessor(args.scale, args.impute, False) if native_prep else \
+                build_preprocessor(dfX[[c for c in dfX.columns if pd.api.types.is_numeric_dtype(dfX[c])]],
+                                   args.scale, args.impute, False)
+            pre = encoding.SparseEncoder(args.impute, args.hash_buckets, num_pre).fit(dfX)
+            est = pre.estimate(len(dfX))
+            sparse = csr_ok and (args.sparse == "on" or est["nnz"] <= SPARSE_AUTO_DENSITY * len(dfX) * est["width"])
+            X = pre.transform(dfX, sparse=sparse)
+            X_feature_names = feat_names
+            print(f"[encode] {pre.describe()} -> {len(dfX)} x {est['width']}: "
+                  f"{'CSR' if sparse else 'dense'} ({est['csr_bytes'] / 1e6:.1f} MB as CSR, "
+                  f"{est['dense_bytes'] / 1e6:.1f} MB dense)", flush=True)
+        elif args.lean:
+            # fit, then transform row blocks in split order into one float32 matrix (shared memory for --cv):
+            # Xtr/Xte below are views of it, no float64 or per-split copies
+            if native_prep and NativePreprocessor.supports(dfX, args.onehot):
+                pre = NativePreprocessor(args.scale, args.impute, args.onehot).fit(dfX)
+            elif _SK_OK:
+                pre = build_preprocessor(dfX, args.scale, args.impute, args.onehot).fit(dfX)
+            else:
+                pre = None
+            order, k_train = (np.arange(len(dfX)), len(dfX)) if args.cv > 1 else \
+                split_order(len(dfX), args.train_pct, split_seed)
+            width = pre.out_dim if isinstance(pre, NativePreprocessor) else \
+                np.asarray(pre.transform(dfX.iloc[:1]) if pre is not None else dfX.iloc[:1]).shape[1]
+            if args.cv > 1:
+                import crossval
+                X = crossval.SharedArray.empty((len(dfX), width), np.float32)
+                out = X.array
+            else:
+                X = out = np.empty((len(dfX), width), dtype=np.float32)
+            if isinstance(pre, NativePreprocessor):
+                pre.transform(dfX, out=out, rows=order)
+            else:
+                for b in range(0, len(order), 65536):
+                    part = dfX.iloc[order[b:b + 65536]]
+                    out[b:b + len(part)] = pre.transform(part) if pre is not None else part.to_numpy(np.float32)
+            X_feature_names = feat_names
+        elif native_prep and NativePreprocessor.supports(dfX, args.onehot):
+            pre = NativePreprocessor(args.scale, args.impute, args.onehot)
+            X = pre.fit_transform(dfX)
+            X_feature_names = feat_names
+        elif _SK_OK:
+            pre = build_preprocessor(dfX, args.scale, args.impute, args.onehot)
+            X = np.asarray(pre.fit_transform(dfX), dtype=np.float32)
+            X_feature_names = feat_names  # after onehot we lose names; keep originals for labels
+        else:
+            X = dfX.to_numpy(dtype=np.float32)
+            X_feature_names = feat_names
+
+        Y = dfY.to_numpy()
+        if order is not None:
+            Y = Y[order]
+        if args.lean:
+            del dfX, dfY   # X (and Y) hold everything from here on
+        mem.stage("preprocess")
+        # decide multilabel: multiple y columns and all values in {0,1}
+        is_multilabel = (Y.ndim == 2 and Y.shape[1] > 1 and set(np.unique(Y[~np.isnan(Y)])).issubset({0,1}))
+
+        if args.cv > 1:  # k-fold: every fold reads this one preprocessed matrix
+            run_cv(args, hp, X, Y, (native_mlp, native_tree, native_knn))
+            return
 
-    Y = dfY.to_numpy()
-    # decide multilabel: multiple y columns and all values in {0,1}
-    is_multilabel = (Y.ndim == 2 and Y.shape[1] > 1 and set(np.unique(Y[~np.isnan(Y)])).issubset({0,1}))
+        # Split (--lean: X is already in split order, the halves are views)
+        if order is not None:
+            Xtr, Xte, ytr, yte = X[:k_train], X[k_train:], Y[:k_train], Y[k_train:]
+        else:
+            Xtr, Xte, ytr, yte = train_test_split(X, Y, args.train_pct, seed=split_seed)
+        in_dim = X.shape[1]
+        mem.stage("split")
+
+        if pcache is not None:
+            try:
+                pcache.store(prep_key, pre, {"Xtr": Xtr, "Xte": Xte, "ytr": ytr, "yte": yte},
+                             {"x": feat_names, "y": y_feats, "multilabel": bool(is_multilabel)})
+            except Exception as e:
+                print(f"[cache] preprocessing not stored: {e}", flush=True)
+
+    Xva = yva = None
+    if 0.0 < args.val_frac < 1.0 and len(Xtr) >= 4:
+        # validation rows for model selection (sweep.py): held out of the training rows before any row budget,
+        # so every budget is scored on the same rows; the test split is only reported
+        perm = np.random.default_rng(split_seed + 1).permutation(len(Xtr))
+        nv = min(len(Xtr) - 2, max(1, int(round(len(Xtr) * args.val_frac))))
+        va, tr = np.sort(perm[:nv]), np.sort(perm[nv:])
+        Xva, yva, Xtr, ytr = Xtr[va], ytr[va], Xtr[tr], ytr[tr]
+        print(f"[val] {nv} training rows held out for validation", flush=True)
+
+    if 0.0 < args.train_frac < 1.0:
+        # row budget: a fixed random subset of the training rows (nested across budgets); test rows stay whole
+        keep = np.random.default_rng(split_seed).permutation(len(Xtr))[:max(1, int(round(len(Xtr) * args.train_frac)))]
+        keep.sort()
+        Xtr, ytr = Xtr[keep], ytr[keep]
+        print(f"[budget] training on {len(keep)} rows ({args.train_frac*100:.0f}%)", flush=True)
 
     # Decide task strictly from model (preserves old behavior for torch models).
     torch_cls = {"logreg","mlp_cls"}
@@ -1133,14 +2956,10 @@ def main():
     is_clf_model = args.model in (torch_cls | sk_cls)
 
     # Small debug line (you already had this)
-    print(f"[dbg] task={'clf' if is_clf_model else 'reg'}  dim={X.shape[1]}  x='{args.x}'  y='{args.y}'", flush=True)
-
-    # Split
-    Xtr, Xte, ytr, yte = train_test_split(X, Y, args.train_pct, seed=123)
-    in_dim = X.shape[1]
+    print(f"[dbg] task={'clf' if is_clf_model else 'reg'}  dim={in_dim}  x='{args.x}'  y='{args.y}'", flush=True)
 
     # ---------------------- BUILD / TRAIN ----------------------
-    device = torch.device("cpu")
+    device = torch.device("cpu") if _TORCH_OK else None
     plot_style = args.plot_style
     hist_vals = []         # metric 0..1
     metric_label = ""      # legend
@@ -1161,74 +2980,101 @@ def main():
         print("\n"+out, flush=True)
         return out
 
-    # ---- classical sklearn models ----
-    if args.model in (sk_cls | sk_reg):
+    if native_mlp and is_multilabel:
+        if not _TORCH_OK:
+            raise SystemExit("native MLP has no multilabel output; install torch for multilabel targets")
+        print("[native] multilabel target: using the torch MLP", flush=True)
+        native_mlp = False
+    if native_tree and is_multilabel:
         if not _SK_OK:
+            raise SystemExit("native trees have no multilabel output; install scikit-learn for multilabel targets")
+        print("[native] multilabel target: using the sklearn trees", flush=True)
+        native_tree = False
+    if native_knn and is_multilabel:
+        if not _SK_OK:
+            raise SystemExit("native KNN has no multilabel output; install scikit-learn for multilabel targets")
+        print("[native] multilabel target: using the sklearn KNN", flush=True)
+        native_knn = False
+
+    # ---- classical sklearn models (and the native MLP/trees, which follow the same fit/predict flow) ----
+    if args.model in (sk_cls | sk_reg) or native_mlp:
+        if not _SK_OK and not (native_mlp or native_tree or native_knn):
             raise SystemExit("Requested classical model but scikit-learn is not available.")
 
         # construct model from hp
         m = args.model
-        if m == "dt_cls":
-            base = DecisionTreeClassifier(random_state=int(hp.get("seed", 42)))
-            model = OneVsRestClassifier(base) if is_multilabel else base
-        elif m == "dt_reg":
-            model = DecisionTreeRegressor(random_state=int(hp.get("seed", 42)))
-        elif m == "rf_cls":
-            base = RandomForestClassifier(
-                n_estimators=int(hp.get("n_estimators", 200)),
-                max_depth=hp.get("max_depth", None),
-                random_state=int(hp.get("seed", 42)),
-                n_jobs=-1
-            )
-            model = OneVsRestClassifier(base) if is_multilabel else base
-        elif m == "rf_reg":
-            model = RandomForestRegressor(
-                n_estimators=int(hp.get("n_estimators", 200)),
-                max_depth=hp.get("max_depth", None),
-                random_state=int(hp.get("seed", 42)),
-                n_jobs=-1
-            )
-        elif m == "knn_cls":
-            base = KNeighborsClassifier(n_neighbors=int(hp.get("n_neighbors", 7)))
-            model = OneVsRestClassifier(base) if is_multilabel else base
-        elif m == "knn_reg":
-            model = KNeighborsRegressor(n_neighbors=int(hp.get("n_neighbors", 7)))
-        elif m == "nb_cls":
-            base = GaussianNB()
-            model = OneVsRestClassifier(base) if is_multilabel else base
-        elif m == "nb_reg":
-            model = GaussianNBRegressor(n_bins=int(hp.get("nb_reg_bins", 10)))
-        elif m == "svm_cls":
-            base = SVC(kernel=hp.get("kernel", "rbf"),
-                       C=float(hp.get("C", 1.0)),
-                       gamma=hp.get("gamma", "scale"),
-                       probability=True,
-                       random_state=int(hp.get("seed", 42)))
-            model = OneVsRestClassifier(base) if is_multilabel else base
-        elif m == "svm_reg":
-            model = SVR(kernel=hp.get("kernel", "rbf"),
-                        C=float(hp.get("C", 1.0)),
-                        gamma=hp.get("gamma", "scale"),
-                        epsilon=float(hp.get("epsilon", 0.1)))
-        elif m == "gb_cls":
-            base = GradientBoostingClassifier(random_state=int(hp.get("seed", 42)))
-            model = OneVsRestClassifier(base) if is_multilabel else base
-        elif m == "gb_reg":
-            model = GradientBoostingRegressor(random_state=int(hp.get("seed", 42)))
-        else:
-            raise SystemExit(f"Unknown model {m}")
+        control = fit_progress = None
+        native = native_mlp or native_tree or native_knn
+        staged = m in ("rf_cls", "rf_reg", "gb_cls", "gb_reg") and not is_multilabel
+        early_stop = staged and str(hp.get("early_stopping", "off")).lower() in ("1", "on", "true", "yes")
+        if native or staged:
+            # one "epoch" event per epoch (MLP), per finished tree (native) or per ensemble stage;
+            # stdin commands act in between
+            control = TrainControl(sys.stdin if args.control == "stdin" else None)
+            def fit_progress(it, total, loss, score):
+                _emit(event="epoch", epoch=it, epochs=total, loss=loss, score=score)
+                # no mid-fit snapshot here: the weights live in the native/sklearn fit until it returns
+                return not control.poll(lambda: print("[checkpoint] not supported for this model: "
+                                                      "only the torch loop saves mid-training snapshots", flush=True))
+            _emit(event="begin", task=("classification" if is_clf_model else "regression"),
+                  input_dim=int(in_dim), params=hp, **({"engine": "native"} if native else {}))
+        model, approx_note = make_classical_model(m, hp, Xtr, is_multilabel, args.epochs, native_mlp,
+                                                  native_tree, native_knn, progress=fit_progress)
+        if approx_note:
+            print("[svm] " + approx_note, flush=True)
+
+        # warm start: ensembles with the same settings keep their trees and only add new ones;
+        # the native MLP restarts from the previous weights when the shape still matches
+        src = warm_source("model.pkl") if (m in ("rf_cls", "rf_reg", "gb_cls", "gb_reg") or native_mlp) else None
+        if src is not None:
+            import pickle
+            try:
+                with open(src / "model.pkl", "rb") as f:
+                    prev = pickle.load(f)
+                if native_mlp:
+                    warm = isinstance(prev, NativeMLP) and \
+                        (prev.hidden, prev.layers, prev.activation) == (model.hidden, model.layers, model.activation)
+                    if warm:
+                        model.params_, model.classes_ = prev.params_, prev.classes_
+                elif native_tree:
+                    warm = type(prev) is type(model) and prev.forest_ is not None and \
+                        prev.settings() == model.settings() and prev.stages_() <= model.n_estimators
+                    if warm:
+                        model.forest_, model.classes_ = prev.forest_, prev.classes_
+                else:
+                    same = lambda est: {k: v for k, v in est.get_params().items() if k not in ("n_estimators", "warm_start", "oob_score")}
+                    warm = type(prev) is type(model) and same(prev) == same(model) and prev.n_estimators <= model.n_estimators
+                    if warm:
+                        prev.set_params(warm_start=True, n_estimators=model.n_estimators)
+                        model = prev
+                if warm:
+                    print(f"[cache] warm start from {src.name}", flush=True)
+                    _emit(event="cache", hit=False, warm=True, key=src.name)
+            except Exception as e:
+                print(f"[cache] warm start skipped: {e}", flush=True)
 
         # fit once
         ytr_fit = ytr if is_multilabel else ytr.reshape(-1)
-        model = model.fit(Xtr, ytr_fit)
+        stage_note, finished = "", True
+        if staged and (early_stop or not native_tree):  # native ensembles already report every tree
+            model, finished, stage_note = fit_in_stages(
+                model, Xtr, ytr_fit, is_clf_model, progress=fit_progress, early_stopping=early_stop,
+                validation_fraction=float(hp.get("validation_fraction", 0.1)),
+                n_iter_no_change=int(hp.get("n_iter_no_change", 3)), seed=int(hp.get("seed", 42)))
+        else:
+            model = model.fit(Xtr, ytr_fit)
+        partial = not model.finished_ if native else not finished
+        if partial:
+            print("[control] cancelled: evaluating the partial model (not cached)", flush=True)
         # plots (single frame at the end, to keep changes minimal)
         if args.out_plot:
+            Xp, yp = _plot_rows(Xtr, ytr)
             if is_clf_model:
-                save_plot_classification(Xtr, ytr, model, args.epochs, args.epochs, args.out_plot,
+                save_plot_classification(Xp, yp, model, args.epochs, args.epochs, args.out_plot,
                                          feature_names=X_feature_names, proj=args.proj)
             else:
-                y_for_plot = ytr.astype(float) if ytr.ndim == 1 else ytr[:,0].astype(float)
-                save_plot_regression(Xtr, y_for_plot, model, args.epochs, args.epochs, args.out_plot,
+                y_for_plot = yp.astype(float) if yp.ndim == 1 else yp[:,0].astype(float)
+                save_plot_regression(Xp, y_for_plot, model, args.epochs, args.epochs, args.out_plot,
                                      x_label=(args.x_label or X_feature_names[0] if len(X_feature_names)==1 else "X"),
                                      y_label=(args.y_label or ",".join(y_feats)), proj=args.proj, color_by=args.color_by)
 
@@ -1237,6 +3083,7 @@ def main():
             yhat = np.asarray(model.predict(Xte))
             if is_multilabel:
                 text = print_multilabel_metrics(yte, yhat)
+                final_score = float((yhat == yte).all(axis=1).mean())
             else:
                 # Encode true/pred labels together so plotting/metrics can use numeric indices.
                 y_true_raw = yte.reshape(-1)
@@ -1262,14 +3109,35 @@ def main():
                 print_classification_report(ytrue_idx, ypred_idx, classes, stream=buf)
                 text = buf.getvalue()
                 print("\n"+text, flush=True)
-
-
+                final_score = float((ytrue_idx == ypred_idx).mean())
+        else:
+            pred = np.asarray(model.predict(Xte))
+            r2, mae, mse, rmse = regression_metrics(yte, pred)
+            text = "\n".join([
+                "=== Regression Metrics ===",
+                f"R²  : {r2:.6f}",
+                f"MAE  : {mae:.6f}",
+                f"MSE  : {mse:.6f}",
+                f"RMSE : {rmse:.6f}",
+            ])
+            print("\n" + text, flush=True)
+            final_score = float(r2)
+
+        for note in (approx_note, stage_note):
+            if note:
+                text += "\n\n" + note
         if args.out_metrics:
             tmp = args.out_metrics + ".tmp"
             with open(tmp, "w", encoding="utf-8") as f:
                 f.write(text)
             os.replace(tmp, args.out_metrics)
 
+        val_score = _val_score(model.predict(Xva), yva, is_clf_model) if Xva is not None else None
+        saved = ""
+        if cache is not None and not partial:
+            saved = str(cache.store(cache_key, cache_family, model, text, args.out_plot,
+                                    {"model": args.model, "hparams": hp, "score": final_score, "val_score": val_score}))
+        _emit(event="done", score=final_score, path=saved, **({"val_score": val_score} if val_score is not None else {}))
         return  # classical path ends here
 
     # ---- torch models (kept logic; with small tweaks for multilabel) ----
@@ -1321,123 +3189,120 @@ def main():
             yte_idx, _       = encode_labels(yte, classes)
             ncls = len(classes)
 
-            if args.model == "mlp_cls":
-                hidden  = int(hp.get("hidden", max(8, in_dim * 2)))
-                layers  = int(hp.get("layers", 2))
-                actname = str(hp.get("activation", "relu")).lower()
-                Act = nn.ReLU if actname == "relu" else nn.Tanh
-
-                seq: list[nn.Module] = [nn.Linear(in_dim, hidden), Act()]
-                for _ in range(max(0, layers - 1)):
-                    seq += [nn.Linear(hidden, hidden), Act()]
-                if ncls == 2:
-                    seq += [nn.Linear(hidden, 1)]
-                    loss_fn = nn.BCEWithLogitsLoss()
-                    yt = torch.from_numpy(ytr_idx.astype(np.float32)).view(-1, 1)
-                else:
-                    seq += [nn.Linear(hidden, ncls)]
-                    loss_fn = nn.CrossEntropyLoss()
-                    yt = torch.from_numpy(ytr_idx.astype(np.int64))
-                model = nn.Sequential(*seq).to(device)
-
-                lr = float(hp.get("lr", 5e-2))
-                opt = optim.Adam(model.parameters(), lr=lr)
-
-            else:  # logistic regression
-                C        = float(hp.get("C", 1.0))
-                penalty  = str(hp.get("penalty", "L2")).upper()
-                lr       = float(hp.get("lr", 5e-2))
-                weight_decay = (1.0 / C) if penalty == "L2" else 0.0
-                l1_lambda    = (1.0 / C) if penalty == "L1" else 0.0
-
-                if ncls == 2:
-                    model = nn.Sequential(nn.Linear(in_dim, 1)).to(device)
-                    loss_fn = nn.BCEWithLogitsLoss()
-                    yt = torch.from_numpy(ytr_idx.astype(np.float32)).view(-1, 1)
-                else:
-                    model = nn.Sequential(nn.Linear(in_dim, ncls)).to(device)
-                    loss_fn = nn.CrossEntropyLoss()
-                    yt = torch.from_numpy(ytr_idx.astype(np.int64))
-
-                opt = optim.Adam(model.parameters(), lr=lr, weight_decay=weight_decay)
+            model, loss_fn, opt, l1_lambda = build_torch_model(args.model, in_dim, ncls, hp)
+            if isinstance(loss_fn, nn.CrossEntropyLoss):
+                yt = torch.from_numpy(ytr_idx.astype(np.int64))
+            else:
+                yt = torch.from_numpy(ytr_idx.astype(np.float32)).view(-1, 1)
 
     else:
         # regression (kept)
-        if args.model == "mlp_reg":
-            hidden  = int(hp.get("hidden", max(16, in_dim * 2)))
-            layers  = int(hp.get("layers", 2))
-            actname = str(hp.get("activation", "relu")).lower()
-            Act = nn.ReLU if actname == "relu" else nn.Tanh
-            seq: list[nn.Module] = [nn.Linear(in_dim, hidden), Act()]
-            for _ in range(max(0, layers - 1)):
-                seq += [nn.Linear(hidden, hidden), Act()]
-            seq += [nn.Linear(hidden, 1)]
-            model = nn.Sequential(*seq).to(device)
-            loss_fn = nn.MSELoss()
-            lr = float(hp.get("lr", 5e-3))
-            opt = optim.Adam(model.parameters(), lr=lr)
-            yt = torch.from_numpy(ytr.astype(np.float32)).view(-1, 1)
-        else:
-            model = nn.Sequential(nn.Linear(in_dim, 1)).to(device)
-            loss_fn = nn.MSELoss()
-            alpha    = float(hp.get("alpha", 1e-2))
-            lr       = float(hp.get("lr", 5e-2))
-            weight_decay = alpha if args.model == "ridge" else 0.0
-            l1_lambda   = alpha if args.model == "lasso" else 0.0
-            opt = optim.Adam(model.parameters(), lr=lr, weight_decay=weight_decay)
-            yt = torch.from_numpy(ytr.astype(np.float32)).view(-1, 1)
+        model, loss_fn, opt, l1_lambda = build_torch_model(args.model, in_dim, 0, hp)
+        yt = torch.from_numpy(ytr.astype(np.float32)).view(-1, 1)
 
     Xt = torch.from_numpy(Xtr).float()
 
+    # warm start: same data/features/preprocessing/model -> start from the newest weights
+    src = warm_source("model.pt")
+    if src is not None:
+        try:
+            model.load_state_dict(torch.load(src / "model.pt", map_location="cpu")["state_dict"])
+            print(f"[cache] warm start from {src.name}", flush=True)
+            _emit(event="cache", hit=False, warm=True, key=src.name)
+        except Exception as e:
+            print(f"[cache] warm start skipped (different architecture?): {e}", flush=True)
+
     # ----------------------------- TRAIN (torch) -------------------------------
-    for epoch in range(1, args.epochs+1):
-        opt.zero_grad()
-        out = model(Xt)
-        if is_clf_model and isinstance(loss_fn, nn.CrossEntropyLoss):
-            loss = loss_fn(out, yt)
-        else:
-            loss = loss_fn(out, yt)
+    pacer = FramePacer(args.frame_interval, args.frame_budget, args.frame_every)
+    control = TrainControl(sys.stdin if args.control == "stdin" else None)
+    ckpt_path = Path(args.checkpoint) if args.checkpoint else CKPT_PATH / f"{run_key}.pt"
+    done_epoch = 0
+    def snapshot() -> None:
+        save_checkpoint(ckpt_path, model, opt, done_epoch, hist_vals=hist_vals, model_name=args.model)
+        print(f"[checkpoint] epoch {done_epoch} -> {ckpt_path}", flush=True)
+        _emit(event="checkpoint", epoch=done_epoch, path=str(ckpt_path))
+
+    if args.resume and ckpt_path.exists():
+        try:
+            state = load_checkpoint(ckpt_path, model, opt)
+            done_epoch = int(state["epoch"])
+            hist_vals[:] = list(state.get("hist_vals", []))
+            print(f"[checkpoint] resumed at epoch {done_epoch} from {ckpt_path}", flush=True)
+            _emit(event="control", state="resumed", epoch=done_epoch)
+        except Exception as e:
+            print(f"[checkpoint] cannot resume ({e}); starting over", flush=True)
+            done_epoch = 0
+
+    # ---- steps (parallel.EpochRunner): full batch by default, hp batch_size > 0 -> shuffled minibatches;
+    # the epoch metric comes from the training forward pass. --workers N: data-parallel over N processes ----
+    import parallel
+    n_rows = int(Xt.shape[0])
+    bs = int(hp.get("batch_size", 0) or 0)
+    if (not is_clf_model) and args.model == "lasso":
+        l1_w = float(hp.get("l1_lambda", l1_lambda))
+    elif is_clf_model and args.model == "logreg":
+        l1_w = float(hp.get("l1_lambda", 0.0))
+    else:
+        l1_w = 0.0
+    task = "reg" if not is_clf_model else ("ce" if isinstance(loss_fn, nn.CrossEntropyLoss) else "bin")
+    if is_clf_model:
+        metric_den = float(yt.numel())   # multilabel: per-label accuracy (proxy)
+    else:
+        ss_tot = float(((yt - yt.mean()) ** 2).sum()) or 1.0   # the targets don't change between epochs
+
+    world = max(1, min(int(args.workers), n_rows))
+    if world > 1 and not torch.distributed.is_available():
+        print("[dp] this torch build has no torch.distributed; training in one process", flush=True)
+        world = 1
+    runner = parallel.EpochRunner(model, opt, loss_fn, Xt, yt, bs, l1_w, task, split_seed, 0, world)
+    group, t_single = None, 0.0
+    if world > 1:
+        cores = N_JOBS if N_JOBS > 0 else (os.cpu_count() or 1)
+        threads = max(1, cores // world)
+        t_single = runner.probe()   # one global batch in this process with every core: the scaling baseline
+        torch.set_num_threads(threads)
+        group = parallel.Group(world, threads, model, opt, loss_fn, Xt, yt, bs, l1_w, task, split_seed)
+        print(f"[dp] {world} workers x {threads} thread(s), gloo on localhost, "
+              f"{runner.steps} step(s)/epoch of {runner.bs} rows", flush=True)
+
+    rows_seen, t_steps = 0, 0.0
+    _emit(event="begin", task=("classification" if is_clf_model else "regression"), input_dim=int(in_dim), params=hp)
+    for epoch in range(done_epoch + 1, args.epochs+1):
+        # control commands land between epochs (full batch: between optimizer steps)
+        if not control.poll(snapshot):
+            if group is not None:
+                group.stop()
+            snapshot()
+            _emit(event="control", state="cancelled", epoch=done_epoch)
+            print(f"[control] cancelled after epoch {done_epoch}; rerun with --resume to continue", flush=True)
+            return
+        t_epoch = time.perf_counter()
+        if group is not None:
+            group.go()
+        hits, loss_sum = runner.epoch()
+        epoch_loss = loss_sum / n_rows
+        secs = time.perf_counter() - t_epoch
+        rows_seen += n_rows; t_steps += secs
+        if group is not None and epoch == done_epoch + 1:
+            print(f"[dp] first epoch: {n_rows / max(secs, 1e-9):,.0f} rows/s, "
+                  f"{parallel.scaling(t_single, secs / runner.steps, world)}", flush=True)
 
-        # L1 for lasso/logreg (kept)
-        if (not is_clf_model) and args.model == "lasso":
-            l1 = sum(p.abs().sum() for p in model.parameters())
-            loss = loss + float(hp.get("l1_lambda", l1_lambda if 'l1_lambda' in locals() else 0.0)) * l1
-        if is_clf_model and args.model == "logreg" and float(hp.get("l1_lambda", 0.0)) > 0.0:
-            l1 = sum(p.abs().sum() for p in model.parameters())
-            loss = loss + float(hp["l1_lambda"]) * l1
+        # metric 0..1 for retro95 top monitor
+        if is_clf_model:
+            acc = hits / metric_den
+            hist_vals.append(acc)
+            metric_label = (f"Training multilabel (proxy acc): {acc*100:.1f}%" if is_multilabel
+                            else f"Training accuracy: {acc*100:.1f}%")
+        else:
+            r2 = max(0.0, min(1.0, 1.0 - hits / ss_tot))
+            hist_vals.append(r2)
+            metric_label = f"Training R²: {r2*100:.1f}%"
 
-        loss.backward(); opt.step()
+        pacer.add_train(time.perf_counter() - t_epoch)
 
-        # metric 0..1 for retro95 top monitor
-        with torch.no_grad():
-            if is_clf_model:
-                logits_tr = model(Xt)
-                if is_multilabel:
-                    yhat = (logits_tr >= 0.0).float()
-                    # micro-F1-ish proxy: exact match isn't great; use mean per-label acc as proxy
-                    acc = float((yhat.round() == yt).float().mean().cpu().item())
-                    hist_vals.append(acc)
-                    metric_label = f"Training multilabel (proxy acc): {acc*100:.1f}%"
-                else:
-                    if logits_tr.dim()==2 and logits_tr.shape[1]>1:
-                        yhat_idx_tr = torch.argmax(logits_tr, dim=1).cpu().numpy()
-                    else:
-                        yhat_idx_tr = (torch.sigmoid(logits_tr.view(-1))>=0.5).cpu().numpy().astype(int)
-                    ytrue_idx_tr = (yt if isinstance(loss_fn, nn.CrossEntropyLoss) else yt.view(-1)).cpu().numpy().astype(int)
-                    acc_tr = float((yhat_idx_tr == ytrue_idx_tr).mean())
-                    hist_vals.append(acc_tr)
-                    metric_label = f"Training accuracy: {acc_tr*100:.1f}%"
-            else:
-                yhat_tr = model(Xt).cpu().numpy().reshape(-1)
-                ytrue_tr = yt.view(-1).cpu().numpy().astype(float)
-                ss_res = float(np.sum((ytrue_tr - yhat_tr)**2))
-                ss_tot = float(np.sum((ytrue_tr - ytrue_tr.mean())**2)) or 1.0
-                r2 = max(0.0, min(1.0, 1.0 - ss_res/ss_tot))
-                hist_vals.append(r2)
-                metric_label = f"Training R²: {r2*100:.1f}%"
-
-        # render frames
-        if args.out_plot and (epoch % max(1, args.frame_every) == 0 or epoch == args.epochs):
+        # render frames (time-budgeted, see FramePacer)
+        if args.out_plot and pacer.due(epoch, args.epochs):
+            t_frame = time.perf_counter()
             if plot_style == "retro95":
                 y_plot = (ytr if not is_clf_model else (ytr if is_multilabel else encode_labels(ytr)[0]))  # type: ignore
                 save_plot_combo_retro95(
@@ -1459,8 +3324,26 @@ def main():
                         Xtr, ytr.astype(float), model, epoch, args.epochs, args.out_plot,
                         x_label=(args.x_label or X_feature_names[0] if len(X_feature_names)==1 else "X"),
                         y_label=(args.y_label or ",".join(y_feats)), proj=args.proj, color_by=args.color_by)
-
-        print(f"epoch {epoch}/{args.epochs}  loss={loss.item():.6f}", flush=True)
+            pacer.rendered(epoch, time.perf_counter() - t_frame)
+            _emit(event="cadence", epoch=epoch, **pacer.report(epoch))
+
+        _emit(event="epoch", epoch=epoch, epochs=args.epochs, loss=epoch_loss, score=float(hist_vals[-1]),
+              rows_per_s=round(n_rows / max(secs, 1e-9)))
+        done_epoch = epoch
+
+    if ckpt_path.exists():
+        ckpt_path.unlink()  # finished: the stored model supersedes the snapshot
+    if group is not None:
+        group.stop()
+    if rows_seen:
+        print(f"[throughput] {rows_seen / max(t_steps, 1e-9):,.0f} rows/s over {rows_seen // n_rows} epochs "
+              f"({'full batch' if runner.bs == n_rows else f'batch {runner.bs}'}, {n_rows} rows)", flush=True)
+        if group is not None:
+            print(f"[dp] {world} workers: {parallel.scaling(t_single, t_steps / (rows_seen // n_rows) / runner.steps, world)}",
+                  flush=True)
+    cad = pacer.report(args.epochs)
+    print(f"[frames] {cad['frames']} frames, 1 every {cad['epochs_per_frame']:.1f} epochs "
+          f"({cad['seconds_per_frame']:.2f}s), render {cad['render_share']*100:.1f}% of time", flush=True)
 
     # ------------------------ TEST + METRICS (torch) ---------------------------
     model.eval()
@@ -1472,6 +3355,7 @@ def main():
                 yhat = (prob >= 0.5).astype(int)
                 text = "=== Multilabel Metrics (proxy) ===\n" + \
                        f"Exact-match accuracy: {float((yhat==yte).all(axis=1).mean()):.6f}"
+                final_score = float((yhat == yte).all(axis=1).mean())
                 print("\n"+text, flush=True)
             else:
                 if logits_te.dim() == 2 and logits_te.shape[1] > 1:
@@ -1492,8 +3376,10 @@ def main():
         print_classification_report(yte_idx, yhat_idx, classes, stream=buf)
         text = buf.getvalue()
         print("\n" + text, flush=True)
+        final_score = float((yte_idx == yhat_idx).mean())
     elif not is_clf_model:
         r2, mae, mse, rmse = regression_metrics(yte, pred)
+        final_score = float(r2)
         text = "\n".join([
             "=== Regression Metrics ===",
             f"R²  : {r2:.6f}",
@@ -1509,6 +3395,25 @@ def main():
             f.write(text)
         os.replace(tmp, args.out_metrics)
 
+    val_score = None
+    if Xva is not None:
+        with torch.no_grad():
+            out = model(torch.from_numpy(np.asarray(Xva)).float())
+        if not is_clf_model:
+            yv_hat = out.cpu().numpy().squeeze()
+        elif is_multilabel:
+            yv_hat = (torch.sigmoid(out).cpu().numpy() >= 0.5).astype(int)
+        else:
+            idx = out.argmax(dim=1) if (out.dim() == 2 and out.shape[1] > 1) else (out.view(-1) >= 0.0).long()
+            yv_hat = encode_labels(ytr)[1][idx.cpu().numpy()]   # back to the label strings
+        val_score = _val_score(yv_hat, yva, is_clf_model)
+
+    saved = ""
+    if cache is not None:
+        saved = str(cache.store(cache_key, cache_family, model, text, args.out_plot,
+                                {"model": args.model, "hparams": hp, "score": final_score, "val_score": val_score}))
+    _emit(event="done", score=final_score, path=saved, **({"val_score": val_score} if val_score is not None else {}))
+
 
 if __name__ == "__main__":
     main()
\ No newline at end of file
@@ -0,0 +1,207 @@
+# python/models/parallel.py
+"""
+Training steps for the torch models, single process or data-parallel
+(`models.py --workers N`): N local processes joined over gloo on localhost.
+The caller is rank 0 and keeps frames, the control channel and checkpoints;
+ranks 1..N-1 run worker() here. Every rank draws the same shuffled global
+batches and trains on its own slice of each; one all-reduce per step over a
+flat gradient buffer gives every replica the same update, so the weights
+never drift apart.
+"""
+from __future__ import annotations
+from typing import Any, Dict, List, Tuple
+import datetime, socket, time
+import multiprocessing as mp
+import numpy as np
+import torch
+import torch.distributed as dist
+
+TIMEOUT = datetime.timedelta(hours=12)   # a paused run keeps the helpers waiting on the next broadcast
+
+
+class EpochRunner:
+    """
+    One epoch of optimizer steps, with the epoch metric accumulated from each
+    step's own forward pass (torch scalars, read once per epoch). bs >= n is the
+    full-batch step; smaller bs trains shuffled minibatches gathered into a
+    preallocated buffer. task: "reg" (squared error), "ce" (class index) or
+    "bin" (one logit per label).
+    """
+    def __init__(self, model, opt, loss_fn, Xt, yt, bs: int, l1_w: float, task: str, seed: int,
+                 rank: int = 0, world: int = 1):
+        self.model, self.opt, self.loss_fn = model, opt, loss_fn
+        self.Xt, self.yt = Xt, yt
+        self.n = int(Xt.shape[0])
+        self.bs = self.n if bs <= 0 or bs >= self.n else int(bs)
+        self.l1_w, self.task = float(l1_w), task
+        self.rank, self.world = rank, world
+        self.gen = torch.Generator().manual_seed(seed)   # same seed on every rank -> same batches
+        if self.bs < self.n:
+            local = -(-self.bs // world)   # largest slice of a global batch one rank gets
+            self.xb = torch.empty((local,) + tuple(Xt.shape[1:]), dtype=Xt.dtype)
+            self.yb = torch.empty((local,) + tuple(yt.shape[1:]), dtype=yt.dtype)
+        if world > 1:
+            self.params = [p for p in model.parameters() if p.requires_grad]
+            self.flat = torch.zeros(sum(p.numel() for p in self.params), dtype=torch.float32)
+
+    @property
+    def steps(self) -> int:
+        return -(-self.n // self.bs)
+
+    def _allreduce(self) -> None:
+        """Sum of the (already weighted) gradients of every rank, in one collective."""
+        off = 0
+        for p in self.params:
+            k = p.numel()
+            if p.grad is None:
+                self.flat[off:off + k].zero_()
+            else:
+                self.flat[off:off + k].copy_(p.grad.reshape(-1))
+            off += k
+        dist.all_reduce(self.flat)
+        off = 0
+        for p in self.params:
+            k = p.numel()
+            g = self.flat[off:off + k].view_as(p)
+            if p.grad is None:
+                p.grad = g.clone()
+            else:
+                p.grad.copy_(g)
+            off += k
+
+    def _step(self, xs, ys, batch: int, hits, loss_sum) -> None:
+        m = int(xs.shape[0])
+        self.opt.zero_grad()
+        if m:
+            out = self.model(xs)
+            loss = self.loss_fn(out, ys)
+            if self.l1_w > 0.0:   # L1 for lasso/logreg
+                loss = loss + self.l1_w * sum(p.abs().sum() for p in self.model.parameters())
+            # each rank's mean loss weighted by its share of the global batch: the summed gradients are the global mean
+            (loss * (m / batch) if self.world > 1 else loss).backward()
+            with torch.no_grad():
+                o = out.detach()
+                if self.task == "reg":
+                    hits += ((o - ys) ** 2).sum()   # squared error; R² at the end of the epoch
+                elif self.task == "ce":
+                    hits += (o.argmax(dim=1) == ys).sum()
+                else:
+                    hits += ((o >= 0.0) == (ys >= 0.5)).sum()   # logit >= 0 <=> sigmoid >= 0.5
+                loss_sum += loss.detach() * m
+        if self.world > 1:
+            self._allreduce()
+        self.opt.step()
+
+    def epoch(self) -> Tuple[float, float]:
+        """(hits or squared error, loss x rows) summed over the epoch and over every rank."""
+        hits = torch.zeros((), dtype=torch.float64)
+        loss_sum = torch.zeros((), dtype=torch.float64)
+        if self.bs == self.n and self.world == 1:
+            self._step(self.Xt, self.yt, self.n, hits, loss_sum)
+        else:
+            perm = torch.randperm(self.n, generator=self.gen) if self.bs < self.n else None
+            for b in range(0, self.n, self.bs):
+                B = min(self.bs, self.n - b)
+                lo, hi = b + B * self.rank // self.world, b + B * (self.rank + 1) // self.world
+                if perm is None:   # full batch split across ranks: contiguous views, no gather
+                    xs, ys = self.Xt[lo:hi], self.yt[lo:hi]
+                else:
+                    idx, m = perm[lo:hi], hi - lo
+                    xs, ys = self.xb[:m], self.yb[:m]
+                    torch.index_select(self.Xt, 0, idx, out=xs)
+                    torch.index_select(self.yt, 0, idx, out=ys)
+                self._step(xs, ys, B, hits, loss_sum)
+        if self.world > 1:
+            tot = torch.stack([hits, loss_sum])
+            dist.all_reduce(tot)
+            hits, loss_sum = tot[0], tot[1]
+        return float(hits), float(loss_sum)
+
+    def probe(self, reps: int = 3) -> float:
+        """Seconds for forward + backward over one global batch in this process alone (no update)."""
+        xs, ys = self.Xt[:self.bs], self.yt[:self.bs]
+        best = float("inf")
+        for _ in range(reps):
+            t0 = time.perf_counter()
+            self.opt.zero_grad()
+            self.loss_fn(self.model(xs), ys).backward()
+            best = min(best, time.perf_counter() - t0)
+        self.opt.zero_grad()
+        return best
+
+
+def _free_port() -> int:
+    with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as s:
+        s.bind(("127.0.0.1", 0))
+        return s.getsockname()[1]
+
+
+def worker(rank: int, world: int, addr: str, job: Dict[str, Any]) -> None:
+    """Ranks 1..N-1: the same steps as rank 0 on its own slices, one epoch per go from rank 0."""
+    from crossval import SharedArray
+    torch.set_num_threads(job["threads"])
+    dist.init_process_group("gloo", init_method=addr, rank=rank, world_size=world, timeout=TIMEOUT)
+    shm_x, X = SharedArray.attach(job["X"])
+    shm_y, y = SharedArray.attach(job["y"])
+    model = job["model"]
+    opt = job["opt_cls"](model.parameters(), **job["opt_defaults"])
+    opt.load_state_dict(job["opt_state"])
+    runner = EpochRunner(model, opt, job["loss_fn"], torch.from_numpy(X), torch.from_numpy(y), job["bs"],
+                         job["l1_w"], job["task"], job["seed"], rank, world)
+    flag = torch.zeros(1, dtype=torch.int64)
+    try:
+        while True:
+            dist.broadcast(flag, 0)
+            if int(flag[0]) == 0:
+                break
+            runner.epoch()
+    finally:
+        del runner, X, y
+        shm_x.close(); shm_y.close()
+        dist.destroy_process_group()
+
+
+class Group:
+    """
+    Rank 0's side: copies X/y into shared memory, spawns the other ranks with
+    the model, optimizer state and loss, then go() before each epoch and stop()
+    at the end (or on cancel).
+    """
+    def __init__(self, world: int, threads: int, model, opt, loss_fn, Xt, yt, bs: int, l1_w: float,
+                 task: str, seed: int):
+        from crossval import SharedArray
+        self.world = world
+        self.sx, self.sy = SharedArray(Xt.numpy()), SharedArray(yt.numpy())
+        addr = f"tcp://127.0.0.1:{_free_port()}"
+        job = {"X": self.sx.handle, "y": self.sy.handle, "model": model, "opt_cls": type(opt),
+               "opt_defaults": dict(opt.defaults), "opt_state": opt.state_dict(), "loss_fn": loss_fn,
+               "bs": bs, "l1_w": l1_w, "task": task, "seed": seed, "threads": threads}
+        ctx = mp.get_context("spawn")   # no fork after torch started its thread pools
+        self.procs: List[Any] = [ctx.Process(target=worker, args=(r, world, addr, job), daemon=True)
+                                 for r in range(1, world)]
+        for p in self.procs:
+            p.start()
+        dist.init_process_group("gloo", init_method=addr, rank=0, world_size=world, timeout=TIMEOUT)
+        self.flag = torch.zeros(1, dtype=torch.int64)
+
+    def go(self) -> None:
+        self.flag[0] = 1
+        dist.broadcast(self.flag, 0)
+
+    def stop(self) -> None:
+        self.flag[0] = 0
+        try:
+            dist.broadcast(self.flag, 0)
+            dist.destroy_process_group()
+        finally:
+            for p in self.procs:
+                p.join(timeout=10)
+                if p.is_alive():
+                    p.terminate()
+            self.sx.release(); self.sy.release()
+
+
+def scaling(t_single: float, t_step: float, world: int) -> str:
+    """Log text: speedup of one data-parallel step over the single-process probe, and efficiency = speedup / N."""
+    speedup = t_single / max(t_step, 1e-12)
+    return f"speedup {speedup:.2f}x over 1 process, scaling efficiency {speedup / world * 100:.0f}%"
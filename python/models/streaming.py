@@ -0,0 +1,218 @@
+# python/models/streaming.py
+"""
+Out-of-core pieces for `models.py --stream`: chunked CSV/Parquet reads, a
+preprocessor fitted one chunk at a time, a per-row train/test split that needs
+no shuffle of the whole file, and metric accumulators. Memory depends on the
+chunk size and the sample caps below, never on the number of rows.
+"""
+from __future__ import annotations
+from typing import Any, Dict, Iterator, List, Optional
+import numpy as np
+import pandas as pd
+
+STREAM_CHUNK_ROWS = 65536    # rows per chunk read from disk
+QUANTILE_SAMPLE   = 20000    # reservoir per column for median / most_frequent
+MAX_CATEGORIES    = 256      # one-hot columns kept per categorical feature
+PLOT_SAMPLE       = 4000     # training rows kept for the plot frames
+
+
+def read_columns(path: str) -> List[str]:
+    if str(path).lower().endswith((".parquet", ".pq")):
+        import pyarrow.parquet as pq
+        return list(pq.ParquetFile(path).schema_arrow.names)
+    return list(pd.read_csv(path, nrows=0).columns)
+
+
+def iter_chunks(path: str, columns: List[str], chunk_rows: int = STREAM_CHUNK_ROWS) -> Iterator[pd.DataFrame]:
+    """Yields DataFrames of at most `chunk_rows` rows holding only `columns`."""
+    chunk_rows = max(1, int(chunk_rows))
+    if str(path).lower().endswith((".parquet", ".pq")):
+        import pyarrow.parquet as pq
+        for batch in pq.ParquetFile(path).iter_batches(batch_size=chunk_rows, columns=columns):
+            yield batch.to_pandas()
+        return
+    for chunk in pd.read_csv(path, usecols=columns, chunksize=chunk_rows):
+        yield chunk[columns]
+
+
+def train_mask(start: int, n: int, train_pct: float, seed: int) -> np.ndarray:
+    """Deterministic split by global row number: the same row lands on the same side every pass."""
+    with np.errstate(over="ignore"):
+        h = (np.arange(start, start + n, dtype=np.uint64) + np.uint64(seed)) * np.uint64(0x9E3779B97F4A7C15)
+        h ^= h >> np.uint64(29)
+        h *= np.uint64(0xBF58476D1CE4E5B9)
+        h ^= h >> np.uint64(32)
+    return (h >> np.uint64(11)).astype(np.float64) * (1.0 / 9007199254740992.0) < float(train_pct)
+
+
+class Reservoir:
+    """Uniform sample of fixed size over a stream (algorithm R, one chunk at a time)."""
+    def __init__(self, cap: int, seed: int = 0):
+        self.cap = int(cap); self.seen = 0
+        self.rng = np.random.default_rng(seed)
+        self.items: Optional[np.ndarray] = None
+
+    def add(self, a: np.ndarray) -> None:
+        a = np.asarray(a)
+        if a.shape[0] == 0: return
+        if self.items is None:
+            self.items = np.empty((self.cap,) + a.shape[1:], dtype=a.dtype)
+        k = max(0, min(self.cap - self.seen, a.shape[0]))
+        self.items[self.seen:self.seen + k] = a[:k]
+        rest = a[k:]
+        if rest.shape[0]:
+            pos = self.rng.integers(0, self.seen + k + np.arange(rest.shape[0]) + 1)
+            hit = pos < self.cap
+            self.items[pos[hit]] = rest[hit]
+        self.seen += a.shape[0]
+
+    def sample(self) -> np.ndarray:
+        return self.items[:min(self.cap, self.seen)] if self.items is not None else np.empty((0,))
+
+
+class StreamingPreprocessor:
+    """
+    Same treatment as build_preprocessor (impute -> scale numeric, impute -> one-hot
+    categorical, numeric columns first), fitted by partial_fit over chunks:
+    running mean/var (Chan's merge), min/max, reservoir quantiles for the
+    median/most_frequent imputers and capped category counts. With buckets > 0
+    the categories are hashed into that many shared columns (encoding.py)
+    instead of keeping the MAX_CATEGORIES most frequent ones.
+    """
+    def __init__(self, scale: str, impute: str, onehot: bool, seed: int = 0, buckets: int = 0):
+        self.scale, self.impute, self.onehot, self.seed = scale, impute, bool(onehot), seed
+        self.buckets = max(0, int(buckets))
+        self.num_cols: Optional[List[str]] = None
+        self.cat_cols: List[str] = []
+        self.rows = 0
+
+    def _start(self, dfX: pd.DataFrame) -> None:
+        self.num_cols = [c for c in dfX.columns if pd.api.types.is_numeric_dtype(dfX[c])]
+        self.cat_cols = [c for c in dfX.columns if c not in self.num_cols]
+        if self.cat_cols and not self.onehot:
+            raise SystemExit(f"--stream: categorical columns {self.cat_cols} need --onehot")
+        d = len(self.num_cols)
+        self.count = np.zeros(d); self.mean = np.zeros(d); self.m2 = np.zeros(d)
+        self.lo = np.full(d, np.inf); self.hi = np.full(d, -np.inf)
+        self.res = [Reservoir(QUANTILE_SAMPLE, self.seed + j) for j in range(d)] \
+            if self.impute in ("median", "most_frequent") else []
+        self.counts: List[Dict[str, int]] = [dict() for _ in self.cat_cols]
+
+    def partial_fit(self, dfX: pd.DataFrame) -> "StreamingPreprocessor":
+        if self.num_cols is None:
+            self._start(dfX)
+        self.rows += len(dfX)
+        if self.num_cols:
+            V = dfX[self.num_cols].to_numpy(dtype=np.float64, na_value=np.nan)
+            ok = ~np.isnan(V)
+            nb = ok.sum(axis=0).astype(np.float64)
+            Z = np.where(ok, V, 0.0)
+            mb = Z.sum(axis=0) / np.maximum(nb, 1)
+            m2b = (np.where(ok, V - mb, 0.0) ** 2).sum(axis=0)
+            n = self.count + nb
+            delta = mb - self.mean
+            self.mean = self.mean + delta * nb / np.maximum(n, 1)
+            self.m2 = self.m2 + m2b + delta ** 2 * self.count * nb / np.maximum(n, 1)
+            self.count = n
+            self.lo = np.minimum(self.lo, np.where(ok, V, np.inf).min(axis=0))
+            self.hi = np.maximum(self.hi, np.where(ok, V, -np.inf).max(axis=0))
+            for j, r in enumerate(self.res):
+                r.add(V[ok[:, j], j])
+        for j, c in enumerate(self.cat_cols):
+            fill = "" if self.impute == "zero" else None
+            vc = dfX[c].astype(object).where(dfX[c].notna(), fill).dropna().astype(str).value_counts()
+            cnt = self.counts[j]
+            for k, v in vc.items():
+                cnt[k] = cnt.get(k, 0) + int(v)
+            if len(cnt) > 64 * MAX_CATEGORIES:   # high cardinality: keep the heavy hitters only
+                keep = sorted(cnt.items(), key=lambda kv: -kv[1])[:8 * MAX_CATEGORIES]
+                self.counts[j] = dict(keep)
+        return self
+
+    def finalize(self) -> "StreamingPreprocessor":
+        d = len(self.num_cols or [])
+        fill = np.zeros(d)
+        for j in range(d):
+            if self.impute == "mean":
+                fill[j] = self.mean[j]
+            elif self.impute in ("median", "most_frequent") and self.res[j].seen:
+                s = self.res[j].sample()
+                if self.impute == "median":
+                    fill[j] = float(np.median(s))
+                else:
+                    u, k = np.unique(s, return_counts=True); fill[j] = float(u[np.argmax(k)])
+        # statistics after imputation: the missing rows count as copies of the fill value
+        miss = self.rows - self.count
+        n = np.maximum(self.count + miss, 1)
+        delta = fill - self.mean
+        mean = self.mean + delta * miss / n
+        var = (self.m2 + delta ** 2 * self.count * miss / n) / n
+        lo = np.where(miss > 0, np.minimum(self.lo, fill), self.lo)
+        hi = np.where(miss > 0, np.maximum(self.hi, fill), self.hi)
+        self.fill_ = fill
+        if self.scale == "standard":
+            std = np.sqrt(var)
+            self.shift_, self.div_ = mean, np.where(std > 0, std, 1.0)
+        elif self.scale == "minmax":
+            rng = hi - lo
+            self.shift_, self.div_ = np.where(np.isfinite(lo), lo, 0.0), np.where(rng > 0, rng, 1.0)
+        else:
+            self.shift_, self.div_ = np.zeros(d), np.ones(d)
+        self.categories_ = []
+        for cnt in self.counts:
+            top = sorted(cnt.items(), key=lambda kv: -kv[1])[:MAX_CATEGORIES]
+            self.categories_.append(sorted(k for k, _ in top))
+        self.cat_fill_ = [("" if self.impute == "zero" else (max(cnt, key=cnt.get) if cnt else ""))
+                          for cnt in self.counts]
+        self.out_dim = d + (self.buckets if self.buckets and self.cat_cols else sum(len(c) for c in self.categories_))
+        return self
+
+    def transform(self, dfX: pd.DataFrame) -> np.ndarray:
+        out = np.zeros((len(dfX), self.out_dim), dtype=np.float32)
+        d = len(self.num_cols)
+        if d:
+            V = dfX[self.num_cols].to_numpy(dtype=np.float64, na_value=np.nan)
+            V = np.where(np.isnan(V), self.fill_, V)
+            out[:, :d] = (V - self.shift_) / self.div_
+        col = d
+        for j, c in enumerate(self.cat_cols):
+            if self.buckets:
+                from encoding import hash_buckets
+                codes, uniques = pd.factorize(dfX[c].astype(object).where(dfX[c].notna(), self.cat_fill_[j]).astype(str))
+                out[np.arange(len(dfX)), col + hash_buckets(c, uniques, self.buckets)[codes]] += 1.0
+                continue
+            cats = self.categories_[j]
+            s = dfX[c].astype(object).where(dfX[c].notna(), self.cat_fill_[j]).astype(str).to_numpy()
+            idx = np.searchsorted(cats, s)
+            idx = np.minimum(idx, len(cats) - 1)
+            hit = np.asarray(cats, dtype=object)[idx] == s   # unknown categories -> all zeros
+            out[np.nonzero(hit)[0], col + idx[hit]] = 1.0
+            col += len(cats)
+        return out
+
+
+class StreamMetrics:
+    """Test metrics accumulated chunk by chunk: a confusion matrix or the regression sums."""
+    def __init__(self, n_classes: int = 0):
+        self.k = int(n_classes)
+        self.cm = np.zeros((self.k, self.k), dtype=np.int64) if self.k else None
+        self.n = 0; self.sy = self.syy = self.sse = self.sae = 0.0
+
+    def update(self, y_true: np.ndarray, y_pred: np.ndarray) -> None:
+        y_true = np.asarray(y_true).reshape(-1); y_pred = np.asarray(y_pred).reshape(-1)
+        if self.cm is not None:
+            np.add.at(self.cm, (y_true.astype(np.int64), y_pred.astype(np.int64)), 1)
+            return
+        y_true = y_true.astype(np.float64); e = y_true - y_pred.astype(np.float64)
+        self.n += y_true.size; self.sy += float(y_true.sum()); self.syy += float((y_true ** 2).sum())
+        self.sse += float((e ** 2).sum()); self.sae += float(np.abs(e).sum())
+
+    def accuracy(self) -> float:
+        return float(np.trace(self.cm) / max(1, self.cm.sum()))
+
+    def regression(self):
+        """(r2, mae, mse, rmse), as regression_metrics in models.py."""
+        n = max(1, self.n)
+        ss_tot = self.syy - self.sy * self.sy / n
+        mse = self.sse / n
+        return 1.0 - self.sse / max(1e-12, ss_tot), self.sae / n, mse, float(np.sqrt(mse))
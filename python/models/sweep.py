@@ -0,0 +1,392 @@
+# python/models/sweep.py
+"""
+Hyperparameter sweep: runs models.py once per trial, N trials at a time.
+Every option this script does not know is passed to each trial unchanged;
+--space lists the ranges (`lr=1e-4:1e-1:log; max_depth=2:12; activation=relu|tanh`)
+and --sweep picks how points are drawn (grid, random or Latin hypercube) or
+how a budget is shared out (successive halving, Hyperband): candidates start
+on a few epochs or a slice of the training rows and only the top 1/eta of
+each rung moves on to a budget eta times larger. A `model=a|b` entry compares
+algorithms. Trials are ranked on a validation split of their training rows
+(--val-frac); the test score is only reported.
+The cores are shared out through AIFD_THREADS/OMP_NUM_THREADS, so trials do
+not fight over threads. Events on stdout: "sweep", "trial", "rung" and a final "done".
+"""
+from __future__ import annotations
+from typing import Any, Dict, List, Optional, Tuple
+from pathlib import Path
+import argparse, itertools, json, math, os, shutil, subprocess, sys, tempfile, threading, time
+
+import numpy as np
+
+SCRIPT = Path(__file__).resolve().parent / "models.py"
+THREAD_VARS = ("AIFD_THREADS", "OMP_NUM_THREADS", "MKL_NUM_THREADS", "OPENBLAS_NUM_THREADS")
+PROGRESS_EVERY_S = 0.5   # at most one "trial" progress event per trial in this interval
+EPOCH_MODELS = {"linreg", "ridge", "lasso", "logreg", "mlp_cls", "mlp_reg"}   # budget = epochs; others: rows
+FULL = 1.0 - 1e-9        # budgets are fractions of the full run
+
+_out_lock = threading.Lock()
+
+def _emit(**payload) -> None:
+    with _out_lock:
+        print(json.dumps(payload), flush=True)
+
+
+def _num(s: str) -> Any:
+    try:
+        return int(s)
+    except ValueError:
+        try:
+            return float(s)
+        except ValueError:
+            return s
+
+
+def parse_space(spec: str) -> Dict[str, Any]:
+    """
+    `key=lo:hi[:log]` -> numeric range (int when both ends are ints);
+    `key=a|b|c` -> choices; `key=v` -> fixed value. Entries split on ';' or newlines.
+    Returns {key: ("range", lo, hi, log, is_int) | ("choice", [values])}.
+    """
+    space: Dict[str, Any] = {}
+    for part in spec.replace("\n", ";").split(";"):
+        if "=" not in part:
+            continue
+        key, val = (s.strip() for s in part.split("=", 1))
+        if not key or not val:
+            continue
+        if "|" in val:
+            space[key] = ("choice", [_num(v.strip()) for v in val.split("|") if v.strip()])
+            continue
+        bits = [b.strip() for b in val.split(":")]
+        if len(bits) >= 2:
+            lo, hi = _num(bits[0]), _num(bits[1])
+            if isinstance(lo, str) or isinstance(hi, str):
+                raise SystemExit(f"--space: bad range for {key}: {val}")
+            log = len(bits) > 2 and bits[2].lower() == "log"
+            if log and (lo <= 0 or hi <= 0):
+                raise SystemExit(f"--space: log range for {key} needs positive ends")
+            space[key] = ("range", min(lo, hi), max(lo, hi), log, isinstance(lo, int) and isinstance(hi, int))
+        else:
+            space[key] = ("choice", [_num(val)])
+    if not space:
+        raise SystemExit("--space: no `key=range` entries")
+    return space
+
+
+def _at(dim: Tuple, u: float) -> Any:
+    """Maps u in [0, 1) to a value of the dimension."""
+    if dim[0] == "choice":
+        vals = dim[1]
+        return vals[min(len(vals) - 1, int(u * len(vals)))]
+    _, lo, hi, log, is_int = dim
+    if is_int:
+        v = math.exp(math.log(lo) + u * (math.log(hi + 1) - math.log(lo))) if log else lo + u * (hi + 1 - lo)
+        return int(min(hi, math.floor(v)))
+    v = math.exp(math.log(lo) + u * (math.log(hi) - math.log(lo))) if log else lo + u * (hi - lo)
+    return float(f"{v:.6g}")
+
+
+def sample_points(space: Dict[str, Any], mode: str, trials: int, seed: int) -> List[Dict[str, Any]]:
+    keys = list(space)
+    rng = np.random.default_rng(seed)
+    if mode == "grid":
+        # numeric ranges get k levels so that the grid has at least `trials` points
+        n_choice = int(np.prod([len(space[k][1]) for k in keys if space[k][0] == "choice"] or [1]))
+        n_range = sum(1 for k in keys if space[k][0] == "range")
+        k = max(2, math.ceil((trials / n_choice) ** (1.0 / n_range))) if n_range else 1
+        axes = []
+        for key in keys:
+            dim = space[key]
+            if dim[0] == "choice":
+                axes.append(list(dim[1]))
+            else:
+                axes.append(list(dict.fromkeys(_at(dim, (i + 0.5) / k) for i in range(k))))
+        grid = [dict(zip(keys, p)) for p in itertools.product(*axes)]
+        if len(grid) > trials:   # evenly spaced subset, corners of the grid included
+            grid = [grid[i] for i in np.linspace(0, len(grid) - 1, trials).round().astype(int)]
+        return grid
+    if mode == "lhs":
+        # one point per stratum in every dimension, strata paired at random
+        U = (np.stack([rng.permutation(trials) for _ in keys], axis=1) + rng.random((trials, len(keys)))) / trials
+    else:
+        U = rng.random((trials, len(keys)))
+    return [{key: _at(space[key], float(U[i, j])) for j, key in enumerate(keys)} for i in range(trials)]
+
+
+class Trial:
+    def __init__(self, idx: int, params: Dict[str, Any], workdir: Path, budget: float = 1.0, rung: int = 0):
+        self.idx, self.params, self.budget, self.rung = idx, params, budget, rung
+        self.metrics = workdir / f"trial_{idx}_r{rung}.txt"
+        self.plot = workdir / f"trial_{idx}_r{rung}.png"
+        self.proc: Optional[subprocess.Popen] = None
+        self.score: Optional[float] = None   # test split: reported, never used to choose
+        self.val: Optional[float] = None     # validation rows: what trials are ranked on
+        self.state = "queued"
+        self.seconds = 0.0
+
+    @property
+    def rank(self) -> float:
+        """Validation score; a trainer that reports none (--cv, --stream) gives its final score."""
+        return self.val if self.val is not None else self.score
+
+
+class Sweep:
+    def __init__(self, args, passthrough: List[str], base_hp: Dict[str, Any]):
+        self.args, self.passthrough, self.base_hp = args, passthrough, base_hp
+        self.lock = threading.Lock()
+        self.cancelled = False
+        self.running: Dict[int, Trial] = {}
+        self.best: Optional[Trial] = None
+        self.finished = 0
+        self.no_val_warned = False
+        self.planned = args.trials
+        cores = os.cpu_count() or 1
+        self.parallel = max(1, min(args.parallel or cores, args.trials))
+        self.threads = max(1, cores // self.parallel)
+
+    def control(self, stream) -> None:
+        """stdin lines are forwarded to every running trial; cancel also stops the queue."""
+        for line in stream:
+            cmd = line.strip().lower()
+            if not cmd:
+                continue
+            with self.lock:
+                if cmd == "cancel":
+                    self.cancelled = True
+                procs = [t.proc for t in self.running.values() if t.proc is not None]
+            for p in procs:
+                try:
+                    p.stdin.write(cmd + "\n"); p.stdin.flush()
+                except Exception:
+                    pass
+            if cmd in ("pause", "resume", "cancel"):
+                _emit(event="control", state={"pause": "paused", "resume": "running", "cancel": "cancelled"}[cmd])
+
+    def run_trial(self, t: Trial) -> None:
+        with self.lock:
+            if self.cancelled:
+                t.state = "cancelled"
+                _emit(event="trial", trial=t.idx, state=t.state, params=t.params)
+                return
+            self.running[t.idx] = t
+        env = dict(os.environ, **{v: str(self.threads) for v in THREAD_VARS})
+        hp = dict(self.base_hp, **t.params)
+        model = str(hp.pop("model", self.args.model))
+        epochs, frac = self.args.epochs, 1.0
+        if t.budget < FULL:
+            if model in EPOCH_MODELS:
+                epochs = max(1, int(round(self.args.epochs * t.budget)))
+            else:
+                frac = t.budget
+        cmd = [sys.executable, str(SCRIPT), *self.passthrough, "--model", model, "--epochs", str(epochs),
+               "--train-frac", f"{frac:.6g}", "--val-frac", f"{self.args.val_frac:.6g}", "--hparams", json.dumps(hp),
+               "--out-metrics", str(t.metrics), "--out-plot", str(t.plot) if self.args.out_plot else "",
+               "--control", "stdin"]
+        t.state = "running"
+        _emit(event="trial", trial=t.idx, state="running", params=t.params, rung=t.rung, budget=t.budget)
+        t0 = time.perf_counter(); last = 0.0
+        try:
+            t.proc = subprocess.Popen(cmd, stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                      text=True, encoding="utf-8", errors="replace", env=env)
+            if self.cancelled:   # cancel arrived while this trial was starting
+                t.proc.stdin.write("cancel\n"); t.proc.stdin.flush()
+            for line in t.proc.stdout:
+                if not line.startswith("{"):
+                    continue
+                try:
+                    ev = json.loads(line)
+                except ValueError:
+                    continue
+                kind = ev.get("event")
+                if kind == "epoch" and time.perf_counter() - last >= PROGRESS_EVERY_S:
+                    last = time.perf_counter()
+                    _emit(event="trial", trial=t.idx, state="running", epoch=ev.get("epoch"),
+                          epochs=ev.get("epochs"), score=ev.get("score"), seconds=last - t0)
+                elif kind == "done":
+                    t.score = float(ev.get("score", 0.0))
+                    if ev.get("val_score") is not None:
+                        t.val = float(ev["val_score"])
+                elif kind == "control" and ev.get("state") == "cancelled":
+                    t.state = "cancelled"
+            t.proc.wait()
+        except OSError as e:
+            print(f"[sweep] trial {t.idx} failed to start: {e}", flush=True)
+        t.seconds = time.perf_counter() - t0
+        if self.cancelled:
+            t.state = "cancelled"   # cut short: shown, but never the best
+        elif t.state != "cancelled":
+            t.state = "done" if t.score is not None else "failed"
+        with self.lock:
+            if t.state == "done" and t.val is None and not self.no_val_warned:
+                self.no_val_warned = True
+                print(f"[sweep] trial {t.idx} reported no validation score: ranking on its final score", flush=True)
+            self.running.pop(t.idx, None)
+            self.finished += 1
+            # only full-budget runs compete: a score on 1/9 of the epochs is not comparable
+            new_best = t.state == "done" and t.budget >= FULL and (self.best is None or t.rank > self.best.rank)
+            if new_best:
+                self.best = t
+                self.publish(t)
+        _emit(event="trial", trial=t.idx, state=t.state, params=t.params,
+              score=(t.rank if t.score is not None else None), test_score=t.score,
+              seconds=round(t.seconds, 3), best=bool(new_best), rung=t.rung, budget=t.budget)
+        _emit(event="sweep", state="progress", done=self.finished, trials=self.planned)
+
+    def run_all(self, trials: List[Trial]) -> None:
+        """Runs the trials, `parallel` at a time."""
+        queue = list(trials)
+        def worker() -> None:
+            while True:
+                with self.lock:
+                    if not queue:
+                        return
+                    t = queue.pop(0)
+                self.run_trial(t)
+        pool = [threading.Thread(target=worker) for _ in range(min(self.parallel, len(queue)))]
+        for th in pool: th.start()
+        for th in pool: th.join()
+
+    def halving(self, trials: List[Trial], eta: int, min_budget: float, bracket: int, workdir: Path) -> List[Trial]:
+        """Successive halving: every rung keeps the top 1/eta and multiplies the budget by eta."""
+        runs: List[Trial] = []
+        alive, budget, rung = trials, min_budget, 0
+        while alive and not self.cancelled:
+            rung_trials = [Trial(t.idx, t.params, workdir, budget, rung) for t in alive]
+            self.run_all(rung_trials)
+            runs += rung_trials
+            ranked = sorted((t for t in rung_trials if t.state == "done"), key=lambda t: -t.rank)
+            last = budget >= FULL
+            keep = ranked if last else ranked[:max(1, len(alive) // eta)]
+            _emit(event="rung", bracket=bracket, rung=rung, budget=budget, candidates=len(alive),
+                  promoted=[] if last else [t.idx for t in keep],
+                  best=(ranked[0].rank if ranked else None))
+            if last:
+                break
+            alive, budget, rung = keep, min(1.0, budget * eta), rung + 1
+        return runs
+
+    def publish(self, t: Trial) -> None:
+        """The GUI files always show the best trial so far."""
+        for src, dst in ((t.metrics, self.args.out_metrics), (t.plot, self.args.out_plot)):
+            if dst and src.exists():
+                tmp = dst + ".tmp"
+                shutil.copyfile(src, tmp)
+                os.replace(tmp, dst)
+
+
+def halving_plan(n: int, eta: int, min_budget: float) -> List[int]:
+    """Candidates per rung for successive halving from n candidates."""
+    sizes, budget = [n], min_budget
+    while budget < FULL:
+        sizes.append(max(1, sizes[-1] // eta)); budget = min(1.0, budget * eta)
+    return sizes
+
+
+def main():
+    ap = argparse.ArgumentParser(description="parallel hyperparameter sweep over models.py")
+    ap.add_argument("--sweep", choices=["grid", "random", "lhs", "halving", "hyperband"], default="random")
+    ap.add_argument("--space", required=True)
+    ap.add_argument("--trials", type=int, default=32)       # halving: candidates in the first rung
+    ap.add_argument("--parallel", type=int, default=0)      # 0 = one trial per core
+    ap.add_argument("--sweep-seed", type=int, default=0)
+    ap.add_argument("--eta", type=int, default=3)           # halving/hyperband: keep 1/eta per rung
+    ap.add_argument("--min-budget", type=float, default=1.0 / 9)   # smallest budget, share of the full run
+    ap.add_argument("--model", default="linreg")            # a `model` key in --space overrides it per trial
+    ap.add_argument("--epochs", type=int, default=100)
+    ap.add_argument("--hparams", type=str, default="")      # fixed values; the swept keys override them
+    ap.add_argument("--val-frac", type=float, default=0.2)  # training rows each trial holds out to be ranked on
+    ap.add_argument("--out-metrics", default="")
+    ap.add_argument("--out-plot", default="")
+    ap.add_argument("--control", choices=["stdin", "none"], default="stdin")
+    ap.add_argument("--warm-start", action="store_true")    # ignored: trials must not seed each other
+    ap.add_argument("--resume", action="store_true")        # ignored: every trial starts fresh
+    args, passthrough = ap.parse_known_args()
+    args.trials = max(1, args.trials)
+    args.eta = max(2, args.eta)
+    args.min_budget = min(1.0, max(1e-3, args.min_budget))
+    args.val_frac = min(0.5, max(0.0, args.val_frac))
+    base_hp = json.loads(args.hparams) if args.hparams.strip() else {}
+
+    space = parse_space(args.space)
+    workdir = Path(tempfile.mkdtemp(prefix="aifd_sweep_"))
+    budgeted = args.sweep in ("halving", "hyperband")
+    if args.sweep == "hyperband":
+        # brackets s = s_max..0: many candidates on eta^-s of the budget down to a few on the full run
+        s_max = max(0, int(round(math.log(1.0 / args.min_budget, args.eta))))
+        brackets = [(s, int(math.ceil((s_max + 1) / (s + 1) * args.eta ** s)), args.eta ** -s)
+                    for s in range(s_max, -1, -1)]
+    elif args.sweep == "halving":
+        brackets = [(0, args.trials, args.min_budget)]
+    else:
+        brackets = []
+    groups, idx = [], 0
+    for b, (s, n, b0) in enumerate(brackets):
+        points = sample_points(space, "lhs", n, args.sweep_seed + b)
+        groups.append(([Trial(idx + i + 1, p, workdir, b0) for i, p in enumerate(points)], b0))
+        idx += n
+    if budgeted:
+        trials = [t for g, _ in groups for t in g]
+    else:
+        points = sample_points(space, args.sweep, args.trials, args.sweep_seed)
+        trials = [Trial(i + 1, p, workdir) for i, p in enumerate(points)]
+    args.trials = len(trials)
+    sweep = Sweep(args, passthrough, base_hp)
+    if budgeted:
+        sweep.planned = sum(sum(halving_plan(len(g), args.eta, b0)) for g, b0 in groups)
+    print(f"[sweep] {args.sweep}: {len(trials)} candidates, {sweep.parallel} at a time, "
+          f"{sweep.threads} thread(s) each", flush=True)
+    _emit(event="sweep", state="begin", mode=args.sweep, trials=sweep.planned, candidates=len(trials),
+          parallel=sweep.parallel, threads=sweep.threads, space=list(space))
+    for t in trials:
+        _emit(event="trial", trial=t.idx, state="queued", params=t.params)
+    if args.control == "stdin":
+        threading.Thread(target=sweep.control, args=(sys.stdin,), daemon=True).start()
+
+    t0 = time.perf_counter()
+    if budgeted:
+        runs = []
+        for b, (g, b0) in enumerate(groups):
+            if sweep.cancelled:
+                break
+            runs += sweep.halving(g, args.eta, b0, b, workdir)
+    else:
+        sweep.run_all(trials)
+        runs = trials
+    wall = time.perf_counter() - t0
+
+    # per candidate, its run on the largest budget it reached
+    final: Dict[int, Trial] = {}
+    for t in runs:
+        if t.state == "done" and (t.idx not in final or t.budget >= final[t.idx].budget):
+            final[t.idx] = t
+    ranked = sorted(final.values(), key=lambda t: (-t.budget, -t.rank))
+    busy = sum(t.seconds for t in runs)
+    lines = ["=== Sweep leaderboard ===",
+             f"{args.sweep}, {len(trials)} candidates, {sweep.parallel} in parallel: {wall:.1f}s wall, "
+             f"{busy:.1f}s of trial time ({busy / max(wall, 1e-9):.1f}x)",
+             "ranked on the validation rows; test = held-out split, for reference only"]
+    if budgeted:
+        used = sum(t.budget for t in runs)
+        lines.append(f"budget: {used:.1f} full runs for {len(trials)} candidates "
+                     f"({used / max(1, len(trials)) * 100:.0f}% of training every candidate fully, eta={args.eta})")
+    for rank, t in enumerate(ranked[:10], 1):
+        tag = "" if t.budget >= FULL else f"  (rung {t.rung}, {t.budget*100:.0f}% budget)"
+        lines.append(f"{rank:>2}. trial {t.idx:<3} val {t.rank:.4f}  test {t.score:.4f}  {t.seconds:6.1f}s  "
+                     f"{json.dumps(t.params)}{tag}")
+    board = "\n".join(lines)
+    print("\n" + board, flush=True)
+    if args.out_metrics and sweep.best is not None:
+        text = sweep.best.metrics.read_text(encoding="utf-8") if sweep.best.metrics.exists() else ""
+        tmp = args.out_metrics + ".tmp"
+        Path(tmp).write_text(text + "\n\n" + board, encoding="utf-8")
+        os.replace(tmp, args.out_metrics)
+    shutil.rmtree(workdir, ignore_errors=True)
+    best = sweep.best
+    _emit(event="sweep", state="cancelled" if sweep.cancelled else "finished", trials=sweep.planned,
+          seconds=round(wall, 3), best=(best.idx if best else None), params=(best.params if best else None))
+    _emit(event="done", score=(best.score if best else 0.0), path="", **({"val_score": best.rank} if best else {}))
+
+
+if __name__ == "__main__":
+    main()
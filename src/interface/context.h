@@ -18,6 +18,8 @@ typedef struct {
     GtkButton      *btn_refresh_ds;
     GtkButton      *btn_start;
     GtkButton      *btn_pause;
+    GtkButton      *btn_stop;        // cancel (salva checkpoint)
+    GtkButton      *btn_checkpoint;  // snapshot retomável sem parar
 
     GtkComboBoxText *model_combo; // "Model"
     GtkComboBoxText *algo_combo;  // kept for later
@@ -36,14 +38,27 @@ typedef struct {
     GtkTreeView         *ds_preview_tv;    // singleton "Preview dataset" tab
     GtkTreeView         *fit_view;         // epochs table
     GtkListStore        *fit_store;
+    GtkTreeView         *board_view;       // leaderboard do sweep (uma linha por trial)
+    GtkListStore        *board_store;
 
     GtkImage            *plot_img;
     GtkLabel            *status;
+    GtkLabel            *cadence_label;    // ritmo efetivo dos frames do plot
+    GtkButton           *btn_project;      // projeção 2D nativa (sem trainer)
+    gpointer             proj_job;         // ProjJob em andamento (NULL = livre)
+    gpointer             train_job;        // TrainJob nativo em andamento (NULL = livre)
+    gpointer             handoff_job;      // HandoffJob em andamento (NULL = livre)
+    gchar               *handoff_key;      // dataset/colunas do último segmento (--shm)
+    gchar               *handoff_path;     // segmento atual; NULL = o trainer lê o CSV
+    gpointer             prep_est_job;     // PrepEstJob em andamento (NULL = livre)
+    gpointer             prep_est;         // PrepStats do X atual (estimativa do Pre-processing)
 
     GtkButton           *btn_logout;
 
     // runtime      
-    gchar               *pause_flag_path;
+    GIOChannel          *trainer_ctl;      // stdin do trainer: pause/resume/cancel/checkpoint
+    gboolean            trainer_paused;
+    gboolean            resume_next;       // Stop salvou um checkpoint: o próximo Start retoma (--resume)
     GtkWidget           *metrics_panel; /* painel da tabela de métricas */
     gchar               *fit_img_path; 
     guint               plot_timer_id; 
@@ -3,6 +3,7 @@
 #include "debug_window.h"
 #include <glib/gstdio.h>
 #include <sys/stat.h>
+#include <signal.h>
 
 #ifdef G_OS_WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -19,6 +20,18 @@
 /* -------- Barra Win95 para a janela do Environment --------- */
 
 #include <gtk/gtk.h>
+#include "../native/tsne.h"
+#include "../native/linear.h"
+#include "../native/mlp.h"
+#include "../native/forest.h"
+#include "../native/gbdt.h"
+#include "../native/knn.h"
+#include "../native/csv.h"
+#include "../native/prep.h"
+
+/* ritmo dos frames do plot: intervalo alvo (s) e fração máxima do tempo gasta renderizando */
+#define FRAME_INTERVAL_S "0.5"
+#define FRAME_BUDGET     "0.10"
 
 /* helper local: alterna maximizar/restaurar */
 static void titlebar_on_max_clicked(GtkButton *btn, gpointer win_) {
@@ -498,6 +511,195 @@ static void on_plot_size_allocate(GtkWidget *w, GtkAllocation *alloc, gpointer u
 }
 
 // ---- trainer stdout JSON lines ------------------------------------
+/* lê um número do evento sem quebrar se a chave faltar */
+static double json_num(const cJSON *js, const char *key, double def) {
+    const cJSON *it = cJSON_GetObjectItemCaseSensitive(js, key);
+    return cJSON_IsNumber(it) ? it->valuedouble : def;
+}
+
+/* leaderboard do sweep: uma linha por trial, ordenada pelo score de validação (sem score = fim da lista);
+   colunas do store: trial, val, tempo, estado, params, teste (só exibição) */
+#define BOARD_NO_SCORE (-1e300)
+
+static void board_update(EnvCtx *ctx, const cJSON *js) {
+    if (!ctx->board_store) return;
+    int trial = (int)json_num(js, "trial", 0);
+    GtkTreeModel *m = GTK_TREE_MODEL(ctx->board_store);
+    GtkTreeIter it;
+    gboolean found = FALSE;
+    for (gboolean ok = gtk_tree_model_get_iter_first(m, &it); ok; ok = gtk_tree_model_iter_next(m, &it)) {
+        int t = 0;
+        gtk_tree_model_get(m, &it, 0, &t, -1);
+        if (t == trial) { found = TRUE; break; }
+    }
+    if (!found) gtk_list_store_insert_with_values(ctx->board_store, &it, -1, 0, trial, 1, BOARD_NO_SCORE,
+                                                  5, BOARD_NO_SCORE, -1);
+
+    const cJSON *st = cJSON_GetObjectItemCaseSensitive(js, "state");
+    const char *state = cJSON_IsString(st) ? st->valuestring : "";
+    const cJSON *ep = cJSON_GetObjectItemCaseSensitive(js, "epoch");
+    char buf[64];
+    if (cJSON_IsNumber(ep))
+        g_snprintf(buf, sizeof buf, "%s %d/%d", state, ep->valueint, (int)json_num(js, "epochs", 0));
+    else
+        g_snprintf(buf, sizeof buf, "%s%s", state, cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(js, "best")) ? " ★" : "");
+    /* halving/hyperband: a mesma linha sobe de rung; mostra o orçamento usado até aqui */
+    double budget = json_num(js, "budget", 1.0);
+    if (budget < 1.0 - 1e-9) {
+        size_t n = strlen(buf);
+        g_snprintf(buf + n, sizeof buf - n, " · r%d %.0f%%", (int)json_num(js, "rung", 0), budget * 100.0);
+    }
+    gtk_list_store_set(ctx->board_store, &it, 3, buf, -1);
+
+    const cJSON *sc = cJSON_GetObjectItemCaseSensitive(js, "score");
+    if (cJSON_IsNumber(sc) && g_strcmp0(state, "running") != 0)
+        gtk_list_store_set(ctx->board_store, &it, 1, sc->valuedouble, -1);
+    const cJSON *ts = cJSON_GetObjectItemCaseSensitive(js, "test_score");
+    if (cJSON_IsNumber(ts)) gtk_list_store_set(ctx->board_store, &it, 5, ts->valuedouble, -1);
+    const cJSON *secs = cJSON_GetObjectItemCaseSensitive(js, "seconds");
+    if (cJSON_IsNumber(secs)) gtk_list_store_set(ctx->board_store, &it, 2, secs->valuedouble, -1);
+    const cJSON *params = cJSON_GetObjectItemCaseSensitive(js, "params");
+    if (cJSON_IsObject(params)) {
+        char *p = cJSON_PrintUnformatted(params);
+        gtk_list_store_set(ctx->board_store, &it, 4, p ? p : "", -1);
+        free(p);
+    }
+}
+
+static void board_score_cell(GtkTreeViewColumn *col, GtkCellRenderer *cell, GtkTreeModel *m,
+                             GtkTreeIter *it, gpointer data) {
+    (void)col;
+    int column = GPOINTER_TO_INT(data);
+    double v = 0.0;
+    gtk_tree_model_get(m, it, column, &v, -1);
+    char buf[32] = "";
+    if ((column == 1 || column == 5) && v > BOARD_NO_SCORE / 2) g_snprintf(buf, sizeof buf, "%.4f", v);
+    if (column == 2 && v > 0.0)                g_snprintf(buf, sizeof buf, "%.1f", v);
+    g_object_set(cell, "text", buf, NULL);
+}
+
+/* trata um evento JSON do trainer ({"event": ...}); usado pelos dois leitores de stdout */
+static void trainer_handle_event(EnvCtx *ctx, const cJSON *js) {
+    const cJSON *ev = cJSON_GetObjectItemCaseSensitive(js, "event");
+    if (!cJSON_IsString(ev)) return;
+
+    if (g_strcmp0(ev->valuestring, "begin")==0) {
+        append_log(ctx, "[trainer] begin");
+        if (ctx->progress) gtk_progress_bar_set_fraction(ctx->progress, 0.0);
+    } else if (g_strcmp0(ev->valuestring, "epoch")==0) {
+        int   e     = (int)json_num(js, "epoch", 0);
+        int   epochs= (int)json_num(js, "epochs", 1);
+        double loss = json_num(js, "loss", 0.0);
+        double score= json_num(js, "score", 0.0);
+        if (ctx->fit_store) {
+            GtkTreeIter it;
+            gtk_list_store_append(ctx->fit_store, &it);
+            gtk_list_store_set(ctx->fit_store, &it, 0, e, 1, loss, 2, score, -1);
+        }
+        if (ctx->progress) gtk_progress_bar_set_fraction(ctx->progress, CLAMP((double)e/(double)MAX(1, epochs), 0.0, 1.0));
+        if (ctx->status) {
+            /* vazão do loop torch (linhas/s), quando o trainer informa */
+            double rps = json_num(js, "rows_per_s", 0.0);
+            if (rps > 0.0) {
+                char buf[64];
+                g_snprintf(buf, sizeof buf, "Training… %.0f rows/s", rps);
+                gtk_label_set_text(ctx->status, buf);
+            } else {
+                gtk_label_set_text(ctx->status, "Training…");
+            }
+        }
+    } else if (g_strcmp0(ev->valuestring, "cadence")==0) {
+        /* ritmo efetivo dos frames do plot (o trainer limita o custo de render) */
+        if (ctx->cadence_label) {
+            char buf[128];
+            g_snprintf(buf, sizeof buf, "Plot: 1 frame / %.1f epochs (%.2fs) · render %.0f%%",
+                       json_num(js, "epochs_per_frame", 0), json_num(js, "seconds_per_frame", 0),
+                       100.0 * json_num(js, "render_share", 0));
+            gtk_label_set_text(ctx->cadence_label, buf);
+        }
+    } else if (g_strcmp0(ev->valuestring, "projection")==0) {
+        /* t-SNE nativo dentro do trainer (primeiro frame do plot) */
+        if (ctx->status) {
+            char buf[96];
+            const cJSON *kl = cJSON_GetObjectItemCaseSensitive(js, "kl");
+            if (cJSON_IsNumber(kl))
+                g_snprintf(buf, sizeof buf, "t-SNE %d/%d (KL %.3f)", (int)json_num(js, "iter", 0),
+                           (int)json_num(js, "iters", 0), kl->valuedouble);
+            else
+                g_snprintf(buf, sizeof buf, "t-SNE %d/%d", (int)json_num(js, "iter", 0), (int)json_num(js, "iters", 0));
+            gtk_label_set_text(ctx->status, buf);
+        }
+    } else if (g_strcmp0(ev->valuestring, "control")==0) {
+        /* estado confirmado pelo trainer (paused/running/resumed/cancelled) */
+        const cJSON *st = cJSON_GetObjectItemCaseSensitive(js, "state");
+        const char *state = cJSON_IsString(st) ? st->valuestring : "";
+        ctx->trainer_paused = (g_strcmp0(state, "paused") == 0);
+        if (ctx->btn_pause) gtk_button_set_label(ctx->btn_pause, ctx->trainer_paused ? "Resume ▶" : "Pause ⏸");
+        if (ctx->status) {
+            if      (ctx->trainer_paused)                  gtk_label_set_text(ctx->status, "Paused");
+            else if (g_strcmp0(state, "cancelled") == 0)   gtk_label_set_text(ctx->status, "Stopped (checkpoint saved)");
+            else                                           gtk_label_set_text(ctx->status, "Training…");
+        }
+        if (g_strcmp0(state, "cancelled") == 0) {
+            /* retomar é explícito: só o Start logo depois deste Stop passa --resume */
+            ctx->resume_next = TRUE;
+            if (ctx->btn_start) gtk_button_set_label(ctx->btn_start, "Resume ▶");
+        }
+        if (g_strcmp0(state, "resumed") == 0)
+            append_log(ctx, "[control] resumed from checkpoint at epoch %d", (int)json_num(js, "epoch", 0));
+    } else if (g_strcmp0(ev->valuestring, "checkpoint")==0) {
+        const cJSON *p = cJSON_GetObjectItemCaseSensitive(js, "path");
+        append_log(ctx, "[control] checkpoint at epoch %d -> %s", (int)json_num(js, "epoch", 0),
+                   cJSON_IsString(p) ? p->valuestring : "");
+    } else if (g_strcmp0(ev->valuestring, "cache")==0) {
+        /* hit = métricas/plot reexibidos sem treinar; warm = treino partindo de um modelo salvo */
+        const cJSON *k = cJSON_GetObjectItemCaseSensitive(js, "key");
+        const char *key = cJSON_IsString(k) ? k->valuestring : "";
+        if (cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(js, "hit"))) {
+            append_log(ctx, "[cache] hit %s (no training needed)", key);
+            if (ctx->status) gtk_label_set_text(ctx->status, "Loaded from cache");
+        } else if (cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(js, "warm"))) {
+            append_log(ctx, "[cache] warm start from %s", key);
+        }
+    } else if (g_strcmp0(ev->valuestring, "trial")==0) {
+        board_update(ctx, js);
+    } else if (g_strcmp0(ev->valuestring, "rung")==0) {
+        const cJSON *prom = cJSON_GetObjectItemCaseSensitive(js, "promoted");
+        append_log(ctx, "[sweep] bracket %d rung %d: %d candidates at %.0f%% budget, best %.4f, %d promoted",
+                   (int)json_num(js, "bracket", 0), (int)json_num(js, "rung", 0), (int)json_num(js, "candidates", 0),
+                   json_num(js, "budget", 1.0) * 100.0, json_num(js, "best", 0.0),
+                   cJSON_IsArray(prom) ? cJSON_GetArraySize(prom) : 0);
+    } else if (g_strcmp0(ev->valuestring, "sweep")==0) {
+        /* sweep.py: begin / progress / finished / cancelled */
+        const cJSON *st = cJSON_GetObjectItemCaseSensitive(js, "state");
+        const char *state = cJSON_IsString(st) ? st->valuestring : "";
+        int trials = (int)json_num(js, "trials", 0);
+        char buf[128];
+        if (g_strcmp0(state, "begin") == 0) {
+            append_log(ctx, "[sweep] %d trials, %d at a time, %d thread(s) each", trials,
+                       (int)json_num(js, "parallel", 1), (int)json_num(js, "threads", 1));
+            g_snprintf(buf, sizeof buf, "Sweep 0/%d", trials);
+            if (ctx->status) gtk_label_set_text(ctx->status, buf);
+        } else if (g_strcmp0(state, "progress") == 0) {
+            int done = (int)json_num(js, "done", 0);
+            g_snprintf(buf, sizeof buf, "Sweep %d/%d", done, trials);
+            if (ctx->status)   gtk_label_set_text(ctx->status, buf);
+            if (ctx->progress) gtk_progress_bar_set_fraction(ctx->progress, CLAMP((double)done / MAX(1, trials), 0.0, 1.0));
+        } else {
+            const cJSON *params = cJSON_GetObjectItemCaseSensitive(js, "params");
+            char *p = cJSON_IsObject(params) ? cJSON_PrintUnformatted(params) : NULL;
+            append_log(ctx, "[sweep] %s in %.1fs; best trial %d %s", state, json_num(js, "seconds", 0),
+                       (int)json_num(js, "best", 0), p ? p : "");
+            free(p);
+        }
+    } else if (g_strcmp0(ev->valuestring, "done")==0) {
+        const cJSON *p = cJSON_GetObjectItemCaseSensitive(js, "path");
+        append_log(ctx, "[trainer] done. score=%.4f saved=%s", json_num(js, "score", 0.0),
+                   cJSON_IsString(p) ? p->valuestring : "");
+        if (ctx->status) gtk_label_set_text(ctx->status, "Done");
+    }
+}
+
 static void trainer_read_stdout_cb(GObject *src, GAsyncResult *res, gpointer user_data) {
     EnvCtx *ctx = (EnvCtx*)user_data;
     GError *err = NULL;
@@ -513,28 +715,7 @@ static void trainer_read_stdout_cb(GObject *src, GAsyncResult *res, gpointer use
     // parse one JSON line
     cJSON *js = cJSON_Parse(line);
     if (js) {
-        cJSON *ev = cJSON_GetObjectItemCaseSensitive(js, "event");
-        if (cJSON_IsString(ev)) {
-            if (g_strcmp0(ev->valuestring, "begin")==0) {
-                append_log(ctx, "[trainer] begin");
-                if (ctx->progress) gtk_progress_bar_set_fraction(ctx->progress, 0.0);
-            } else if (g_strcmp0(ev->valuestring, "epoch")==0) {
-                int   e     = cJSON_GetObjectItemCaseSensitive(js,"epoch")->valueint;
-                int   epochs= cJSON_GetObjectItemCaseSensitive(js,"epochs")->valueint;
-                double loss = cJSON_GetObjectItemCaseSensitive(js,"loss")->valuedouble;
-                double score= cJSON_GetObjectItemCaseSensitive(js,"score")->valuedouble;
-                GtkTreeIter it;
-                gtk_list_store_append(ctx->fit_store, &it);
-                gtk_list_store_set(ctx->fit_store, &it, 0, e, 1, loss, 2, score, -1);
-                if (ctx->progress) gtk_progress_bar_set_fraction(ctx->progress, (double)e/(double)epochs);
-                if (ctx->status)   gtk_label_set_text(ctx->status, "Training…");
-            } else if (g_strcmp0(ev->valuestring, "done")==0) {
-                double sc = cJSON_GetObjectItemCaseSensitive(js,"score")->valuedouble;
-                cJSON *p  = cJSON_GetObjectItemCaseSensitive(js,"path");
-                append_log(ctx, "[trainer] done. score=%.4f saved=%s", sc, cJSON_IsString(p)?p->valuestring:"");
-                if (ctx->status) gtk_label_set_text(ctx->status, "Done");
-            }
-        }
+        trainer_handle_event(ctx, js);
         cJSON_Delete(js);
     }
     g_free(line);
@@ -696,13 +877,61 @@ static const char* color_to_flag(GtkComboBoxText *c) {
     return "none";
 }
 
+// ---- trainer control channel (stdin) -------------------------------
+static void trainer_ctl_close(EnvCtx *ctx) {
+    if (ctx->trainer_ctl) {
+        g_io_channel_shutdown(ctx->trainer_ctl, FALSE, NULL);
+        g_io_channel_unref(ctx->trainer_ctl);
+        ctx->trainer_ctl = NULL;
+    }
+    ctx->trainer_paused = FALSE;
+    if (ctx->btn_pause) gtk_button_set_label(ctx->btn_pause, "Pause ⏸");
+}
+
+/* adota o fd de escrita do stdin do filho como canal de controle */
+static void trainer_ctl_open(EnvCtx *ctx, int in_fd) {
+    trainer_ctl_close(ctx);
+    if (in_fd < 0) return;
+#ifdef G_OS_WIN32
+    ctx->trainer_ctl = g_io_channel_win32_new_fd(in_fd);
+#else
+    signal(SIGPIPE, SIG_IGN);   /* trainer morto -> write falha com EPIPE em vez de derrubar a GUI */
+    ctx->trainer_ctl = g_io_channel_unix_new(in_fd);
+#endif
+    g_io_channel_set_encoding(ctx->trainer_ctl, NULL, NULL);
+    g_io_channel_set_close_on_unref(ctx->trainer_ctl, TRUE);
+}
+
+/* um comando por linha; o trainer reage antes do próximo passo do otimizador */
+static gboolean trainer_send(EnvCtx *ctx, const char *cmd) {
+    if (!ctx->trainer_ctl || !ctx->trainer_running) {
+        append_log(ctx, "[control] no trainer running");
+        return FALSE;
+    }
+    GError *err = NULL; gsize written = 0;
+    gchar *line = g_strconcat(cmd, "\n", NULL);
+    GIOStatus st = g_io_channel_write_chars(ctx->trainer_ctl, line, -1, &written, &err);
+    if (st == G_IO_STATUS_NORMAL) st = g_io_channel_flush(ctx->trainer_ctl, &err);
+    g_free(line);
+    if (st != G_IO_STATUS_NORMAL) {
+        append_log(ctx, "[control] %s failed: %s", cmd, err ? err->message : "pipe closed");
+        if (err) g_error_free(err);
+        trainer_ctl_close(ctx);
+        return FALSE;
+    }
+    append_log(ctx, "[control] %s", cmd);
+    return TRUE;
+}
+
 static gboolean on_python_stdout(GIOChannel *ch, GIOCondition cond, gpointer user_data) {
     EnvCtx *ctx = (EnvCtx*)user_data;
     if (!ctx) return FALSE;
 
     if (cond & (G_IO_HUP | G_IO_ERR | G_IO_NVAL)) {          /* closed/error */
         if (ch) g_io_channel_unref(ch);
-        append_log(ctx, "[trainer] process ended");
+        if (ctx->trainer_running) append_log(ctx, "[trainer] process ended");
+        ctx->trainer_running = FALSE;
+        trainer_ctl_close(ctx);
         return FALSE;
     }
 
@@ -712,7 +941,14 @@ static gboolean on_python_stdout(GIOChannel *ch, GIOCondition cond, gpointer use
 
     if (st == G_IO_STATUS_NORMAL && line) {
         if (len > 0 && (line[len-1] == '\n' || line[len-1] == '\r')) line[len-1] = '\0';
-        append_log(ctx, "%s", line);
+        /* linhas {"event": ...} vão para a tabela/progresso; o resto para os logs */
+        cJSON *js = (line[0] == '{') ? cJSON_Parse(line) : NULL;
+        if (js) {
+            trainer_handle_event(ctx, js);
+            cJSON_Delete(js);
+        } else {
+            append_log(ctx, "%s", line);
+        }
         g_free(line);
     }
     if (err) g_error_free(err);
@@ -722,10 +958,11 @@ static gboolean on_python_stdout(GIOChannel *ch, GIOCondition cond, gpointer use
 
 #ifdef G_OS_WIN32
 static gboolean spawn_process_with_pipes_win(const gchar *exe_utf8, const gchar *cmdline_utf8,
-                                             int *out_fd_ptr, int *err_fd_ptr, PROCESS_INFORMATION *pi_out,
-                                             GError **gerr)
+                                             int *in_fd_ptr, int *out_fd_ptr, int *err_fd_ptr,
+                                             PROCESS_INFORMATION *pi_out, GError **gerr)
 {
     gboolean res = FALSE;
+    HANDLE hInRd = NULL, hInWr = NULL;
     HANDLE hOutRd = NULL, hOutWr = NULL;
     HANDLE hErrRd = NULL, hErrWr = NULL;
     SECURITY_ATTRIBUTES sa = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
@@ -740,6 +977,14 @@ static gboolean spawn_process_with_pipes_win(const gchar *exe_utf8, const gchar
         goto done;
     }
 
+    /* stdin opcional: o filho herda a leitura, nós ficamos com a escrita (canal de controle) */
+    if (in_fd_ptr) {
+        if (!CreatePipe(&hInRd, &hInWr, &sa, 0) || !SetHandleInformation(hInWr, HANDLE_FLAG_INHERIT, 0)) {
+            g_set_error(gerr, G_FILE_ERROR, G_FILE_ERROR_FAILED, "CreatePipe stdin failed (err=%lu)", GetLastError());
+            goto done;
+        }
+    }
+
     /* leitura não herdável (só os handles de escrita vão ser herdados pelo filho) */
     if (!SetHandleInformation(hOutRd, HANDLE_FLAG_INHERIT, 0) ||
         !SetHandleInformation(hErrRd, HANDLE_FLAG_INHERIT, 0)) {
@@ -760,7 +1005,7 @@ static gboolean spawn_process_with_pipes_win(const gchar *exe_utf8, const gchar
     ZeroMemory(&si, sizeof(si));
     si.cb = sizeof(si);
     si.dwFlags = STARTF_USESTDHANDLES;
-    si.hStdInput  = GetStdHandle(STD_INPUT_HANDLE); /* não redirecionamos stdin */
+    si.hStdInput  = hInRd ? hInRd : GetStdHandle(STD_INPUT_HANDLE);
     si.hStdOutput = hOutWr;
     si.hStdError  = hErrWr;
 
@@ -787,6 +1032,7 @@ static gboolean spawn_process_with_pipes_win(const gchar *exe_utf8, const gchar
     /* parent fecha os handles de escrita; o filho tem os seus próprios */
     CloseHandle(hOutWr); hOutWr = NULL;
     CloseHandle(hErrWr); hErrWr = NULL;
+    if (hInRd) { CloseHandle(hInRd); hInRd = NULL; }
 
     /* converter handles de leitura para descritores POSIX */
     intptr_t out_fd_os = _open_osfhandle((intptr_t)hOutRd, _O_RDONLY | _O_BINARY);
@@ -801,6 +1047,13 @@ static gboolean spawn_process_with_pipes_win(const gchar *exe_utf8, const gchar
         goto done;
     }
 
+    if (in_fd_ptr) {
+        intptr_t in_fd_os = _open_osfhandle((intptr_t)hInWr, _O_WRONLY | _O_BINARY);
+        *in_fd_ptr = (int)in_fd_os;          /* -1: segue sem canal de controle */
+        if (in_fd_os == -1) CloseHandle(hInWr);
+        hInWr = NULL;
+    }
+
     /* devolver fds e PROCESS_INFORMATION (quem chamar decide fechar pi.hProcess/hThread) */
     *out_fd_ptr = (int)out_fd_os;
     *err_fd_ptr = (int)err_fd_os;
@@ -816,6 +1069,8 @@ static gboolean spawn_process_with_pipes_win(const gchar *exe_utf8, const gchar
     return res;
 
 done:
+    if (hInRd)  CloseHandle(hInRd);
+    if (hInWr)  CloseHandle(hInWr);
     if (hOutRd) CloseHandle(hOutRd);
     if (hOutWr) CloseHandle(hOutWr);
     if (hErrRd) CloseHandle(hErrRd);
@@ -861,6 +1116,123 @@ static char* build_hparams_json(EnvCtx *ctx) {
     return out; // free() after spawn
 }
 
+/* mtime em ns, o mesmo valor do os.stat().st_mtime_ns do Python (Windows: FILETIME, 100 ns); -1 = erro */
+static gint64 file_mtime_ns(const char *path) {
+#ifdef G_OS_WIN32
+    WIN32_FILE_ATTRIBUTE_DATA fa;
+    wchar_t *w = g_utf8_to_utf16(path, -1, NULL, NULL, NULL);
+    BOOL ok = w && GetFileAttributesExW(w, GetFileExInfoStandard, &fa);
+    g_free(w);
+    if (!ok) return -1;
+    gint64 t = ((gint64)fa.ftLastWriteTime.dwHighDateTime << 32) | fa.ftLastWriteTime.dwLowDateTime;
+    return (t - G_GINT64_CONSTANT(116444736000000000)) * 100;   /* 1601 -> 1970 */
+#else
+    GStatBuf st;
+    if (g_stat(path, &st) != 0) return -1;
+#ifdef __APPLE__
+    return (gint64)st.st_mtimespec.tv_sec * G_GINT64_CONSTANT(1000000000) + st.st_mtimespec.tv_nsec;
+#else
+    return (gint64)st.st_mtim.tv_sec * G_GINT64_CONSTANT(1000000000) + st.st_mtim.tv_nsec;
+#endif
+#endif
+}
+
+/* handoff do dataset (--shm): chave = arquivo + colunas + tamanho + mtime (ns); NULL = não usar
+   (AIFD_HANDOFF=0, ou arquivo acima de AIFD_STREAM_MB, que o trainer lê em pedaços) */
+static gchar* handoff_key(EnvCtx *ctx) {
+    const char *off = g_getenv("AIFD_HANDOFF");
+    if ((off && g_strcmp0(off, "0") == 0) || !ctx->current_dataset_path || !ctx->x_feat || !ctx->y_feat) return NULL;
+    GStatBuf st;
+    if (g_stat(ctx->current_dataset_path, &st) != 0) return NULL;
+    const char *mb = g_getenv("AIFD_STREAM_MB");
+    double cap = (mb && *mb) ? g_ascii_strtod(mb, NULL) : 1024.0;
+    if ((double)st.st_size > cap * 1024.0 * 1024.0) return NULL;
+    return g_strdup_printf("%s|%s|%s|%" G_GINT64_FORMAT "|%" G_GINT64_FORMAT, ctx->current_dataset_path,
+                           gtk_entry_get_text(ctx->x_feat), gtk_entry_get_text(ctx->y_feat),
+                           (gint64)st.st_size, file_mtime_ns(ctx->current_dataset_path));
+}
+
+/* segmento pronto para o pedido atual, ou NULL */
+static const char* handoff_current(EnvCtx *ctx) {
+    if (!ctx->handoff_path || !ctx->handoff_key) return NULL;
+    gchar *key = handoff_key(ctx);
+    gboolean same = key && g_strcmp0(key, ctx->handoff_key) == 0 && g_file_test(ctx->handoff_path, G_FILE_TEST_EXISTS);
+    g_free(key);
+    return same ? ctx->handoff_path : NULL;
+}
+
+/* sweep: NULL = desligado; senão o modo passado ao sweep.py */
+static const char* sweep_mode_flag(EnvCtx *ctx) {
+    GtkComboBox *cb = ctx->model_box ? g_object_get_data(G_OBJECT(ctx->model_box), "sweep_combo") : NULL;
+    switch (cb ? gtk_combo_box_get_active(cb) : 0) {
+        case 1:  return "grid";
+        case 2:  return "random";
+        case 3:  return "lhs";
+        case 4:  return "halving";
+        case 5:  return "hyperband";
+        default: return NULL;
+    }
+}
+
+/* k-fold: 0 = desligado (usa o split treino/teste) */
+static int cv_folds(EnvCtx *ctx) {
+    GtkSpinButton *sp = ctx->preproc_box ? g_object_get_data(G_OBJECT(ctx->preproc_box), "cv_spin") : NULL;
+    int k = sp ? gtk_spin_button_get_value_as_int(sp) : 0;
+    return k >= 2 ? k : 0;
+}
+
+/* faixas iniciais tiradas do painel de hiperparâmetros: spin v -> v/2:2v, número v -> v/10:10v (log),
+   combo -> todas as opções; seed fica fixo. Formato lido por sweep.py (--space). */
+static gchar* sweep_space_from_panel(EnvCtx *ctx) {
+    GString *out = g_string_new("");
+    if (!ctx || !ctx->model_params_box) return g_string_free(out, FALSE);
+
+    GList *stack = g_list_prepend(NULL, ctx->model_params_box);
+    while (stack) {
+        GtkWidget *w = stack->data; stack = g_list_delete_link(stack, stack);
+
+        const char *key = g_object_get_data(G_OBJECT(w), "hp-key");
+        if (key && g_strcmp0(key, "seed") != 0) {
+            if (GTK_IS_SPIN_BUTTON(w)) {
+                double lo = 0, hi = 0;
+                gtk_spin_button_get_range(GTK_SPIN_BUTTON(w), &lo, &hi);
+                int v = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(w));
+                int a = MAX(MAX((int)lo, 1), v / 2), b = MIN((int)hi, v * 2);
+                if (v > 0 && a < b) g_string_append_printf(out, "%s=%d:%d; ", key, a, b);
+            } else if (GTK_IS_ENTRY(w)) {
+                const char *t = gtk_entry_get_text(GTK_ENTRY(w));
+                char *end = NULL; double d = g_ascii_strtod(t ? t : "", &end);
+                if (t && *t && end && *end == '\0' && d > 0) {
+                    char a[G_ASCII_DTOSTR_BUF_SIZE], b[G_ASCII_DTOSTR_BUF_SIZE];
+                    g_ascii_formatd(a, sizeof a, "%g", d / 10.0);
+                    g_ascii_formatd(b, sizeof b, "%g", d * 10.0);
+                    g_string_append_printf(out, "%s=%s:%s:log; ", key, a, b);
+                }
+            } else if (GTK_IS_COMBO_BOX_TEXT(w)) {
+                GtkTreeModel *m = gtk_combo_box_get_model(GTK_COMBO_BOX(w));
+                GtkTreeIter it;
+                GString *opts = g_string_new("");
+                for (gboolean ok = gtk_tree_model_get_iter_first(m, &it); ok; ok = gtk_tree_model_iter_next(m, &it)) {
+                    gchar *t = NULL;
+                    gtk_tree_model_get(m, &it, 0, &t, -1);
+                    if (t) g_string_append_printf(opts, "%s%s", opts->len ? "|" : "", t);
+                    g_free(t);
+                }
+                if (strchr(opts->str, '|')) g_string_append_printf(out, "%s=%s; ", key, opts->str);
+                g_string_free(opts, TRUE);
+            }
+        }
+
+        if (GTK_IS_CONTAINER(w)) {
+            GList *ch = gtk_container_get_children(GTK_CONTAINER(w));
+            for (GList *l = ch; l; l = l->next) stack = g_list_prepend(stack, l->data);
+            g_list_free(ch);
+        }
+    }
+    if (out->len >= 2) g_string_truncate(out, out->len - 2);   /* último "; " */
+    return g_string_free(out, FALSE);
+}
+
 /* --- Função spawn_python_training atualizada para usar o helper no Windows --- */
 static gboolean spawn_python_training(EnvCtx *ctx) {
     if (!ctx || !ctx->current_dataset_path) return FALSE;
@@ -885,8 +1257,10 @@ static gboolean spawn_python_training(EnvCtx *ctx) {
         return FALSE;
     }
 
+    /* sweep ligado: sweep.py roda vários models.py em paralelo com os mesmos argumentos */
+    const char *sweep = sweep_mode_flag(ctx);
     gchar *cwd = g_get_current_dir();
-    gchar *script = g_build_filename(cwd, "python", "models", "models.py", NULL);
+    gchar *script = g_build_filename(cwd, "python", "models", sweep ? "sweep.py" : "models.py", NULL);
     if (!g_file_test(script, G_FILE_TEST_EXISTS)) {
         append_log(ctx, "[error] Script não encontrado: %s", script);
         g_free(cwd); g_free(script); g_free(python);
@@ -901,9 +1275,7 @@ static gboolean spawn_python_training(EnvCtx *ctx) {
     gchar *train_s = g_strdup(tb);
 
     gint epochs = gtk_spin_button_get_value_as_int(ctx->epochs_spin);
-    gint frame_every = MAX(1, epochs / 40);
     gchar *epochs_s = g_strdup_printf("%d", epochs);
-    gchar *frame_s  = g_strdup_printf("%d", frame_every);
 
     const gchar *proj  = proj_to_flag(ctx->proj_combo);
     const gchar *color = color_to_flag(ctx->colorby_combo);
@@ -943,6 +1315,20 @@ static gboolean spawn_python_training(EnvCtx *ctx) {
         }
     }
     gboolean onehot_on = (chk_onehot && gtk_toggle_button_get_active(chk_onehot)) ? TRUE : FALSE;
+    GtkSpinButton   *sp_hash    = g_object_get_data(G_OBJECT(ctx->preproc_box), "hash_spin");
+    GtkToggleButton *chk_sparse = g_object_get_data(G_OBJECT(ctx->preproc_box), "sparse_check");
+    int buckets = sp_hash ? gtk_spin_button_get_value_as_int(sp_hash) : 0;
+    gchar *buckets_s = g_strdup_printf("%d", buckets);
+    gboolean sparse_on = !chk_sparse || gtk_toggle_button_get_active(chk_sparse);
+    GtkToggleButton *chk_lean = g_object_get_data(G_OBJECT(ctx->preproc_box), "lean_check");
+    gboolean lean_on = (chk_lean && gtk_toggle_button_get_active(chk_lean)) ? TRUE : FALSE;
+    GtkToggleButton *chk_warm = g_object_get_data(G_OBJECT(ctx->model_box), "warm_check");
+    gboolean warm_on = (chk_warm && gtk_toggle_button_get_active(chk_warm)) ? TRUE : FALSE;
+    GtkToggleButton *chk_native = g_object_get_data(G_OBJECT(ctx->model_box), "native_check");
+    gboolean native_on = (chk_native && gtk_toggle_button_get_active(chk_native)) ? TRUE : FALSE;
+    GtkSpinButton *sp_workers = g_object_get_data(G_OBJECT(ctx->model_box), "workers_spin");
+    int workers = sp_workers ? gtk_spin_button_get_value_as_int(sp_workers) : 1;
+    gchar *workers_s = g_strdup_printf("%d", workers);
 
     /* ---- Build argv dynamically so optional flags are easy ---- */
     GPtrArray *vec = g_ptr_array_new();
@@ -959,7 +1345,8 @@ static gboolean spawn_python_training(EnvCtx *ctx) {
     g_ptr_array_add(vec, "--train-pct");   g_ptr_array_add(vec, train_s);
     g_ptr_array_add(vec, "--proj");        g_ptr_array_add(vec, (gchar*)proj);
     g_ptr_array_add(vec, "--color-by");    g_ptr_array_add(vec, (gchar*)color);
-    g_ptr_array_add(vec, "--frame-every"); g_ptr_array_add(vec, frame_s);
+    g_ptr_array_add(vec, "--frame-interval"); g_ptr_array_add(vec, FRAME_INTERVAL_S);
+    g_ptr_array_add(vec, "--frame-budget");   g_ptr_array_add(vec, FRAME_BUDGET);
     g_ptr_array_add(vec, "--out-plot");    g_ptr_array_add(vec, out_plot);
     g_ptr_array_add(vec, "--out-metrics"); g_ptr_array_add(vec, out_metrics);
 
@@ -967,6 +1354,38 @@ static gboolean spawn_python_training(EnvCtx *ctx) {
     g_ptr_array_add(vec, "--scale");       g_ptr_array_add(vec, scale_flag);
     g_ptr_array_add(vec, "--impute");      g_ptr_array_add(vec, impute_flag);
     if (onehot_on) g_ptr_array_add(vec, "--onehot");
+    if (onehot_on && buckets > 0) { g_ptr_array_add(vec, "--hash-buckets"); g_ptr_array_add(vec, buckets_s); }
+    if (!sparse_on) { g_ptr_array_add(vec, "--sparse"); g_ptr_array_add(vec, "off"); }
+    if (lean_on)   g_ptr_array_add(vec, "--lean");
+    if (warm_on)   g_ptr_array_add(vec, "--warm-start");
+    if (native_on) { g_ptr_array_add(vec, "--engine"); g_ptr_array_add(vec, "native"); }  /* MLPs no núcleo nativo */
+    /* continua do checkpoint deste mesmo pedido só depois de um Stop (botão "Resume ▶") */
+    gboolean resume_on = ctx->resume_next;
+    ctx->resume_next = FALSE;
+    if (ctx->btn_start) gtk_button_set_label(ctx->btn_start, "Start ▶");
+    if (resume_on) g_ptr_array_add(vec, "--resume");
+
+    int folds = cv_folds(ctx);
+    gchar *cv_s = g_strdup_printf("%d", folds);
+    if (folds) { g_ptr_array_add(vec, "--cv"); g_ptr_array_add(vec, cv_s); }
+    /* data-parallel só no trainer sozinho: o sweep já divide os núcleos entre trials */
+    if (workers > 1 && !sweep) { g_ptr_array_add(vec, "--workers"); g_ptr_array_add(vec, workers_s); }
+    const char *shm = handoff_current(ctx);   /* colunas já lidas aqui: o trainer só mapeia */
+    if (shm) { g_ptr_array_add(vec, "--shm"); g_ptr_array_add(vec, (gchar*)shm); }
+
+    gchar *trials_s = NULL, *parallel_s = NULL, *space_s = NULL;
+    if (sweep) {
+        GtkSpinButton *sp_trials = g_object_get_data(G_OBJECT(ctx->model_box), "sweep_trials");
+        GtkSpinButton *sp_par    = g_object_get_data(G_OBJECT(ctx->model_box), "sweep_parallel");
+        GtkEntry      *ent_space = g_object_get_data(G_OBJECT(ctx->model_box), "sweep_space");
+        trials_s   = g_strdup_printf("%d", sp_trials ? gtk_spin_button_get_value_as_int(sp_trials) : 32);
+        parallel_s = g_strdup_printf("%d", sp_par ? gtk_spin_button_get_value_as_int(sp_par) : 0);
+        space_s    = g_strdup(ent_space ? gtk_entry_get_text(ent_space) : "");
+        g_ptr_array_add(vec, "--sweep");    g_ptr_array_add(vec, (gchar*)sweep);
+        g_ptr_array_add(vec, "--trials");   g_ptr_array_add(vec, trials_s);
+        g_ptr_array_add(vec, "--parallel"); g_ptr_array_add(vec, parallel_s);
+        g_ptr_array_add(vec, "--space");    g_ptr_array_add(vec, space_s);
+    }
 
     /* only pass --hparams if we actually have JSON */
     if (hp_json && hp_json[0]) {
@@ -983,8 +1402,8 @@ static gboolean spawn_python_training(EnvCtx *ctx) {
         append_log(ctx, "[debug] argv[%u] = %s", i, (gchar*)g_ptr_array_index(vec, i));
     }
 
-    /* spawn with pipes */
-    gint out_fd = -1, err_fd = -1;
+    /* spawn with pipes (stdin = canal de controle) */
+    gint in_fd = -1, out_fd = -1, err_fd = -1;
     GError *err = NULL; GPid pid = 0;
     GSpawnFlags flags = 0;
     if (!g_path_is_absolute(python)) flags = G_SPAWN_SEARCH_PATH;
@@ -993,7 +1412,7 @@ static gboolean spawn_python_training(EnvCtx *ctx) {
     gboolean ok = g_spawn_async_with_pipes(
         NULL, argv, NULL, flags,
         NULL, NULL, &pid,
-        NULL, &out_fd, &err_fd, &err
+        &in_fd, &out_fd, &err_fd, &err
     );
 
     if (!ok) {
@@ -1006,6 +1425,12 @@ static gboolean spawn_python_training(EnvCtx *ctx) {
 
         /* Build a safe cmdline. We must quote JSON because it contains quotes. */
         gchar *onehot_part = onehot_on ? " --onehot" : "";
+        gchar *warm_part   = warm_on   ? " --warm-start" : "";
+        gchar *engine_part = native_on ? " --engine native" : "";
+        gchar *hash_part   = (onehot_on && buckets > 0) ? g_strdup_printf(" --hash-buckets %d", buckets) : g_strdup("");
+        gchar *sparse_part = sparse_on ? "" : " --sparse off";
+        gchar *lean_part   = lean_on   ? " --lean" : "";
+        gchar *resume_part = resume_on ? " --resume" : "";
 
         gchar *hp_part = NULL;
         if (hp_json && hp_json[0]) {
@@ -1021,30 +1446,43 @@ static gboolean spawn_python_training(EnvCtx *ctx) {
         } else {
             hp_part = g_strdup("");
         }
+        gchar *cv_part = folds ? g_strdup_printf(" --cv %d", folds) : g_strdup("");
+        gchar *workers_part = (workers > 1 && !sweep) ? g_strdup_printf(" --workers %d", workers) : g_strdup("");
+        gchar *shm_part = shm ? g_strdup_printf(" --shm \"%s\"", shm) : g_strdup("");
+        gchar *sweep_part = sweep
+            ? g_strdup_printf(" --sweep %s --trials %s --parallel %s --space \"%s\"", sweep, trials_s, parallel_s, space_s)
+            : g_strdup("");
 
         gchar *cmdline = g_strdup_printf(
             "\"%s\" \"%s\""
             " --csv \"%s\" --x \"%s\" --y \"%s\""
             " --x-label \"%s\" --y-label \"%s\""
             " --model \"%s\" --epochs %s --train-pct %s"
-            " --proj \"%s\" --color-by \"%s\" --frame-every %s"
+            " --proj \"%s\" --color-by \"%s\""
+            " --frame-interval " FRAME_INTERVAL_S " --frame-budget " FRAME_BUDGET
             " --out-plot \"%s\" --out-metrics \"%s\""
-            " --scale %s --impute %s%s%s",
+            " --scale %s --impute %s%s%s%s%s%s%s%s%s%s%s%s%s",
             python, script,
             ctx->current_dataset_path,
             xname, yname,
             xname, yname,
             algo, epochs_s, train_s,
-            proj, color, frame_s,
+            proj, color,
             out_plot, out_metrics,
-            scale_flag, impute_flag, onehot_part, hp_part
+            scale_flag, impute_flag, onehot_part, hash_part, sparse_part, lean_part, warm_part, engine_part, resume_part,
+            cv_part, workers_part, shm_part, hp_part, sweep_part
         );
+        g_free(workers_part);
+        g_free(hash_part);
+        g_free(cv_part);
+        g_free(shm_part);
+        g_free(sweep_part);
 
         PROCESS_INFORMATION pi;
-        int win_out_fd = -1, win_err_fd = -1;
+        int win_in_fd = -1, win_out_fd = -1, win_err_fd = -1;
         GError *werr = NULL;
 
-        if (spawn_process_with_pipes_win(python, cmdline, &win_out_fd, &win_err_fd, &pi, &werr)) {
+        if (spawn_process_with_pipes_win(python, cmdline, &win_in_fd, &win_out_fd, &win_err_fd, &pi, &werr)) {
             /* stdout/stderr channels */
             GIOChannel *ch_out = (win_out_fd >= 0) ? g_io_channel_win32_new_fd(win_out_fd) : NULL;
             GIOChannel *ch_err = (win_err_fd >= 0) ? g_io_channel_win32_new_fd(win_err_fd) : NULL;
@@ -1060,6 +1498,7 @@ static gboolean spawn_python_training(EnvCtx *ctx) {
             CloseHandle(pi.hThread);
             CloseHandle(pi.hProcess);
 
+            trainer_ctl_open(ctx, win_in_fd);
             ctx->trainer_running = TRUE;
             append_log(ctx, "[info] started child via CreateProcessW (with pipes).");
             if (ctx->status)   gtk_label_set_text(ctx->status, "Training…");
@@ -1074,7 +1513,7 @@ static gboolean spawn_python_training(EnvCtx *ctx) {
             g_free(scale_flag);
             g_free(impute_flag);
             g_ptr_array_free(vec, TRUE);
-            g_free(train_s); g_free(epochs_s); g_free(frame_s);
+            g_free(train_s); g_free(epochs_s); g_free(cv_s); g_free(workers_s); g_free(buckets_s); g_free(trials_s); g_free(parallel_s); g_free(space_s);
             g_free(script);  g_free(python); g_free(cwd);
             g_free(out_plot); g_free(out_metrics);
             return TRUE;
@@ -1100,7 +1539,7 @@ static gboolean spawn_python_training(EnvCtx *ctx) {
                 g_free(scale_flag);
                 g_free(impute_flag);
                 g_ptr_array_free(vec, TRUE);
-                g_free(train_s); g_free(epochs_s); g_free(frame_s);
+                g_free(train_s); g_free(epochs_s); g_free(cv_s); g_free(workers_s); g_free(buckets_s); g_free(trials_s); g_free(parallel_s); g_free(space_s);
                 g_free(script);  g_free(python); g_free(cwd);
                 g_free(out_plot); g_free(out_metrics);
                 return FALSE;
@@ -1117,7 +1556,7 @@ static gboolean spawn_python_training(EnvCtx *ctx) {
                 g_free(scale_flag);
                 g_free(impute_flag);
                 g_ptr_array_free(vec, TRUE);
-                g_free(train_s); g_free(epochs_s); g_free(frame_s);
+                g_free(train_s); g_free(epochs_s); g_free(cv_s); g_free(workers_s); g_free(buckets_s); g_free(trials_s); g_free(parallel_s); g_free(space_s);
                 g_free(script);  g_free(python); g_free(cwd);
                 g_free(out_plot); g_free(out_metrics);
                 return TRUE;
@@ -1130,7 +1569,7 @@ static gboolean spawn_python_training(EnvCtx *ctx) {
         g_free(scale_flag);
         g_free(impute_flag);
         g_ptr_array_free(vec, TRUE);
-        g_free(train_s); g_free(epochs_s); g_free(frame_s);
+        g_free(train_s); g_free(epochs_s); g_free(cv_s); g_free(workers_s); g_free(buckets_s); g_free(trials_s); g_free(parallel_s); g_free(space_s);
         g_free(script);  g_free(python); g_free(cwd);
         g_free(out_plot); g_free(out_metrics);
         return FALSE;
@@ -1147,13 +1586,14 @@ static gboolean spawn_python_training(EnvCtx *ctx) {
 #endif
     if (ch_out) { g_io_channel_set_encoding(ch_out, NULL, NULL); g_io_add_watch(ch_out, G_IO_IN | G_IO_HUP, (GIOFunc)on_python_stdout, ctx); }
     if (ch_err) { g_io_channel_set_encoding(ch_err, NULL, NULL); g_io_add_watch(ch_err, G_IO_IN | G_IO_HUP, (GIOFunc)on_python_stdout, ctx); }
+    trainer_ctl_open(ctx, in_fd);
 
     if (hp_json) free(hp_json);
     g_free(scale_flag);
     g_free(impute_flag);
     g_ptr_array_free(vec, TRUE);
 
-    g_free(train_s); g_free(epochs_s); g_free(frame_s);
+    g_free(train_s); g_free(epochs_s); g_free(cv_s); g_free(workers_s); g_free(buckets_s); g_free(trials_s); g_free(parallel_s); g_free(space_s);
     g_free(script);  g_free(python); g_free(cwd);
     g_free(out_plot); g_free(out_metrics);
 
@@ -1167,43 +1607,1287 @@ static gboolean spawn_python_training(EnvCtx *ctx) {
     return TRUE;
 }
 
+/* treino nativo in-process (definido junto das rotinas nativas, abaixo) */
+static gboolean native_train_try_start(EnvCtx *ctx);
+static gboolean native_train_cancel(EnvCtx *ctx);
+/* trainer Python, passando antes pelo handoff do dataset (definido junto do NumMatrix) */
+static void start_trainer(EnvCtx *ctx);
+
 static void on_start_clicked(GtkButton *btn, gpointer user_data) {
     (void)btn;
     EnvCtx *ctx = (EnvCtx*)user_data;
     if (!ctx) return;
 
-    /* Unpause (remove flag if present) */
-    g_unlink(ctx->pause_flag_path);
+    if (ctx->trainer_running && ctx->trainer_ctl) {
+        append_log(ctx, "[start] trainer already running (Stop first)");
+        return;
+    }
+
+    if (ctx->train_job) {
+        append_log(ctx, "[start] native training already running (Stop first)");
+        return;
+    }
 
     ctx->plot_timer_id = g_timeout_add(120, poll_fit_image_cb, ctx);
 
     /* Clear progress + status */
     if (ctx->progress) gtk_progress_bar_set_fraction(ctx->progress, 0.0);
     if (ctx->status)   gtk_label_set_text(ctx->status, "Starting…");
+    if (ctx->cadence_label) gtk_label_set_text(ctx->cadence_label, "");
+    if (ctx->fit_store) gtk_list_store_clear(ctx->fit_store);
+    if (ctx->board_store) gtk_list_store_clear(ctx->board_store);
+
+    /* sweep: sempre pelo sweep.py (cada trial ainda usa o engine nativo dentro do trainer) */
+    if (sweep_mode_flag(ctx)) {
+        GtkEntry *ent = g_object_get_data(G_OBJECT(ctx->model_box), "sweep_space");
+        if (ent && !*gtk_entry_get_text(ent)) {
+            gchar *spec = sweep_space_from_panel(ctx);
+            gtk_entry_set_text(ent, spec);
+            g_free(spec);
+        }
+        if (!ent || !*gtk_entry_get_text(ent)) {
+            append_log(ctx, "[sweep] no ranges to search (fill Ranges, e.g. lr=1e-4:1e-1:log)");
+            if (ctx->status) gtk_label_set_text(ctx->status, "Idle");
+            return;
+        }
+        start_trainer(ctx);
+        return;
+    }
 
-    /* Spawn trainer (this will also jump to Plot) */
-    spawn_python_training(ctx);
+    /* Linear models train in-process; the rest spawns the trainer (this will also jump to Plot).
+       k-fold always goes to the trainer: the folds run in its worker processes. */
+    if (!cv_folds(ctx) && native_train_try_start(ctx)) return;
+    start_trainer(ctx);
 }
 
+/* o rótulo/status só mudam quando o trainer confirma (evento "control") */
 static void on_pause_clicked(GtkButton *btn, gpointer user_data) {
+    (void)btn;
     EnvCtx *ctx = (EnvCtx*)user_data;
-    if (!ctx || !ctx->pause_flag_path) return;
-    if (!ctx->trainer_running) return;
-
-    if (g_file_test(ctx->pause_flag_path, G_FILE_TEST_EXISTS)) {
-        g_remove(ctx->pause_flag_path);
-        gtk_button_set_label(btn, "Pause");
-        if (ctx->status) gtk_label_set_text(ctx->status, "Training…");
-        append_log(ctx, "[pause] resume");
+    if (!ctx) return;
+    trainer_send(ctx, ctx->trainer_paused ? "resume" : "pause");
+}
+
+static void on_stop_clicked(GtkButton *btn, gpointer user_data) {
+    (void)btn;
+    EnvCtx *ctx = (EnvCtx*)user_data;
+    if (ctx && native_train_cancel(ctx)) {
+        if (ctx->status) gtk_label_set_text(ctx->status, "Stopping…");
+        return;
+    }
+    if (ctx && trainer_send(ctx, "cancel") && ctx->status)
+        gtk_label_set_text(ctx->status, "Stopping…");
+}
+
+static void on_checkpoint_clicked(GtkButton *btn, gpointer user_data) {
+    (void)btn;
+    EnvCtx *ctx = (EnvCtx*)user_data;
+    if (ctx) trainer_send(ctx, "checkpoint");
+}
+
+
+// ---- native data + 2D projection (in-process) ---------------------
+/* Matriz numérica lida do CSV para as rotinas de src/native (sem Python). */
+typedef struct {
+    int n, d;
+    double    *X;            /* n x d, linha-major; NaN imputado pela média (se pedido) */
+    double    *y;            /* n valores do alvo (NaN se faltando) ou NULL */
+    gboolean   y_categorical;
+    GPtrArray *y_classes;    /* nomes das classes quando categórico */
+    GPtrArray *names;        /* nomes das colunas de X */
+    int        n_missing;    /* células de X vazias/NA (antes da imputação) */
+    int        x_text;       /* células de X com texto: colunas categóricas */
+    int      **x_codes;      /* d: códigos das colunas de texto (NULL nas numéricas), -1 = ausente */
+    gchar    **x_levels;     /* d: níveis dessas colunas, separados por '\0' (como em csv.h) */
+    int       *x_nlevels;
+} NumMatrix;
+
+static void num_matrix_free(NumMatrix *m) {
+    if (!m) return;
+    g_free(m->X); g_free(m->y);
+    if (m->y_classes) g_ptr_array_free(m->y_classes, TRUE);
+    if (m->names)     g_ptr_array_free(m->names, TRUE);
+    for (int k = 0; m->x_codes && k < m->d; ++k) { g_free(m->x_codes[k]); g_free(m->x_levels[k]); }
+    g_free(m->x_codes); g_free(m->x_levels); g_free(m->x_nlevels);
+    g_free(m);
+}
+
+/* xspec: "a,b,c" (vazio = todas as colunas numéricas exceto y); yname pode ser vazio.
+   impute = FALSE deixa NaN nas células ausentes (o handoff para o trainer imputa lá).
+   O texto é analisado pelo leitor paralelo de src/native/csv.h.
+   Roda em worker thread: só GLib, nada de GTK. */
+static NumMatrix* num_matrix_from_csv(const char *path, const char *xspec, const char *yname,
+                                      gboolean impute, gchar **err) {
+    gchar *text = NULL; gsize len = 0; GError *gerr = NULL;
+    if (!g_file_get_contents(path, &text, &len, &gerr)) {
+        *err = g_strdup(gerr ? gerr->message : "falha ao ler o CSV");
+        if (gerr) g_error_free(gerr);
+        return NULL;
+    }
+    aifd_csv csv;
+    aifd_csv_opts o;
+    aifd_csv_defaults(&o);   /* delimitador detectado; NA, N/A, null, ? e vazio = ausente */
+    int rc = aifd_csv_parse(text, len, &o, &csv);
+    g_free(text);
+    if (rc != AIFD_OK) {
+        *err = g_strdup(rc == AIFD_ENOMEM ? "memória insuficiente para o CSV" : "CSV vazio");
+        return NULL;
+    }
+
+    int ycol = -1;
+    for (int c = 0; yname && *yname && c < csv.cols; ++c)
+        if (g_strcmp0(csv.col[c].name, yname) == 0) ycol = c;
+
+    /* colunas de X: pedidas pelo nome, ou todas as numéricas */
+    GArray *cols = g_array_new(FALSE, FALSE, sizeof(int));
+    if (xspec && *xspec) {
+        gchar **want = g_strsplit(xspec, ",", -1);
+        for (int w = 0; want[w]; ++w) {
+            g_strstrip(want[w]);
+            if (!*want[w]) continue;
+            int found = -1;
+            for (int c = 0; c < csv.cols; ++c) if (g_strcmp0(csv.col[c].name, want[w]) == 0) found = c;
+            if (found < 0) {
+                *err = g_strdup_printf("coluna X não encontrada: %s", want[w]);
+                g_strfreev(want); g_array_free(cols, TRUE); aifd_csv_free(&csv);
+                return NULL;
+            }
+            g_array_append_val(cols, found);
+        }
+        g_strfreev(want);
     } else {
-        FILE *f = fopen(ctx->pause_flag_path, "wb");
-        if (f) fclose(f);
-        gtk_button_set_label(btn, "Resume");
-        if (ctx->status) gtk_label_set_text(ctx->status, "Paused");
-        append_log(ctx, "[pause] paused");
+        for (int c = 0; c < csv.cols; ++c)
+            if (c != ycol && csv.col[c].kind != AIFD_CSV_TEXT) g_array_append_val(cols, c);
+    }
+    if (cols->len == 0) {
+        *err = g_strdup("nenhuma coluna numérica para X");
+        g_array_free(cols, TRUE); aifd_csv_free(&csv);
+        return NULL;
+    }
+
+    NumMatrix *m = g_new0(NumMatrix, 1);
+    m->n = csv.rows;
+    m->d = (int)cols->len;
+    m->X = g_new(double, (gsize)m->n * m->d + 1);
+    m->y = ycol >= 0 ? g_new(double, (gsize)m->n + 1) : NULL;
+    m->names = g_ptr_array_new_with_free_func(g_free);
+    m->y_classes = g_ptr_array_new_with_free_func(g_free);
+
+    for (int k = 0; k < m->d; ++k) {
+        const aifd_csv_col *col = &csv.col[g_array_index(cols, int, k)];
+        g_ptr_array_add(m->names, g_strdup(col->name));
+        if (col->kind != AIFD_CSV_TEXT) {
+            const double *v = (const double*)col->data;
+            for (int i = 0; i < m->n; ++i) m->X[(gsize)i * m->d + k] = v[i];
+            continue;
+        }
+        /* coluna com texto: níveis numéricos valem, os demais viram NaN e contam em x_text;
+           os códigos ficam para o one-hot (num_matrix_prep) */
+        if (!m->x_codes) {
+            m->x_codes = g_new0(int*, m->d); m->x_levels = g_new0(gchar*, m->d); m->x_nlevels = g_new0(int, m->d);
+        }
+        m->x_codes[k] = g_new(int, (gsize)m->n + 1);
+        memcpy(m->x_codes[k], col->data, sizeof(int) * (gsize)m->n);
+        m->x_levels[k] = g_malloc(col->levels_size + 1);
+        if (col->levels_size) memcpy(m->x_levels[k], col->levels, col->levels_size);
+        m->x_nlevels[k] = col->n_levels;
+        double *lv = g_new(double, col->n_levels + 1);
+        const char *s = col->levels;
+        for (int l = 0; l < col->n_levels; ++l, s += strlen(s) + 1) {
+            int is_int;
+            if (csv_number(s, s + strlen(s), &lv[l], &is_int) != 1) lv[l] = NAN;
+        }
+        const int *code = (const int*)col->data;
+        for (int i = 0; i < m->n; ++i) {
+            double v = code[i] >= 0 ? lv[code[i]] : NAN;
+            if (code[i] >= 0 && isnan(v)) m->x_text++;
+            m->X[(gsize)i * m->d + k] = v;
+        }
+        g_free(lv);
+    }
+
+    /* alvo com texto: índice de classe na ordem de aparição (o dicionário do leitor) */
+    if (m->y) {
+        const aifd_csv_col *col = &csv.col[ycol];
+        if (col->kind == AIFD_CSV_TEXT) {
+            m->y_categorical = TRUE;
+            const char *s = col->levels;
+            for (int l = 0; l < col->n_levels; ++l, s += strlen(s) + 1) g_ptr_array_add(m->y_classes, g_strdup(s));
+            const int *code = (const int*)col->data;
+            for (int i = 0; i < m->n; ++i) m->y[i] = code[i] >= 0 ? (double)code[i] : NAN;
+        } else {
+            memcpy(m->y, col->data, sizeof(double) * (gsize)m->n);
+        }
+    }
+
+    /* imputação pela média da coluna */
+    for (int k = 0; k < m->d; ++k) {
+        double sum = 0.0; int cnt = 0;
+        for (int i = 0; i < m->n; ++i) { double v = m->X[(gsize)i * m->d + k]; if (!isnan(v)) { sum += v; cnt++; } }
+        m->n_missing += m->n - cnt;
+        double mean = cnt ? sum / cnt : 0.0;
+        for (int i = 0; impute && i < m->n; ++i) if (isnan(m->X[(gsize)i * m->d + k])) m->X[(gsize)i * m->d + k] = mean;
+    }
+
+    g_array_free(cols, TRUE); aifd_csv_free(&csv);
+    if (m->n == 0) { num_matrix_free(m); *err = g_strdup("CSV sem linhas de dados"); return NULL; }
+    return m;
+}
+
+/* z-score por coluna (equivale ao "Standard Scale" do trainer) */
+static void num_matrix_standardize(NumMatrix *m) {
+    for (int k = 0; k < m->d; ++k) {
+        double mu = 0.0, s2 = 0.0;
+        for (int i = 0; i < m->n; ++i) mu += m->X[(gsize)i * m->d + k];
+        mu /= m->n;
+        for (int i = 0; i < m->n; ++i) { double t = m->X[(gsize)i * m->d + k] - mu; s2 += t * t; }
+        double sd = sqrt(s2 / m->n);
+        if (sd < 1e-12) sd = 1.0;
+        for (int i = 0; i < m->n; ++i) m->X[(gsize)i * m->d + k] = (m->X[(gsize)i * m->d + k] - mu) / sd;
     }
 }
 
+/* ---- handoff do dataset para o trainer (--shm) ----
+   Arquivo em memória compartilhada (/dev/shm; senão o diretório temporário):
+   "AIFDSHM1" | u32 tamanho do schema | u32 reservado | schema JSON | padding até 64,
+   e os dados: X float64 n x d (linha-major, NaN = ausente), depois y float64 n.
+   y de texto vai como índice de classe, com os nomes no schema.
+   Lido por python/models/handoff.py com numpy, sem parse e sem cópia. */
+#define HANDOFF_MAGIC "AIFDSHM1"
+
+static gboolean handoff_write(const NumMatrix *m, const char *csv_path, const char *yname,
+                              const char *out_path, gchar **err) {
+    GStatBuf st;
+    if (g_stat(csv_path, &st) != 0) { *err = g_strdup("CSV não encontrado"); return FALSE; }
+    const char *dt = G_BYTE_ORDER == G_LITTLE_ENDIAN ? "<f8" : ">f8";
+    gsize xbytes = (gsize)m->n * m->d * sizeof(double);
+
+    cJSON *js = cJSON_CreateObject();
+    cJSON_AddNumberToObject(js, "version", 1);
+    cJSON_AddStringToObject(js, "csv", csv_path);
+    cJSON_AddNumberToObject(js, "csv_size", (double)st.st_size);
+    gchar *mtime = g_strdup_printf("%" G_GINT64_FORMAT, file_mtime_ns(csv_path));   /* texto: ns não cabe num double */
+    cJSON_AddStringToObject(js, "csv_mtime_ns", mtime);
+    g_free(mtime);
+    cJSON_AddNumberToObject(js, "rows", m->n);
+    cJSON *x = cJSON_AddObjectToObject(js, "x");
+    cJSON *names = cJSON_AddArrayToObject(x, "names");
+    for (guint k = 0; k < m->names->len; ++k) cJSON_AddItemToArray(names, cJSON_CreateString(m->names->pdata[k]));
+    cJSON_AddStringToObject(x, "dtype", dt);
+    cJSON_AddNumberToObject(x, "offset", 0);
+    if (m->y) {
+        cJSON *y = cJSON_AddObjectToObject(js, "y");
+        cJSON_AddStringToObject(y, "name", yname);
+        cJSON_AddStringToObject(y, "dtype", dt);
+        cJSON_AddNumberToObject(y, "offset", (double)xbytes);
+        if (m->y_categorical) {
+            cJSON *cls = cJSON_AddArrayToObject(y, "classes");
+            for (guint k = 0; k < m->y_classes->len; ++k) cJSON_AddItemToArray(cls, cJSON_CreateString(m->y_classes->pdata[k]));
+        }
+    }
+    char *schema = cJSON_PrintUnformatted(js);
+    cJSON_Delete(js);
+    if (!schema) { *err = g_strdup("schema JSON"); return FALSE; }
+
+    guint32 jlen = (guint32)strlen(schema);
+    guint32 head[2] = { GUINT32_TO_LE(jlen), 0 };
+    static const char pad[64] = { 0 };
+    gsize padn = ((16 + (gsize)jlen + 63) / 64) * 64 - 16 - jlen;
+
+    gchar *tmp = g_strconcat(out_path, ".tmp", NULL);
+    FILE *f = g_fopen(tmp, "wb");
+    gboolean ok = f != NULL;
+    if (ok) {
+        ok = fwrite(HANDOFF_MAGIC, 1, 8, f) == 8 && fwrite(head, sizeof head, 1, f) == 1 &&
+             fwrite(schema, 1, jlen, f) == jlen && (padn == 0 || fwrite(pad, 1, padn, f) == padn) &&
+             (xbytes == 0 || fwrite(m->X, 1, xbytes, f) == xbytes) &&
+             (!m->y || fwrite(m->y, sizeof(double), (size_t)m->n, f) == (size_t)m->n);
+        ok = (fclose(f) == 0) && ok;
+    }
+    free(schema);
+    if (ok) {
+        g_unlink(out_path);   /* Windows não renomeia por cima */
+        ok = g_rename(tmp, out_path) == 0;
+    }
+    if (!ok) {
+        *err = g_strdup_printf("falha ao gravar %s", out_path);
+        g_unlink(tmp);
+    }
+    g_free(tmp);
+    return ok;
+}
+
+typedef struct {
+    EnvCtx  *ctx;
+    gchar   *csv_path, *xspec, *yname, *key, *out_path;
+    gchar   *err;
+    gboolean usable;     /* FALSE: X tem texto (o one-hot fica com o pandas) */
+    int      n, d;
+    double   secs;
+} HandoffJob;
+
+static gboolean handoff_done_idle(gpointer data) {
+    HandoffJob *j = (HandoffJob*)data;
+    EnvCtx *ctx = j->ctx;
+    ctx->handoff_job = NULL;
+    if (j->err)
+        append_log(ctx, "[shm] %s; o trainer lê o CSV", j->err);
+    else if (!j->usable)
+        append_log(ctx, "[shm] X tem colunas de texto; o trainer lê o CSV (one-hot no pandas)");
+    else
+        append_log(ctx, "[shm] %d linhas x %d colunas -> %s em %.0f ms", j->n, j->d, j->out_path, j->secs * 1e3);
+
+    if (ctx->handoff_path) g_unlink(ctx->handoff_path);
+    g_free(ctx->handoff_path); g_free(ctx->handoff_key);
+    ctx->handoff_path = NULL; ctx->handoff_key = NULL;
+    if (!j->err) {
+        ctx->handoff_key = j->key; j->key = NULL;    /* não-usável também fica lembrado: sem reparse */
+        if (j->usable) { ctx->handoff_path = j->out_path; j->out_path = NULL; }
+    }
+    if (j->out_path) g_unlink(j->out_path);
+    spawn_python_training(ctx);
+
+    g_free(j->csv_path); g_free(j->xspec); g_free(j->yname); g_free(j->key); g_free(j->out_path); g_free(j->err);
+    g_free(j);
+    return G_SOURCE_REMOVE;
+}
+
+static gpointer handoff_worker(gpointer data) {
+    HandoffJob *j = (HandoffJob*)data;
+    double t0 = aifd_now();
+    NumMatrix *m = num_matrix_from_csv(j->csv_path, j->xspec, j->yname, FALSE, &j->err);
+    if (m) {
+        j->n = m->n; j->d = m->d;
+        j->usable = m->x_text == 0 && m->y != NULL;
+        if (j->usable && !handoff_write(m, j->csv_path, j->yname, j->out_path, &j->err)) j->usable = FALSE;
+        num_matrix_free(m);
+    }
+    j->secs = aifd_now() - t0;
+    g_idle_add(handoff_done_idle, j);
+    return NULL;
+}
+
+/* Start do trainer: as colunas X/Y são lidas uma vez aqui, numa thread, e o trainer
+   (e cada trial do sweep) mapeia o segmento. Mesmo arquivo e colunas: reaproveita. */
+static void start_trainer(EnvCtx *ctx) {
+    if (ctx->handoff_job) {
+        append_log(ctx, "[shm] dataset ainda sendo preparado");
+        return;
+    }
+    gchar *key = handoff_key(ctx);
+    if (!key || handoff_current(ctx) || (!ctx->handoff_path && g_strcmp0(key, ctx->handoff_key) == 0)) {
+        g_free(key);
+        spawn_python_training(ctx);
+        return;
+    }
+
+    const char *dir = g_file_test("/dev/shm", G_FILE_TEST_IS_DIR) ? "/dev/shm" : g_get_tmp_dir();
+    gchar *path = g_build_filename(dir, "aifd_XXXXXX.seg", NULL);
+    int fd = g_mkstemp(path);
+    if (fd < 0) {
+        append_log(ctx, "[shm] sem arquivo temporário em %s; o trainer lê o CSV", dir);
+        g_free(path); g_free(key);
+        spawn_python_training(ctx);
+        return;
+    }
+    g_close(fd, NULL);
+
+    HandoffJob *j = g_new0(HandoffJob, 1);
+    j->ctx      = ctx;
+    j->csv_path = g_strdup(ctx->current_dataset_path);
+    j->xspec    = g_strdup(gtk_entry_get_text(ctx->x_feat));
+    j->yname    = g_strdup(gtk_entry_get_text(ctx->y_feat));
+    j->key      = key;
+    j->out_path = path;
+    ctx->handoff_job = j;
+    if (ctx->status) gtk_label_set_text(ctx->status, "Reading dataset…");
+    g_thread_unref(g_thread_new("handoff_worker", handoff_worker, j));
+}
+
+/* scatter 2D em PNG (cairo), colorido por classe ou por valor de y */
+static gboolean render_scatter_png(const char *out_path, const double *Z, int n,
+                                   const double *y, gboolean categorical, const char *title) {
+    static const double pal[10][3] = {
+        {0.12,0.47,0.71},{1.00,0.50,0.05},{0.17,0.63,0.17},{0.84,0.15,0.16},{0.58,0.40,0.74},
+        {0.55,0.34,0.29},{0.89,0.47,0.76},{0.50,0.50,0.50},{0.74,0.74,0.13},{0.09,0.75,0.81} };
+    static const double ramp[5][3] = {
+        {0.27,0.00,0.33},{0.23,0.32,0.55},{0.13,0.57,0.55},{0.37,0.79,0.38},{0.99,0.91,0.14} };
+    const int W = 720, H = 480, L = 40, R = 16, T = 30, B = 24;
+
+    double x0 = INFINITY, x1 = -INFINITY, y0 = INFINITY, y1 = -INFINITY, v0 = INFINITY, v1 = -INFINITY;
+    for (int i = 0; i < n; ++i) {
+        x0 = fmin(x0, Z[2*i]); x1 = fmax(x1, Z[2*i]);
+        y0 = fmin(y0, Z[2*i+1]); y1 = fmax(y1, Z[2*i+1]);
+        if (y && !isnan(y[i])) { v0 = fmin(v0, y[i]); v1 = fmax(v1, y[i]); }
+    }
+    if (!(x1 > x0)) { x0 -= 1; x1 += 1; }
+    if (!(y1 > y0)) { y0 -= 1; y1 += 1; }
+
+    cairo_surface_t *sf = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, W, H);
+    cairo_t *cr = cairo_create(sf);
+    cairo_set_source_rgb(cr, 1, 1, 1); cairo_paint(cr);
+    cairo_set_source_rgb(cr, 0.3, 0.3, 0.3); cairo_set_line_width(cr, 1.0);
+    cairo_rectangle(cr, L + 0.5, T + 0.5, W - L - R, H - T - B); cairo_stroke(cr);
+
+    double rad = n > 20000 ? 1.0 : (n > 2000 ? 1.6 : 2.6);
+    for (int i = 0; i < n; ++i) {
+        double px = L + (Z[2*i]   - x0) / (x1 - x0) * (W - L - R);
+        double py = H - B - (Z[2*i+1] - y0) / (y1 - y0) * (H - T - B);
+        if (!y || isnan(y[i])) cairo_set_source_rgba(cr, 0.35, 0.35, 0.35, 0.7);
+        else if (categorical)  { const double *c = pal[((int)y[i]) % 10]; cairo_set_source_rgba(cr, c[0], c[1], c[2], 0.8); }
+        else {
+            double t = v1 > v0 ? (y[i] - v0) / (v1 - v0) * 4.0 : 0.0;
+            int a = (int)fmin(3.0, floor(t)); double f = t - a;
+            cairo_set_source_rgba(cr, ramp[a][0] + f * (ramp[a+1][0] - ramp[a][0]),
+                                      ramp[a][1] + f * (ramp[a+1][1] - ramp[a][1]),
+                                      ramp[a][2] + f * (ramp[a+1][2] - ramp[a][2]), 0.8);
+        }
+        cairo_arc(cr, px, py, rad, 0, 2 * M_PI);
+        cairo_fill(cr);
+    }
+
+    cairo_set_source_rgb(cr, 0, 0, 0);
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size(cr, 13);
+    cairo_move_to(cr, L, T - 10);
+    cairo_show_text(cr, title ? title : "");
+    cairo_destroy(cr);
+
+    /* escreve ao lado e troca: o poll do Plot nunca lê um PNG pela metade */
+    gchar *tmp = g_strconcat(out_path, ".tmp", NULL);
+    gboolean ok = cairo_surface_write_to_png(sf, tmp) == CAIRO_STATUS_SUCCESS;
+    cairo_surface_destroy(sf);
+    if (ok) {
+        g_unlink(out_path);
+        ok = g_rename(tmp, out_path) == 0;
+    }
+    g_free(tmp);
+    return ok;
+}
+
+typedef struct {
+    EnvCtx  *ctx;
+    gchar   *csv_path, *xspec, *yname;
+    gboolean tsne;
+    volatile gint cancel;
+    volatile gint pending;   /* já existe um idle de progresso na fila */
+    volatile gint iter, iters;
+    double   kl;
+    int      rc, n, d;
+    double   secs;
+    gchar   *err;
+} ProjJob;
+
+static gboolean proj_progress_idle(gpointer data) {
+    ProjJob *j = (ProjJob*)data;
+    g_atomic_int_set(&j->pending, 0);
+    int it = g_atomic_int_get(&j->iter), tot = g_atomic_int_get(&j->iters);
+    if (tot > 0 && j->ctx->progress) gtk_progress_bar_set_fraction(j->ctx->progress, (double)it / tot);
+    if (j->ctx->status) {
+        char buf[96];
+        if (isnan(j->kl)) g_snprintf(buf, sizeof buf, "t-SNE %d/%d", it, tot);
+        else              g_snprintf(buf, sizeof buf, "t-SNE %d/%d (KL %.3f)", it, tot, j->kl);
+        gtk_label_set_text(j->ctx->status, buf);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+static int proj_progress_cb(void *user, int step, int total, double value) {
+    ProjJob *j = (ProjJob*)user;
+    g_atomic_int_set(&j->iter, step);
+    g_atomic_int_set(&j->iters, total);
+    j->kl = value;
+    if (g_atomic_int_compare_and_exchange(&j->pending, 0, 1)) g_idle_add(proj_progress_idle, j);
+    return g_atomic_int_get(&j->cancel);
+}
+
+static gboolean proj_done_idle(gpointer data) {
+    ProjJob *j = (ProjJob*)data;
+    EnvCtx *ctx = j->ctx;
+    if (j->err) {
+        append_log(ctx, "[projection] erro: %s", j->err);
+        if (ctx->status) gtk_label_set_text(ctx->status, "Idle");
+    } else if (j->rc == AIFD_CANCELLED) {
+        append_log(ctx, "[projection] cancelado (embedding parcial no Plot)");
+        if (ctx->status) gtk_label_set_text(ctx->status, "Cancelled");
+    } else {
+        append_log(ctx, "[projection] %s: %d linhas x %d colunas em %.2fs (nativo, %d threads)",
+                   j->tsne ? "t-SNE" : "PCA", j->n, j->d, j->secs, aifd_num_threads(0));
+        if (ctx->status)   gtk_label_set_text(ctx->status, "Done");
+        if (ctx->progress) gtk_progress_bar_set_fraction(ctx->progress, 1.0);
+    }
+    if (!j->err) {
+        poll_fit_image_cb(ctx);
+        if (ctx->right_nb && ctx->plot_page_idx >= 0) gtk_notebook_set_current_page(ctx->right_nb, ctx->plot_page_idx);
+    }
+    if (ctx->btn_project) gtk_button_set_label(ctx->btn_project, "Project");
+    ctx->proj_job = NULL;
+    g_free(j->csv_path); g_free(j->xspec); g_free(j->yname); g_free(j->err);
+    g_free(j);
+    return G_SOURCE_REMOVE;
+}
+
+static gpointer proj_worker(gpointer data) {
+    ProjJob *j = (ProjJob*)data;
+    double t0 = aifd_now();
+    NumMatrix *m = num_matrix_from_csv(j->csv_path, j->xspec, j->yname, TRUE, &j->err);
+    if (m) {
+        num_matrix_standardize(m);
+        j->n = m->n; j->d = m->d;
+        double *Z = g_new(double, 2 * (gsize)m->n);
+        if (j->tsne) {
+            j->kl = NAN;
+            j->rc = aifd_tsne2(m->X, m->n, m->d, Z, NULL, proj_progress_cb, j);
+        } else {
+            j->rc = aifd_pca2(m->X, m->n, m->d, Z, 0);
+        }
+        j->secs = aifd_now() - t0;
+        if (j->rc < 0) {
+            j->err = g_strdup_printf("rotina nativa falhou (rc=%d)", j->rc);
+        } else {
+            gchar *title = g_strdup_printf("%s  n=%d  d=%d  %.2fs%s", j->tsne ? "t-SNE" : "PCA",
+                                           m->n, m->d, j->secs, j->rc == AIFD_CANCELLED ? "  (parcial)" : "");
+            if (!render_scatter_png(j->ctx->fit_img_path, Z, m->n, m->y, m->y_categorical, title))
+                j->err = g_strdup("falha ao gravar o PNG do plot");
+            g_free(title);
+        }
+        g_free(Z);
+        num_matrix_free(m);
+    }
+    g_idle_add(proj_done_idle, j);
+    return NULL;
+}
+
+/* "Project": projeta o dataset atual (colunas X, cor = Y) com PCA/t-SNE nativos,
+   sem iniciar o trainer. Clicar de novo durante o t-SNE cancela. */
+static void on_project_clicked(GtkButton *btn, gpointer user_data) {
+    EnvCtx *ctx = (EnvCtx*)user_data;
+    if (!ctx) return;
+    if (ctx->proj_job) {
+        g_atomic_int_set(&((ProjJob*)ctx->proj_job)->cancel, 1);
+        return;
+    }
+    if (!ctx->current_dataset_path || !ctx->fit_img_path) {
+        append_log(ctx, "[projection] carregue um dataset primeiro.");
+        return;
+    }
+    gint proj = gtk_combo_box_get_active(GTK_COMBO_BOX(ctx->proj_combo));
+    if (proj == 2) {
+        append_log(ctx, "[projection] projeção está em Off.");
+        return;
+    }
+
+    ProjJob *j = g_new0(ProjJob, 1);
+    j->ctx      = ctx;
+    j->csv_path = g_strdup(ctx->current_dataset_path);
+    j->xspec    = g_strdup(ctx->x_feat ? gtk_entry_get_text(ctx->x_feat) : "");
+    j->yname    = g_strdup(ctx->y_feat ? gtk_entry_get_text(ctx->y_feat) : "");
+    j->tsne     = (proj == 1);
+    j->kl       = NAN;
+    ctx->proj_job = j;
+
+    if (j->tsne) gtk_button_set_label(btn, "Cancel");
+    if (ctx->progress) gtk_progress_bar_set_fraction(ctx->progress, 0.0);
+    if (ctx->status)   gtk_label_set_text(ctx->status, j->tsne ? "t-SNE…" : "PCA…");
+    g_thread_unref(g_thread_new("proj_worker", proj_worker, j));
+}
+
+// ---- native in-process training ---------------------------------------
+/* Modelos com solver nativo (src/native) treinam numa GThread, sem subir o
+   Python: mesmo CSV, tratamento (num_matrix_prep), split e tabela Fit do
+   trainer. Colunas categóricas sem one-hot, com hashing ou com one-hot denso
+   acima de NATIVE_ONEHOT_MAX_MB caem no trainer (que usa CSR). */
+#define NATIVE_ONEHOT_MAX_MB 1024.0
+
+typedef struct { int iter; double loss, score; } FitRow;
+
+typedef struct {
+    EnvCtx  *ctx;
+    gchar   *csv_path, *xspec, *yname, *algo;
+    int      scale;            /* AIFD_SCALE_* */
+    int      impute;           /* AIFD_IMPUTE_* */
+    gboolean onehot;
+    int      buckets;          /* hashing das categóricas (> 0): fica com o trainer */
+    double   train_pct;
+    int      epochs;           /* MLPs */
+    cJSON   *hp;               /* hiperparâmetros do painel (build_hparams_json) */
+    volatile gint cancel;
+    volatile gint pending;     /* já existe um idle de progresso na fila */
+    GMutex   lock;
+    GArray  *rows;             /* FitRow ainda não mostradas */
+    int      total, rc, n, d;
+    double   secs, score;
+    gboolean fallback;         /* delega ao trainer Python */
+    gchar   *err, *note, *metrics;
+} TrainJob;
+
+static gboolean native_train_supported(const char *algo) {
+    return g_strcmp0(algo, "linreg") == 0 || g_strcmp0(algo, "ridge") == 0
+        || g_strcmp0(algo, "lasso") == 0  || g_strcmp0(algo, "logreg") == 0
+        || g_strcmp0(algo, "mlp_reg") == 0 || g_strcmp0(algo, "mlp_cls") == 0
+        || g_strcmp0(algo, "dt_reg") == 0  || g_strcmp0(algo, "dt_cls") == 0
+        || g_strcmp0(algo, "rf_reg") == 0  || g_strcmp0(algo, "rf_cls") == 0
+        || g_strcmp0(algo, "gb_reg") == 0  || g_strcmp0(algo, "gb_cls") == 0
+        || g_strcmp0(algo, "knn_reg") == 0 || g_strcmp0(algo, "knn_cls") == 0;
+}
+
+static void train_job_free(TrainJob *j) {
+    g_free(j->csv_path); g_free(j->xspec); g_free(j->yname); g_free(j->algo);
+    if (j->hp) cJSON_Delete(j->hp);
+    g_array_free(j->rows, TRUE);
+    g_mutex_clear(&j->lock);
+    g_free(j->err); g_free(j->note); g_free(j->metrics);
+    g_free(j);
+}
+
+/* copia as linhas pendentes para a tabela Fit (thread da GUI) */
+static void train_drain_rows(TrainJob *j) {
+    EnvCtx *ctx = j->ctx;
+    g_mutex_lock(&j->lock);
+    for (guint k = 0; k < j->rows->len; ++k) {
+        FitRow *r = &g_array_index(j->rows, FitRow, k);
+        if (ctx->fit_store) {
+            GtkTreeIter it;
+            gtk_list_store_append(ctx->fit_store, &it);
+            gtk_list_store_set(ctx->fit_store, &it, 0, r->iter, 1, r->loss, 2, r->score, -1);
+        }
+        if (ctx->progress && j->total > 0)
+            gtk_progress_bar_set_fraction(ctx->progress, CLAMP((double)r->iter / j->total, 0.0, 1.0));
+    }
+    g_array_set_size(j->rows, 0);
+    g_mutex_unlock(&j->lock);
+}
+
+static gboolean train_progress_idle(gpointer data) {
+    TrainJob *j = (TrainJob*)data;
+    g_atomic_int_set(&j->pending, 0);
+    train_drain_rows(j);
+    return G_SOURCE_REMOVE;
+}
+
+static int train_fit_cb(void *user, int iter, int total, double loss, double score) {
+    TrainJob *j = (TrainJob*)user;
+    FitRow r = { iter, loss, score };
+    g_mutex_lock(&j->lock);
+    g_array_append_val(j->rows, r);
+    j->total = total;
+    g_mutex_unlock(&j->lock);
+    if (g_atomic_int_compare_and_exchange(&j->pending, 0, 1)) g_idle_add(train_progress_idle, j);
+    return g_atomic_int_get(&j->cancel);
+}
+
+/* tratamento do trainer (build_preprocessor) em C: imputa e escala as numéricas e
+   faz one-hot nas de texto, numéricas primeiro como no ColumnTransformer.
+   impute/scale: AIFD_IMPUTE_* / AIFD_SCALE_*. Troca X, d e names de m. */
+static gboolean num_matrix_prep(NumMatrix *m, int impute, int scale, gchar **err) {
+    int n = m->n, dn = 0;
+    for (int k = 0; k < m->d; ++k) if (!m->x_codes || !m->x_codes[k]) dn++;
+    aifd_prep P = {0};
+    double *Xn = NULL;
+    if (dn) {
+        Xn = g_new(double, (gsize)n * dn);
+        for (int i = 0; i < n; ++i)
+            for (int k = 0, c = 0; k < m->d; ++k)
+                if (!m->x_codes || !m->x_codes[k]) Xn[(gsize)i * dn + c++] = m->X[(gsize)i * m->d + k];
+        int rc = aifd_prep_fit(Xn, n, dn, dn, impute, scale, 0, &P);
+        if (rc != AIFD_OK) {
+            *err = g_strdup(rc == AIFD_ENOMEM ? "memória insuficiente no pré-processamento" : "pré-processamento inválido");
+            g_free(Xn);
+            return FALSE;
+        }
+    }
+    aifd_onehot *H = g_new0(aifd_onehot, m->d);
+    int width = P.out_d;
+    for (int k = 0; m->x_codes && k < m->d; ++k) {
+        if (!m->x_codes[k]) continue;
+        if (aifd_onehot_fit(m->x_codes[k], n, m->x_levels[k], m->x_nlevels[k],
+                            impute == AIFD_IMPUTE_ZERO ? AIFD_IMPUTE_ZERO : AIFD_IMPUTE_MOST_FREQUENT, &H[k]) != AIFD_OK) {
+            *err = g_strdup("memória insuficiente no one-hot");
+            for (int q = 0; q <= k; ++q) aifd_onehot_free(&H[q]);
+            g_free(H); g_free(Xn); aifd_prep_free(&P);
+            return FALSE;
+        }
+        width += H[k].width;
+    }
+
+    double *Y = g_new(double, (gsize)n * width + 1);
+    GPtrArray *names = g_ptr_array_new_with_free_func(g_free);
+    if (dn) aifd_prep_transform(&P, Xn, n, dn, Y, width, 0, 0);
+    for (int k = 0, c = 0; k < m->d; ++k)
+        if (!m->x_codes || !m->x_codes[k]) { if (P.out[c++] >= 0) g_ptr_array_add(names, g_strdup(m->names->pdata[k])); }
+    int col = P.out_d;
+    for (int k = 0; m->x_codes && k < m->d; ++k) {
+        if (!m->x_codes[k]) continue;
+        aifd_onehot_transform(&H[k], m->x_codes[k], n, Y + col, width, 0, 0);
+        const char **lv = g_new(const char*, m->x_nlevels[k] + 1);
+        const char *s = m->x_levels[k];
+        for (int l = 0; l < m->x_nlevels[k]; ++l, s += strlen(s) + 1) lv[l] = s;
+        for (int t = 0; t < H[k].width; ++t)
+            g_ptr_array_add(names, g_strdup_printf("%s=%s", (char*)m->names->pdata[k],
+                                                   H[k].order[t] >= 0 ? lv[H[k].order[t]] : ""));
+        g_free(lv);
+        col += H[k].width;
+        aifd_onehot_free(&H[k]);
+    }
+    g_free(H); g_free(Xn);
+    aifd_prep_free(&P);
+
+    for (int k = 0; m->x_codes && k < m->d; ++k) { g_free(m->x_codes[k]); g_free(m->x_levels[k]); }
+    g_free(m->x_codes); g_free(m->x_levels); g_free(m->x_nlevels);
+    m->x_codes = NULL; m->x_levels = NULL; m->x_nlevels = NULL;
+    g_free(m->X); m->X = Y;
+    g_ptr_array_free(m->names, TRUE); m->names = names;
+    m->d = width; m->x_text = 0;
+    if (width == 0) { *err = g_strdup("nenhuma coluna sobra após o pré-processamento"); return FALSE; }
+    return TRUE;
+}
+
+/* ---- estimativa de dimensão/memória (aba Pre-processing) ----
+   Um worker lê o X atual uma vez (mesmo parser do treino) e guarda linhas, colunas
+   numéricas e níveis das categóricas; mudar impute/one-hot/buckets só refaz a conta,
+   a mesma do trainer (encoding.py): float32 denso ou CSR com índices int32. */
+typedef struct {
+    gchar    *key;        /* caminho|X|Y lidos */
+    int       rows, num;  /* linhas e colunas numéricas de X */
+    int       ncat;
+    int      *levels;     /* ncat: níveis distintos de cada categórica */
+    gboolean *missing;    /* ncat: tem ausentes (com impute zero vira a categoria "") */
+    gchar    *err;
+} PrepStats;
+
+typedef struct {
+    EnvCtx    *ctx;
+    gchar     *csv_path, *xspec, *yname;
+    PrepStats *st;
+} PrepEstJob;
+
+static void prep_stats_free(PrepStats *s) {
+    if (!s) return;
+    g_free(s->key); g_free(s->levels); g_free(s->missing); g_free(s->err);
+    g_free(s);
+}
+
+static PrepStats* prep_stats_from(const NumMatrix *m) {
+    PrepStats *s = g_new0(PrepStats, 1);
+    s->rows = m->n;
+    s->levels = g_new0(int, m->d + 1); s->missing = g_new0(gboolean, m->d + 1);
+    for (int k = 0; k < m->d; ++k) {
+        if (!m->x_codes || !m->x_codes[k]) { s->num++; continue; }
+        s->levels[s->ncat] = m->x_nlevels[k];
+        for (int i = 0; i < m->n && !s->missing[s->ncat]; ++i) s->missing[s->ncat] = m->x_codes[k][i] < 0;
+        s->ncat++;
+    }
+    return s;
+}
+
+/* colunas de saída: numéricas + uma por categoria (one-hot) ou buckets compartilhados */
+static gint64 prep_stats_width(const PrepStats *s, int impute, gboolean onehot, int buckets) {
+    gint64 w = s->num;
+    if (!onehot || s->ncat == 0) return w;
+    if (buckets > 0) return w + buckets;
+    for (int k = 0; k < s->ncat; ++k) w += s->levels[k] + (s->missing[k] && impute == AIFD_IMPUTE_ZERO);
+    return w;
+}
+
+static gboolean prep_est_done_idle(gpointer data);
+
+static gpointer prep_est_worker(gpointer data) {
+    PrepEstJob *j = (PrepEstJob*)data;
+    gchar *err = NULL;
+    NumMatrix *m = num_matrix_from_csv(j->csv_path, j->xspec, j->yname, FALSE, &err);
+    if (m) {
+        gchar *key = j->st->key;
+        g_free(j->st);
+        j->st = prep_stats_from(m);
+        j->st->key = key;
+        num_matrix_free(m);
+    } else {
+        j->st->err = err;
+    }
+    g_idle_add(prep_est_done_idle, j);
+    return NULL;
+}
+
+static void prep_est_refresh(EnvCtx *ctx) {
+    GtkLabel *lbl = ctx->preproc_box ? g_object_get_data(G_OBJECT(ctx->preproc_box), "prep_est_label") : NULL;
+    if (!lbl) return;
+    if (!ctx->current_dataset_path || !ctx->x_feat) { gtk_label_set_text(lbl, "Output: load a dataset"); return; }
+    const char *xs = gtk_entry_get_text(ctx->x_feat), *ys = ctx->y_feat ? gtk_entry_get_text(ctx->y_feat) : "";
+    gchar *key = g_strdup_printf("%s|%s|%s", ctx->current_dataset_path, xs, ys);
+    PrepStats *s = (PrepStats*)ctx->prep_est;
+    if (!s || g_strcmp0(s->key, key) != 0) {
+        if (!ctx->prep_est_job) {   /* um por vez: ao terminar, refresh compara a chave de novo */
+            PrepEstJob *j = g_new0(PrepEstJob, 1);
+            j->ctx = ctx;
+            j->csv_path = g_strdup(ctx->current_dataset_path);
+            j->xspec = g_strdup(xs); j->yname = g_strdup(ys);
+            j->st = g_new0(PrepStats, 1);
+            j->st->key = key; key = NULL;
+            ctx->prep_est_job = j;
+            g_thread_unref(g_thread_new("prep_est", prep_est_worker, j));
+        }
+        gtk_label_set_text(lbl, "Output: reading dataset…");
+        g_free(key);
+        return;
+    }
+    g_free(key);
+    if (s->err) {
+        gchar *t = g_strdup_printf("Output: — (%s)", s->err);
+        gtk_label_set_text(lbl, t);
+        g_free(t);
+        return;
+    }
+
+    GtkComboBoxText *cmb_impute = g_object_get_data(G_OBJECT(ctx->preproc_box), "impute_combo");
+    GtkToggleButton *chk_onehot = g_object_get_data(G_OBJECT(ctx->preproc_box), "onehot_check");
+    GtkSpinButton   *sp_hash    = g_object_get_data(G_OBJECT(ctx->preproc_box), "hash_spin");
+    GtkToggleButton *chk_sparse = g_object_get_data(G_OBJECT(ctx->preproc_box), "sparse_check");
+    int impute = AIFD_IMPUTE_MEAN;
+    if (cmb_impute) {
+        gchar *t = gtk_combo_box_text_get_active_text(cmb_impute);
+        if (t && g_str_has_suffix(t, "zero")) impute = AIFD_IMPUTE_ZERO;
+        g_free(t);
+    }
+    gboolean onehot = chk_onehot && gtk_toggle_button_get_active(chk_onehot);
+    gboolean sparse = !chk_sparse || gtk_toggle_button_get_active(chk_sparse);
+    int buckets = sp_hash ? gtk_spin_button_get_value_as_int(sp_hash) : 0;
+
+    gint64 w = prep_stats_width(s, impute, onehot, buckets);
+    gint64 nnz = (gint64)s->rows * (s->num + (onehot ? s->ncat : 0));
+    int idx = MAX(nnz, w) < G_MAXINT32 ? 4 : 8;
+    gchar *dense = g_format_size((guint64)s->rows * (guint64)w * 4u);
+    gchar *csr = g_format_size((guint64)nnz * (4u + idx) + (guint64)(s->rows + 1) * idx);
+    gchar *t;
+    if (s->ncat && !onehot)
+        t = g_strdup_printf("Output: %d rows × %" G_GINT64_FORMAT " columns · %d categorical column(s) need one-hot",
+                            s->rows, w, s->ncat);
+    else if (s->ncat && sparse)
+        t = g_strdup_printf("Output: %d rows × %" G_GINT64_FORMAT " columns · dense %s · CSR %s",
+                            s->rows, w, dense, csr);
+    else
+        t = g_strdup_printf("Output: %d rows × %" G_GINT64_FORMAT " columns · dense %s", s->rows, w, dense);
+    gtk_label_set_text(lbl, t);
+    g_free(t); g_free(dense); g_free(csr);
+}
+
+static gboolean prep_est_done_idle(gpointer data) {
+    PrepEstJob *j = (PrepEstJob*)data;
+    EnvCtx *ctx = j->ctx;
+    prep_stats_free((PrepStats*)ctx->prep_est);
+    ctx->prep_est = j->st;
+    ctx->prep_est_job = NULL;
+    g_free(j->csv_path); g_free(j->xspec); g_free(j->yname);
+    g_free(j);
+    prep_est_refresh(ctx);
+    return G_SOURCE_REMOVE;
+}
+
+static void on_prep_est_changed(GtkWidget *w, gpointer user_data) {
+    (void)w;
+    prep_est_refresh((EnvCtx*)user_data);
+}
+
+/* relatório no formato do print_classification_report do trainer */
+static gchar* classification_report_text(const int *yt, const int *yp, int n, GPtrArray *names) {
+    int C = (int)names->len;
+    int *cm = g_new0(int, (gsize)C * C), hit = 0, cmax = 0, namew = 5;
+    for (int i = 0; i < n; ++i) { cm[yt[i] * C + yp[i]]++; hit += yt[i] == yp[i]; }
+    for (int k = 0; k < C * C; ++k) cmax = MAX(cmax, cm[k]);
+    for (int c = 0; c < C; ++c) namew = MAX(namew, (int)strlen(names->pdata[c]));
+    int cellw = MAX(3, (int)g_snprintf(NULL, 0, "%d", cmax));
+    double acc = n ? (double)hit / n : 0.0;
+
+    GString *s = g_string_new("=== Classification Report ===\n");
+    g_string_append_printf(s, "accuracy: %.4f\n%-18s %7s %7s %7s %8s\n", acc, "class", "prec", "rec", "f1", "support");
+    for (int c = 0; c < C; ++c) {
+        int tp = cm[c * C + c], col = 0, row = 0;
+        for (int k = 0; k < C; ++k) { col += cm[k * C + c]; row += cm[c * C + k]; }
+        double prec = tp / (col + 1e-12), rec = tp / (row + 1e-12), f1 = 2 * prec * rec / (prec + rec + 1e-12);
+        g_string_append_printf(s, "%-18s %7.4f %7.4f %7.4f %8d\n", (char*)names->pdata[c], prec, rec, f1, row);
+    }
+    g_string_append(s, "\nConfusion Matrix (rows=true, cols=pred):\n");
+    g_string_append_printf(s, "%*s", namew + 2, "");
+    for (int c = 0; c < C; ++c) g_string_append_printf(s, "%s%*s", c ? " " : "", cellw, (char*)names->pdata[c]);
+    g_string_append_c(s, '\n');
+    for (int r = 0; r < C; ++r) {
+        g_string_append_printf(s, "%*s | ", namew, (char*)names->pdata[r]);
+        for (int c = 0; c < C; ++c) g_string_append_printf(s, "%s%*d", c ? " " : "", cellw, cm[r * C + c]);
+        g_string_append_c(s, '\n');
+    }
+    g_string_append_printf(s, "\nOverall accuracy: %.4f", acc);
+    g_free(cm);
+    return g_string_free(s, FALSE);
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static gchar* regression_report_text(const double *yt, const double *yp, int n, double *r2_out) {
+    double mu = 0.0, ss_res = 0.0, ss_tot = 0.0, mae = 0.0;
+    for (int i = 0; i < n; ++i) mu += yt[i];
+    mu /= MAX(1, n);
+    for (int i = 0; i < n; ++i) {
+        double e = yt[i] - yp[i];
+        ss_res += e * e; ss_tot += (yt[i] - mu) * (yt[i] - mu); mae += fabs(e);
+    }
+    double mse = ss_res / MAX(1, n), r2 = 1.0 - ss_res / (ss_tot > 0 ? ss_tot : 1.0);
+    *r2_out = r2;
+    return g_strdup_printf("=== Regression Metrics ===\nR²  : %.6f\nMAE  : %.6f\nMSE  : %.6f\nRMSE : %.6f",
+                           r2, mae / MAX(1, n), mse, sqrt(mse));
+}
+
+static gboolean train_done_idle(gpointer data) {
+    TrainJob *j = (TrainJob*)data;
+    EnvCtx *ctx = j->ctx;
+    train_drain_rows(j);
+    ctx->train_job = NULL;
+
+    if (j->fallback) {
+        append_log(ctx, "[native] %s -> trainer Python", j->note);
+        start_trainer(ctx);
+        train_job_free(j);
+        return G_SOURCE_REMOVE;
+    }
+    if (j->err) {
+        append_log(ctx, "[native] erro: %s", j->err);
+        if (ctx->status) gtk_label_set_text(ctx->status, "Idle");
+    } else {
+        append_log(ctx, "[native] %s: %d linhas x %d colunas, score=%.4f em %.0f ms (%d threads)%s",
+                   j->algo, j->n, j->d, j->score, j->secs * 1e3, aifd_num_threads(0),
+                   j->rc == AIFD_CANCELLED ? " (parado: modelo parcial)" : "");
+        if (j->note) append_log(ctx, "[native] %s", j->note);
+        if (ctx->status)   gtk_label_set_text(ctx->status, j->rc == AIFD_CANCELLED ? "Cancelled" : "Done");
+        if (ctx->progress) gtk_progress_bar_set_fraction(ctx->progress, 1.0);
+        poll_fit_image_cb(ctx);
+        if (ctx->right_nb && ctx->plot_page_idx >= 0) gtk_notebook_set_current_page(ctx->right_nb, ctx->plot_page_idx);
+    }
+    train_job_free(j);
+    return G_SOURCE_REMOVE;
+}
+
+/* hiperparâmetros do painel MLP (mesmos padrões do trainer) */
+static void train_mlp_opts(const TrainJob *j, int d, gboolean clf, aifd_mlp_opts *o) {
+    aifd_mlp_defaults(o);
+    o->hidden = (int)json_num(j->hp, "hidden", MAX(clf ? 8 : 16, 2 * d));
+    o->layers = (int)json_num(j->hp, "layers", 2);
+    o->lr     = json_num(j->hp, "lr", clf ? 5e-2 : 5e-3);
+    int bs    = (int)json_num(j->hp, "batch_size", 0);
+    o->batch  = bs > 0 ? bs : 64;   /* 0 no painel = padrão do engine (o torch usa lote inteiro) */
+    o->epochs = MAX(1, j->epochs);
+    const cJSON *act = cJSON_GetObjectItemCaseSensitive(j->hp, "activation");
+    const cJSON *opt = cJSON_GetObjectItemCaseSensitive(j->hp, "optimizer");
+    if (cJSON_IsString(act) && g_ascii_strcasecmp(act->valuestring, "tanh") == 0) o->act = AIFD_ACT_TANH;
+    if (cJSON_IsString(opt) && g_ascii_strcasecmp(opt->valuestring, "sgd") == 0)  o->optimizer = AIFD_OPT_SGD;
+}
+
+/* dt_*: uma árvore inteira; rf_*: bootstrap + sqrt(d) colunas por nó (classes) */
+static void train_forest_opts(const TrainJob *j, aifd_forest_opts *o) {
+    gboolean rf = g_str_has_prefix(j->algo, "rf_");
+    aifd_forest_defaults(o);
+    o->n_trees      = rf ? MAX(1, (int)json_num(j->hp, "n_estimators", 200)) : 1;
+    o->max_depth    = (int)json_num(j->hp, "max_depth", 0);
+    o->max_features = rf ? json_num(j->hp, "max_features", 0.0) : 1.0;
+    o->bootstrap    = rf;
+    o->seed         = (unsigned long long)json_num(j->hp, "seed", 42);
+}
+
+/* gb_*: padrões do HistGradientBoosting (31 folhas, 20 linhas por folha) */
+static void train_gbdt_opts(const TrainJob *j, aifd_gbdt_opts *o) {
+    aifd_gbdt_defaults(o);
+    o->rounds     = MAX(1, (int)json_num(j->hp, "n_estimators", 100));
+    o->lr         = json_num(j->hp, "learning_rate", 0.1);
+    o->max_leaves = MAX(2, (int)json_num(j->hp, "max_leaf_nodes", 31));
+    o->max_depth  = (int)json_num(j->hp, "max_depth", 0);
+    o->min_leaf   = MAX(1, (int)json_num(j->hp, "min_samples_leaf", 20));
+}
+
+/* knn_*: algorithm do painel (auto/kd_tree/hnsw/brute) */
+static void train_knn_opts(const TrainJob *j, aifd_knn_opts *o) {
+    aifd_knn_defaults(o);
+    o->ef = MAX(1, (int)json_num(j->hp, "ef", 64));
+    const cJSON *a = cJSON_GetObjectItemCaseSensitive(j->hp, "algorithm");
+    if (!cJSON_IsString(a)) return;
+    if (g_strcmp0(a->valuestring, "kd_tree") == 0)   o->algo = AIFD_KNN_KD;
+    else if (g_strcmp0(a->valuestring, "hnsw") == 0)  o->algo = AIFD_KNN_HNSW;
+    else if (g_strcmp0(a->valuestring, "brute") == 0) o->algo = AIFD_KNN_BRUTE;
+}
+
+static gpointer train_worker(gpointer data) {
+    TrainJob *j = (TrainJob*)data;
+    EnvCtx *ctx = j->ctx;
+    double t0 = aifd_now();
+    gboolean clf = g_strcmp0(j->algo, "logreg") == 0 || g_str_has_suffix(j->algo, "_cls");
+    gboolean mlp = g_str_has_prefix(j->algo, "mlp_");
+    gboolean tree = g_str_has_prefix(j->algo, "dt_") || g_str_has_prefix(j->algo, "rf_");
+    gboolean gb = g_str_has_prefix(j->algo, "gb_");
+    gboolean knn = g_str_has_prefix(j->algo, "knn_");
+    int kn = 0;
+    aifd_forest forest = {0};
+    aifd_gbdt boost = {0};
+    aifd_knn index = {0};
+    NumMatrix *m = num_matrix_from_csv(j->csv_path, j->xspec, j->yname, FALSE, &j->err);
+    double *Xtr = NULL, *Xte = NULL, *ytr = NULL, *yte = NULL, *W = NULL, *Z = NULL, *pred = NULL;
+    float *F = NULL;
+    int *itr = NULL, *ite = NULL, *ipred = NULL, *perm = NULL, k = 0;
+    GPtrArray *cls = NULL;
+    if (!m) goto done;
+
+    if (!m->y && (!j->yname || !*g_strstrip(j->yname))) { j->err = g_strdup("defina a coluna Y"); goto done; }
+    if (!m->y) {   /* várias colunas Y ou nome aproximado: o trainer resolve */
+        j->fallback = TRUE; j->note = g_strdup_printf("coluna Y \"%s\" resolvida no trainer", j->yname); goto done;
+    }
+    if (m->x_codes && !j->onehot) {
+        j->fallback = TRUE; j->note = g_strdup("X tem colunas categóricas e o one-hot está desligado"); goto done;
+    }
+    if (m->x_codes && j->buckets > 0) {
+        j->fallback = TRUE; j->note = g_strdup("hashing das categóricas"); goto done;
+    }
+    if (m->x_codes) {   /* one-hot denso (double) grande demais: o trainer monta CSR */
+        PrepStats *ps = prep_stats_from(m);
+        double mb = (double)m->n * (double)prep_stats_width(ps, j->impute, TRUE, 0) * sizeof(double) / 1048576.0;
+        prep_stats_free(ps);
+        if (mb > NATIVE_ONEHOT_MAX_MB) {
+            j->fallback = TRUE; j->note = g_strdup_printf("one-hot denso de %.0f MB", mb); goto done;
+        }
+    }
+    const cJSON *es = cJSON_GetObjectItemCaseSensitive(j->hp, "early_stopping");
+    if ((tree || gb) && cJSON_IsString(es) && g_strcmp0(es->valuestring, "on") == 0) {
+        j->fallback = TRUE; j->note = g_strdup("early stopping (validação por estágios no trainer)"); goto done;
+    }
+
+    /* imputa/escala/one-hot ajustados no frame inteiro, como o trainer; depois descarta linhas sem alvo */
+    if (!num_matrix_prep(m, j->impute, j->scale, &j->err)) goto done;
+    int n = 0, d = m->d;
+    for (int i = 0; i < m->n; ++i)
+        if (!isnan(m->y[i])) {
+            if (n != i) { memmove(m->X + (gsize)n * d, m->X + (gsize)i * d, sizeof(double) * d); m->y[n] = m->y[i]; }
+            n++;
+        }
+    m->n = n;
+    if (n < 3) { j->err = g_strdup("poucas linhas com Y"); goto done; }
+    if (!clf && m->y_categorical) { j->err = g_strdup("Y categórico: use um modelo de classificação"); goto done; }
+
+    /* classes: texto na ordem de aparição; numéricas em ordem crescente */
+    cls = g_ptr_array_new_with_free_func(g_free);
+    if (clf) {
+        if (m->y_categorical) {
+            for (guint c = 0; c < m->y_classes->len; ++c) g_ptr_array_add(cls, g_strdup(m->y_classes->pdata[c]));
+        } else {
+            double *u = g_new(double, n);
+            memcpy(u, m->y, sizeof(double) * n);
+            int nu = 0;
+            qsort(u, n, sizeof(double), cmp_double);
+            for (int i = 0; i < n; ++i) if (i == 0 || u[i] != u[i - 1]) u[nu++] = u[i];
+            if (nu > 100) { g_free(u); j->err = g_strdup("Y contínuo: use um modelo de regressão"); goto done; }
+            for (int c = 0; c < nu; ++c) g_ptr_array_add(cls, g_strdup_printf("%g", u[c]));
+            for (int i = 0; i < n; ++i) {
+                int lo = 0, hi = nu - 1;
+                while (lo < hi) { int mid = (lo + hi) / 2; if (u[mid] < m->y[i]) lo = mid + 1; else hi = mid; }
+                m->y[i] = lo;
+            }
+            g_free(u);
+        }
+        k = (int)cls->len;
+        if (k < 2) { j->err = g_strdup("Y precisa de ao menos 2 classes"); goto done; }
+    }
+
+    /* split embaralhado com semente fixa (mesmo train_pct do trainer) */
+    perm = g_new(int, n);
+    for (int i = 0; i < n; ++i) perm[i] = i;
+    unsigned long long seed = 123;
+    for (int i = n - 1; i > 0; --i) { int r = (int)(aifd_rng_next(&seed) % (unsigned long long)(i + 1)); int t = perm[i]; perm[i] = perm[r]; perm[r] = t; }
+    int ntr = CLAMP((int)lround(j->train_pct * n), 1, n - 1), nte = n - ntr;
+    Xtr = g_new(double, (gsize)ntr * d); Xte = g_new(double, (gsize)nte * d);
+    ytr = g_new(double, ntr);            yte = g_new(double, nte);
+    for (int i = 0; i < n; ++i) {
+        int src = perm[i];
+        double *dst = i < ntr ? Xtr + (gsize)i * d : Xte + (gsize)(i - ntr) * d;
+        memcpy(dst, m->X + (gsize)src * d, sizeof(double) * d);
+        if (i < ntr) ytr[i] = m->y[src]; else yte[i - ntr] = m->y[src];
+    }
+    j->n = n; j->d = d;
+
+    Z = g_new(double, 2 * (gsize)nte);
+    aifd_mlp_opts mo;
+    if (mlp) {
+        train_mlp_opts(j, d, clf, &mo);
+        F = g_new(float, aifd_mlp_param_count(d, mo.hidden, mo.layers, k));
+        j->rc = aifd_mlp_fit(Xtr, ntr, d, ytr, k, &mo, F, train_fit_cb, j);
+        if (j->rc == AIFD_EINVAL) { j->err = g_strdup("MLP divergiu (learning rate alto demais?)"); goto done; }
+        if (j->rc < 0) goto done;
+    } else if (tree) {
+        aifd_forest_opts fo;
+        train_forest_opts(j, &fo);
+        j->rc = aifd_forest_fit(Xtr, ntr, d, ytr, k, &fo, &forest, train_fit_cb, j);
+        if (j->rc < 0) goto done;
+    } else if (gb) {
+        aifd_gbdt_opts go;
+        train_gbdt_opts(j, &go);
+        j->rc = aifd_gbdt_fit(Xtr, ntr, d, ytr, k, NULL, &go, &boost, train_fit_cb, j);
+        if (j->rc < 0) goto done;
+    } else if (knn) {
+        aifd_knn_opts ko;
+        train_knn_opts(j, &ko);
+        kn = MAX(1, (int)json_num(j->hp, "n_neighbors", 7));
+        j->rc = aifd_knn_build(Xtr, ntr, d, &ko, &index);
+        if (j->rc < 0) goto done;
+        static const char *names[] = { "auto", "força bruta", "KD-tree", "HNSW" };
+        j->note = g_strdup_printf("índice KNN: %s", names[index.algo]);
+    }
+    if (clf) {
+        itr = g_new(int, ntr); ite = g_new(int, nte); ipred = g_new(int, nte);
+        for (int i = 0; i < ntr; ++i) itr[i] = (int)ytr[i];
+        for (int i = 0; i < nte; ++i) ite[i] = (int)yte[i];
+        if (mlp || tree || gb || knn) {
+            int K = tree || knn ? k : aifd_mlp_outputs(k);   /* gbdt: mesmas saídas do MLP */
+            double *prob = g_new(double, (gsize)nte * K);
+            if (tree)     aifd_forest_predict(&forest, Xte, nte, d, prob, 0);
+            else if (knn) j->rc = aifd_knn_predict(&index, ytr, k, Xte, nte, kn, 0, prob, 0);
+            else if (gb)  aifd_gbdt_predict(&boost, Xte, nte, d, 0, prob, 0);
+            else          aifd_mlp_predict(Xte, nte, d, k, mo.hidden, mo.layers, mo.act, F, prob, mo.threads);
+            for (int i = 0; i < nte; ++i) {
+                const double *p = prob + (gsize)i * K;
+                int best = 0;
+                for (int c = 1; c < K; ++c) if (p[c] > p[best]) best = c;
+                ipred[i] = K == 1 ? p[0] >= 0.5 : best;
+            }
+            g_free(prob);
+            if (j->rc < 0) goto done;
+        } else {
+            aifd_logreg_opts o;
+            aifd_logreg_defaults(&o);
+            o.C        = json_num(j->hp, "C", 1.0);
+            o.max_iter = (int)json_num(j->hp, "max_iter", 200);
+            const cJSON *pen = cJSON_GetObjectItemCaseSensitive(j->hp, "penalty");
+            o.l1 = cJSON_IsString(pen) && g_ascii_strcasecmp(pen->valuestring, "L1") == 0;
+            W = g_new0(double, (gsize)(k == 2 ? 1 : k) * (d + 1));
+            j->rc = aifd_logreg_fit(Xtr, ntr, d, itr, k, &o, W, train_fit_cb, j);
+            if (j->rc < 0) goto done;
+            aifd_logreg_predict(Xte, nte, d, W, k, ipred);
+        }
+        j->metrics = classification_report_text(ite, ipred, nte, cls);
+        int hit = 0;
+        for (int i = 0; i < nte; ++i) hit += ite[i] == ipred[i];
+        j->score = (double)hit / nte;
+        /* plot: teste projetado (PCA nativa) colorido pela classe prevista */
+        pred = g_new(double, nte);
+        for (int i = 0; i < nte; ++i) pred[i] = ipred[i];
+        if (d >= 2) aifd_pca2(Xte, nte, d, Z, 0);
+        else for (int i = 0; i < nte; ++i) { Z[2*i] = Xte[i]; Z[2*i+1] = yte[i]; }
+    } else {
+        pred = g_new(double, nte);
+        if (mlp) {
+            aifd_mlp_predict(Xte, nte, d, 0, mo.hidden, mo.layers, mo.act, F, pred, mo.threads);
+        } else if (tree) {
+            aifd_forest_predict(&forest, Xte, nte, d, pred, 0);
+        } else if (gb) {
+            aifd_gbdt_predict(&boost, Xte, nte, d, 0, pred, 0);
+        } else if (knn) {
+            j->rc = aifd_knn_predict(&index, ytr, 0, Xte, nte, kn, 0, pred, 0);
+            if (j->rc < 0) goto done;
+        } else {
+            aifd_linear_opts o;
+            aifd_linear_defaults(&o);
+            o.kind  = g_strcmp0(j->algo, "ridge") == 0 ? AIFD_LIN_RIDGE
+                    : g_strcmp0(j->algo, "lasso") == 0 ? AIFD_LIN_LASSO : AIFD_LIN_OLS;
+            /* alpha na escala do trainer (MSE médio + weight_decay do Adam / L1 somado):
+               ridge  (1/n)||r||² + (a/2)||w||²  ->  ||r||² + (n·a/2)||w||²
+               lasso  (1/n)||r||² + a·||w||₁     ->  ||r||²/(2n) + (a/2)||w||₁ */
+            double a = json_num(j->hp, "alpha", 1e-2);
+            o.alpha = o.kind == AIFD_LIN_RIDGE ? a * ntr / 2.0 : a / 2.0;
+            W = g_new0(double, d + 1);
+            j->rc = aifd_linear_fit(Xtr, ntr, d, ytr, &o, W, W + d, train_fit_cb, j);
+            if (j->rc < 0) goto done;
+            aifd_linear_predict(Xte, nte, d, W, W[d], pred);
+        }
+        j->metrics = regression_report_text(yte, pred, nte, &j->score);
+        /* plot: real x previsto, cor = |resíduo| */
+        for (int i = 0; i < nte; ++i) { Z[2*i] = yte[i]; Z[2*i+1] = pred[i]; pred[i] = fabs(yte[i] - pred[i]); }
+    }
+    j->secs = aifd_now() - t0;
+
+    gchar *title = g_strdup_printf("%s (nativo)  %s=%.4f  train=%d test=%d  %.0f ms%s", j->algo,
+                                   clf ? "acc" : "R²", j->score, ntr, nte, j->secs * 1e3,
+                                   clf ? "" : "   x: real  y: previsto");
+    if (ctx->fit_img_path && !render_scatter_png(ctx->fit_img_path, Z, nte, pred, clf, title))
+        { g_free(j->note); j->note = g_strdup("falha ao gravar o PNG do plot"); }
+    g_free(title);
+    if (ctx->metrics_path && j->metrics) g_file_set_contents(ctx->metrics_path, j->metrics, -1, NULL);
+
+done:
+    if (j->rc < 0 && !j->err) j->err = g_strdup_printf("rotina nativa falhou (rc=%d)", j->rc);
+    if (cls) g_ptr_array_free(cls, TRUE);
+    g_free(Xtr); g_free(Xte); g_free(ytr); g_free(yte); g_free(W); g_free(Z); g_free(pred);
+    g_free(itr); g_free(ite); g_free(ipred); g_free(perm); g_free(F);
+    aifd_forest_free(&forest);
+    aifd_gbdt_free(&boost);
+    aifd_knn_free(&index);
+    num_matrix_free(m);
+    g_idle_add(train_done_idle, j);
+    return NULL;
+}
+
+/* Stop: o solver para na próxima iteração e o modelo parcial é avaliado */
+static gboolean native_train_cancel(EnvCtx *ctx) {
+    if (!ctx->train_job) return FALSE;
+    g_atomic_int_set(&((TrainJob*)ctx->train_job)->cancel, 1);
+    return TRUE;
+}
+
+/* Start: lineares, Logistic, MLPs, árvores/boosting e KNN rodam aqui quando "Native engine" está marcado.
+   FALSE = não se aplica (o chamador sobe o trainer Python). */
+static gboolean native_train_try_start(EnvCtx *ctx) {
+    const char *algo = algo_to_flag(GTK_COMBO_BOX_TEXT(ctx->algo_combo));
+    GtkToggleButton *chk = ctx->model_box ? g_object_get_data(G_OBJECT(ctx->model_box), "native_check") : NULL;
+    if (!native_train_supported(algo) || !chk || !gtk_toggle_button_get_active(chk)) return FALSE;
+    if (!ctx->current_dataset_path) return FALSE;
+
+    TrainJob *j = g_new0(TrainJob, 1);
+    j->ctx       = ctx;
+    j->csv_path  = g_strdup(ctx->current_dataset_path);
+    j->xspec     = g_strdup(ctx->x_feat ? gtk_entry_get_text(ctx->x_feat) : "");
+    j->yname     = g_strdup(ctx->y_feat ? gtk_entry_get_text(ctx->y_feat) : "");
+    j->algo      = g_strdup(algo);
+    j->train_pct = gtk_range_get_value(GTK_RANGE(ctx->split_scale)) / 100.0;
+    j->epochs    = gtk_spin_button_get_value_as_int(ctx->epochs_spin);
+    j->scale     = AIFD_SCALE_STANDARD;
+    j->impute    = AIFD_IMPUTE_MEAN;
+    j->onehot    = TRUE;
+    j->rows      = g_array_new(FALSE, FALSE, sizeof(FitRow));
+    g_mutex_init(&j->lock);
+
+    GtkComboBoxText *cmb_scale  = g_object_get_data(G_OBJECT(ctx->preproc_box), "scale_combo");
+    GtkComboBoxText *cmb_impute = g_object_get_data(G_OBJECT(ctx->preproc_box), "impute_combo");
+    GtkToggleButton *chk_onehot = g_object_get_data(G_OBJECT(ctx->preproc_box), "onehot_check");
+    if (cmb_scale) {
+        gchar *t = gtk_combo_box_text_get_active_text(cmb_scale);
+        if (t) j->scale = g_str_has_prefix(t, "Standard") ? AIFD_SCALE_STANDARD
+                        : g_str_has_prefix(t, "Min-Max") ? AIFD_SCALE_MINMAX : AIFD_SCALE_NONE;
+        g_free(t);
+    }
+    if (cmb_impute) {
+        gchar *t = gtk_combo_box_text_get_active_text(cmb_impute);
+        if (t) j->impute = g_str_has_suffix(t, "median")        ? AIFD_IMPUTE_MEDIAN
+                         : g_str_has_suffix(t, "most_frequent") ? AIFD_IMPUTE_MOST_FREQUENT
+                         : g_str_has_suffix(t, "zero")          ? AIFD_IMPUTE_ZERO : AIFD_IMPUTE_MEAN;
+        g_free(t);
+    }
+    if (chk_onehot) j->onehot = gtk_toggle_button_get_active(chk_onehot);
+    GtkSpinButton *sp_hash = g_object_get_data(G_OBJECT(ctx->preproc_box), "hash_spin");
+    if (sp_hash) j->buckets = gtk_spin_button_get_value_as_int(sp_hash);
+    char *hp = build_hparams_json(ctx);
+    j->hp = cJSON_Parse(hp && *hp ? hp : "{}");
+    if (!j->hp) j->hp = cJSON_CreateObject();
+    free(hp);
+
+    ctx->train_job = j;
+    append_log(ctx, "[start] model=%s (nativo)  train%%=%.1f", algo, j->train_pct * 100.0);
+    if (ctx->status) gtk_label_set_text(ctx->status, "Training (native)…");
+    g_thread_unref(g_thread_new("train_worker", train_worker, j));
+    return TRUE;
+}
 
 /* Slider mudou -> atualiza labels e entry */
 static void on_split_changed(GtkRange *range, gpointer user_data) {
@@ -1306,6 +2990,19 @@ static void destroy_all_children(GtkWidget *box) {
     g_list_free(ch);
 }
 
+// early stopping dos ensembles (RF/GB): linha off/on na grade de hiperparâmetros
+static void attach_early_stopping(EnvCtx *ctx, GtkWidget *grid, int *r) {
+    GtkWidget *cb = gtk_combo_box_text_new();
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb), "off");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb), "on");
+    gtk_combo_box_set_active(GTK_COMBO_BOX(cb), 0);
+    gtk_grid_attach(GTK_GRID(grid), gtk_label_new("early_stopping"), 0, *r, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), cb,                              1, (*r)++, 1, 1);
+    g_object_set_data(G_OBJECT(cb), "hp-key", "early_stopping");
+    env_bind_desc(ctx, cb, "early_stopping: separa 10% do treino para validação e para de crescer o ensemble "
+                           "quando o score não melhora por 3 estágios (n_estimators vira o máximo).");
+}
+
 // reconstrói a UI de hyperparâmetros conforme o modelo escolhido
 static void rebuild_hparams_ui(EnvCtx *ctx) {
     if (!ctx || !ctx->model_params_box || !ctx->algo_combo) return;
@@ -1330,6 +3027,12 @@ static void rebuild_hparams_ui(EnvCtx *ctx) {
         gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_act), "relu");
         gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_act), "tanh");
         gtk_combo_box_set_active(GTK_COMBO_BOX(cb_act), 0);
+        GtkWidget *cb_opt = gtk_combo_box_text_new();
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_opt), "adam");
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_opt), "sgd");
+        gtk_combo_box_set_active(GTK_COMBO_BOX(cb_opt), 0);
+        GtkWidget *sp_batch = gtk_spin_button_new_with_range(0, 65536, 16);
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(sp_batch), 0);
 
         gtk_grid_attach(GTK_GRID(grid), gtk_label_new("Hidden units"), 0, r, 1, 1);
         gtk_grid_attach(GTK_GRID(grid), sp_hidden,                    1, r++, 1, 1);
@@ -1339,16 +3042,24 @@ static void rebuild_hparams_ui(EnvCtx *ctx) {
         gtk_grid_attach(GTK_GRID(grid), ent_lr,                       1, r++, 1, 1);
         gtk_grid_attach(GTK_GRID(grid), gtk_label_new("Activation"),  0, r, 1, 1);
         gtk_grid_attach(GTK_GRID(grid), cb_act,                       1, r++, 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), gtk_label_new("Optimizer"),   0, r, 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), cb_opt,                       1, r++, 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), gtk_label_new("Batch size"),  0, r, 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), sp_batch,                     1, r++, 1, 1);
 
         g_object_set_data(G_OBJECT(sp_hidden), "hp-key", "hidden");
         g_object_set_data(G_OBJECT(sp_layers), "hp-key", "layers");
         g_object_set_data(G_OBJECT(ent_lr),    "hp-key", "lr");
         g_object_set_data(G_OBJECT(cb_act),    "hp-key", "activation");
+        g_object_set_data(G_OBJECT(cb_opt),    "hp-key", "optimizer");
+        g_object_set_data(G_OBJECT(sp_batch),  "hp-key", "batch_size");
 
         env_bind_desc(ctx, sp_hidden, "Hidden units: largura das camadas internas. Mais alto = mais capacidade (cuidado com overfitting).");
         env_bind_desc(ctx, sp_layers, "Layers: número de camadas densas. Aumenta profundidade e custo.");
         env_bind_desc(ctx, ent_lr,    "Learning rate: passo do otimizador. Dica: 1e-3 é ponto inicial clássico.");
         env_bind_desc(ctx, cb_act,    "Activation: função de ativação (relu/tanh).");
+        env_bind_desc(ctx, cb_opt,    "Optimizer: Adam (adaptativo, padrão) ou SGD com momentum 0.9. Usado pelo engine nativo.");
+        env_bind_desc(ctx, sp_batch,  "Batch size: linhas por passo do otimizador (torch e engine nativo). 0 = padrão: lote inteiro no torch, 64 no engine nativo.");
 
     } else if (g_strcmp0(flag, "logreg") == 0) {
         GtkWidget *ent_C = gtk_entry_new();
@@ -1391,9 +3102,39 @@ static void rebuild_hparams_ui(EnvCtx *ctx) {
 
         env_bind_desc(ctx, sp_n,   "n_estimators: número de árvores. Mais árvores = melhor estabilidade, maior custo.");
         env_bind_desc(ctx, sp_seed,"seed: semente para reprodutibilidade.");
+        attach_early_stopping(ctx, grid, &r);
 
-    } else if (g_strcmp0(flag, "dt_cls") == 0 || g_strcmp0(flag, "dt_reg") == 0
-            || g_strcmp0(flag, "gb_cls") == 0 || g_strcmp0(flag, "gb_reg") == 0) {
+    } else if (g_strcmp0(flag, "gb_cls") == 0 || g_strcmp0(flag, "gb_reg") == 0) {
+        GtkWidget *sp_n = gtk_spin_button_new_with_range(1, 10000, 1);
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(sp_n), 100);
+        GtkWidget *ent_lr = gtk_entry_new();
+        gtk_entry_set_text(GTK_ENTRY(ent_lr), "0.1");
+        GtkWidget *sp_leaves = gtk_spin_button_new_with_range(2, 4096, 1);
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(sp_leaves), 31);
+        GtkWidget *sp_seed = gtk_spin_button_new_with_range(0, 999999, 1);
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(sp_seed), 42);
+
+        gtk_grid_attach(GTK_GRID(grid), gtk_label_new("n_estimators"),  0, r, 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), sp_n,                           1, r++, 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), gtk_label_new("Learning rate"), 0, r, 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), ent_lr,                         1, r++, 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), gtk_label_new("Max leaves"),    0, r, 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), sp_leaves,                      1, r++, 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), gtk_label_new("seed"),          0, r, 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), sp_seed,                        1, r++, 1, 1);
+
+        g_object_set_data(G_OBJECT(sp_n),      "hp-key", "n_estimators");
+        g_object_set_data(G_OBJECT(ent_lr),    "hp-key", "learning_rate");
+        g_object_set_data(G_OBJECT(sp_leaves), "hp-key", "max_leaf_nodes");
+        g_object_set_data(G_OBJECT(sp_seed),   "hp-key", "seed");
+
+        env_bind_desc(ctx, sp_n,      "n_estimators: rodadas de boosting (uma árvore por rodada; k árvores com k classes).");
+        env_bind_desc(ctx, ent_lr,    "Learning rate: peso de cada árvore nova. Menor = mais rodadas, em geral melhor generalização.");
+        env_bind_desc(ctx, sp_leaves, "Max leaves: folhas por árvore no engine nativo (cresce pela folha de maior ganho).");
+        env_bind_desc(ctx, sp_seed,   "seed: semente para reprodutibilidade (sklearn).");
+        attach_early_stopping(ctx, grid, &r);
+
+    } else if (g_strcmp0(flag, "dt_cls") == 0 || g_strcmp0(flag, "dt_reg") == 0) {
         GtkWidget *sp_seed = gtk_spin_button_new_with_range(0, 999999, 1);
         gtk_spin_button_set_value(GTK_SPIN_BUTTON(sp_seed), 42);
 
@@ -1408,12 +3149,25 @@ static void rebuild_hparams_ui(EnvCtx *ctx) {
         GtkWidget *sp_k = gtk_spin_button_new_with_range(1, 2048, 1);
         gtk_spin_button_set_value(GTK_SPIN_BUTTON(sp_k), 7);
 
+        GtkWidget *cb_algo = gtk_combo_box_text_new();
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_algo), "auto");
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_algo), "kd_tree");
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_algo), "hnsw");
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_algo), "brute");
+        gtk_combo_box_set_active(GTK_COMBO_BOX(cb_algo), 0);
+
         gtk_grid_attach(GTK_GRID(grid), gtk_label_new("n_neighbors"), 0, r, 1, 1);
         gtk_grid_attach(GTK_GRID(grid), sp_k,                         1, r++, 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), gtk_label_new("algorithm"),   0, r, 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), cb_algo,                      1, r++, 1, 1);
 
-        g_object_set_data(G_OBJECT(sp_k), "hp-key", "n_neighbors");
+        g_object_set_data(G_OBJECT(sp_k),    "hp-key", "n_neighbors");
+        g_object_set_data(G_OBJECT(cb_algo), "hp-key", "algorithm");
 
         env_bind_desc(ctx, sp_k, "n_neighbors: vizinhos para classificação/regressão. Dica: ímpar para classificação binária.");
+        env_bind_desc(ctx, cb_algo, "algorithm: índice de vizinhos. kd_tree = exato, bom até ~12 colunas; "
+                                    "hnsw = grafo aproximado para muitas colunas (nativo); brute = varre tudo; "
+                                    "auto escolhe pelo tamanho do dataset.");
 
     } else if (g_strcmp0(flag, "nb_cls") == 0) {
         gtk_grid_attach(GTK_GRID(grid), gtk_label_new("No specific hyperparameters."), 0, r++, 2, 1);
@@ -1455,6 +3209,28 @@ static void rebuild_hparams_ui(EnvCtx *ctx) {
         env_bind_desc(ctx, ent_C,     "C: penalidade por erro. Maior C = margem menor, ajusta mais o treino.");
         env_bind_desc(ctx, ent_g,     "gamma: alcance do kernel (rbf/poly/sigmoid). 'scale' usa 1/(n_features*var).");
 
+        GtkWidget *cb_approx = gtk_combo_box_text_new();
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_approx), "auto");
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_approx), "off");
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_approx), "nystroem");
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_approx), "rff");
+        gtk_combo_box_set_active(GTK_COMBO_BOX(cb_approx), 0);
+        GtkWidget *sp_comp = gtk_spin_button_new_with_range(10, 20000, 10);
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(sp_comp), 1000);
+
+        gtk_grid_attach(GTK_GRID(grid), gtk_label_new("approx"),       0, r, 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), cb_approx,                     1, r++, 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), gtk_label_new("n_components"), 0, r, 1, 1);
+        gtk_grid_attach(GTK_GRID(grid), sp_comp,                       1, r++, 1, 1);
+
+        g_object_set_data(G_OBJECT(cb_approx), "hp-key", "approx");
+        g_object_set_data(G_OBJECT(sp_comp),   "hp-key", "n_components");
+
+        env_bind_desc(ctx, cb_approx, "approx: kernel aproximado + SVM linear (O(n) em vez de O(n²)). "
+                                      "auto liga acima de 20000 linhas de treino; nystroem = qualquer kernel; "
+                                      "rff = random Fourier features (só rbf). A aproximação aparece nas métricas.");
+        env_bind_desc(ctx, sp_comp,   "n_components: nº de features do mapa aproximado. Mais = mais perto do kernel exato, mais lento.");
+
         if (g_strcmp0(flag, "svm_reg") == 0) {
             GtkWidget *ent_eps = gtk_entry_new(); gtk_entry_set_text(GTK_ENTRY(ent_eps), "0.1");
             gtk_grid_attach(GTK_GRID(grid), gtk_label_new("epsilon"), 0, r, 1, 1);
@@ -1465,7 +3241,7 @@ static void rebuild_hparams_ui(EnvCtx *ctx) {
 
     } else if (g_strcmp0(flag, "ridge") == 0 || g_strcmp0(flag, "lasso") == 0) {
         GtkWidget *ent_alpha = gtk_entry_new();
-        gtk_entry_set_text(GTK_ENTRY(ent_alpha), "1.0");
+        gtk_entry_set_text(GTK_ENTRY(ent_alpha), "0.01");
         gtk_grid_attach(GTK_GRID(grid), gtk_label_new("alpha"), 0, r, 1, 1);
         gtk_grid_attach(GTK_GRID(grid), ent_alpha,              1, r++, 1, 1);
         g_object_set_data(G_OBJECT(ent_alpha), "hp-key", "alpha");
@@ -1480,9 +3256,26 @@ static void rebuild_hparams_ui(EnvCtx *ctx) {
     gtk_widget_show_all(ctx->model_params_box);
 }
 
+/* refaz as faixas do sweep a partir do painel atual (chaves mudam com o modelo) */
+static void sweep_refill_space(EnvCtx *ctx) {
+    GtkEntry *ent = ctx->model_box ? g_object_get_data(G_OBJECT(ctx->model_box), "sweep_space") : NULL;
+    if (!ent || !sweep_mode_flag(ctx)) return;
+    gchar *spec = sweep_space_from_panel(ctx);
+    gtk_entry_set_text(ent, spec);
+    g_free(spec);
+}
+
+static void on_sweep_mode_changed(GtkComboBox *box, gpointer user_data) {
+    (void)box;
+    EnvCtx *ctx = (EnvCtx*)user_data;
+    GtkEntry *ent = g_object_get_data(G_OBJECT(ctx->model_box), "sweep_space");
+    if (ent && !*gtk_entry_get_text(ent)) sweep_refill_space(ctx);
+}
+
 static void on_algo_changed(GtkComboBox *box, gpointer user_data) {
     (void)box;
     rebuild_hparams_ui((EnvCtx*)user_data);
+    sweep_refill_space((EnvCtx*)user_data);
 }
 
 /* Build the Environment tab (LEFT controls | RIGHT notebook) */
@@ -1682,6 +3475,87 @@ void add_environment_tab(GtkNotebook *nb, EnvCtx *ctx) {
         gtk_box_pack_start(GTK_BOX(model_box), group_panel("Hyperparameters", ctx->model_params_box), FALSE, FALSE, 0);
         g_signal_connect(ctx->algo_combo, "changed", G_CALLBACK(on_algo_changed), ctx);
         rebuild_hparams_ui(ctx);
+
+        /* Cache: pedidos idênticos são reexibidos do cache; warm start reaproveita o último modelo da mesma família */
+        GtkWidget *chk_warm = gtk_check_button_new_with_label("Warm start from cached model");
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(chk_warm), FALSE);   /* opt-in: muda o resultado */
+        GtkWidget *warm_w = wrap_for_hover(ctx, chk_warm,
+            "Cache de modelos: mesmo dataset + features + pré-processamento + hiperparâmetros = resultado instantâneo.\n"
+            "Warm start: se só mudaram hiperparâmetros/épocas, começa do último modelo treinado (redes: pesos; RF/GB: árvores).");
+        gtk_box_pack_start(GTK_BOX(model_box), group_panel("Cache", warm_w), FALSE, FALSE, 0);
+        g_object_set_data(G_OBJECT(model_box), "warm_check", chk_warm);
+
+        /* Engine: lineares, Logistic e MLPs treinam in-process (src/native), sem subir o Python */
+        GtkWidget *chk_native = gtk_check_button_new_with_label("Native engine (in-process)");
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(chk_native), TRUE);
+        GtkWidget *native_w = wrap_for_hover(ctx, chk_native,
+            "Native engine: Linear/Ridge/Lasso (Cholesky / coordinate descent), Logistic (L-BFGS, OWL-QN p/ L1), MLPs\n"
+            "(minibatch Adam/SGD, GEMM em blocos AVX2), Decision Tree / Random Forest (histogramas, uma árvore por thread)\n"
+            "Gradient Boosting (histogramas uint8, árvores por folha, uma linha Fit por rodada) e KNN (KD-tree/HNSW)\n"
+            "rodam dentro do app, com a tabela Fit a cada iteração/época/árvore (score OOB na floresta).\n"
+            "Colunas categóricas ou imputação != mean vão para o trainer Python (MLPs, árvores e KNN continuam nativos lá).");
+        /* Workers: treino torch data-parallel (gloo em localhost), um processo por worker */
+        GtkWidget *workers_row = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
+        GtkWidget *sp_workers  = gtk_spin_button_new_with_range(1, 256, 1);
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(sp_workers), 1);
+        gtk_box_pack_start(GTK_BOX(workers_row), gtk_label_new("Workers"), FALSE, FALSE, 0);
+        gtk_box_pack_end  (GTK_BOX(workers_row), sp_workers, FALSE, FALSE, 0);
+        GtkWidget *workers_w = wrap_for_hover(ctx, workers_row,
+            "Workers: N processos treinam o modelo torch juntos; cada um pega uma fatia de cada lote\n"
+            "e os gradientes são somados (all-reduce gloo) antes de cada passo. Os núcleos são divididos entre eles.\n"
+            "Vale com o Native engine desligado; o log mostra o speedup e a eficiência de escala ([dp]).");
+        GtkWidget *engine_col = gtk_box_new(GTK_ORIENTATION_VERTICAL, 6);
+        gtk_box_pack_start(GTK_BOX(engine_col), native_w,  FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(engine_col), workers_w, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(model_box), group_panel("Engine", engine_col), FALSE, FALSE, 0);
+        g_object_set_data(G_OBJECT(model_box), "native_check", chk_native);
+        g_object_set_data(G_OBJECT(model_box), "workers_spin", sp_workers);
+
+        /* Sweep: vários trials do trainer ao mesmo tempo, cada um com uma fatia dos núcleos */
+        GtkWidget *sweep_grid = gtk_grid_new();
+        gtk_grid_set_row_spacing(GTK_GRID(sweep_grid), 6);
+        gtk_grid_set_column_spacing(GTK_GRID(sweep_grid), 6);
+        GtkWidget *cb_sweep = gtk_combo_box_text_new();
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_sweep), "Off");
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_sweep), "Grid");
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_sweep), "Random");
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_sweep), "Latin hypercube");
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_sweep), "Successive halving");
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(cb_sweep), "Hyperband");
+        gtk_combo_box_set_active(GTK_COMBO_BOX(cb_sweep), 0);
+        GtkWidget *sp_trials = gtk_spin_button_new_with_range(1, 1024, 1);
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(sp_trials), 32);
+        GtkWidget *sp_par = gtk_spin_button_new_with_range(0, 256, 1);
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(sp_par), 0);
+        GtkWidget *ent_space = gtk_entry_new();
+        gtk_entry_set_placeholder_text(GTK_ENTRY(ent_space), "lr=1e-4:1e-1:log; max_depth=2:12; activation=relu|tanh");
+        gtk_widget_set_hexpand(ent_space, TRUE);
+
+        int sr = 0;
+        gtk_grid_attach(GTK_GRID(sweep_grid), gtk_label_new("Mode"),     0, sr, 1, 1);
+        gtk_grid_attach(GTK_GRID(sweep_grid), cb_sweep,                  1, sr++, 1, 1);
+        gtk_grid_attach(GTK_GRID(sweep_grid), gtk_label_new("Trials"),   0, sr, 1, 1);
+        gtk_grid_attach(GTK_GRID(sweep_grid), sp_trials,                 1, sr++, 1, 1);
+        gtk_grid_attach(GTK_GRID(sweep_grid), gtk_label_new("Parallel"), 0, sr, 1, 1);
+        gtk_grid_attach(GTK_GRID(sweep_grid), sp_par,                    1, sr++, 1, 1);
+        gtk_grid_attach(GTK_GRID(sweep_grid), gtk_label_new("Ranges"),   0, sr, 1, 1);
+        gtk_grid_attach(GTK_GRID(sweep_grid), ent_space,                 1, sr++, 1, 1);
+
+        env_bind_desc(ctx, cb_sweep,  "Sweep: Grid (pontos regulares), Random ou Latin hypercube (cada faixa coberta por igual).\n"
+                                      "Successive halving: todos começam com 1/9 das épocas (ou das linhas) e só o terço melhor\n"
+                                      "de cada rodada continua, com 3x mais; Hyperband repete isso com pontos de partida diferentes.\n"
+                                      "Ranges aceita model=a|b para comparar algoritmos.\n"
+                                      "Start roda os trials e preenche a aba Leaderboard; Metrics/Plot mostram o melhor até agora.");
+        env_bind_desc(ctx, sp_trials, "Trials: quantas configurações testar (halving: quantas começam; Hyperband decide sozinho).");
+        env_bind_desc(ctx, sp_par,    "Parallel: trials ao mesmo tempo. 0 = um por núcleo; os núcleos são divididos entre eles (AIFD_THREADS).");
+        env_bind_desc(ctx, ent_space, "Ranges: chave=min:max (inteiros se as pontas forem inteiras), chave=min:max:log, chave=a|b|c.\n"
+                                      "Preenchido a partir dos hiperparâmetros acima; o que não aparece aqui fica com o valor do painel.");
+        g_signal_connect(cb_sweep, "changed", G_CALLBACK(on_sweep_mode_changed), ctx);
+        gtk_box_pack_start(GTK_BOX(model_box), group_panel("Sweep", sweep_grid), FALSE, FALSE, 0);
+        g_object_set_data(G_OBJECT(model_box), "sweep_combo", cb_sweep);
+        g_object_set_data(G_OBJECT(model_box), "sweep_trials", sp_trials);
+        g_object_set_data(G_OBJECT(model_box), "sweep_parallel", sp_par);
+        g_object_set_data(G_OBJECT(model_box), "sweep_space", ent_space);
     }
 
         /* Projection/Color */
@@ -1709,9 +3583,18 @@ void add_environment_tab(GtkNotebook *nb, EnvCtx *ctx) {
             "• Residual — erro do modelo (bom p/ diagnosticar).\n"
             "• Off — sem coloração adicional.");
 
+        ctx->btn_project = GTK_BUTTON(gtk_button_new_with_label("Project"));
+        g_signal_connect(ctx->btn_project, "clicked", G_CALLBACK(on_project_clicked), ctx);
+        GtkWidget *project_w = wrap_for_hover(ctx, GTK_WIDGET(ctx->btn_project),
+            "Project:\n"
+            "Projeta o dataset (colunas X; cor = Y) com a projeção escolhida,\n"
+            "direto no app (código nativo, multi-thread), sem treinar.\n"
+            "Durante o t-SNE, clique de novo para cancelar.");
+
         /* pack APENAS os wrappers */
         gtk_box_pack_start(GTK_BOX(row), proj_w,  TRUE, TRUE, 0);
         gtk_box_pack_start(GTK_BOX(row), color_w, TRUE, TRUE, 0);
+        gtk_box_pack_start(GTK_BOX(row), project_w, FALSE, FALSE, 0);
 
         gtk_box_pack_start(GTK_BOX(pre_box), group_panel("Projection & Color", row), FALSE, FALSE, 0);
     }
@@ -1735,6 +3618,17 @@ void add_environment_tab(GtkNotebook *nb, EnvCtx *ctx) {
 
         GtkWidget *chk_onehot = gtk_check_button_new_with_label("One-hot encode categoricals");
 
+        GtkWidget *row2 = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
+        GtkWidget *lbl_hash = gtk_label_new("Hash buckets");
+        GtkWidget *sp_hash  = gtk_spin_button_new_with_range(0, 1 << 24, 256);
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(sp_hash), 0);
+        GtkWidget *chk_sparse = gtk_check_button_new_with_label("Sparse (CSR)");
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(chk_sparse), TRUE);
+        GtkWidget *chk_lean = gtk_check_button_new_with_label("Lean memory (float32)");
+        GtkWidget *lbl_est = gtk_label_new("Output: load a dataset");
+        gtk_label_set_xalign(GTK_LABEL(lbl_est), 0.0f);
+        gtk_label_set_ellipsize(GTK_LABEL(lbl_est), PANGO_ELLIPSIZE_END);
+
         /* === wrappers de hover (pack APENAS os wrappers) === */
         GtkWidget *scale_w  = wrap_for_hover(ctx, GTK_WIDGET(cmb_scale),
             "Scaling: normaliza atributos numéricos.\n• Standard=z-score (0,1)\n• Min-Max=[0,1]\n• No Scaling=mantém valores.");
@@ -1742,17 +3636,49 @@ void add_environment_tab(GtkNotebook *nb, EnvCtx *ctx) {
             "Impute: preenche ausentes.\n• mean/median/most_frequent/zero.\nRegra: escolha conforme distribuição.");
         GtkWidget *onehot_w = wrap_for_hover(ctx, chk_onehot,
             "One-hot: transforma categorias em colunas binárias.\nDica: ative quando houver colunas categóricas.");
+        GtkWidget *hash_w = wrap_for_hover(ctx, sp_hash,
+            "Hash buckets: 0 = uma coluna por categoria.\nN > 0 espalha as categorias em N colunas\n"
+            "(feature hashing): IDs com milhares de valores viram N colunas fixas.");
+        GtkWidget *sparse_w = wrap_for_hover(ctx, chk_sparse,
+            "Sparse: com categóricas, árvores, KNN, SVM e boosting recebem X em CSR\n"
+            "(só os valores não nulos) quando a matriz é quase toda zeros.\nDesligado = sempre denso.");
+        GtkWidget *lean_w = wrap_for_hover(ctx, chk_lean,
+            "Lean: lê o CSV direto em float32, sem cópias do DataFrame,\n"
+            "e monta X uma vez na ordem do split (treino/teste são vistas).\n"
+            "O log mostra o pico de memória de cada etapa ([mem]).");
+        GtkWidget *est_w = wrap_for_hover(ctx, lbl_est,
+            "Dimensão e memória de X depois do tratamento, antes de treinar:\n"
+            "denso = float32 linhas × colunas; CSR = valor + índice por célula não nula.");
 
         gtk_box_pack_start(GTK_BOX(row), scale_w,  TRUE,  TRUE, 0);
         gtk_box_pack_start(GTK_BOX(row), impute_w, TRUE,  TRUE, 0);
         gtk_box_pack_start(GTK_BOX(row), onehot_w, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(row2), lbl_hash, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(row2), hash_w,   FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(row2), sparse_w, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(row2), lean_w,   FALSE, FALSE, 0);
 
-        gtk_box_pack_start(GTK_BOX(pre_box), group_panel("Data Treatment", row), FALSE, FALSE, 0);
+        GtkWidget *col = gtk_box_new(GTK_ORIENTATION_VERTICAL, 6);
+        gtk_box_pack_start(GTK_BOX(col), row,   FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(col), row2,  FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(col), est_w, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(pre_box), group_panel("Data Treatment", col), FALSE, FALSE, 0);
 
         /* Guarda ponteiros para leitura posterior (spawn) */
         g_object_set_data(G_OBJECT(ctx->preproc_box), "scale_combo",  cmb_scale);
         g_object_set_data(G_OBJECT(ctx->preproc_box), "impute_combo", cmb_impute);
         g_object_set_data(G_OBJECT(ctx->preproc_box), "onehot_check", chk_onehot);
+        g_object_set_data(G_OBJECT(ctx->preproc_box), "hash_spin",    sp_hash);
+        g_object_set_data(G_OBJECT(ctx->preproc_box), "sparse_check", chk_sparse);
+        g_object_set_data(G_OBJECT(ctx->preproc_box), "lean_check",   chk_lean);
+        g_object_set_data(G_OBJECT(ctx->preproc_box), "prep_est_label", lbl_est);
+
+        /* estimativa: refeita ao mudar o tratamento e ao abrir a aba */
+        g_signal_connect(cmb_impute, "changed",       G_CALLBACK(on_prep_est_changed), ctx);
+        g_signal_connect(chk_onehot, "toggled",       G_CALLBACK(on_prep_est_changed), ctx);
+        g_signal_connect(sp_hash,    "value-changed", G_CALLBACK(on_prep_est_changed), ctx);
+        g_signal_connect(chk_sparse, "toggled",       G_CALLBACK(on_prep_est_changed), ctx);
+        g_signal_connect(ctx->preproc_box, "map",     G_CALLBACK(on_prep_est_changed), ctx);
     }
 
     /* Split controls */
@@ -1786,6 +3712,14 @@ void add_environment_tab(GtkNotebook *nb, EnvCtx *ctx) {
 
         gtk_box_pack_start(GTK_BOX(box), labels, FALSE, FALSE, 0);
         gtk_box_pack_start(GTK_BOX(box), scale,  FALSE, FALSE, 0);
+
+        GtkWidget *cv_row = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
+        GtkWidget *sp_cv  = gtk_spin_button_new_with_range(0, 20, 1);
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(sp_cv), 0);
+        gtk_box_pack_start(GTK_BOX(cv_row), gtk_label_new("K-fold CV"), FALSE, FALSE, 0);
+        gtk_box_pack_end  (GTK_BOX(cv_row), sp_cv, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(box), cv_row, FALSE, FALSE, 0);
+        g_object_set_data(G_OBJECT(ctx->preproc_box), "cv_spin", sp_cv);
         gtk_box_pack_start(GTK_BOX(pre_box), group_panel("Split (Train/Test)", box), FALSE, FALSE, 0);
         gtk_widget_set_name(lab_tr, "split-train-label");
         gtk_widget_set_name(lab_te, "split-test-label");
@@ -1795,6 +3729,9 @@ void add_environment_tab(GtkNotebook *nb, EnvCtx *ctx) {
         "Split: define porcentagem para treino (restante é teste).\nDica: 70/30 ou 80/20 são bons pontos de partida.");
         env_bind_desc(ctx, GTK_WIDGET(ctx->split_entry),
         "Entrada do split: digite a % de treino (vírgula ou ponto).");
+        env_bind_desc(ctx, sp_cv,
+        "K-fold CV: 0 = usa o split acima. K >= 2 treina K vezes, cada parte uma vez como teste\n"
+        "(estratificado nos classificadores), em paralelo; Metrics mostra média ± desvio de cada métrica.");
     }
 
     /* Features */
@@ -1807,6 +3744,8 @@ void add_environment_tab(GtkNotebook *nb, EnvCtx *ctx) {
         gtk_box_pack_start(GTK_BOX(row), GTK_WIDGET(ctx->x_feat), TRUE, TRUE, 0);
         gtk_box_pack_start(GTK_BOX(row), GTK_WIDGET(ctx->y_feat), TRUE, TRUE, 0);
         gtk_box_pack_start(GTK_BOX(left_col), group_panel("Features", row), FALSE, FALSE, 0);
+        g_signal_connect(ctx->x_feat, "changed", G_CALLBACK(on_prep_est_changed), ctx);
+        g_signal_connect(ctx->y_feat, "changed", G_CALLBACK(on_prep_est_changed), ctx);
 
         env_bind_desc(ctx, GTK_WIDGET(ctx->x_feat),
         "X feature: nome da coluna usada como eixo X/atributo padrão em plots.");
@@ -1820,15 +3759,26 @@ void add_environment_tab(GtkNotebook *nb, EnvCtx *ctx) {
         ctx->btn_start = GTK_BUTTON(gtk_button_new_with_label("Start ▶"));
         ctx->btn_pause = GTK_BUTTON(gtk_button_new_with_label("Pause ⏸"));
         gtk_box_pack_start(GTK_BOX(row), GTK_WIDGET(ctx->btn_start), FALSE, FALSE, 0);
+        ctx->btn_stop       = GTK_BUTTON(gtk_button_new_with_label("Stop ⏹"));
+        ctx->btn_checkpoint = GTK_BUTTON(gtk_button_new_with_label("Checkpoint"));
         gtk_box_pack_start(GTK_BOX(row), GTK_WIDGET(ctx->btn_pause), FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(row), GTK_WIDGET(ctx->btn_stop), FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(row), GTK_WIDGET(ctx->btn_checkpoint), FALSE, FALSE, 0);
         gtk_box_pack_start(GTK_BOX(left_col), group_panel("Actions", row), FALSE, FALSE, 0);
         g_signal_connect(ctx->btn_start, "clicked", G_CALLBACK(on_start_clicked), ctx);
         g_signal_connect(ctx->btn_pause, "clicked", G_CALLBACK(on_pause_clicked), ctx);
+        g_signal_connect(ctx->btn_stop, "clicked", G_CALLBACK(on_stop_clicked), ctx);
+        g_signal_connect(ctx->btn_checkpoint, "clicked", G_CALLBACK(on_checkpoint_clicked), ctx);
 
         env_bind_desc(ctx, GTK_WIDGET(ctx->btn_start),
-        "Start: inicia o treino com as opções atuais. Abre a aba Plot e atualiza Metrics/Logs.");
+        "Start: inicia o treino com as opções atuais. Abre a aba Plot e atualiza Metrics/Logs.\n"
+        "Depois de um Stop vira \"Resume ▶\": continua do checkpoint salvo (se o pedido for o mesmo).");
         env_bind_desc(ctx, GTK_WIDGET(ctx->btn_pause),
-        "Pause/Resume: pausa e retoma o trainer criando/removendo um flag de pausa.");
+        "Pause/Resume: envia o comando pelo stdin do trainer; vale antes do próximo passo de treino.");
+        env_bind_desc(ctx, GTK_WIDGET(ctx->btn_stop),
+        "Stop: cancela o treino salvando um checkpoint (modelo, otimizador, época e RNG) para retomar depois.");
+        env_bind_desc(ctx, GTK_WIDGET(ctx->btn_checkpoint),
+        "Checkpoint: grava um snapshot retomável sem parar o treino.");
     }
 
     /* Wrap left/right com o mesmo look */
@@ -1876,6 +3826,54 @@ void add_environment_tab(GtkNotebook *nb, EnvCtx *ctx) {
     ctx->metrics_panel = metrics_panel;
     env_bind_desc(ctx, metrics_tab, "Metrics: tabela de métricas lidas do arquivo de métricas.");
 
+    /* Fit: uma linha por evento "epoch" do trainer */
+    ctx->fit_store = gtk_list_store_new(3, G_TYPE_INT, G_TYPE_DOUBLE, G_TYPE_DOUBLE);
+    ctx->fit_view  = GTK_TREE_VIEW(gtk_tree_view_new_with_model(GTK_TREE_MODEL(ctx->fit_store)));
+    g_object_unref(ctx->fit_store); /* a view guarda a referência */
+    {
+        const char *cols[] = { "Epoch", "Loss", "Score" };
+        for (int i = 0; i < 3; ++i) {
+            GtkCellRenderer *r = gtk_cell_renderer_text_new();
+            GtkTreeViewColumn *c = gtk_tree_view_column_new_with_attributes(cols[i], r, "text", i, NULL);
+            gtk_tree_view_append_column(ctx->fit_view, c);
+        }
+    }
+    GtkWidget *sc_fit = gtk_scrolled_window_new(NULL, NULL);
+    gtk_container_add(GTK_CONTAINER(sc_fit), GTK_WIDGET(ctx->fit_view));
+    GtkWidget *fit_tab  = make_tab_label("assets/metrics.png", "Fit");
+    GtkWidget *fit_page = wrap_for_hover(ctx, sc_fit, "Fit: loss e score por época, conforme o treino avança.");
+    gtk_notebook_append_page(ctx->right_nb, fit_page, fit_tab);
+    env_bind_desc(ctx, fit_tab, "Fit: loss e score por época, conforme o treino avança.");
+
+    /* Leaderboard: um trial do sweep por linha, melhor score no topo */
+    ctx->board_store = gtk_list_store_new(6, G_TYPE_INT, G_TYPE_DOUBLE, G_TYPE_DOUBLE, G_TYPE_STRING, G_TYPE_STRING,
+                                          G_TYPE_DOUBLE);
+    gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(ctx->board_store), 1, GTK_SORT_DESCENDING);
+    ctx->board_view = GTK_TREE_VIEW(gtk_tree_view_new_with_model(GTK_TREE_MODEL(ctx->board_store)));
+    g_object_unref(ctx->board_store);
+    {
+        const char *cols[] = { "Trial", "Val score", "Test", "Time (s)", "State", "Params" };
+        const int   src[]  = { 0, 1, 5, 2, 3, 4 };   /* coluna do store de cada coluna da view */
+        for (int i = 0; i < 6; ++i) {
+            GtkCellRenderer *r = gtk_cell_renderer_text_new();
+            GtkTreeViewColumn *c;
+            int k = src[i];
+            if (k == 1 || k == 2 || k == 5) {   /* números formatados; vazio enquanto não há score */
+                c = gtk_tree_view_column_new_with_attributes(cols[i], r, NULL);
+                gtk_tree_view_column_set_cell_data_func(c, r, board_score_cell, GINT_TO_POINTER(k), NULL);
+            } else {
+                c = gtk_tree_view_column_new_with_attributes(cols[i], r, "text", k, NULL);
+            }
+            gtk_tree_view_append_column(ctx->board_view, c);
+        }
+    }
+    GtkWidget *sc_board = gtk_scrolled_window_new(NULL, NULL);
+    gtk_container_add(GTK_CONTAINER(sc_board), GTK_WIDGET(ctx->board_view));
+    GtkWidget *board_tab  = make_tab_label("assets/metrics.png", "Leaderboard");
+    GtkWidget *board_page = wrap_for_hover(ctx, sc_board, "Leaderboard: trials do sweep ordenados pelo score de validação (★ = novo melhor); Test é só referência.");
+    gtk_notebook_append_page(ctx->right_nb, board_page, board_tab);
+    env_bind_desc(ctx, board_tab, "Leaderboard: trials do sweep ordenados pelo score de validação (★ = novo melhor); Test é só referência.");
+
     GtkWidget *right_panel = wrap_CSS(ENVIRONMENT_CSS, "metal-panel", right_nb, "env-right-panel");
     gtk_paned_pack2(GTK_PANED(paned), right_panel, TRUE, TRUE);
 
@@ -1887,7 +3885,9 @@ void add_environment_tab(GtkNotebook *nb, EnvCtx *ctx) {
     GtkWidget *footer = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
     ctx->progress = GTK_PROGRESS_BAR(gtk_progress_bar_new());
     ctx->status   = GTK_LABEL(gtk_label_new("Idle"));
+    ctx->cadence_label = GTK_LABEL(gtk_label_new(""));
     gtk_box_pack_start(GTK_BOX(footer), GTK_WIDGET(ctx->progress), TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(footer), GTK_WIDGET(ctx->cadence_label), FALSE, FALSE, 0);
     gtk_box_pack_start(GTK_BOX(footer), GTK_WIDGET(ctx->status),   FALSE, FALSE, 0);
     gtk_box_pack_start(GTK_BOX(outer), footer, FALSE, FALSE, 0);
 
@@ -25,6 +25,8 @@ static void env_free(gpointer p) {
     if (env->current_user_name) g_free(env->current_user_name);
     if (env->current_user_email) g_free(env->current_user_email);
     if (env->token) g_free(env->token);
+    if (env->handoff_path) { g_unlink(env->handoff_path); g_free(env->handoff_path); }
+    g_free(env->handoff_key);
     g_free(env);
 }
 
@@ -0,0 +1,352 @@
+/* -------- aifd_native: DLL com o núcleo nativo para o trainer Python (ctypes) --------
+   Build: make native  ->  aifd_native.dll  (ver python/models/aifd_native.py)
+   O cliente GTK não linka esta unidade: inclui os headers de src/native/ direto. */
+
+/* fseeko/ftello (read_whole_file) com -std=c11 fora do Windows; native_common.h faz o mesmo */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+  #define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "native_common.h"
+#include "tsne.h"
+#include "linear.h"
+#include "mlp.h"
+#include "forest.h"
+#include "gbdt.h"
+#include "knn.h"
+#include "csv.h"
+#include "prep.h"
+#include <stdio.h>
+
+#ifdef _WIN32
+  #define AIFD_EXPORT __declspec(dllexport)
+#else
+  #define AIFD_EXPORT __attribute__((visibility("default")))
+#endif
+
+AIFD_EXPORT int aifd_version(void) { return 1; }
+
+AIFD_EXPORT int aifd_simd_level(void) { return aifd_has_avx2() ? 2 : 0; }
+
+AIFD_EXPORT int aifd_pca(const double *X, int n, int d, double *Z, int threads) {
+    return aifd_pca2(X, n, d, Z, threads);
+}
+
+AIFD_EXPORT int aifd_tsne(const double *X, int n, int d, double *Y,
+                          double perplexity, double theta, int max_iter, int threads,
+                          unsigned long long seed, aifd_progress_fn cb, void *user) {
+    aifd_tsne_opts o;
+    aifd_tsne_defaults(&o);
+    if (perplexity > 0) o.perplexity = perplexity;
+    if (theta >= 0)     o.theta = theta;
+    if (max_iter > 0)   o.max_iter = max_iter;
+    if (o.exag_iter > o.max_iter) o.exag_iter = o.max_iter / 4;
+    o.threads = threads;
+    o.seed = seed;
+    return aifd_tsne2(X, n, d, Y, &o, cb, user);
+}
+
+/* kind: 0 = OLS, 1 = ridge, 2 = lasso; w[d] e *b de saída */
+AIFD_EXPORT int aifd_linear(const double *X, int n, int d, const double *y, int kind, double alpha,
+                            int max_iter, double tol, int threads, double *w, double *b,
+                            aifd_fit_fn cb, void *user) {
+    aifd_linear_opts o;
+    aifd_linear_defaults(&o);
+    o.kind = kind; o.alpha = alpha; o.threads = threads;
+    if (max_iter > 0) o.max_iter = max_iter;
+    if (tol > 0)      o.tol = tol;
+    return aifd_linear_fit(X, n, d, y, &o, w, b, cb, user);
+}
+
+/* y em 0..k-1; W: (k == 2 ? 1 : k) x (d+1) */
+AIFD_EXPORT int aifd_logreg(const double *X, int n, int d, const int *y, int k, double C, int l1,
+                            int max_iter, double tol, int threads, double *W,
+                            aifd_fit_fn cb, void *user) {
+    aifd_logreg_opts o;
+    aifd_logreg_defaults(&o);
+    if (C > 0)        o.C = C;
+    if (max_iter > 0) o.max_iter = max_iter;
+    if (tol > 0)      o.tol = tol;
+    o.l1 = l1; o.threads = threads;
+    return aifd_logreg_fit(X, n, d, y, k, &o, W, cb, user);
+}
+
+AIFD_EXPORT long long aifd_mlp_params(int d, int hidden, int layers, int k) {
+    return (long long)aifd_mlp_param_count(d, hidden, layers, k);
+}
+
+/* k = 0 regressão, k >= 2 classes (y = índice); P: aifd_mlp_params(...) floats */
+AIFD_EXPORT int aifd_mlp_train(const double *X, int n, int d, const double *y, int k,
+                               int hidden, int layers, int act, int optimizer, double lr, int batch,
+                               int epochs, unsigned long long seed, int threads, int warm, float *P,
+                               aifd_fit_fn cb, void *user) {
+    aifd_mlp_opts o;
+    aifd_mlp_defaults(&o);
+    o.hidden = hidden; o.layers = layers; o.act = act; o.optimizer = optimizer;
+    if (lr > 0)     o.lr = lr;
+    o.batch = batch; o.epochs = epochs; o.seed = seed; o.threads = threads; o.warm = warm;
+    return aifd_mlp_fit(X, n, d, y, k, &o, P, cb, user);
+}
+
+AIFD_EXPORT int aifd_mlp_infer(const double *X, int n, int d, int k, int hidden, int layers, int act,
+                               const float *P, double *out, int threads) {
+    return aifd_mlp_predict(X, n, d, k, hidden, layers, act, P, out, threads);
+}
+
+/* floresta treinada fica num handle até o chamador copiar os vetores planos
+   (aifd_forest_sizes + aifd_forest_export) e liberar com aifd_forest_release */
+AIFD_EXPORT void *aifd_forest_train(const double *X, int n, int d, const double *y, int k,
+                                    int n_trees, int max_depth, int min_leaf, double max_features,
+                                    int bootstrap, unsigned long long seed, int first_tree, int threads,
+                                    aifd_fit_fn cb, void *user, int *rc) {
+    aifd_forest_opts o;
+    aifd_forest_defaults(&o);
+    o.n_trees = n_trees; o.max_depth = max_depth; o.max_features = max_features;
+    if (min_leaf > 0) o.min_leaf = min_leaf;
+    o.bootstrap = bootstrap; o.seed = seed; o.first_tree = first_tree; o.threads = threads;
+    aifd_forest *F = (aifd_forest*)calloc(1, sizeof(aifd_forest));
+    int r = F ? aifd_forest_fit(X, n, d, y, k, &o, F, cb, user) : AIFD_ENOMEM;
+    if (rc) *rc = r;
+    if (r < 0) { free(F); return NULL; }
+    return F;
+}
+
+/* out: n_trees, n_nodes, n_values */
+AIFD_EXPORT void aifd_forest_sizes(const void *h, int *out) {
+    const aifd_forest *F = (const aifd_forest*)h;
+    out[0] = F->n_trees; out[1] = F->n_nodes; out[2] = F->n_values;
+}
+
+/* nodes: n_nodes registros {int feature, int right, double thr} */
+AIFD_EXPORT void aifd_forest_export(const void *h, void *nodes, int *roots, double *values) {
+    const aifd_forest *F = (const aifd_forest*)h;
+    memcpy(nodes, F->nodes, sizeof(aifd_tree_node) * F->n_nodes);
+    memcpy(roots, F->roots, sizeof(int) * F->n_trees);
+    memcpy(values, F->values, sizeof(double) * F->n_values);
+}
+
+AIFD_EXPORT void aifd_forest_release(void *h) {
+    if (!h) return;
+    aifd_forest_free((aifd_forest*)h);
+    free(h);
+}
+
+/* out: n x k (k >= 2) ou n (regressão) */
+AIFD_EXPORT int aifd_forest_infer(const void *nodes, const int *roots, const double *values, int n_trees, int k,
+                                  const double *X, int n, int d, double *out, int threads) {
+    aifd_forest F = { n_trees, k, 0, 0, (aifd_tree_node*)nodes, (int*)roots, (double*)values };
+    return aifd_forest_predict(&F, X, n, d, out, threads);
+}
+
+/* mesmo esquema de handle da floresta; base: K valores iniciais (aifd_gbdt_outputs(k)) */
+AIFD_EXPORT void *aifd_gbdt_train(const double *X, int n, int d, const double *y, int k, const double *F0,
+                                  int rounds, double lr, int max_leaves, int max_depth, int min_leaf, double l2,
+                                  int threads, aifd_fit_fn cb, void *user, int *rc) {
+    aifd_gbdt_opts o;
+    aifd_gbdt_defaults(&o);
+    o.rounds = rounds; o.max_depth = max_depth; o.l2 = l2 > 0 ? l2 : 0.0; o.threads = threads;
+    if (lr > 0)         o.lr = lr;
+    if (max_leaves > 1) o.max_leaves = max_leaves;
+    if (min_leaf > 0)   o.min_leaf = min_leaf;
+    aifd_gbdt *G = (aifd_gbdt*)calloc(1, sizeof(aifd_gbdt));
+    int r = G ? aifd_gbdt_fit(X, n, d, y, k, F0, &o, G, cb, user) : AIFD_ENOMEM;
+    if (rc) *rc = r;
+    if (r < 0) { free(G); return NULL; }
+    return G;
+}
+
+AIFD_EXPORT void aifd_gbdt_sizes(const void *h, int *out) {
+    aifd_forest_sizes(&((const aifd_gbdt*)h)->trees, out);
+}
+
+AIFD_EXPORT void aifd_gbdt_export(const void *h, void *nodes, int *roots, double *values, double *base) {
+    const aifd_gbdt *G = (const aifd_gbdt*)h;
+    aifd_forest_export(&G->trees, nodes, roots, values);
+    memcpy(base, G->base, sizeof(double) * G->K);
+}
+
+AIFD_EXPORT void aifd_gbdt_release(void *h) {
+    if (!h) return;
+    aifd_gbdt_free((aifd_gbdt*)h);
+    free(h);
+}
+
+/* out n x aifd_gbdt_outputs(k); raw = 1 devolve a soma crua (para continuar o boosting) */
+AIFD_EXPORT int aifd_gbdt_infer(const void *nodes, const int *roots, const double *values, int n_trees,
+                                const double *base, int k, const double *X, int n, int d, int raw,
+                                double *out, int threads) {
+    aifd_gbdt G = { { n_trees, k, 0, 0, (aifd_tree_node*)nodes, (int*)roots, (double*)values },
+                    aifd_gbdt_outputs(k), (double*)base };
+    return aifd_gbdt_predict(&G, X, n, d, raw, out, threads);
+}
+
+/* índice KNN num handle (copia X); algo: AIFD_KNN_* */
+AIFD_EXPORT void *aifd_knn_new(const double *X, int n, int d, int algo, int M, int ef_construction,
+                               unsigned long long seed, int threads, int *rc) {
+    aifd_knn_opts o;
+    aifd_knn_defaults(&o);
+    o.algo = algo; o.seed = seed; o.threads = threads;
+    if (M > 1)               o.M = M;
+    if (ef_construction > 0) o.ef_construction = ef_construction;
+    aifd_knn *I = (aifd_knn*)calloc(1, sizeof(aifd_knn));
+    int r = I ? aifd_knn_build(X, n, d, &o, I) : AIFD_ENOMEM;
+    if (rc) *rc = r;
+    if (r < 0) { free(I); return NULL; }
+    return I;
+}
+
+/* algoritmo resolvido (AUTO vira KD, HNSW ou força bruta) */
+AIFD_EXPORT int aifd_knn_algo(const void *h) { return ((const aifd_knn*)h)->algo; }
+
+AIFD_EXPORT int aifd_knn_search(const void *h, const double *Q, int m, int k, int ef,
+                                int *idx, double *dist, int threads) {
+    return aifd_knn_query((const aifd_knn*)h, Q, m, k, ef, idx, dist, threads);
+}
+
+/* out: m x k probabilidades (k >= 2) ou m médias (k = 0) */
+AIFD_EXPORT int aifd_knn_vote(const void *h, const double *y, int k, const double *Q, int m,
+                              int n_neighbors, int ef, double *out, int threads) {
+    return aifd_knn_predict((const aifd_knn*)h, y, k, Q, m, n_neighbors, ef, out, threads);
+}
+
+AIFD_EXPORT void aifd_knn_release(void *h) {
+    if (!h) return;
+    aifd_knn_free((aifd_knn*)h);
+    free(h);
+}
+
+/* arquivo inteiro em memória; no Windows o caminho vem em UTF-8 (como o Python manda) */
+static char *read_whole_file(const char *path, size_t *len) {
+#ifdef _WIN32
+    wchar_t wpath[4096];
+    if (!MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath, 4096)) return NULL;
+    FILE *f = _wfopen(wpath, L"rb");
+#else
+    FILE *f = fopen(path, "rb");
+#endif
+    if (!f) return NULL;
+#ifdef _WIN32
+    _fseeki64(f, 0, SEEK_END); long long sz = _ftelli64(f); _fseeki64(f, 0, SEEK_SET);
+#else
+    fseeko(f, 0, SEEK_END); long long sz = (long long)ftello(f); fseeko(f, 0, SEEK_SET);
+#endif
+    char *buf = sz >= 0 ? (char*)malloc((size_t)sz + 1) : NULL;
+    if (buf && fread(buf, 1, (size_t)sz, f) != (size_t)sz) { free(buf); buf = NULL; }
+    fclose(f);
+    if (buf) *len = (size_t)sz;
+    return buf;
+}
+
+/* CSV -> colunas num handle (aifd_csv_shape/name/kind/data/levels, depois aifd_csv_release).
+   delim 0 = detecta; na_pandas = 1 usa os marcadores de ausente do pandas */
+AIFD_EXPORT void *aifd_csv_open(const char *path, int delim, int header, int float32, int na_pandas,
+                                int threads, int *rc) {
+    size_t len = 0;
+    char *buf = read_whole_file(path, &len);
+    if (!buf) { if (rc) *rc = AIFD_EINVAL; return NULL; }
+    aifd_csv_opts o;
+    aifd_csv_defaults(&o);
+    o.delim = (char)delim; o.header = header; o.float32 = float32; o.na_pandas = na_pandas; o.threads = threads;
+    aifd_csv *C = (aifd_csv*)calloc(1, sizeof(aifd_csv));
+    int r = C ? aifd_csv_parse(buf, len, &o, C) : AIFD_ENOMEM;
+    free(buf);
+    if (rc) *rc = r;
+    if (r < 0) { free(C); return NULL; }
+    return C;
+}
+
+/* out: rows, cols, delim; seconds: tempo de análise */
+AIFD_EXPORT void aifd_csv_shape(const void *h, long long *out, double *seconds) {
+    const aifd_csv *C = (const aifd_csv*)h;
+    out[0] = C->rows; out[1] = C->cols; out[2] = C->delim;
+    if (seconds) *seconds = C->seconds;
+}
+
+AIFD_EXPORT const char *aifd_csv_name(const void *h, int j) { return ((const aifd_csv*)h)->col[j].name; }
+
+AIFD_EXPORT int aifd_csv_kind(const void *h, int j) { return ((const aifd_csv*)h)->col[j].kind; }
+
+/* rows doubles/floats (NaN = ausente) ou, para TEXT, rows int32 (-1 = ausente) */
+AIFD_EXPORT const void *aifd_csv_data(const void *h, int j) { return ((const aifd_csv*)h)->col[j].data; }
+
+/* níveis de uma coluna TEXT: n strings terminadas em '\0', size bytes no total */
+AIFD_EXPORT const char *aifd_csv_levels(const void *h, int j, int *n, long long *size) {
+    const aifd_csv_col *c = &((const aifd_csv*)h)->col[j];
+    *n = c->n_levels; *size = (long long)c->levels_size;
+    return c->levels;
+}
+
+AIFD_EXPORT void aifd_csv_release(void *h) {
+    if (!h) return;
+    aifd_csv_free((aifd_csv*)h);
+    free(h);
+}
+
+/* imputação + escala das colunas numéricas (AIFD_IMPUTE_*, AIFD_SCALE_*); X n x d com passo ld.
+   Mesmo esquema de handle da floresta: aifd_prep_sizes/export copiam os vetores e
+   aifd_prep_apply transforma a partir deles */
+AIFD_EXPORT void *aifd_prep_new(const double *X, int n, int d, int ld, int impute, int scale, int threads,
+                                int *rc) {
+    aifd_prep *P = (aifd_prep*)calloc(1, sizeof(aifd_prep));
+    int r = P ? aifd_prep_fit(X, n, d, ld, impute, scale, threads, P) : AIFD_ENOMEM;
+    if (rc) *rc = r;
+    if (r < 0) { free(P); return NULL; }
+    return P;
+}
+
+AIFD_EXPORT int aifd_prep_out_dim(const void *h) { return ((const aifd_prep*)h)->out_d; }
+
+/* out[d] (-1 = coluna descartada), fill[d], a[d], b[d] */
+AIFD_EXPORT void aifd_prep_export(const void *h, int *out, double *fill, double *a, double *b) {
+    const aifd_prep *P = (const aifd_prep*)h;
+    memcpy(out, P->out, sizeof(int) * P->d);
+    memcpy(fill, P->fill, sizeof(double) * P->d);
+    memcpy(a, P->a, sizeof(double) * P->d);
+    memcpy(b, P->b, sizeof(double) * P->d);
+}
+
+AIFD_EXPORT void aifd_prep_release(void *h) {
+    if (!h) return;
+    aifd_prep_free((aifd_prep*)h);
+    free(h);
+}
+
+/* Y: n linhas com passo ldo, double ou float (f32) */
+AIFD_EXPORT int aifd_prep_apply(const int *out, const double *fill, const double *a, const double *b, int d,
+                                int scale, const double *X, int n, int ld, void *Y, int ldo, int f32, int threads) {
+    aifd_prep P = { d, 0, scale, (int*)out, (double*)fill, (double*)a, (double*)b };
+    aifd_prep_transform(&P, X, n, ld, Y, ldo, f32, threads);
+    return AIFD_OK;
+}
+
+/* one-hot de uma coluna de códigos (-1 = ausente); levels: n_levels strings terminadas em '\0' */
+AIFD_EXPORT void *aifd_onehot_new(const int *codes, int n, const char *levels, int n_levels, int impute, int *rc) {
+    aifd_onehot *H = (aifd_onehot*)calloc(1, sizeof(aifd_onehot));
+    int r = H ? aifd_onehot_fit(codes, n, levels, n_levels, impute, H) : AIFD_ENOMEM;
+    if (rc) *rc = r;
+    if (r < 0) { free(H); return NULL; }
+    return H;
+}
+
+AIFD_EXPORT int aifd_onehot_width(const void *h) { return ((const aifd_onehot*)h)->width; }
+
+/* slot[n_levels + 1], order[width] */
+AIFD_EXPORT void aifd_onehot_export(const void *h, int *slot, int *order) {
+    const aifd_onehot *H = (const aifd_onehot*)h;
+    memcpy(slot, H->slot, sizeof(int) * (H->n_levels + 1));
+    memcpy(order, H->order, sizeof(int) * H->width);
+}
+
+AIFD_EXPORT void aifd_onehot_release(void *h) {
+    if (!h) return;
+    aifd_onehot_free((aifd_onehot*)h);
+    free(h);
+}
+
+/* códigos >= n_levels: categoria desconhecida (linha toda 0) */
+AIFD_EXPORT int aifd_onehot_apply(const int *slot, int n_levels, int width, const int *codes, int n,
+                                  void *Y, int ldo, int f32, int threads) {
+    aifd_onehot H = { n_levels, width, (int*)slot, NULL };
+    aifd_onehot_transform(&H, codes, n, Y, ldo, f32, threads);
+    return AIFD_OK;
+}
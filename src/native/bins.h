@@ -0,0 +1,94 @@
+#ifndef NATIVE_BINS_H
+#define NATIVE_BINS_H
+
+/* -------- Quantização por quantis (árvores) --------
+   Cada coluna vira códigos uint8 (até 255 bins) com limites superiores
+   edges[b]: x <= edges[b] <=> código <= b, então um split no bin b vale
+   igual no dado bruto. Colunas com poucos valores distintos usam pontos
+   médios (split exato); as demais, quantis de uma amostra. Os códigos ficam
+   por coluna (d x n) para montar histogramas percorrendo uma coluna só. */
+
+#include "native_common.h"
+
+AIFD_NATIVE_BEGIN
+
+#define AIFD_MAX_BINS 255
+#define BINS_SAMPLE   200000    /* linhas usadas para estimar os quantis */
+
+typedef struct {
+    int n, d;
+    unsigned char *codes;       /* d x n */
+    double *edges;              /* d x AIFD_MAX_BINS (nbins[f] - 1 limites válidos) */
+    int *nbins;
+} aifd_bins;
+
+typedef struct {
+    const double *X;
+    aifd_bins *B;
+    double *tmp;                /* BINS_SAMPLE por thread */
+} bins_job;
+
+static int bins_cmp_double(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void bins_columns(void *arg, int b, int e, int tid) {
+    bins_job *J = (bins_job*)arg;
+    aifd_bins *B = J->B;
+    int n = B->n, d = B->d, m = n < BINS_SAMPLE ? n : BINS_SAMPLE;
+    double *v = J->tmp + (size_t)tid * BINS_SAMPLE;
+    for (int f = b; f < e; ++f) {
+        double *edge = B->edges + (size_t)f * AIFD_MAX_BINS;
+        int u = 0, ne = 0;
+        for (int s = 0; s < m; ++s) v[s] = J->X[(size_t)((long long)s * n / m) * d + f];
+        qsort(v, m, sizeof(double), bins_cmp_double);
+        for (int s = 0; s < m; ++s) if (s == 0 || v[s] != v[u - 1]) v[u++] = v[s];
+        if (u <= AIFD_MAX_BINS) {
+            for (int s = 0; s + 1 < u; ++s) {
+                double mid = 0.5 * (v[s] + v[s + 1]);
+                edge[ne++] = mid < v[s + 1] ? mid : v[s];
+            }
+        } else {
+            for (int q = 1; q < AIFD_MAX_BINS; ++q) {
+                double t = v[(size_t)((long long)q * u / AIFD_MAX_BINS)];
+                if (t < v[u - 1] && (ne == 0 || t > edge[ne - 1])) edge[ne++] = t;
+            }
+        }
+        B->nbins[f] = ne + 1;
+        unsigned char *code = B->codes + (size_t)f * n;
+        for (int i = 0; i < n; ++i) {
+            double x = J->X[(size_t)i * d + f];
+            int lo = 0, hi = ne;        /* primeiro limite >= x (NaN cai no último bin) */
+            while (lo < hi) { int mid = (lo + hi) >> 1; if (x <= edge[mid]) hi = mid; else lo = mid + 1; }
+            code[i] = (unsigned char)lo;
+        }
+    }
+}
+
+static void aifd_bins_free(aifd_bins *B) {
+    free(B->codes); free(B->edges); free(B->nbins);
+    memset(B, 0, sizeof(*B));
+}
+
+/* X linha-major n x d */
+static int aifd_bins_build(const double *X, int n, int d, int threads, aifd_bins *B) {
+    memset(B, 0, sizeof(*B));
+    if (!X || n < 1 || d < 1) return AIFD_EINVAL;
+    int t = aifd_num_threads(threads);
+    if (t > d) t = d;
+    bins_job J = { X, B, NULL };
+    B->n = n; B->d = d;
+    B->codes = (unsigned char*)malloc((size_t)d * n);
+    B->edges = (double*)malloc(sizeof(double) * (size_t)d * AIFD_MAX_BINS);
+    B->nbins = (int*)malloc(sizeof(int) * d);
+    J.tmp    = (double*)malloc(sizeof(double) * (size_t)t * BINS_SAMPLE);
+    if (!B->codes || !B->edges || !B->nbins || !J.tmp) { free(J.tmp); aifd_bins_free(B); return AIFD_ENOMEM; }
+    aifd_parallel_for(d, t, bins_columns, &J);
+    free(J.tmp);
+    return AIFD_OK;
+}
+
+AIFD_NATIVE_END
+
+#endif
@@ -0,0 +1,554 @@
+#ifndef NATIVE_CSV_H
+#define NATIVE_CSV_H
+
+/* -------- Leitor de CSV paralelo (texto -> colunas) --------
+   O texto é cortado em um bloco por thread, sempre num '\n' fora de aspas:
+   cada thread conta as aspas do seu pedaço, a soma prefixada dá a paridade
+   no início de cada bloco e daí o primeiro fim de linha válido. Depois cada
+   thread conta as suas linhas (o offset de saída de cada bloco) e analisa
+   direto nas colunas finais, sem cópia intermediária.
+   Números: parser próprio, independente do locale (sempre '.'), exato no
+   caminho rápido (mantissa < 2^53, |expoente| <= 22). Colunas com texto
+   viram códigos int32 + dicionário na ordem de aparição: cada bloco monta o
+   seu e a junção (uma thread por coluna) renumera para o dicionário global. */
+
+#include "native_common.h"
+#include <stdio.h>
+
+AIFD_NATIVE_BEGIN
+
+enum { AIFD_CSV_FLOAT = 0, AIFD_CSV_INT = 1, AIFD_CSV_TEXT = 2 };
+
+#define CSV_SNIFF_ROWS  1000        /* linhas lidas antes para achar as colunas de texto */
+#define CSV_MIN_BLOCK   (256 << 10) /* bytes mínimos por thread */
+
+typedef struct {
+    char  delim;       /* 0 = detecta pelo cabeçalho (',' ';' ou tab, como detect_delim) */
+    int   header;      /* 1ª linha traz os nomes */
+    int   float32;     /* colunas numéricas em float em vez de double */
+    int   na_pandas;   /* ausentes: 1 = marcadores do pandas (exatos); 0 = lista curta do cliente, sem caixa */
+    int   threads;
+} aifd_csv_opts;
+
+static void aifd_csv_defaults(aifd_csv_opts *o) {
+    o->delim = 0; o->header = 1; o->float32 = 0; o->na_pandas = 0; o->threads = 0;
+}
+
+typedef struct {
+    char  *name;
+    int    kind;          /* AIFD_CSV_*; INT = só literais inteiros e nenhum ausente */
+    void  *data;          /* rows doubles (ou floats), NaN = ausente; TEXT: rows int32, -1 = ausente */
+    char  *levels;        /* TEXT: n_levels strings terminadas em '\0', na ordem de aparição */
+    size_t levels_size;
+    int    n_levels;
+} aifd_csv_col;
+
+typedef struct {
+    int rows, cols;
+    char delim;
+    int float32;
+    aifd_csv_col *col;
+    double seconds;
+} aifd_csv;
+
+static void aifd_csv_free(aifd_csv *C) {
+    for (int j = 0; C->col && j < C->cols; ++j) {
+        free(C->col[j].name); free(C->col[j].data); free(C->col[j].levels);
+    }
+    free(C->col);
+    memset(C, 0, sizeof(*C));
+}
+
+/* ---- dicionário de strings (endereçamento aberto, ids na ordem de inserção) ---- */
+typedef struct {
+    char *blob; size_t used, cap;
+    size_t *off; int *len; unsigned int *hash;
+    int n, cap_ids;
+    int *slot; unsigned int mask;   /* id + 1; 0 = livre */
+} csv_dict;
+
+static void csv_dict_free(csv_dict *D) {
+    free(D->blob); free(D->off); free(D->len); free(D->hash); free(D->slot);
+    memset(D, 0, sizeof(*D));
+}
+
+static unsigned int csv_hash(const char *s, size_t n) {
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < n; ++i) { h ^= (unsigned char)s[i]; h *= 16777619u; }
+    return h;
+}
+
+static int csv_dict_grow(csv_dict *D) {
+    unsigned int size = D->slot ? (D->mask + 1) * 2 : 64;
+    int *slot = (int*)calloc(size, sizeof(int));
+    if (!slot) return 0;
+    for (int id = 0; id < D->n; ++id) {
+        unsigned int i = D->hash[id] & (size - 1);
+        while (slot[i]) i = (i + 1) & (size - 1);
+        slot[i] = id + 1;
+    }
+    free(D->slot);
+    D->slot = slot; D->mask = size - 1;
+    return 1;
+}
+
+/* id da string (insere se nova); -2 sem memória */
+static int csv_dict_id(csv_dict *D, const char *s, size_t n) {
+    if (!D->slot || (size_t)(D->n + 1) * 2 > (size_t)D->mask + 1)
+        if (!csv_dict_grow(D)) return -2;
+    unsigned int h = csv_hash(s, n), i = h & D->mask;
+    for (; D->slot[i]; i = (i + 1) & D->mask) {
+        int id = D->slot[i] - 1;
+        if (D->hash[id] == h && (size_t)D->len[id] == n && memcmp(D->blob + D->off[id], s, n) == 0) return id;
+    }
+    if (D->n == D->cap_ids) {
+        int c = D->cap_ids ? D->cap_ids * 2 : 64;
+        size_t *off = (size_t*)realloc(D->off, sizeof(size_t) * c);
+        if (off) D->off = off;
+        int *len = (int*)realloc(D->len, sizeof(int) * c);
+        if (len) D->len = len;
+        unsigned int *hs = (unsigned int*)realloc(D->hash, sizeof(unsigned int) * c);
+        if (hs) D->hash = hs;
+        if (!off || !len || !hs) return -2;
+        D->cap_ids = c;
+    }
+    if (D->used + n + 1 > D->cap) {
+        size_t c = D->cap ? D->cap * 2 : 4096;
+        while (c < D->used + n + 1) c *= 2;
+        char *b = (char*)realloc(D->blob, c);
+        if (!b) return -2;
+        D->blob = b; D->cap = c;
+    }
+    memcpy(D->blob + D->used, s, n);
+    D->blob[D->used + n] = '\0';
+    D->off[D->n] = D->used; D->len[D->n] = (int)n; D->hash[D->n] = h;
+    D->used += n + 1;
+    D->slot[i] = D->n + 1;
+    return D->n++;
+}
+
+/* ---- tokenização ---- */
+typedef struct { const char *s, *e; int esc, absent; } csv_span;
+typedef struct { char *p; size_t cap; } csv_buf;
+
+/* fim da linha em p: o próximo '\n' fora de aspas (ou e) */
+static const char *csv_line_end(const char *p, const char *e) {
+    const char *nl = (const char*)memchr(p, '\n', (size_t)(e - p));
+    if (!nl) nl = e;
+    const char *q = (const char*)memchr(p, '"', (size_t)(nl - p));
+    if (!q) return nl;
+    int inq = 0;
+    for (; q < e; ++q) {
+        if (*q == '"') inq ^= 1;
+        else if (*q == '\n' && !inq) return q;
+    }
+    return e;
+}
+
+/* próxima célula de [p, e]; devolve onde começa a seguinte (e + 1 = linha acabou) */
+static const char *csv_cell(const char *p, const char *e, char delim, csv_span *c) {
+    c->esc = 0; c->absent = 0;
+    if (p < e && *p == '"') {
+        c->s = ++p;
+        while (p < e) {
+            if (*p == '"') {
+                if (p + 1 < e && p[1] == '"') { c->esc = 1; p += 2; continue; }
+                break;
+            }
+            ++p;
+        }
+        c->e = p;
+        while (p < e && *p != delim) ++p;   /* o que vier depois das aspas é ignorado */
+        return p < e ? p + 1 : e + 1;
+    }
+    c->s = p;
+    while (p < e && *p != delim) ++p;
+    c->e = p;
+    return p < e ? p + 1 : e + 1;
+}
+
+/* conteúdo com "" -> " (em B); 0 sem memória */
+static int csv_unescape(csv_buf *B, csv_span *c) {
+    size_t n = (size_t)(c->e - c->s);
+    if (n + 1 > B->cap) {
+        char *p = (char*)realloc(B->p, n + 64);
+        if (!p) return 0;
+        B->p = p; B->cap = n + 64;
+    }
+    size_t m = 0;
+    for (const char *q = c->s; q < c->e; ++q) {
+        B->p[m++] = *q;
+        if (*q == '"' && q + 1 < c->e && q[1] == '"') ++q;
+    }
+    c->s = B->p; c->e = B->p + m;
+    return 1;
+}
+
+static void csv_trim(const char **s, const char **e) {
+    while (*s < *e && (**s == ' ' || **s == '\t')) ++*s;
+    while (*e > *s && ((*e)[-1] == ' ' || (*e)[-1] == '\t')) --*e;
+}
+
+static int csv_ieq(const char *s, size_t n, const char *w) {
+    for (size_t i = 0; i < n; ++i) {
+        char a = s[i], b = w[i];
+        if (!b) return 0;
+        if (a >= 'A' && a <= 'Z') a = (char)(a - 'A' + 'a');
+        if (b >= 'A' && b <= 'Z') b = (char)(b - 'A' + 'a');
+        if (a != b) return 0;
+    }
+    return w[n] == '\0';
+}
+
+static int csv_is_na(const char *s, const char *e, int na_pandas) {
+    static const char *const na_client[] = { "", "NA", "N/A", "NaN", "nan", "null", "NULL", "None", "?", NULL };
+    static const char *const na_pandas_[] = { "", "#N/A", "#N/A N/A", "#NA", "-1.#IND", "-1.#QNAN", "-NaN", "-nan",
+        "1.#IND", "1.#QNAN", "<NA>", "N/A", "NA", "NULL", "NaN", "None", "n/a", "nan", "null", NULL };
+    if (na_pandas) {
+        size_t n = (size_t)(e - s);
+        for (int k = 0; na_pandas_[k]; ++k)
+            if (strlen(na_pandas_[k]) == n && memcmp(s, na_pandas_[k], n) == 0) return 1;
+        return 0;
+    }
+    csv_trim(&s, &e);
+    for (int k = 0; na_client[k]; ++k)
+        if (csv_ieq(s, (size_t)(e - s), na_client[k])) return 1;
+    return 0;
+}
+
+static const double csv_p10[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+static const long double csv_p10l[28] = {
+    1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L, 1e10L, 1e11L, 1e12L, 1e13L,
+    1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L, 1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L };
+
+/* 1 = número (*is_int: literal inteiro), 0 = vazio, -1 = texto */
+static int csv_number(const char *s, const char *e, double *out, int *is_int) {
+    csv_trim(&s, &e);
+    if (s == e) return 0;
+    const char *p = s;
+    int neg = 0;
+    if (*p == '-' || *p == '+') { neg = *p == '-'; ++p; }
+    unsigned long long m = 0;
+    int nd = 0, ex = 0, any = 0, integer = 1;
+    for (; p < e && (unsigned)(*p - '0') < 10u; ++p, any = 1) {
+        if (nd < 19) { m = m * 10 + (unsigned)(*p - '0'); if (m) nd++; }
+        else ex++;
+    }
+    if (p < e && *p == '.') {
+        integer = 0;
+        for (++p; p < e && (unsigned)(*p - '0') < 10u; ++p, any = 1)
+            if (nd < 19) { m = m * 10 + (unsigned)(*p - '0'); if (m) nd++; ex--; }
+    }
+    if (!any) {
+        size_t n = (size_t)(e - p);
+        if (csv_ieq(p, n, "inf") || csv_ieq(p, n, "infinity")) {
+            *out = neg ? -INFINITY : INFINITY; *is_int = 0;
+            return 1;
+        }
+        return -1;
+    }
+    if (p < e && (*p == 'e' || *p == 'E')) {
+        integer = 0;
+        int eneg = 0, ev = 0, edig = 0;
+        ++p;
+        if (p < e && (*p == '-' || *p == '+')) { eneg = *p == '-'; ++p; }
+        for (; p < e && (unsigned)(*p - '0') < 10u; ++p, edig = 1)
+            if (ev < 100000) ev = ev * 10 + (*p - '0');
+        if (!edig) return -1;
+        ex += eneg ? -ev : ev;
+    }
+    if (p != e) return -1;
+    /* m e 10^|ex| exatos: uma operação em double (m < 2^53) ou em long double (até 19
+       dígitos, como os que o pandas grava; 10^27 ainda cabe) arredonda certo; o resto usa powl */
+    double v;
+    int ax = ex < 0 ? -ex : ex;
+    if (m == 0)                               v = 0.0;
+    else if (m < (1ULL << 53) && ax <= 22)    v = ex >= 0 ? (double)m * csv_p10[ax] : (double)m / csv_p10[ax];
+    else if (ax <= 27)                        v = (double)(ex >= 0 ? (long double)m * csv_p10l[ax]
+                                                                   : (long double)m / csv_p10l[ax]);
+    else                                      v = (double)((long double)m * powl(10.0L, (long double)ex));
+    *out = neg ? -v : v;
+    *is_int = integer && nd < 19;
+    return 1;
+}
+
+/* ---- passadas paralelas ---- */
+typedef struct {
+    aifd_csv *C;
+    int T, na_pandas, probe, last, err;
+    const char *const *start;   /* T + 1 limites de bloco */
+    const int *row0;            /* 1ª linha de saída de cada bloco */
+    int *count;                 /* linhas por bloco (passada de contagem) */
+    int *quotes;                /* aspas por bloco (corte) */
+    const char *body, *end;
+    const unsigned char *want;  /* colunas escritas nesta passada */
+    unsigned char *seen_text;   /* T x cols: coluna numérica com texto */
+    unsigned char *not_int;     /* T x cols */
+    csv_dict *dict;             /* T x cols (só as colunas TEXT) */
+    csv_buf *scratch;           /* T */
+} csv_job;
+
+static void csv_count_quotes(void *arg, int b, int e, int tid) {
+    csv_job *J = (csv_job*)arg;
+    (void)tid;
+    for (int k = b; k < e; ++k) {
+        int q = 0;
+        for (const char *p = J->start[k]; p < J->start[k + 1]; ++p) q += *p == '"';
+        J->quotes[k] = q;
+    }
+}
+
+static void csv_count_rows(void *arg, int b, int e, int tid) {
+    csv_job *J = (csv_job*)arg;
+    (void)tid;
+    for (int k = b; k < e; ++k) {
+        const char *p = J->start[k], *end = J->start[k + 1];
+        int n = 0;
+        while (p < end) {
+            const char *le = csv_line_end(p, end);
+            if (le > p && !(le == p + 1 && *p == '\r')) n++;
+            p = le < end ? le + 1 : end;
+        }
+        J->count[k] = n;
+    }
+}
+
+/* analisa as linhas de [s, e) do bloco k a partir da linha de saída `row` */
+static void csv_parse_block(csv_job *J, int k, const char *s, const char *e, int row, int max_rows) {
+    aifd_csv *C = J->C;
+    int cols = C->cols, f32 = C->float32, na = J->na_pandas;
+    char delim = C->delim;
+    unsigned char *seen = J->seen_text + (size_t)k * cols, *nint = J->not_int + (size_t)k * cols;
+    csv_dict *D = J->dict + (size_t)k * cols;
+    csv_buf *S = J->scratch + k;
+    const char *p = s;
+    for (int n = 0; p < e && n != max_rows; ) {
+        const char *le = csv_line_end(p, e), *next = le < e ? le + 1 : e;
+        if (le > p && le[-1] == '\r') --le;
+        if (le == p) { p = next; continue; }
+        const char *q = p;
+        for (int j = 0; j <= J->last; ++j) {
+            csv_span c;
+            if (q <= le) q = csv_cell(q, le, delim, &c);
+            else { c.s = c.e = le; c.esc = 0; c.absent = 1; }
+            if (!J->want[j]) continue;
+            if (c.esc && !csv_unescape(S, &c)) { J->err = AIFD_ENOMEM; return; }
+            aifd_csv_col *col = &C->col[j];
+            if (col->kind == AIFD_CSV_TEXT && !J->probe) {
+                if (!na) csv_trim(&c.s, &c.e);
+                int id = (c.absent || csv_is_na(c.s, c.e, na)) ? -1 : csv_dict_id(&D[j], c.s, (size_t)(c.e - c.s));
+                if (id < -1) { J->err = AIFD_ENOMEM; return; }
+                ((int*)col->data)[row + n] = id;
+                continue;
+            }
+            double v = 0.0;
+            int is_int = 0, r = c.absent ? 0 : csv_number(c.s, c.e, &v, &is_int);
+            if (r < 0 && csv_is_na(c.s, c.e, na)) r = 0;
+            if (r <= 0) { v = NAN; nint[j] = 1; if (r < 0) seen[j] = 1; }
+            else if (!is_int) nint[j] = 1;
+            if (J->probe) continue;
+            if (f32) ((float*)col->data)[row + n] = (float)v;
+            else     ((double*)col->data)[row + n] = v;
+        }
+        ++n;
+        p = next;
+    }
+}
+
+static void csv_parse_blocks(void *arg, int b, int e, int tid) {
+    csv_job *J = (csv_job*)arg;
+    (void)tid;
+    for (int k = b; k < e; ++k) csv_parse_block(J, k, J->start[k], J->start[k + 1], J->row0[k], -1);
+}
+
+/* junta os dicionários dos blocos (em ordem) e renumera os códigos; uma tarefa por coluna */
+static void csv_merge_column(void *arg, int j, int tid) {
+    csv_job *J = (csv_job*)arg;
+    aifd_csv_col *col = &J->C->col[j];
+    (void)tid;
+    if (col->kind != AIFD_CSV_TEXT) return;
+    int cols = J->C->cols, *codes = (int*)col->data;
+    csv_dict G = J->dict[j];                 /* o bloco 0 já está na ordem global */
+    memset(&J->dict[j], 0, sizeof(csv_dict));
+    for (int k = 1; k < J->T; ++k) {
+        csv_dict *L = &J->dict[(size_t)k * cols + j];
+        if (L->n == 0) continue;
+        int *map = (int*)malloc(sizeof(int) * L->n);
+        if (!map) { J->err = AIFD_ENOMEM; break; }
+        int ok = 1;
+        for (int id = 0; id < L->n && ok; ++id)
+            ok = (map[id] = csv_dict_id(&G, L->blob + L->off[id], (size_t)L->len[id])) >= 0;
+        if (!ok) { free(map); J->err = AIFD_ENOMEM; break; }
+        for (int i = J->row0[k]; i < J->row0[k + 1]; ++i) if (codes[i] >= 0) codes[i] = map[codes[i]];
+        free(map);
+    }
+    col->levels = G.blob; col->levels_size = G.used; col->n_levels = G.n;
+    G.blob = NULL;
+    csv_dict_free(&G);
+}
+
+static char csv_detect_delim(const char *p, const char *e) {
+    int c = 0, s = 0, t = 0;
+    for (; p < e; ++p) {
+        if (*p == ',') c++;
+        else if (*p == ';') s++;
+        else if (*p == '\t') t++;
+    }
+    if (t >= c && t >= s) return '\t';
+    if (s >= c && s >= t) return ';';
+    return ',';
+}
+
+/* aloca os dados da coluna conforme o tipo */
+static int csv_alloc_column(aifd_csv *C, int j) {
+    aifd_csv_col *col = &C->col[j];
+    size_t w = col->kind == AIFD_CSV_TEXT ? sizeof(int) : (C->float32 ? sizeof(float) : sizeof(double));
+    free(col->data);
+    col->data = malloc(w * ((size_t)C->rows + 1));
+    return col->data != NULL;
+}
+
+/* buf[len] inteiro -> colunas em C (liberar com aifd_csv_free) */
+static int aifd_csv_parse(const char *buf, size_t len, const aifd_csv_opts *o, aifd_csv *C) {
+    memset(C, 0, sizeof(*C));
+    double t0 = aifd_now();
+    const char *p = buf, *end = buf + len;
+    if (len >= 3 && memcmp(p, "\xEF\xBB\xBF", 3) == 0) p += 3;   /* BOM UTF-8 */
+
+    /* cabeçalho: primeira linha não vazia */
+    const char *he = p, *hl = p;
+    while (p < end) {
+        he = csv_line_end(p, end);
+        hl = (he > p && he[-1] == '\r') ? he - 1 : he;
+        if (hl > p) break;
+        p = he < end ? he + 1 : end;
+    }
+    if (p >= end) return AIFD_EINVAL;
+    C->delim = o->delim ? o->delim : csv_detect_delim(p, hl);
+    C->float32 = o->float32 ? 1 : 0;
+    int cols = 0;
+    for (const char *q = p; q <= hl; ++cols) { csv_span c; q = csv_cell(q, hl, C->delim, &c); }
+    C->cols = cols;
+    C->col = (aifd_csv_col*)calloc((size_t)cols, sizeof(aifd_csv_col));
+    if (!C->col) return AIFD_ENOMEM;
+    csv_buf hb = { NULL, 0 };
+    const char *q = p;
+    for (int j = 0; j < cols; ++j) {
+        char num[16];
+        csv_span c;
+        q = csv_cell(q, hl, C->delim, &c);
+        if (c.esc && !csv_unescape(&hb, &c)) { free(hb.p); aifd_csv_free(C); return AIFD_ENOMEM; }
+        if (!o->na_pandas) csv_trim(&c.s, &c.e);
+        if (!o->header) { snprintf(num, sizeof(num), "%d", j); c.s = num; c.e = num + strlen(num); }
+        size_t n = (size_t)(c.e - c.s);
+        C->col[j].name = (char*)malloc(n + 1);
+        if (!C->col[j].name) { free(hb.p); aifd_csv_free(C); return AIFD_ENOMEM; }
+        memcpy(C->col[j].name, c.s, n); C->col[j].name[n] = '\0';
+    }
+    free(hb.p);
+    const char *body = o->header ? (he < end ? he + 1 : end) : p;
+
+    /* blocos: um por thread, com pelo menos CSV_MIN_BLOCK bytes */
+    size_t blen = (size_t)(end - body);
+    int T = aifd_num_threads(o->threads);
+    if ((size_t)T > blen / CSV_MIN_BLOCK + 1) T = (int)(blen / CSV_MIN_BLOCK + 1);
+    if (T > 64) T = 64;
+    if (T < 1) T = 1;
+
+    const char *start[65];
+    int row0[65], count[64], quotes[64];
+    csv_job J;
+    memset(&J, 0, sizeof(J));
+    J.C = C; J.T = T; J.na_pandas = o->na_pandas ? 1 : 0; J.last = cols - 1;
+    J.start = start; J.row0 = row0; J.count = count; J.quotes = quotes;
+    J.body = body; J.end = end;
+    for (int k = 0; k <= T; ++k) start[k] = body + blen * (size_t)k / (size_t)T;
+    if (T > 1) {
+        aifd_parallel_for(T, T, csv_count_quotes, &J);
+        /* a paridade no corte nominal é exata; dali até o 1º '\n' fora de aspas.
+           Um campo entre aspas maior que um bloco só deixa blocos vazios. */
+        int par = 0;
+        const char *cut[65];
+        memcpy(cut, start, sizeof(const char*) * (T + 1));
+        for (int k = 1; k < T; ++k) {
+            par ^= quotes[k - 1] & 1;
+            const char *s = cut[k];
+            int inq = par;
+            while (s < end && (inq || *s != '\n')) { if (*s == '"') inq ^= 1; ++s; }
+            start[k] = s < end ? s + 1 : end;
+        }
+    }
+
+    aifd_parallel_for(T, T, csv_count_rows, &J);
+    long long total = 0;
+    for (int k = 0; k < T; ++k) { row0[k] = (int)total; total += count[k]; }
+    if (total > 0x7fffffff) { aifd_csv_free(C); return AIFD_EINVAL; }
+    row0[T] = (int)total;
+    C->rows = (int)total;
+
+    unsigned char *want = (unsigned char*)malloc((size_t)cols);
+    J.seen_text = (unsigned char*)calloc((size_t)T * cols, 1);
+    J.not_int = (unsigned char*)calloc((size_t)T * cols, 1);
+    J.dict = (csv_dict*)calloc((size_t)T * cols, sizeof(csv_dict));
+    J.scratch = (csv_buf*)calloc((size_t)T, sizeof(csv_buf));
+    int rc = (want && J.seen_text && J.not_int && J.dict && J.scratch) ? AIFD_OK : AIFD_ENOMEM;
+    J.want = want;
+
+    /* amostra das primeiras linhas: colunas com texto já nascem TEXT */
+    if (rc == AIFD_OK) {
+        memset(want, 1, (size_t)cols);
+        J.probe = 1;
+        csv_parse_block(&J, 0, body, end, 0, CSV_SNIFF_ROWS);
+        J.probe = 0;
+        for (int j = 0; j < cols; ++j) {
+            C->col[j].kind = J.seen_text[j] ? AIFD_CSV_TEXT : AIFD_CSV_FLOAT;
+            if (!csv_alloc_column(C, j)) rc = AIFD_ENOMEM;
+        }
+        memset(J.seen_text, 0, (size_t)T * cols);
+        memset(J.not_int, 0, (size_t)T * cols);
+    }
+    if (rc == AIFD_OK) {
+        aifd_parallel_for(T, T, csv_parse_blocks, &J);
+        rc = J.err;
+    }
+    /* texto depois da amostra: só essas colunas são relidas, agora como TEXT */
+    if (rc == AIFD_OK) {
+        int again = 0, last = -1;
+        for (int j = 0; j < cols; ++j) {
+            want[j] = 0;
+            if (C->col[j].kind == AIFD_CSV_TEXT) continue;
+            for (int k = 0; k < T; ++k) want[j] |= J.seen_text[(size_t)k * cols + j];
+            if (!want[j]) continue;
+            C->col[j].kind = AIFD_CSV_TEXT;
+            if (!csv_alloc_column(C, j)) rc = AIFD_ENOMEM;
+            again = 1; last = j;
+        }
+        if (again && rc == AIFD_OK) {
+            J.last = last;
+            aifd_parallel_for(T, T, csv_parse_blocks, &J);
+            rc = J.err;
+        }
+    }
+    if (rc == AIFD_OK) {
+        aifd_parallel_tasks(cols, o->threads, csv_merge_column, &J, NULL);
+        rc = J.err;
+        for (int j = 0; j < cols; ++j) {
+            if (C->col[j].kind != AIFD_CSV_FLOAT || C->rows == 0) continue;
+            int is_int = 1;
+            for (int k = 0; k < T; ++k) is_int &= !J.not_int[(size_t)k * cols + j];
+            if (is_int) C->col[j].kind = AIFD_CSV_INT;
+        }
+    }
+
+    for (size_t i = 0; J.dict && i < (size_t)T * cols; ++i) csv_dict_free(&J.dict[i]);
+    for (int k = 0; J.scratch && k < T; ++k) free(J.scratch[k].p);
+    free(J.dict); free(J.scratch); free(J.seen_text); free(J.not_int); free(want);
+    if (rc != AIFD_OK) { aifd_csv_free(C); return rc; }
+    C->seconds = aifd_now() - t0;
+    return AIFD_OK;
+}
+
+AIFD_NATIVE_END
+#endif
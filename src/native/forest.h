@@ -0,0 +1,452 @@
+#ifndef NATIVE_FOREST_H
+#define NATIVE_FOREST_H
+
+/* -------- Árvores de decisão e random forest (CART) --------
+   Splits por histograma sobre os bins de quantis (bins.h): gini na
+   classificação, variância na regressão. Cada árvore é uma tarefa da fila
+   (aifd_parallel_tasks) com semente própria, então o resultado não depende
+   do nº de threads. Os nós ficam num vetor plano em pré-ordem (filho
+   esquerdo = nó seguinte, 16 bytes por nó); a inferência percorre blocos de
+   linhas árvore a árvore para que cada árvore fique no cache. */
+
+#include "native_common.h"
+#include "bins.h"
+
+AIFD_NATIVE_BEGIN
+
+#define FOREST_SMALL_NODE 96      /* nós menores ordenam os códigos em vez de varrer os 255 bins */
+#define FOREST_PRED_BLOCK 256
+#define FOREST_NO_DEPTH   (1 << 30)
+
+/* feature < 0: folha, e right = offset do valor em values */
+typedef struct { int feature, right; double thr; } aifd_tree_node;
+
+typedef struct {
+    int n_trees, k;             /* k = 0 regressão; senão nº de classes */
+    int n_nodes, n_values;
+    aifd_tree_node *nodes;      /* árvores em sequência; right é índice absoluto */
+    int *roots;
+    double *values;             /* folha: k probabilidades ou 1 valor */
+} aifd_forest;
+
+typedef struct {
+    int n_trees;
+    int max_depth;              /* 0 = sem limite */
+    int min_split, min_leaf;
+    double max_features;        /* fração das colunas por nó; 0 = sqrt(d) (classes) / todas (regressão) */
+    int bootstrap;
+    unsigned long long seed;
+    int first_tree;             /* índice global da 1ª árvore: warm start continua as sementes */
+    int threads;
+} aifd_forest_opts;
+
+static void aifd_forest_defaults(aifd_forest_opts *o) {
+    o->n_trees = 100; o->max_depth = 0; o->min_split = 2; o->min_leaf = 1;
+    o->max_features = 0.0; o->bootstrap = 1; o->seed = 42; o->first_tree = 0; o->threads = 0;
+}
+
+typedef struct { aifd_tree_node *nodes; double *values; int nn, nv, cap_n, cap_v; } forest_tree;
+typedef struct { int lo, hi, depth, parent; } forest_item;
+
+/* buffers de uma thread */
+typedef struct {
+    int *rows, *w, *leaf, *perm, *keys, *code_of;
+    double *hist, *tot, *left;
+    forest_item *stack;
+    int cap_s;
+} forest_ws;
+
+typedef struct {
+    const double *X, *y;
+    int n, d, k, S, mtry;       /* S = estatísticas por bin: k contagens, ou (peso, soma) */
+    const aifd_bins *B;
+    const aifd_forest_opts *o;
+    forest_tree *trees;
+    forest_ws *ws;
+    pthread_mutex_t lock;       /* protege acc/cnt, done, rc e o callback */
+    double *acc;                /* previsões OOB somadas (treino inteiro sem bootstrap) */
+    int *cnt;
+    int done, rc;
+    volatile int stop;
+    aifd_fit_fn cb;
+    void *user;
+} forest_job;
+
+static int tree_push_node(forest_tree *T, int feature, int right, double thr) {
+    if (T->nn == T->cap_n) {
+        int cap = T->cap_n ? 2 * T->cap_n : 256;
+        aifd_tree_node *p = (aifd_tree_node*)realloc(T->nodes, sizeof(aifd_tree_node) * cap);
+        if (!p) return -1;
+        T->nodes = p; T->cap_n = cap;
+    }
+    T->nodes[T->nn].feature = feature; T->nodes[T->nn].right = right; T->nodes[T->nn].thr = thr;
+    return T->nn++;
+}
+
+static int tree_push_values(forest_tree *T, const double *v, int cnt) {
+    if (T->nv + cnt > T->cap_v) {
+        int cap = T->cap_v ? 2 * T->cap_v : 256;
+        while (cap < T->nv + cnt) cap *= 2;
+        double *p = (double*)realloc(T->values, sizeof(double) * cap);
+        if (!p) return -1;
+        T->values = p; T->cap_v = cap;
+    }
+    memcpy(T->values + T->nv, v, sizeof(double) * cnt);
+    T->nv += cnt;
+    return T->nv - cnt;
+}
+
+static inline int forest_leaf(const aifd_tree_node *nodes, int i, const double *x) {
+    while (nodes[i].feature >= 0) i = x[nodes[i].feature] <= nodes[i].thr ? i + 1 : nodes[i].right;
+    return nodes[i].right;
+}
+
+static inline void forest_add_row(const forest_job *J, double *h, int r, double w) {
+    if (J->k) h[(int)J->y[r]] += w;
+    else { h[0] += w; h[1] += w * J->y[r]; }
+}
+
+/* critério a maximizar: sum_c n_c^2 / n (gini) ou soma^2 / peso (variância) */
+static inline double forest_side_score(const forest_job *J, const double *h, double W) {
+    if (!J->k) return h[1] * h[1] / W;
+    double s = 0.0;
+    for (int c = 0; c < J->k; ++c) s += h[c] * h[c];
+    return s / W;
+}
+
+/* melhor limite da coluna f em rows[lo,hi). Retorna o score (ou -1 sem split
+   válido, -2 coluna constante no nó) e o código do limite em *bin */
+static double forest_best_split(const forest_job *J, forest_ws *ws, int f, int lo, int hi, double W, int *bin) {
+    const int S = J->S, min_leaf = J->o->min_leaf;
+    const unsigned char *code = J->B->codes + (size_t)f * J->n;
+    int ne = 0;
+    if (hi - lo <= FOREST_SMALL_NODE) {
+        /* poucos dados: ordena (código, posição) e agrupa códigos iguais */
+        int m = hi - lo;
+        for (int i = 0; i < m; ++i) {
+            int key = ((int)code[ws->rows[lo + i]] << 7) | i, j = i - 1;
+            while (j >= 0 && ws->keys[j] > key) { ws->keys[j + 1] = ws->keys[j]; --j; }
+            ws->keys[j + 1] = key;
+        }
+        for (int i = 0; i < m; ++i) {
+            int c = ws->keys[i] >> 7, r = ws->rows[lo + (ws->keys[i] & 127)];
+            if (ne == 0 || ws->code_of[ne - 1] != c) {
+                ws->code_of[ne] = c;
+                memset(ws->hist + (size_t)ne * S, 0, sizeof(double) * S);
+                ne++;
+            }
+            forest_add_row(J, ws->hist + (size_t)(ne - 1) * S, r, ws->w[r]);
+        }
+    } else {
+        int nb = J->B->nbins[f], cmin = nb, cmax = -1;
+        memset(ws->hist, 0, sizeof(double) * (size_t)nb * S);
+        for (int i = lo; i < hi; ++i) {
+            int r = ws->rows[i], c = code[r];
+            forest_add_row(J, ws->hist + (size_t)c * S, r, ws->w[r]);
+            if (c < cmin) cmin = c;
+            if (c > cmax) cmax = c;
+        }
+        if (cmin == cmax) return -2.0;
+        /* compacta os bins [cmin, cmax] no início do histograma */
+        for (int c = cmin; c <= cmax; ++c) ws->code_of[ne++] = c;
+        if (cmin > 0) memmove(ws->hist, ws->hist + (size_t)cmin * S, sizeof(double) * (size_t)ne * S);
+    }
+    if (ne < 2) return -2.0;
+
+    double best = -1.0, WL = 0.0;
+    memset(ws->left, 0, sizeof(double) * S);
+    for (int e = 0; e + 1 < ne; ++e) {
+        const double *h = ws->hist + (size_t)e * S;
+        double we = 0.0;
+        if (J->k) for (int c = 0; c < J->k; ++c) we += h[c];
+        else      we = h[0];
+        if (we == 0.0) continue;
+        for (int s = 0; s < S; ++s) ws->left[s] += h[s];
+        WL += we;
+        if (WL < min_leaf) continue;
+        double WR = W - WL;
+        if (WR < min_leaf) break;
+        double sl = forest_side_score(J, ws->left, WL), sr;
+        if (J->k) {
+            sr = 0.0;
+            for (int c = 0; c < J->k; ++c) { double t = ws->tot[c] - ws->left[c]; sr += t * t; }
+            sr /= WR;
+        } else {
+            double t = ws->tot[1] - ws->left[1];
+            sr = t * t / WR;
+        }
+        if (sl + sr > best) { best = sl + sr; *bin = ws->code_of[e]; }
+    }
+    return best;
+}
+
+static int forest_grow(forest_job *J, forest_ws *ws, int t, forest_tree *T) {
+    const aifd_forest_opts *o = J->o;
+    const int n = J->n, d = J->d, k = J->k, S = J->S;
+    const int max_depth = o->max_depth > 0 ? o->max_depth : FOREST_NO_DEPTH;
+    unsigned long long rng = o->seed ^ (0x9E3779B97F4A7C15ULL * (unsigned long long)(o->first_tree + t + 1));
+    aifd_rng_next(&rng);
+    for (int f = 0; f < d; ++f) ws->perm[f] = f;   /* sorteios dependem só da semente da árvore */
+
+    int m = 0;
+    if (o->bootstrap) {
+        memset(ws->w, 0, sizeof(int) * n);
+        for (int i = 0; i < n; ++i) ws->w[aifd_rng_next(&rng) % (unsigned long long)n]++;
+        for (int i = 0; i < n; ++i) if (ws->w[i]) ws->rows[m++] = i;
+    } else {
+        for (int i = 0; i < n; ++i) { ws->w[i] = 1; ws->rows[m++] = i; }
+    }
+
+    int sp = 0;
+    ws->stack[sp++] = (forest_item){ 0, m, 0, -1 };
+    while (sp > 0) {
+        forest_item it = ws->stack[--sp];
+        int idx = T->nn;
+        if (it.parent >= 0) T->nodes[it.parent].right = idx;
+
+        memset(ws->tot, 0, sizeof(double) * S);
+        for (int i = it.lo; i < it.hi; ++i) forest_add_row(J, ws->tot, ws->rows[i], ws->w[ws->rows[i]]);
+        double W = 0.0;
+        int pure = 0;
+        if (k) {
+            for (int c = 0; c < k; ++c) W += ws->tot[c];
+            for (int c = 0; c < k; ++c) pure |= ws->tot[c] == W;
+        } else W = ws->tot[0];
+
+        int best_f = -1, best_b = 0;
+        if (!pure && it.depth < max_depth && W >= o->min_split && it.hi - it.lo >= 2) {
+            double parent = forest_side_score(J, ws->tot, W), best = parent + 1e-12 * (fabs(parent) + 1.0);
+            /* sorteia colunas (Fisher-Yates parcial) até mtry não constantes */
+            for (int s = 0, seen = 0; s < d && seen < J->mtry; ++s) {
+                int r = s + (int)(aifd_rng_next(&rng) % (unsigned long long)(d - s));
+                int f = ws->perm[r]; ws->perm[r] = ws->perm[s]; ws->perm[s] = f;
+                int b = 0;
+                double sc = forest_best_split(J, ws, f, it.lo, it.hi, W, &b);
+                if (sc == -2.0) continue;
+                seen++;
+                if (sc > best) { best = sc; best_f = f; best_b = b; }
+            }
+        }
+
+        if (best_f < 0) {
+            double mean = ws->tot[1] / W;
+            if (k) for (int c = 0; c < k; ++c) ws->tot[c] /= W;
+            int off = tree_push_values(T, k ? ws->tot : &mean, k ? k : 1);
+            if (off < 0 || tree_push_node(T, -1, off, 0.0) < 0) return AIFD_ENOMEM;
+            continue;
+        }
+
+        if (tree_push_node(T, best_f, 0, J->B->edges[(size_t)best_f * AIFD_MAX_BINS + best_b]) < 0) return AIFD_ENOMEM;
+        const unsigned char *code = J->B->codes + (size_t)best_f * n;
+        int a = it.lo, b = it.hi - 1;
+        while (a <= b) {
+            if (code[ws->rows[a]] <= best_b) a++;
+            else { int tmp = ws->rows[a]; ws->rows[a] = ws->rows[b]; ws->rows[b--] = tmp; }
+        }
+        if (sp + 2 > ws->cap_s) {
+            int cap = 2 * ws->cap_s;
+            forest_item *p = (forest_item*)realloc(ws->stack, sizeof(forest_item) * cap);
+            if (!p) return AIFD_ENOMEM;
+            ws->stack = p; ws->cap_s = cap;
+        }
+        ws->stack[sp++] = (forest_item){ a, it.hi, it.depth + 1, idx };  /* direita: sai depois */
+        ws->stack[sp++] = (forest_item){ it.lo, a, it.depth + 1, -1 };   /* esquerda = idx + 1 */
+    }
+    return AIFD_OK;
+}
+
+/* soma a árvore nova nas previsões OOB e reporta (loss, score) dessas linhas */
+static void forest_report(forest_job *J, forest_ws *ws, const forest_tree *T) {
+    const int n = J->n, d = J->d, k = J->k;
+    for (int i = 0; i < n; ++i)
+        ws->leaf[i] = (J->o->bootstrap && ws->w[i]) ? -1 : forest_leaf(T->nodes, 0, J->X + (size_t)i * d);
+
+    pthread_mutex_lock(&J->lock);
+    double loss = 0.0, score = 0.0, ym = 0.0, sst = 0.0;
+    int m = 0;
+    for (int i = 0; i < n; ++i) {
+        if (ws->leaf[i] >= 0) {
+            if (k) aifd_axpy(1.0, T->values + ws->leaf[i], J->acc + (size_t)i * k, k);
+            else   J->acc[i] += T->values[ws->leaf[i]];
+            J->cnt[i]++;
+        }
+        if (!J->cnt[i]) continue;
+        m++;
+        if (k) {
+            const double *p = J->acc + (size_t)i * k;
+            int y = (int)J->y[i], best = 0;
+            for (int c = 1; c < k; ++c) if (p[c] > p[best]) best = c;
+            loss -= log(fmax(p[y] / J->cnt[i], 1e-15));
+            score += best == y;
+        } else {
+            double e = J->acc[i] / J->cnt[i] - J->y[i];
+            loss += e * e;
+            ym += J->y[i];
+        }
+    }
+    if (m > 0) {
+        loss /= m;
+        if (k) score /= m;
+        else {
+            ym /= m;
+            for (int i = 0; i < n; ++i) if (J->cnt[i]) sst += (J->y[i] - ym) * (J->y[i] - ym);
+            score = sst > 0.0 ? 1.0 - loss * m / sst : 0.0;
+        }
+    }
+    J->done++;
+    if (J->cb && J->cb(J->user, J->done, J->o->n_trees, loss, score))
+        __atomic_store_n(&J->stop, 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&J->lock);
+}
+
+static void forest_task(void *arg, int t, int tid) {
+    forest_job *J = (forest_job*)arg;
+    forest_tree *T = &J->trees[t];
+    int rc = forest_grow(J, &J->ws[tid], t, T);
+    if (rc == AIFD_OK) { forest_report(J, &J->ws[tid], T); return; }
+    free(T->nodes); free(T->values);
+    memset(T, 0, sizeof(*T));
+    pthread_mutex_lock(&J->lock);
+    J->rc = rc;
+    __atomic_store_n(&J->stop, 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&J->lock);
+}
+
+/* junta as árvores prontas (em ordem) no vetor plano */
+static int forest_assemble(const forest_tree *trees, int count, int k, aifd_forest *F) {
+    int nt = 0, nn = 0, nv = 0;
+    for (int t = 0; t < count; ++t)
+        if (trees[t].nn) { nt++; nn += trees[t].nn; nv += trees[t].nv; }
+    F->k = k;
+    F->nodes  = (aifd_tree_node*)malloc(sizeof(aifd_tree_node) * (nn ? nn : 1));
+    F->roots  = (int*)malloc(sizeof(int) * (nt ? nt : 1));
+    F->values = (double*)malloc(sizeof(double) * (nv ? nv : 1));
+    if (!F->nodes || !F->roots || !F->values) return AIFD_ENOMEM;
+    for (int t = 0; t < count; ++t) {
+        const forest_tree *T = &trees[t];
+        if (!T->nn) continue;
+        F->roots[F->n_trees++] = F->n_nodes;
+        for (int i = 0; i < T->nn; ++i) {
+            aifd_tree_node nd = T->nodes[i];
+            nd.right += nd.feature >= 0 ? F->n_nodes : F->n_values;
+            F->nodes[F->n_nodes + i] = nd;
+        }
+        memcpy(F->values + F->n_values, T->values, sizeof(double) * T->nv);
+        F->n_nodes += T->nn; F->n_values += T->nv;
+    }
+    return AIFD_OK;
+}
+
+static void aifd_forest_free(aifd_forest *F) {
+    free(F->nodes); free(F->roots); free(F->values);
+    memset(F, 0, sizeof(*F));
+}
+
+/* X linha-major n x d; y: valor (k = 0) ou índice da classe (k >= 2).
+   cb a cada árvore pronta (iter = árvores prontas, loss/score OOB com
+   bootstrap, de treino sem), chamado sob lock na thread que a terminou.
+   Cancelado: F tem as árvores já prontas e o retorno é AIFD_CANCELLED. */
+static int aifd_forest_fit(const double *X, int n, int d, const double *y, int k,
+                           const aifd_forest_opts *o, aifd_forest *F, aifd_fit_fn cb, void *user) {
+    memset(F, 0, sizeof(*F));
+    if (!X || !y || n < 2 || d < 1 || k == 1 || k < 0 || o->n_trees < 1) return AIFD_EINVAL;
+    if (k) for (int i = 0; i < n; ++i) if (!(y[i] >= 0 && y[i] < k)) return AIFD_EINVAL;
+
+    forest_job J;
+    memset(&J, 0, sizeof(J));
+    J.X = X; J.y = y; J.n = n; J.d = d; J.k = k; J.S = k ? k : 2; J.o = o; J.cb = cb; J.user = user;
+    J.mtry = o->max_features > 0.0 ? (int)(o->max_features * d) : (k ? (int)sqrt((double)d) : d);
+    if (J.mtry < 1) J.mtry = 1;
+    if (J.mtry > d) J.mtry = d;
+
+    aifd_bins B;
+    int rc = aifd_bins_build(X, n, d, o->threads, &B);
+    if (rc != AIFD_OK) return rc;
+    J.B = &B;
+
+    int t = aifd_num_threads(o->threads);
+    if (t > o->n_trees) t = o->n_trees;
+    J.trees = (forest_tree*)calloc(o->n_trees, sizeof(forest_tree));
+    J.ws    = (forest_ws*)calloc(t, sizeof(forest_ws));
+    J.acc   = (double*)calloc((size_t)n * (k ? k : 1), sizeof(double));
+    J.cnt   = (int*)calloc(n, sizeof(int));
+    rc = (J.trees && J.ws && J.acc && J.cnt) ? AIFD_OK : AIFD_ENOMEM;
+    for (int w = 0; rc == AIFD_OK && w < t; ++w) {
+        forest_ws *ws = &J.ws[w];
+        ws->rows    = (int*)malloc(sizeof(int) * n);
+        ws->w       = (int*)malloc(sizeof(int) * n);
+        ws->leaf    = (int*)malloc(sizeof(int) * n);
+        ws->perm    = (int*)malloc(sizeof(int) * d);
+        ws->keys    = (int*)malloc(sizeof(int) * FOREST_SMALL_NODE);
+        ws->code_of = (int*)malloc(sizeof(int) * AIFD_MAX_BINS);
+        ws->hist    = (double*)malloc(sizeof(double) * AIFD_MAX_BINS * J.S);
+        ws->tot     = (double*)malloc(sizeof(double) * J.S);
+        ws->left    = (double*)malloc(sizeof(double) * J.S);
+        ws->cap_s   = 64;
+        ws->stack   = (forest_item*)malloc(sizeof(forest_item) * ws->cap_s);
+        if (!ws->rows || !ws->w || !ws->leaf || !ws->perm || !ws->keys || !ws->code_of
+            || !ws->hist || !ws->tot || !ws->left || !ws->stack) { rc = AIFD_ENOMEM; break; }
+    }
+
+    if (rc == AIFD_OK) {
+        pthread_mutex_init(&J.lock, NULL);
+        aifd_parallel_tasks(o->n_trees, t, forest_task, &J, &J.stop);
+        pthread_mutex_destroy(&J.lock);
+        rc = J.rc;
+        if (rc == AIFD_OK && forest_assemble(J.trees, o->n_trees, k, F) != AIFD_OK) rc = AIFD_ENOMEM;
+        if (rc == AIFD_OK && J.done < o->n_trees) rc = AIFD_CANCELLED;
+        if (rc < 0) aifd_forest_free(F);
+    }
+
+    for (int w = 0; J.ws && w < t; ++w) {
+        forest_ws *ws = &J.ws[w];
+        free(ws->rows); free(ws->w); free(ws->leaf); free(ws->perm); free(ws->keys);
+        free(ws->code_of); free(ws->hist); free(ws->tot); free(ws->left); free(ws->stack);
+    }
+    for (int i = 0; J.trees && i < o->n_trees; ++i) { free(J.trees[i].nodes); free(J.trees[i].values); }
+    free(J.trees); free(J.ws); free(J.acc); free(J.cnt);
+    aifd_bins_free(&B);
+    return rc;
+}
+
+typedef struct {
+    const aifd_forest *F;
+    const double *X;
+    int d;
+    double *out;
+} forest_pred_job;
+
+static void forest_pred_rows(void *arg, int b, int e, int tid) {
+    forest_pred_job *P = (forest_pred_job*)arg;
+    const aifd_forest *F = P->F;
+    const int K = F->k ? F->k : 1;
+    const double inv = F->n_trees ? 1.0 / F->n_trees : 0.0;
+    (void)tid;
+    for (int r0 = b; r0 < e; r0 += FOREST_PRED_BLOCK) {
+        int r1 = r0 + FOREST_PRED_BLOCK < e ? r0 + FOREST_PRED_BLOCK : e;
+        double *out = P->out + (size_t)r0 * K;
+        memset(out, 0, sizeof(double) * (size_t)(r1 - r0) * K);
+        for (int t = 0; t < F->n_trees; ++t)
+            for (int r = r0; r < r1; ++r) {
+                const double *v = F->values + forest_leaf(F->nodes, F->roots[t], P->X + (size_t)r * P->d);
+                double *o = P->out + (size_t)r * K;
+                for (int c = 0; c < K; ++c) o[c] += v[c];
+            }
+        for (size_t i = 0; i < (size_t)(r1 - r0) * K; ++i) out[i] *= inv;
+    }
+}
+
+/* média das árvores: out n x k (probabilidades) ou n (regressão) */
+static int aifd_forest_predict(const aifd_forest *F, const double *X, int n, int d, double *out, int threads) {
+    if (!F || !X || !out || n < 0 || d < 1) return AIFD_EINVAL;
+    forest_pred_job P = { F, X, d, out };
+    int blocks = (n + FOREST_PRED_BLOCK - 1) / FOREST_PRED_BLOCK;
+    int t = (double)n * F->n_trees < 1e5 ? 1 : aifd_num_threads(threads);
+    if (t > blocks) t = blocks;
+    aifd_parallel_for(n, t, forest_pred_rows, &P);
+    return AIFD_OK;
+}
+
+AIFD_NATIVE_END
+
+#endif
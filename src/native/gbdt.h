@@ -0,0 +1,398 @@
+#ifndef NATIVE_GBDT_H
+#define NATIVE_GBDT_H
+
+/* -------- Gradient boosting por histogramas (estilo LightGBM / HistGradientBoosting) --------
+   Colunas em bins uint8 (bins.h). Cada árvore cresce por folha: sempre abre a
+   folha de maior ganho, até max_leaves. Histogramas de (g, h, n) por folha:
+   só o filho menor é montado varrendo linhas (colunas divididas entre
+   threads); o maior sai de pai - menor. As linhas de cada folha ficam
+   contíguas em rows, então somar a folha nas previsões de treino não
+   percorre a árvore. Perdas: quadrática (k = 0), logística (k = 2) e
+   softmax com k árvores por rodada (k > 2). As árvores saem no mesmo vetor
+   plano em pré-ordem de forest.h. */
+
+#include "native_common.h"
+#include "bins.h"
+#include "forest.h"
+
+AIFD_NATIVE_BEGIN
+
+#define GBDT_PAR_MIN (1 << 16)  /* linhas x colunas mínimas para dividir o histograma entre threads */
+
+typedef struct {
+    int rounds;                 /* rodadas de boosting (k > 2: k árvores por rodada) */
+    double lr;
+    int max_leaves;
+    int max_depth;              /* 0 = sem limite */
+    int min_leaf;
+    double l2;                  /* regularização L2 dos valores das folhas */
+    int threads;
+} aifd_gbdt_opts;
+
+static void aifd_gbdt_defaults(aifd_gbdt_opts *o) {
+    o->rounds = 100; o->lr = 0.1; o->max_leaves = 31; o->max_depth = 0;
+    o->min_leaf = 20; o->l2 = 0.0; o->threads = 0;
+}
+
+static int aifd_gbdt_outputs(int k) { return k > 2 ? k : 1; }
+
+typedef struct { double gain, gl, hl; int feat, bin, nl; } gbdt_split;
+
+typedef struct {
+    int lo, hi, depth, node;
+    double G, H;
+    double *hist;               /* off[d] bins x (g, h, n) */
+    gbdt_split best;
+} gbdt_leaf;
+
+typedef struct { int feature, bin, left, right; double value; } gbdt_gnode;
+
+typedef struct {
+    const aifd_bins *B;
+    const aifd_gbdt_opts *o;
+    int n, d;
+    const int *off;             /* início de cada coluna no histograma */
+    const int *rows;
+    const double *og, *oh;      /* g/h na ordem de rows (contíguos para a varredura) */
+    int unit_h;                 /* perda quadrática: h = 1, soma de h = contagem */
+    gbdt_leaf *small, *large;   /* large = NULL na raiz */
+    gbdt_split *bs, *bl;        /* melhor split por coluna */
+    int max_depth;
+} gbdt_pass;
+
+static void gbdt_scan(const gbdt_pass *P, const gbdt_leaf *L, int f, gbdt_split *out) {
+    const double *hs = L->hist + (size_t)P->off[f] * 3;
+    const double l2 = P->o->l2, parent = L->G * L->G / (L->H + l2);
+    const int nb = P->B->nbins[f], cnt = L->hi - L->lo, min_leaf = P->o->min_leaf;
+    double GL = 0.0, HL = 0.0;
+    int NL = 0;
+    out->gain = 0.0; out->feat = -1;
+    if (L->depth >= P->max_depth || cnt < 2 * min_leaf) return;
+    for (int b = 0; b + 1 < nb; ++b) {
+        if (hs[3 * b + 2] == 0.0) continue;
+        GL += hs[3 * b]; HL += hs[3 * b + 1]; NL += (int)hs[3 * b + 2];
+        if (NL < min_leaf) continue;
+        if (cnt - NL < min_leaf) break;
+        double GR = L->G - GL, HR = L->H - HL;
+        if (HL < 1e-3 || HR < 1e-3) continue;
+        double gain = GL * GL / (HL + l2) + GR * GR / (HR + l2) - parent;
+        if (gain > out->gain) { out->gain = gain; out->feat = f; out->bin = b; out->gl = GL; out->hl = HL; out->nl = NL; }
+    }
+}
+
+/* histograma do filho menor por varredura, do maior por subtração, e melhor split de ambos */
+static void gbdt_hist_cols(void *arg, int b, int e, int tid) {
+    gbdt_pass *P = (gbdt_pass*)arg;
+    const gbdt_leaf *S = P->small;
+    (void)tid;
+    for (int f = b; f < e; ++f) {
+        double *hs = S->hist + (size_t)P->off[f] * 3;
+        const unsigned char *code = P->B->codes + (size_t)f * P->n;
+        int nb = P->B->nbins[f];
+        const int *rows = P->rows;
+        const double *og = P->og, *oh = P->oh;
+        memset(hs, 0, sizeof(double) * 3 * nb);
+        if (P->unit_h) {
+            for (int i = S->lo; i < S->hi; ++i) { double *c = hs + 3 * code[rows[i]]; c[0] += og[i]; c[2] += 1.0; }
+            for (int q = 0; q < nb; ++q) hs[3 * q + 1] = hs[3 * q + 2];
+        } else {
+            for (int i = S->lo; i < S->hi; ++i) {
+                double *c = hs + 3 * code[rows[i]];
+                c[0] += og[i]; c[1] += oh[i]; c[2] += 1.0;
+            }
+        }
+        gbdt_scan(P, S, f, &P->bs[f]);
+        if (P->large) {
+            double *hl = P->large->hist + (size_t)P->off[f] * 3;
+            for (int q = 0; q < 3 * nb; ++q) hl[q] -= hs[q];
+            gbdt_scan(P, P->large, f, &P->bl[f]);
+        }
+    }
+}
+
+static void gbdt_reduce(const gbdt_split *s, int d, gbdt_split *best) {
+    best->gain = 0.0; best->feat = -1;
+    for (int f = 0; f < d; ++f) if (s[f].feat >= 0 && s[f].gain > best->gain) *best = s[f];
+}
+
+typedef struct {
+    const double *X, *y;
+    int n, d, k, K;
+    const aifd_gbdt_opts *o;
+    aifd_bins B;
+    int *off, *rows, *tmp;
+    double *F, *g, *h, *og, *oh, *prob, *pool;
+    gbdt_split *bs, *bl;
+    gbdt_leaf *leaves;
+    gbdt_gnode *gn;
+    int threads, max_depth;
+    size_t hist_len;            /* doubles por histograma */
+} gbdt_job;
+
+/* cresce uma árvore para a saída c com g/h atuais; soma lr·folha em F e anexa a T */
+static int gbdt_grow(gbdt_job *J, int c, forest_tree *T) {
+    const int n = J->n, d = J->d, ML = J->o->max_leaves > 1 ? J->o->max_leaves : 2;
+    gbdt_pass P = { &J->B, J->o, n, d, J->off, J->rows, J->og, J->oh, !J->k, NULL, NULL, J->bs, J->bl, J->max_depth };
+    int nl = 1, ng = 1, used = 1;
+    gbdt_leaf *L = J->leaves;
+    L[0].lo = 0; L[0].hi = n; L[0].depth = 0; L[0].node = 0; L[0].hist = J->pool;
+    L[0].G = L[0].H = 0.0;
+    for (int i = 0; i < n; ++i) {
+        J->rows[i] = i; J->og[i] = J->g[i]; J->oh[i] = J->h[i];
+        L[0].G += J->g[i]; L[0].H += J->h[i];
+    }
+    J->gn[0].feature = -1;
+
+    P.small = &L[0];
+    aifd_parallel_for(d, (double)n * d < GBDT_PAR_MIN ? 1 : J->threads, gbdt_hist_cols, &P);
+    gbdt_reduce(J->bs, d, &L[0].best);
+
+    while (nl < ML) {
+        int p = -1;
+        for (int i = 0; i < nl; ++i)
+            if (L[i].best.feat >= 0 && (p < 0 || L[i].best.gain > L[p].best.gain)) p = i;
+        if (p < 0) break;
+        gbdt_leaf par = L[p];
+        const gbdt_split s = par.best;
+        const unsigned char *code = J->B.codes + (size_t)s.feat * n;
+        /* partição estável: cada folha mantém as linhas em ordem crescente (acesso quase sequencial) */
+        int a = par.lo, nr = 0;
+        for (int i = par.lo; i < par.hi; ++i) {
+            int r = J->rows[i];
+            if (code[r] <= s.bin) J->rows[a++] = r; else J->tmp[nr++] = r;
+        }
+        memcpy(J->rows + a, J->tmp, sizeof(int) * nr);
+        gbdt_gnode *gp = &J->gn[par.node];
+        gp->feature = s.feat; gp->bin = s.bin; gp->left = ng; gp->right = ng + 1;
+        J->gn[ng].feature = J->gn[ng + 1].feature = -1;
+
+        gbdt_leaf lf = { par.lo, a, par.depth + 1, ng, s.gl, s.hl, NULL, { 0.0, 0.0, 0.0, -1, 0, 0 } };
+        gbdt_leaf rt = { a, par.hi, par.depth + 1, ng + 1, par.G - s.gl, par.H - s.hl, NULL, { 0.0, 0.0, 0.0, -1, 0, 0 } };
+        ng += 2;
+        /* o pai cede o histograma ao filho maior; o menor pega um buffer novo */
+        double *fresh = J->pool + (size_t)used++ * J->hist_len;
+        int left_small = (lf.hi - lf.lo) <= (rt.hi - rt.lo);
+        lf.hist = left_small ? fresh : par.hist;
+        rt.hist = left_small ? par.hist : fresh;
+        L[p] = lf; L[nl] = rt;
+        P.small = left_small ? &L[p] : &L[nl];
+        P.large = left_small ? &L[nl] : &L[p];
+        nl++;
+        for (int i = P.small->lo; i < P.small->hi; ++i) { J->og[i] = J->g[J->rows[i]]; J->oh[i] = J->h[J->rows[i]]; }
+        aifd_parallel_for(d, (double)(P.small->hi - P.small->lo) * d < GBDT_PAR_MIN ? 1 : J->threads,
+                          gbdt_hist_cols, &P);
+        gbdt_reduce(J->bs, d, &P.small->best);
+        gbdt_reduce(J->bl, d, &P.large->best);
+    }
+
+    for (int i = 0; i < nl; ++i) {
+        double v = -J->o->lr * L[i].G / (L[i].H + J->o->l2);
+        J->gn[L[i].node].value = v;
+        for (int q = L[i].lo; q < L[i].hi; ++q) J->F[(size_t)J->rows[q] * J->K + c] += v;
+    }
+
+    /* pré-ordem: filho esquerdo logo após o pai, right corrigido ao emitir o filho direito */
+    int *st = (int*)malloc(sizeof(int) * 2 * ng), sp = 0;
+    if (!st) return AIFD_ENOMEM;
+    int *pa = st + ng;
+    st[sp] = 0; pa[sp++] = -1;
+    while (sp > 0) {
+        --sp;
+        const gbdt_gnode *gnd = &J->gn[st[sp]];
+        int parent = pa[sp], idx = T->nn;
+        if (gnd->feature >= 0) {
+            if (tree_push_node(T, gnd->feature, 0, J->B.edges[(size_t)gnd->feature * AIFD_MAX_BINS + gnd->bin]) < 0) { free(st); return AIFD_ENOMEM; }
+            st[sp] = gnd->right; pa[sp++] = idx;
+            st[sp] = gnd->left;  pa[sp++] = -1;
+        } else {
+            int off = tree_push_values(T, &gnd->value, 1);
+            if (off < 0 || tree_push_node(T, -1, off, 0.0) < 0) { free(st); return AIFD_ENOMEM; }
+        }
+        if (parent >= 0) T->nodes[parent].right = idx;
+    }
+    free(st);
+    return AIFD_OK;
+}
+
+/* probabilidades / gradientes a partir de F; devolve (loss, score) de treino */
+static void gbdt_gradients(gbdt_job *J, int c, double *loss, double *score) {
+    const int n = J->n, K = J->K, k = J->k;
+    double L = 0.0, S = 0.0, ym = 0.0, sst = 0.0;
+    if (!k) {
+        for (int i = 0; i < n; ++i) { double e = J->F[i] - J->y[i]; J->g[i] = e; J->h[i] = 1.0; L += e * e; ym += J->y[i]; }
+        ym /= n;
+        for (int i = 0; i < n; ++i) sst += (J->y[i] - ym) * (J->y[i] - ym);
+        if (loss) { *loss = L / n; *score = sst > 0.0 ? 1.0 - L / sst : 0.0; }
+        return;
+    }
+    if (c == 0) {   /* probabilidades uma vez por rodada */
+        for (int i = 0; i < n; ++i) {
+            const double *f = J->F + (size_t)i * K;
+            double *p = J->prob + (size_t)i * K;
+            int y = (int)J->y[i];
+            if (K == 1) {
+                p[0] = 1.0 / (1.0 + exp(-f[0]));
+                L -= log(fmax(y ? p[0] : 1.0 - p[0], 1e-15));
+                S += (p[0] >= 0.5) == (y == 1);
+            } else {
+                double mx = f[0], z = 0.0;
+                int best = 0;
+                for (int q = 1; q < K; ++q) if (f[q] > mx) { mx = f[q]; best = q; }
+                for (int q = 0; q < K; ++q) z += (p[q] = exp(f[q] - mx));
+                for (int q = 0; q < K; ++q) p[q] /= z;
+                L -= log(fmax(p[y], 1e-15));
+                S += best == y;
+            }
+        }
+        if (loss) { *loss = L / n; *score = S / n; }
+    }
+    for (int i = 0; i < n; ++i) {
+        double p = J->prob[(size_t)i * K + c];
+        int hit = K == 1 ? (int)J->y[i] == 1 : (int)J->y[i] == c;
+        J->g[i] = p - hit;
+        J->h[i] = fmax(p * (1.0 - p), 1e-16);
+    }
+}
+
+/* árvores em ordem de rodada: a árvore t soma na saída t % K */
+typedef struct {
+    aifd_forest trees;          /* trees.k = nº de classes (0 regressão) */
+    int K;                      /* saídas cruas: k > 2 ? k : 1 */
+    double *base;               /* K valores iniciais de F */
+} aifd_gbdt;
+
+static void aifd_gbdt_free(aifd_gbdt *G) {
+    aifd_forest_free(&G->trees);
+    free(G->base);
+    memset(G, 0, sizeof(*G));
+}
+
+/* y: valor (k = 0) ou índice da classe (k >= 2). F0 (opcional, n x K): previsões
+   cruas de um modelo anterior para continuar o boosting; senão parte da média /
+   log-odds das classes. cb a cada rodada com (loss, score) de treino; cancelado,
+   G fica com as rodadas completas e o retorno é AIFD_CANCELLED. */
+static int aifd_gbdt_fit(const double *X, int n, int d, const double *y, int k, const double *F0,
+                         const aifd_gbdt_opts *o, aifd_gbdt *G, aifd_fit_fn cb, void *user) {
+    memset(G, 0, sizeof(*G));
+    if (!X || !y || n < 2 || d < 1 || k == 1 || k < 0 || o->rounds < 1) return AIFD_EINVAL;
+    if (k) for (int i = 0; i < n; ++i) if (!(y[i] >= 0 && y[i] < k)) return AIFD_EINVAL;
+
+    gbdt_job J;
+    memset(&J, 0, sizeof(J));
+    J.X = X; J.y = y; J.n = n; J.d = d; J.k = k; J.K = aifd_gbdt_outputs(k); J.o = o;
+    J.threads = aifd_num_threads(o->threads);
+    J.max_depth = o->max_depth > 0 ? o->max_depth : FOREST_NO_DEPTH;
+    int ML = o->max_leaves > 1 ? o->max_leaves : 2, rc = aifd_bins_build(X, n, d, o->threads, &J.B);
+    if (rc != AIFD_OK) return rc;
+
+    J.off = (int*)malloc(sizeof(int) * (d + 1));
+    if (J.off) {
+        J.off[0] = 0;
+        for (int f = 0; f < d; ++f) J.off[f + 1] = J.off[f] + J.B.nbins[f];
+        J.hist_len = (size_t)J.off[d] * 3;
+    }
+    J.rows   = (int*)malloc(sizeof(int) * n);
+    J.tmp    = (int*)malloc(sizeof(int) * n);
+    J.F      = (double*)malloc(sizeof(double) * (size_t)n * J.K);
+    J.g      = (double*)malloc(sizeof(double) * n);
+    J.h      = (double*)malloc(sizeof(double) * n);
+    J.og     = (double*)malloc(sizeof(double) * n);
+    J.oh     = (double*)malloc(sizeof(double) * n);
+    J.prob   = k ? (double*)malloc(sizeof(double) * (size_t)n * J.K) : NULL;
+    J.pool   = J.off ? (double*)malloc(sizeof(double) * J.hist_len * ML) : NULL;
+    J.bs     = (gbdt_split*)malloc(sizeof(gbdt_split) * d);
+    J.bl     = (gbdt_split*)malloc(sizeof(gbdt_split) * d);
+    J.leaves = (gbdt_leaf*)malloc(sizeof(gbdt_leaf) * ML);
+    J.gn     = (gbdt_gnode*)malloc(sizeof(gbdt_gnode) * 2 * ML);
+    G->base  = (double*)calloc(J.K, sizeof(double));
+    int ntrees = o->rounds * J.K;
+    forest_tree *T = (forest_tree*)calloc(ntrees, sizeof(forest_tree));
+    if (!J.off || !J.rows || !J.tmp || !J.F || !J.g || !J.h || !J.og || !J.oh || (k && !J.prob) || !J.pool || !J.bs || !J.bl
+        || !J.leaves || !J.gn || !G->base || !T) rc = AIFD_ENOMEM;
+
+    if (rc == AIFD_OK) {
+        G->K = J.K; G->trees.k = k;
+        if (!k)          for (int i = 0; i < n; ++i) G->base[0] += y[i] / n;
+        else if (J.K == 1) for (int i = 0; i < n; ++i) G->base[0] += (y[i] == 1) / (double)n;
+        else             for (int i = 0; i < n; ++i) G->base[(int)y[i]] += 1.0 / n;
+        if (k) {
+            for (int q = 0; q < J.K; ++q) {
+                double p = fmin(fmax(G->base[q], 1e-6), 1.0 - 1e-6);
+                G->base[q] = J.K == 1 ? log(p / (1.0 - p)) : log(p);
+            }
+        }
+        for (int i = 0; i < n; ++i)
+            for (int q = 0; q < J.K; ++q) J.F[(size_t)i * J.K + q] = F0 ? F0[(size_t)i * J.K + q] : G->base[q];
+    }
+
+    /* a saída 0 calcula as probabilidades da rodada; o (loss, score) de
+       treino reportado já inclui as árvores da rodada que acabou */
+    int done = 0;
+    double loss = 0.0, score = 0.0;
+    if (rc == AIFD_OK) gbdt_gradients(&J, 0, &loss, &score);
+    for (int r = 0; rc == AIFD_OK && r < o->rounds; ++r) {
+        for (int c = 0; rc == AIFD_OK && c < J.K; ++c) {
+            if (c > 0) gbdt_gradients(&J, c, NULL, NULL);
+            rc = gbdt_grow(&J, c, &T[r * J.K + c]);
+        }
+        if (rc != AIFD_OK) break;
+        done = r + 1;
+        gbdt_gradients(&J, 0, &loss, &score);
+        if (cb && cb(user, done, o->rounds, loss, score)) { rc = AIFD_CANCELLED; break; }
+    }
+
+    if (rc >= 0 && forest_assemble(T, done * J.K, k, &G->trees) != AIFD_OK) rc = AIFD_ENOMEM;
+    if (rc < 0) aifd_gbdt_free(G);
+
+    for (int t = 0; T && t < ntrees; ++t) { free(T[t].nodes); free(T[t].values); }
+    free(T); free(J.off); free(J.rows); free(J.tmp); free(J.F); free(J.g); free(J.h); free(J.og); free(J.oh); free(J.prob); free(J.pool);
+    free(J.bs); free(J.bl); free(J.leaves); free(J.gn);
+    aifd_bins_free(&J.B);
+    return rc;
+}
+
+typedef struct {
+    const aifd_gbdt *G;
+    const double *X;
+    int d, raw;
+    double *out;
+} gbdt_pred_job;
+
+static void gbdt_pred_rows(void *arg, int b, int e, int tid) {
+    gbdt_pred_job *P = (gbdt_pred_job*)arg;
+    const aifd_gbdt *G = P->G;
+    const aifd_forest *F = &G->trees;
+    const int K = G->K;
+    (void)tid;
+    for (int r0 = b; r0 < e; r0 += FOREST_PRED_BLOCK) {
+        int r1 = r0 + FOREST_PRED_BLOCK < e ? r0 + FOREST_PRED_BLOCK : e;
+        for (int r = r0; r < r1; ++r) memcpy(P->out + (size_t)r * K, G->base, sizeof(double) * K);
+        for (int t = 0; t < F->n_trees; ++t)
+            for (int r = r0; r < r1; ++r)
+                P->out[(size_t)r * K + t % K] += F->values[forest_leaf(F->nodes, F->roots[t], P->X + (size_t)r * P->d)];
+        if (P->raw || !F->k) continue;
+        for (int r = r0; r < r1; ++r) {
+            double *o = P->out + (size_t)r * K;
+            if (K == 1) { o[0] = 1.0 / (1.0 + exp(-o[0])); continue; }
+            double mx = o[0], z = 0.0;
+            for (int q = 1; q < K; ++q) mx = fmax(mx, o[q]);
+            for (int q = 0; q < K; ++q) z += (o[q] = exp(o[q] - mx));
+            for (int q = 0; q < K; ++q) o[q] /= z;
+        }
+    }
+}
+
+/* out n x K: regressão, P(classe 1) (binária) ou probabilidades; raw = 1 devolve F cru */
+static int aifd_gbdt_predict(const aifd_gbdt *G, const double *X, int n, int d, int raw, double *out, int threads) {
+    if (!G || !G->base || !X || !out || n < 0 || d < 1) return AIFD_EINVAL;
+    gbdt_pred_job P = { G, X, d, raw, out };
+    int blocks = (n + FOREST_PRED_BLOCK - 1) / FOREST_PRED_BLOCK;
+    int t = (double)n * G->trees.n_trees < 1e5 ? 1 : aifd_num_threads(threads);
+    if (t > blocks) t = blocks;
+    aifd_parallel_for(n, t, gbdt_pred_rows, &P);
+    return AIFD_OK;
+}
+
+AIFD_NATIVE_END
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef NATIVE_GEMM_H
+#define NATIVE_GEMM_H
+
+/* -------- GEMM float32 em blocos --------
+   C = alpha·op(A)·op(B) + beta·C, tudo linha-major (op = transposta ou não).
+   Blocos MC x KC de A e KC x NC de B são empacotados em painéis contíguos de
+   MR linhas / NR colunas (A fica no L2, um painel de B no L1) e o micro-kernel
+   6x16 (AVX2+FMA, 12 acumuladores) roda sobre eles. Os blocos de C são
+   divididos entre threads; produtos pequenos rodam na thread chamadora. */
+
+#include "native_common.h"
+
+AIFD_NATIVE_BEGIN
+
+#define GEMM_MR 6
+#define GEMM_NR 16
+#define GEMM_MC 96              /* múltiplo de MR */
+#define GEMM_KC 256
+#define GEMM_NC 512             /* múltiplo de NR */
+#define GEMM_PAR_MIN 4.0e6      /* M·N·K mínimo para abrir threads */
+#define GEMM_WS_PER_THREAD ((size_t)GEMM_MC * GEMM_KC + (size_t)GEMM_KC * GEMM_NC)
+
+typedef struct {
+    int ta, tb, M, N, K;
+    float alpha, beta;
+    const float *A; int lda;
+    const float *B; int ldb;
+    float *C; int ldc;
+    int mt, nt;                 /* nº de blocos de C em M e N */
+    float *buf;                 /* por thread: pack de A (MC x KC) + pack de B (KC x NC) */
+} gemm_job;
+
+/* painéis de MR linhas de op(A)[i0.., k0..]: a[p][k][r], linhas além de mc zeradas */
+static void gemm_pack_a(const gemm_job *g, int i0, int mc, int k0, int kc, float *dst) {
+    for (int p = 0; p < mc; p += GEMM_MR) {
+        int mr = mc - p < GEMM_MR ? mc - p : GEMM_MR;
+        for (int k = 0; k < kc; ++k, dst += GEMM_MR) {
+            int r = 0;
+            if (g->ta) {
+                const float *src = g->A + (size_t)(k0 + k) * g->lda + i0 + p;
+                for (; r < mr; ++r) dst[r] = g->alpha * src[r];
+            } else {
+                const float *src = g->A + (size_t)(i0 + p) * g->lda + k0 + k;
+                for (; r < mr; ++r) dst[r] = g->alpha * src[(size_t)r * g->lda];
+            }
+            for (; r < GEMM_MR; ++r) dst[r] = 0.0f;
+        }
+    }
+}
+
+/* painéis de NR colunas de op(B)[k0.., j0..]: b[p][k][c], colunas além de nc zeradas */
+static void gemm_pack_b(const gemm_job *g, int k0, int kc, int j0, int nc, float *dst) {
+    for (int p = 0; p < nc; p += GEMM_NR) {
+        int nr = nc - p < GEMM_NR ? nc - p : GEMM_NR;
+        for (int k = 0; k < kc; ++k, dst += GEMM_NR) {
+            int c = 0;
+            if (g->tb) {
+                const float *src = g->B + (size_t)(j0 + p) * g->ldb + k0 + k;
+                for (; c < nr; ++c) dst[c] = src[(size_t)c * g->ldb];
+            } else {
+                const float *src = g->B + (size_t)(k0 + k) * g->ldb + j0 + p;
+                memcpy(dst, src, sizeof(float) * nr);
+                c = nr;
+            }
+            for (; c < GEMM_NR; ++c) dst[c] = 0.0f;
+        }
+    }
+}
+
+/* C[mr x nr] += a·b sobre kc (painéis empacotados) */
+static void gemm_kernel_scalar(int kc, const float *a, const float *b, float *c, int ldc, int mr, int nr) {
+    float acc[GEMM_MR][GEMM_NR] = {{0}};
+    for (int k = 0; k < kc; ++k, a += GEMM_MR, b += GEMM_NR)
+        for (int r = 0; r < GEMM_MR; ++r)
+            for (int j = 0; j < GEMM_NR; ++j) acc[r][j] += a[r] * b[j];
+    for (int r = 0; r < mr; ++r)
+        for (int j = 0; j < nr; ++j) c[(size_t)r * ldc + j] += acc[r][j];
+}
+
+#ifdef AIFD_X86
+__attribute__((target("avx2,fma")))
+static void gemm_kernel_avx2(int kc, const float *a, const float *b, float *c, int ldc, int mr, int nr) {
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps(), c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps(), c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+    __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps(), c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+    for (int k = 0; k < kc; ++k, a += GEMM_MR, b += GEMM_NR) {
+        __m256 b0 = _mm256_loadu_ps(b), b1 = _mm256_loadu_ps(b + 8), ar;
+        ar = _mm256_broadcast_ss(a + 0); c00 = _mm256_fmadd_ps(ar, b0, c00); c01 = _mm256_fmadd_ps(ar, b1, c01);
+        ar = _mm256_broadcast_ss(a + 1); c10 = _mm256_fmadd_ps(ar, b0, c10); c11 = _mm256_fmadd_ps(ar, b1, c11);
+        ar = _mm256_broadcast_ss(a + 2); c20 = _mm256_fmadd_ps(ar, b0, c20); c21 = _mm256_fmadd_ps(ar, b1, c21);
+        ar = _mm256_broadcast_ss(a + 3); c30 = _mm256_fmadd_ps(ar, b0, c30); c31 = _mm256_fmadd_ps(ar, b1, c31);
+        ar = _mm256_broadcast_ss(a + 4); c40 = _mm256_fmadd_ps(ar, b0, c40); c41 = _mm256_fmadd_ps(ar, b1, c41);
+        ar = _mm256_broadcast_ss(a + 5); c50 = _mm256_fmadd_ps(ar, b0, c50); c51 = _mm256_fmadd_ps(ar, b1, c51);
+    }
+    __m256 acc[GEMM_MR][2] = { {c00, c01}, {c10, c11}, {c20, c21}, {c30, c31}, {c40, c41}, {c50, c51} };
+    if (mr == GEMM_MR && nr == GEMM_NR) {
+        for (int r = 0; r < GEMM_MR; ++r) {
+            float *cr = c + (size_t)r * ldc;
+            _mm256_storeu_ps(cr,     _mm256_add_ps(_mm256_loadu_ps(cr),     acc[r][0]));
+            _mm256_storeu_ps(cr + 8, _mm256_add_ps(_mm256_loadu_ps(cr + 8), acc[r][1]));
+        }
+        return;
+    }
+    float tmp[GEMM_NR];
+    for (int r = 0; r < mr; ++r) {
+        _mm256_storeu_ps(tmp, acc[r][0]); _mm256_storeu_ps(tmp + 8, acc[r][1]);
+        for (int j = 0; j < nr; ++j) c[(size_t)r * ldc + j] += tmp[j];
+    }
+}
+#endif
+
+static void gemm_tiles(void *arg, int b, int e, int tid) {
+    gemm_job *g = (gemm_job*)arg;
+    float *pa = g->buf + (size_t)tid * GEMM_WS_PER_THREAD;
+    float *pb = pa + GEMM_MC * GEMM_KC;
+#ifdef AIFD_X86
+    int simd = aifd_has_avx2();
+#endif
+    for (int t = b; t < e; ++t) {
+        int i0 = (t / g->nt) * GEMM_MC, j0 = (t % g->nt) * GEMM_NC;
+        int mc = g->M - i0 < GEMM_MC ? g->M - i0 : GEMM_MC;
+        int nc = g->N - j0 < GEMM_NC ? g->N - j0 : GEMM_NC;
+        for (int i = 0; i < mc; ++i) {
+            float *ci = g->C + (size_t)(i0 + i) * g->ldc + j0;
+            if (g->beta == 0.0f) memset(ci, 0, sizeof(float) * nc);
+            else if (g->beta != 1.0f) for (int j = 0; j < nc; ++j) ci[j] *= g->beta;
+        }
+        for (int k0 = 0; k0 < g->K; k0 += GEMM_KC) {
+            int kc = g->K - k0 < GEMM_KC ? g->K - k0 : GEMM_KC;
+            gemm_pack_b(g, k0, kc, j0, nc, pb);
+            gemm_pack_a(g, i0, mc, k0, kc, pa);
+            for (int jp = 0; jp < nc; jp += GEMM_NR) {
+                int nr = nc - jp < GEMM_NR ? nc - jp : GEMM_NR;
+                const float *bp = pb + (size_t)(jp / GEMM_NR) * kc * GEMM_NR;
+                for (int ip = 0; ip < mc; ip += GEMM_MR) {
+                    int mr = mc - ip < GEMM_MR ? mc - ip : GEMM_MR;
+                    const float *ap = pa + (size_t)(ip / GEMM_MR) * kc * GEMM_MR;
+                    float *cp = g->C + (size_t)(i0 + ip) * g->ldc + j0 + jp;
+#ifdef AIFD_X86
+                    if (simd) { gemm_kernel_avx2(kc, ap, bp, cp, g->ldc, mr, nr); continue; }
+#endif
+                    gemm_kernel_scalar(kc, ap, bp, cp, g->ldc, mr, nr);
+                }
+            }
+        }
+    }
+}
+
+/* tamanho (em floats) do workspace para até `threads` threads */
+static size_t aifd_sgemm_ws_floats(int threads) {
+    return (size_t)aifd_num_threads(threads) * GEMM_WS_PER_THREAD;
+}
+
+/* ta/tb: A guardada K x M / B guardada N x K. threads = 0 usa todos os núcleos.
+   ws: workspace de aifd_sgemm_ws_floats(threads) floats (NULL = aloca aqui);
+   quem chama em laço (treino) passa o seu para não alocar a cada produto. */
+static int aifd_sgemm(int ta, int tb, int M, int N, int K, float alpha,
+                      const float *A, int lda, const float *B, int ldb,
+                      float beta, float *C, int ldc, int threads, float *ws) {
+    if (M <= 0 || N <= 0) return AIFD_OK;
+    gemm_job g = { ta, tb, M, N, K > 0 ? K : 0, alpha, beta, A, lda, B, ldb, C, ldc,
+                   (M + GEMM_MC - 1) / GEMM_MC, (N + GEMM_NC - 1) / GEMM_NC, ws };
+    int tiles = g.mt * g.nt;
+    int t = (double)M * N * K < GEMM_PAR_MIN ? 1 : aifd_num_threads(threads);
+    if (t > tiles) t = tiles;
+    if (!ws && !(g.buf = (float*)malloc(sizeof(float) * t * GEMM_WS_PER_THREAD))) return AIFD_ENOMEM;
+    aifd_parallel_for(tiles, t, gemm_tiles, &g);
+    if (!ws) free(g.buf);
+    return AIFD_OK;
+}
+
+AIFD_NATIVE_END
+
+#endif
@@ -0,0 +1,510 @@
+#ifndef NATIVE_KNN_H
+#define NATIVE_KNN_H
+
+/* -------- Vizinhos mais próximos (KNN) --------
+   Três índices sobre uma cópia de X:
+   - KD-tree (poucas dimensões): exata, corte pela distância ao plano de split.
+   - HNSW (muitas dimensões): grafo hierárquico navegável, aproximado
+     (Malkov & Yashunin); inserção em paralelo com um mutex por nó.
+   - força bruta: conjuntos pequenos, onde montar um índice não compensa.
+   Consultas em lote são divididas entre threads; distâncias euclidianas. */
+
+#include "native_common.h"
+
+AIFD_NATIVE_BEGIN
+
+enum { AIFD_KNN_AUTO = 0, AIFD_KNN_BRUTE = 1, AIFD_KNN_KD = 2, AIFD_KNN_HNSW = 3 };
+
+#define KNN_KD_LEAF     16      /* pontos por folha da KD-tree */
+#define KNN_KD_MAX_DIM  12      /* acima disso a KD-tree quase não poda */
+#define KNN_HNSW_MIN    4096    /* abaixo disso a força bruta já é rápida */
+#define KNN_MAX_LEVEL   24
+
+typedef struct {
+    int algo;                   /* AIFD_KNN_* (AUTO escolhe por n e d) */
+    int M;                      /* HNSW: arestas por nó (2M no nível 0) */
+    int ef_construction;        /* HNSW: candidatos na inserção */
+    int ef;                     /* HNSW: candidatos na consulta (>= k) */
+    unsigned long long seed;    /* HNSW: níveis dos nós */
+    int threads;
+} aifd_knn_opts;
+
+static void aifd_knn_defaults(aifd_knn_opts *o) {
+    o->algo = AIFD_KNN_AUTO;
+    o->M = 16; o->ef_construction = 100; o->ef = 64;
+    o->seed = 42; o->threads = 0;
+}
+
+/* nó da KD-tree em pré-ordem: filho esquerdo = próximo nó; folha: dim < 0, pontos [lo, hi) */
+typedef struct {
+    int lo, hi, dim, right;
+    double split;
+} knn_kd_node;
+
+typedef struct {
+    int n, d, algo;             /* algo já resolvido (nunca AUTO) */
+    double *X;                  /* cópia n x d (KD: na ordem das folhas) */
+    int *id;                    /* KD: linha da cópia -> índice original */
+    knn_kd_node *kd;
+    int n_kd, cap_kd;
+    int M, ef, entry, top;      /* HNSW */
+    int *level;
+    int *link0;                 /* n x (2M + 1): [contagem, vizinhos...] */
+    int **up;                   /* up[i]: level[i] x (M + 1), níveis 1.. */
+    pthread_mutex_t *lock;      /* só durante a construção */
+} aifd_knn;
+
+typedef struct { double key; int id; } knn_item;
+
+/* ---- heap de máximo por key (resultado); candidatos usam key negativa ---- */
+static void knn_sift_down(knn_item *h, int size, int i) {
+    knn_item x = h[i];
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= size) break;
+        if (c + 1 < size && h[c + 1].key > h[c].key) c++;
+        if (h[c].key <= x.key) break;
+        h[i] = h[c]; i = c;
+    }
+    h[i] = x;
+}
+
+static void knn_heap_push(knn_item *h, int *size, knn_item x) {
+    int i = (*size)++;
+    while (i > 0) {
+        int p = (i - 1) >> 1;
+        if (h[p].key >= x.key) break;
+        h[i] = h[p]; i = p;
+    }
+    h[i] = x;
+}
+
+static knn_item knn_heap_pop(knn_item *h, int *size) {
+    knn_item top = h[0];
+    if (--(*size) > 0) { h[0] = h[*size]; knn_sift_down(h, *size, 0); }
+    return top;
+}
+
+/* mantém os `cap` menores */
+static void knn_heap_keep(knn_item *h, int *size, int cap, knn_item x) {
+    if (*size < cap) knn_heap_push(h, size, x);
+    else if (x.key < h[0].key) { h[0] = x; knn_sift_down(h, *size, 0); }
+}
+
+/* heapsort: o heap vira ordem crescente de distância */
+static void knn_heap_sort(knn_item *h, int size) {
+    for (int s = size; s > 1; --s) {
+        knn_item t = h[0]; h[0] = h[s - 1]; h[s - 1] = t;
+        knn_sift_down(h, s - 1, 0);
+    }
+}
+
+/* ---- rascunho por thread ---- */
+typedef struct {
+    knn_item *res, *cand, *tmp;
+    int cand_cap, oom;
+    unsigned *mark;             /* HNSW: visitados nesta busca == gen */
+    unsigned gen;
+    int *nb;
+} knn_scratch;
+
+static void knn_scratch_free(knn_scratch *S) {
+    free(S->res); free(S->cand); free(S->tmp); free(S->mark); free(S->nb);
+    memset(S, 0, sizeof(*S));
+}
+
+static int knn_scratch_init(knn_scratch *S, const aifd_knn *I, int cap) {
+    memset(S, 0, sizeof(*S));
+    int nb = I->algo == AIFD_KNN_HNSW ? 2 * I->M + 1 : 1;
+    S->cand_cap = 256;
+    S->res  = (knn_item*)malloc(sizeof(knn_item) * (size_t)(cap + 1));
+    S->cand = (knn_item*)malloc(sizeof(knn_item) * (size_t)S->cand_cap);
+    S->tmp  = (knn_item*)malloc(sizeof(knn_item) * (size_t)nb);
+    S->nb   = (int*)malloc(sizeof(int) * (size_t)nb);
+    S->mark = I->algo == AIFD_KNN_HNSW ? (unsigned*)calloc((size_t)I->n, sizeof(unsigned)) : NULL;
+    if (!S->res || !S->cand || !S->tmp || !S->nb || (I->algo == AIFD_KNN_HNSW && !S->mark)) {
+        knn_scratch_free(S);
+        return AIFD_ENOMEM;
+    }
+    return AIFD_OK;
+}
+
+static void knn_cand_push(knn_scratch *S, int *size, knn_item x) {
+    if (*size == S->cand_cap) {
+        knn_item *c = (knn_item*)realloc(S->cand, sizeof(knn_item) * (size_t)S->cand_cap * 2);
+        if (!c) { S->oom = 1; return; }
+        S->cand = c; S->cand_cap *= 2;
+    }
+    knn_heap_push(S->cand, size, x);
+}
+
+/* ---- KD-tree ---- */
+static void knn_nth(int *p, int lo, int hi, int nth, const double *X, int d, int dim) {
+    hi -= 1;
+    while (lo < hi) {
+        double pivot = X[(size_t)p[(lo + hi) >> 1] * d + dim];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (X[(size_t)p[i] * d + dim] < pivot) i++;
+            while (X[(size_t)p[j] * d + dim] > pivot) j--;
+            if (i <= j) { int t = p[i]; p[i] = p[j]; p[j] = t; i++; j--; }
+        }
+        if (nth <= j) hi = j;
+        else if (nth >= i) lo = i;
+        else break;
+    }
+}
+
+/* corta na mediana da dimensão de maior amplitude; devolve o nó ou -1 (memória) */
+static int knn_kd_build(aifd_knn *I, const double *X, int *p, int lo, int hi) {
+    int d = I->d;
+    if (I->n_kd == I->cap_kd) {
+        int cap = I->cap_kd ? 2 * I->cap_kd : 64;
+        knn_kd_node *k = (knn_kd_node*)realloc(I->kd, sizeof(knn_kd_node) * (size_t)cap);
+        if (!k) return -1;
+        I->kd = k; I->cap_kd = cap;
+    }
+    int me = I->n_kd++, dim = -1;
+    knn_kd_node leaf = { lo, hi, -1, -1, 0.0 };
+    I->kd[me] = leaf;
+    if (hi - lo <= KNN_KD_LEAF) return me;
+
+    double best = 0.0;
+    for (int f = 0; f < d; ++f) {
+        double mn = INFINITY, mx = -INFINITY;
+        for (int i = lo; i < hi; ++i) {
+            double v = X[(size_t)p[i] * d + f];
+            if (v < mn) mn = v;
+            if (v > mx) mx = v;
+        }
+        if (mx - mn > best) { best = mx - mn; dim = f; }
+    }
+    if (dim < 0) return me;             /* pontos repetidos: fica folha */
+
+    int mid = (lo + hi) >> 1;
+    knn_nth(p, lo, hi, mid, X, d, dim);
+    I->kd[me].dim = dim;
+    I->kd[me].split = X[(size_t)p[mid] * d + dim];
+    if (knn_kd_build(I, X, p, lo, mid) < 0) return -1;
+    int r = knn_kd_build(I, X, p, mid, hi);
+    if (r < 0) return -1;
+    I->kd[me].right = r;
+    return me;
+}
+
+/* à esquerda x[dim] <= split, à direita >= split: |q - split| limita o lado de lá */
+static void knn_kd_search(const aifd_knn *I, int node, const double *q, int k, knn_item *res, int *nr) {
+    const knn_kd_node *N = I->kd + node;
+    if (N->dim < 0) {
+        for (int i = N->lo; i < N->hi; ++i) {
+            knn_item x = { aifd_sqdist(q, I->X + (size_t)i * I->d, I->d), i };
+            knn_heap_keep(res, nr, k, x);
+        }
+        return;
+    }
+    double diff = q[N->dim] - N->split;
+    int near = diff <= 0 ? node + 1 : N->right, far = diff <= 0 ? N->right : node + 1;
+    knn_kd_search(I, near, q, k, res, nr);
+    if (*nr < k || diff * diff < res[0].key) knn_kd_search(I, far, q, k, res, nr);
+}
+
+/* ---- HNSW ---- */
+static int *knn_links(const aifd_knn *I, int i, int lev) {
+    return lev == 0 ? I->link0 + (size_t)i * (2 * I->M + 1) : I->up[i] + (size_t)(lev - 1) * (I->M + 1);
+}
+
+/* copia a lista de vizinhos (sob o mutex do nó enquanto o grafo é montado) */
+static int knn_neighbors(const aifd_knn *I, int i, int lev, int *buf) {
+    const int *L = knn_links(I, i, lev);
+    if (I->lock) pthread_mutex_lock(&I->lock[i]);
+    int c = L[0];
+    memcpy(buf, L + 1, sizeof(int) * (size_t)c);
+    if (I->lock) pthread_mutex_unlock(&I->lock[i]);
+    return c;
+}
+
+/* desce gulosamente enquanto algum vizinho estiver mais perto */
+static double knn_greedy(const aifd_knn *I, const double *q, int *cur, double dcur, int lev, knn_scratch *S) {
+    for (int moved = 1; moved; ) {
+        moved = 0;
+        int c = knn_neighbors(I, *cur, lev, S->nb);
+        for (int t = 0; t < c; ++t) {
+            double dv = aifd_sqdist(q, I->X + (size_t)S->nb[t] * I->d, I->d);
+            if (dv < dcur) { dcur = dv; *cur = S->nb[t]; moved = 1; }
+        }
+    }
+    return dcur;
+}
+
+/* busca com lista dinâmica de ef candidatos num nível; devolve o tamanho de S->res (heap) */
+static int knn_search_layer(const aifd_knn *I, const double *q, int ep, double dep, int ef, int lev, knn_scratch *S) {
+    int nr = 0, nc = 0;
+    if (++S->gen == 0) { memset(S->mark, 0, sizeof(unsigned) * (size_t)I->n); S->gen = 1; }
+    S->mark[ep] = S->gen;
+    knn_item r0 = { dep, ep }, c0 = { -dep, ep };
+    knn_heap_push(S->res, &nr, r0);
+    knn_heap_push(S->cand, &nc, c0);
+    while (nc > 0) {
+        knn_item c = knn_heap_pop(S->cand, &nc);
+        if (-c.key > S->res[0].key && nr >= ef) break;
+        int cnt = knn_neighbors(I, c.id, lev, S->nb);
+        for (int t = 0; t < cnt; ++t) {
+            int v = S->nb[t];
+            if (S->mark[v] == S->gen) continue;
+            S->mark[v] = S->gen;
+            double dv = aifd_sqdist(q, I->X + (size_t)v * I->d, I->d);
+            if (nr < ef || dv < S->res[0].key) {
+                knn_item rv = { dv, v }, cv = { -dv, v };
+                knn_heap_keep(S->res, &nr, ef, rv);
+                knn_cand_push(S, &nc, cv);
+            }
+        }
+    }
+    return nr;
+}
+
+/* heurística de vizinhos: c (crescente) entra se estiver mais perto do nó base do
+   que de todo vizinho já escolhido, o que espalha as arestas entre direções */
+static int knn_prune(const aifd_knn *I, knn_item *c, int nc, int max) {
+    int r = 0;
+    for (int t = 0; t < nc && r < max; ++t) {
+        const double *x = I->X + (size_t)c[t].id * I->d;
+        int keep = 1;
+        for (int s = 0; s < r && keep; ++s)
+            if (aifd_sqdist(x, I->X + (size_t)c[s].id * I->d, I->d) < c[t].key) keep = 0;
+        if (keep) c[r++] = c[t];
+    }
+    return r;
+}
+
+/* aresta de volta s -> i; lista cheia: poda de novo entre os antigos e i */
+static void knn_link_back(const aifd_knn *I, int s, int i, int lev, knn_scratch *S) {
+    int cap = lev ? I->M : 2 * I->M;
+    int *L = knn_links(I, s, lev);
+    pthread_mutex_lock(&I->lock[s]);
+    if (L[0] < cap) {
+        L[1 + L[0]++] = i;
+    } else {
+        const double *xs = I->X + (size_t)s * I->d;
+        knn_item *c = S->tmp;
+        for (int t = 0; t <= cap; ++t) {
+            int v = t < cap ? L[1 + t] : i;
+            knn_item x = { aifd_sqdist(xs, I->X + (size_t)v * I->d, I->d), v };
+            int u = t;                  /* inserção: no máximo 2M + 1 itens */
+            while (u > 0 && c[u - 1].key > x.key) { c[u] = c[u - 1]; u--; }
+            c[u] = x;
+        }
+        int r = knn_prune(I, c, cap + 1, cap);
+        for (int t = 0; t < r; ++t) L[1 + t] = c[t].id;
+        L[0] = r;
+    }
+    pthread_mutex_unlock(&I->lock[s]);
+}
+
+typedef struct {
+    aifd_knn *I;
+    knn_scratch *S;             /* um por thread */
+    int ef_construction;
+    pthread_mutex_t global;     /* ponto de entrada e nível do topo */
+} knn_build_job;
+
+static void knn_insert(void *arg, int task, int tid) {
+    knn_build_job *J = (knn_build_job*)arg;
+    aifd_knn *I = J->I;
+    knn_scratch *S = &J->S[tid];
+    int i = task + 1, l = I->level[i];  /* o ponto 0 já é a entrada */
+    const double *q = I->X + (size_t)i * I->d;
+
+    pthread_mutex_lock(&J->global);
+    int cur = I->entry, top = I->top;
+    pthread_mutex_unlock(&J->global);
+
+    double dcur = aifd_sqdist(q, I->X + (size_t)cur * I->d, I->d);
+    for (int lev = top; lev > l; --lev) dcur = knn_greedy(I, q, &cur, dcur, lev, S);
+    for (int lev = l < top ? l : top; lev >= 0; --lev) {
+        int nr = knn_search_layer(I, q, cur, dcur, J->ef_construction, lev, S);
+        knn_heap_sort(S->res, nr);
+        cur = S->res[0].id; dcur = S->res[0].key;
+        int r = knn_prune(I, S->res, nr, I->M);
+        int *L = knn_links(I, i, lev);
+        pthread_mutex_lock(&I->lock[i]);
+        for (int t = 0; t < r; ++t) L[1 + t] = S->res[t].id;
+        L[0] = r;
+        pthread_mutex_unlock(&I->lock[i]);
+        for (int t = 0; t < r; ++t) knn_link_back(I, S->res[t].id, i, lev, S);
+    }
+    if (l > top) {
+        pthread_mutex_lock(&J->global);
+        if (l > I->top) { I->top = l; I->entry = i; }
+        pthread_mutex_unlock(&J->global);
+    }
+}
+
+static int knn_hnsw_build(aifd_knn *I, const aifd_knn_opts *o) {
+    int n = I->n, M = I->M;
+    I->level = (int*)malloc(sizeof(int) * (size_t)n);
+    I->link0 = (int*)calloc((size_t)n * (2 * M + 1), sizeof(int));
+    I->up    = (int**)calloc((size_t)n, sizeof(int*));
+    if (!I->level || !I->link0 || !I->up) return AIFD_ENOMEM;
+    /* nível ~ geométrico com razão 1/M */
+    double mL = 1.0 / log((double)M);
+    unsigned long long s = o->seed ^ 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < n; ++i) {
+        int l = (int)(-log(1.0 - aifd_rng_uniform(&s)) * mL);
+        I->level[i] = l < KNN_MAX_LEVEL ? l : KNN_MAX_LEVEL;
+        if (I->level[i] > 0) {
+            I->up[i] = (int*)calloc((size_t)I->level[i] * (M + 1), sizeof(int));
+            if (!I->up[i]) return AIFD_ENOMEM;
+        }
+    }
+    I->entry = 0; I->top = n > 0 ? I->level[0] : 0;
+    if (n <= 1) return AIFD_OK;
+
+    int t = aifd_num_threads(o->threads), rc = AIFD_OK;
+    if (t > n - 1) t = n - 1;
+    knn_build_job J;
+    J.I = I;
+    J.ef_construction = o->ef_construction > M ? o->ef_construction : M;
+    J.S = (knn_scratch*)calloc((size_t)t, sizeof(knn_scratch));
+    I->lock = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t) * (size_t)n);
+    if (!J.S || !I->lock) { free(J.S); free(I->lock); I->lock = NULL; return AIFD_ENOMEM; }
+    for (int k = 0; k < t && rc == AIFD_OK; ++k) rc = knn_scratch_init(&J.S[k], I, J.ef_construction);
+    if (rc == AIFD_OK) {
+        for (int i = 0; i < n; ++i) pthread_mutex_init(&I->lock[i], NULL);
+        pthread_mutex_init(&J.global, NULL);
+        aifd_parallel_tasks(n - 1, t, knn_insert, &J, NULL);
+        pthread_mutex_destroy(&J.global);
+        for (int i = 0; i < n; ++i) pthread_mutex_destroy(&I->lock[i]);
+        for (int k = 0; k < t; ++k) if (J.S[k].oom) rc = AIFD_ENOMEM;
+    }
+    for (int k = 0; k < t; ++k) knn_scratch_free(&J.S[k]);
+    free(J.S); free(I->lock);
+    I->lock = NULL;
+    return rc;
+}
+
+/* ---- API ---- */
+static void aifd_knn_free(aifd_knn *I) {
+    if (I->up) for (int i = 0; i < I->n; ++i) free(I->up[i]);
+    free(I->X); free(I->id); free(I->kd);
+    free(I->level); free(I->link0); free(I->up);
+    memset(I, 0, sizeof(*I));
+}
+
+/* X linha-major n x d (copiado) */
+static int aifd_knn_build(const double *X, int n, int d, const aifd_knn_opts *o, aifd_knn *I) {
+    memset(I, 0, sizeof(*I));
+    if (!X || n < 1 || d < 1) return AIFD_EINVAL;
+    int algo = o->algo;
+    if (algo == AIFD_KNN_AUTO)
+        algo = d <= KNN_KD_MAX_DIM ? AIFD_KNN_KD : n >= KNN_HNSW_MIN ? AIFD_KNN_HNSW : AIFD_KNN_BRUTE;
+    I->n = n; I->d = d; I->algo = algo;
+    I->M = o->M > 1 ? o->M : 2;
+    I->ef = o->ef > 0 ? o->ef : 64;
+    I->X = (double*)malloc(sizeof(double) * (size_t)n * d);
+    if (!I->X) return AIFD_ENOMEM;
+
+    int rc = AIFD_OK;
+    if (algo == AIFD_KNN_KD) {
+        I->id = (int*)malloc(sizeof(int) * (size_t)n);
+        if (!I->id) { aifd_knn_free(I); return AIFD_ENOMEM; }
+        for (int i = 0; i < n; ++i) I->id[i] = i;
+        if (knn_kd_build(I, X, I->id, 0, n) < 0) { aifd_knn_free(I); return AIFD_ENOMEM; }
+        for (int i = 0; i < n; ++i) memcpy(I->X + (size_t)i * d, X + (size_t)I->id[i] * d, sizeof(double) * d);
+    } else {
+        memcpy(I->X, X, sizeof(double) * (size_t)n * d);
+        if (algo == AIFD_KNN_HNSW) rc = knn_hnsw_build(I, o);
+    }
+    if (rc != AIFD_OK) aifd_knn_free(I);
+    return rc;
+}
+
+/* k vizinhos de q em S->res, ordem crescente; devolve quantos (<= k) */
+static int knn_search(const aifd_knn *I, const double *q, int k, int ef, knn_scratch *S) {
+    int nr = 0;
+    if (I->algo == AIFD_KNN_KD) {
+        knn_kd_search(I, 0, q, k, S->res, &nr);
+    } else if (I->algo == AIFD_KNN_HNSW) {
+        int cur = I->entry;
+        double dcur = aifd_sqdist(q, I->X + (size_t)cur * I->d, I->d);
+        for (int lev = I->top; lev > 0; --lev) dcur = knn_greedy(I, q, &cur, dcur, lev, S);
+        nr = knn_search_layer(I, q, cur, dcur, ef > k ? ef : k, 0, S);
+        knn_heap_sort(S->res, nr);
+        return nr < k ? nr : k;
+    } else {
+        for (int i = 0; i < I->n; ++i) {
+            knn_item x = { aifd_sqdist(q, I->X + (size_t)i * I->d, I->d), i };
+            knn_heap_keep(S->res, &nr, k, x);
+        }
+    }
+    knn_heap_sort(S->res, nr);
+    return nr;
+}
+
+typedef struct {
+    const aifd_knn *I;
+    const double *Q, *y;
+    int k, ef, n_classes;
+    int *idx;
+    double *dist, *out;
+    volatile int err;
+} knn_query_job;
+
+static void knn_query_range(void *arg, int b, int e, int tid) {
+    knn_query_job *J = (knn_query_job*)arg;
+    const aifd_knn *I = J->I;
+    int k = J->k, K = J->n_classes;
+    knn_scratch S;
+    (void)tid;
+    if (knn_scratch_init(&S, I, k > J->ef ? k : J->ef) != AIFD_OK) { J->err = 1; return; }
+    for (int q = b; q < e; ++q) {
+        int nr = knn_search(I, J->Q + (size_t)q * I->d, k, J->ef, &S);
+        if (J->idx) {
+            for (int t = 0; t < k; ++t) {
+                int v = t < nr ? S.res[t].id : -1;
+                J->idx[(size_t)q * k + t]  = v >= 0 && I->id ? I->id[v] : v;
+                J->dist[(size_t)q * k + t] = t < nr ? sqrt(S.res[t].key) : INFINITY;
+            }
+        }
+        if (J->out) {
+            /* pesos uniformes, como o KNeighbors* padrão */
+            if (K > 0) {
+                double *p = J->out + (size_t)q * K;
+                memset(p, 0, sizeof(double) * K);
+                for (int t = 0; t < nr; ++t) {
+                    int c = (int)J->y[I->id ? I->id[S.res[t].id] : S.res[t].id];
+                    if (c >= 0 && c < K) p[c] += 1.0 / nr;
+                }
+            } else {
+                double s = 0.0;
+                for (int t = 0; t < nr; ++t) s += J->y[I->id ? I->id[S.res[t].id] : S.res[t].id];
+                J->out[q] = nr ? s / nr : NAN;
+            }
+        }
+        if (S.oom) J->err = 1;
+    }
+    knn_scratch_free(&S);
+}
+
+/* idx/dist: m x k, ordem crescente (faltando: -1 / INFINITY); ef <= 0 usa o do índice */
+static int aifd_knn_query(const aifd_knn *I, const double *Q, int m, int k, int ef,
+                          int *idx, double *dist, int threads) {
+    if (!I->X || !Q || m < 0 || k < 1 || !idx || !dist) return AIFD_EINVAL;
+    knn_query_job J = { I, Q, NULL, k, ef > 0 ? ef : I->ef, 0, idx, dist, NULL, 0 };
+    aifd_parallel_for(m, threads, knn_query_range, &J);
+    return J.err ? AIFD_ENOMEM : AIFD_OK;
+}
+
+/* y: alvos na ordem original (classes 0..K-1 ou valores); out: m x K probabilidades
+   (K = n_classes >= 2) ou m médias (n_classes = 0); k é limitado a n */
+static int aifd_knn_predict(const aifd_knn *I, const double *y, int n_classes, const double *Q, int m,
+                            int k, int ef, double *out, int threads) {
+    if (!I->X || !y || !Q || m < 0 || k < 1 || !out || n_classes == 1 || n_classes < 0) return AIFD_EINVAL;
+    knn_query_job J = { I, Q, y, k < I->n ? k : I->n, ef > 0 ? ef : I->ef, n_classes, NULL, NULL, out, 0 };
+    aifd_parallel_for(m, threads, knn_query_range, &J);
+    return J.err ? AIFD_ENOMEM : AIFD_OK;
+}
+
+AIFD_NATIVE_END
+
+#endif
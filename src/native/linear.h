@@ -0,0 +1,479 @@
+#ifndef NATIVE_LINEAR_H
+#define NATIVE_LINEAR_H
+
+/* -------- Modelos lineares nativos --------
+   OLS/Ridge por equações normais (Gram em blocos + Cholesky), Lasso por
+   coordinate descent sobre a Gram, e regressão logística por L-BFGS (L1 via
+   OWL-QN). Objetivos na convenção do scikit-learn, intercepto nunca penalizado:
+     ridge : ||y - Xw - b||² + alpha·||w||²
+     lasso : ||y - Xw - b||² / (2n) + alpha·||w||₁
+     logreg: log-loss média + ||W||² / (2·C·n)      (L1: + ||W||₁ / (C·n))
+   Gram e gradientes rodam em paralelo (aifd_parallel_for) com kernels AVX2. */
+
+#include "native_common.h"
+
+AIFD_NATIVE_BEGIN
+
+enum { AIFD_LIN_OLS = 0, AIFD_LIN_RIDGE = 1, AIFD_LIN_LASSO = 2 };
+
+typedef struct {
+    int    kind;       /* AIFD_LIN_* */
+    double alpha;      /* ridge/lasso */
+    int    max_iter;   /* lasso: varreduras de coordinate descent */
+    double tol;        /* lasso: max|Δw| <= tol · max|w| */
+    int    threads;
+} aifd_linear_opts;
+
+static void aifd_linear_defaults(aifd_linear_opts *o) {
+    o->kind = AIFD_LIN_OLS; o->alpha = 1.0; o->max_iter = 1000; o->tol = 1e-4; o->threads = 0;
+}
+
+/* ======================= Gram centrada (X-μ)^T (X-μ) ======================= */
+
+#define LIN_TILE 64   /* linhas por bloco transposto: a Gram é tocada 1x a cada 64 linhas */
+
+typedef struct {
+    const double *X, *y; int n, d;
+    const double *mu; double ymu;
+    double *G, *r, *yy;   /* por thread: d x d (triângulo superior), d, 1 */
+    double *sum;          /* por thread: d + 1 (somas de X e y) */
+    double *BT;           /* por thread: d x LIN_TILE */
+} lin_gram_job;
+
+static void lin_sum_rows(void *arg, int b, int e, int tid) {
+    lin_gram_job *J = (lin_gram_job*)arg;
+    int d = J->d;
+    double *s = J->sum + (size_t)tid * (d + 1);
+    memset(s, 0, sizeof(double) * (d + 1));
+    for (int i = b; i < e; ++i) {
+        aifd_axpy(1.0, J->X + (size_t)i * d, s, d);
+        s[d] += J->y[i];
+    }
+}
+
+static void lin_gram_rows(void *arg, int b, int e, int tid) {
+    lin_gram_job *J = (lin_gram_job*)arg;
+    int d = J->d;
+    double *G = J->G + (size_t)tid * d * d, *r = J->r + (size_t)tid * d;
+    double *BT = J->BT + (size_t)tid * d * LIN_TILE;
+    double yc[LIN_TILE], yy = 0.0;
+    memset(G, 0, sizeof(double) * d * d);
+    memset(r, 0, sizeof(double) * d);
+    for (int i0 = b; i0 < e; i0 += LIN_TILE) {
+        int m = e - i0 < LIN_TILE ? e - i0 : LIN_TILE;
+        for (int t = 0; t < m; ++t) {
+            const double *x = J->X + (size_t)(i0 + t) * d;
+            for (int j = 0; j < d; ++j) BT[(size_t)j * LIN_TILE + t] = x[j] - J->mu[j];
+            yc[t] = J->y[i0 + t] - J->ymu;
+            yy += yc[t] * yc[t];
+        }
+        for (int j = 0; j < d; ++j) {
+            const double *bj = BT + (size_t)j * LIN_TILE;
+            double *Gj = G + (size_t)j * d;
+            for (int k = j; k < d; ++k) Gj[k] += aifd_dot(bj, BT + (size_t)k * LIN_TILE, m);
+            r[j] += aifd_dot(bj, yc, m);
+        }
+    }
+    J->yy[tid] = yy;
+}
+
+/* G (d x d simétrica cheia), r = Xc^T yc, yy = ||yc||², mu/ymu = médias */
+static int lin_gram(const double *X, const double *y, int n, int d, int threads,
+                    double *G, double *r, double *yy, double *mu, double *ymu) {
+    int t = aifd_num_threads(threads);
+    /* cada thread guarda uma Gram inteira: limita a ~256 MB */
+    size_t per = sizeof(double) * ((size_t)d * d + (size_t)d * (LIN_TILE + 2) + 2);
+    while (t > 1 && (size_t)t * per > ((size_t)256 << 20)) --t;
+    if (t > (n + LIN_TILE - 1) / LIN_TILE) t = (n + LIN_TILE - 1) / LIN_TILE;
+    if (t < 1) t = 1;
+
+    lin_gram_job J = { X, y, n, d, mu, 0.0, NULL, NULL, NULL, NULL, NULL };
+    J.G   = (double*)malloc(sizeof(double) * (size_t)t * d * d);
+    J.r   = (double*)malloc(sizeof(double) * (size_t)t * d);
+    J.yy  = (double*)calloc((size_t)t, sizeof(double));
+    J.sum = (double*)calloc((size_t)t * (d + 1), sizeof(double));
+    J.BT  = (double*)malloc(sizeof(double) * (size_t)t * d * LIN_TILE);
+    int rc = AIFD_ENOMEM;
+    if (!J.G || !J.r || !J.yy || !J.sum || !J.BT) goto out;
+
+    aifd_parallel_for(n, t, lin_sum_rows, &J);
+    memset(mu, 0, sizeof(double) * d);
+    double ys = 0.0;
+    for (int k = 0; k < t; ++k) { aifd_axpy(1.0, J.sum + (size_t)k * (d + 1), mu, d); ys += J.sum[(size_t)k * (d + 1) + d]; }
+    for (int j = 0; j < d; ++j) mu[j] /= n;
+    J.ymu = *ymu = ys / n;
+
+    aifd_parallel_for(n, t, lin_gram_rows, &J);
+    memcpy(G, J.G, sizeof(double) * d * d);
+    memcpy(r, J.r, sizeof(double) * d);
+    *yy = J.yy[0];
+    for (int k = 1; k < t; ++k) {
+        aifd_axpy(1.0, J.G + (size_t)k * d * d, G, d * d);
+        aifd_axpy(1.0, J.r + (size_t)k * d, r, d);
+        *yy += J.yy[k];
+    }
+    for (int j = 0; j < d; ++j)
+        for (int k = j + 1; k < d; ++k) G[(size_t)k * d + j] = G[(size_t)j * d + k];
+    rc = AIFD_OK;
+out:
+    free(J.G); free(J.r); free(J.yy); free(J.sum); free(J.BT);
+    return rc;
+}
+
+/* A = L L^T in-place (L no triângulo inferior, linha-major); -1 se não for definida positiva */
+static int aifd_cholesky(double *A, int d) {
+    for (int j = 0; j < d; ++j) {
+        double *Lj = A + (size_t)j * d;
+        double s = Lj[j] - aifd_dot(Lj, Lj, j);
+        if (!(s > 0.0)) return -1;
+        double l = sqrt(s);
+        Lj[j] = l;
+        for (int i = j + 1; i < d; ++i) {
+            double *Li = A + (size_t)i * d;
+            Li[j] = (Li[j] - aifd_dot(Li, Lj, j)) / l;
+        }
+    }
+    return 0;
+}
+
+/* resolve L L^T x = b (x pode ser b) */
+static void aifd_cholesky_solve(const double *L, int d, const double *b, double *x) {
+    if (x != b) memcpy(x, b, sizeof(double) * d);
+    for (int i = 0; i < d; ++i) x[i] = (x[i] - aifd_dot(L + (size_t)i * d, x, i)) / L[(size_t)i * d + i];
+    for (int i = d - 1; i >= 0; --i) {
+        double s = x[i];
+        for (int k = i + 1; k < d; ++k) s -= L[(size_t)k * d + i] * x[k];
+        x[i] = s / L[(size_t)i * d + i];
+    }
+}
+
+/* RSS = ||yc - Xc w||² a partir da Gram: yy - 2 r·w + w·G w */
+static double lin_rss(const double *G, const double *r, double yy, const double *w, int d) {
+    double wGw = 0.0;
+    for (int j = 0; j < d; ++j) wGw += w[j] * aifd_dot(G + (size_t)j * d, w, d);
+    double rss = yy - 2.0 * aifd_dot(r, w, d) + wGw;
+    return rss > 0.0 ? rss : 0.0;
+}
+
+/* ======================= Lasso: coordinate descent ======================= */
+
+static double soft_threshold(double z, double g) {
+    return z > g ? z - g : (z < -g ? z + g : 0.0);
+}
+
+/* G/r/yy já divididos por n; q = G w é mantido incrementalmente */
+static int lin_lasso_cd(const double *G, const double *r, double yy, int d, const aifd_linear_opts *o,
+                        double *w, aifd_fit_fn cb, void *user) {
+    double *q = (double*)calloc((size_t)d, sizeof(double));
+    if (!q) return AIFD_ENOMEM;
+    memset(w, 0, sizeof(double) * d);
+    int rc = AIFD_OK;
+    for (int it = 1; it <= o->max_iter; ++it) {
+        double max_dw = 0.0, max_w = 0.0;
+        for (int j = 0; j < d; ++j) {
+            double gjj = G[(size_t)j * d + j];
+            double wj = w[j], nw = 0.0;
+            if (gjj > 1e-300) nw = soft_threshold(r[j] - (q[j] - gjj * wj), o->alpha) / gjj;
+            if (nw != wj) {
+                aifd_axpy(nw - wj, G + (size_t)j * d, q, d);   /* G simétrica: linha j = coluna j */
+                w[j] = nw;
+                if (fabs(nw - wj) > max_dw) max_dw = fabs(nw - wj);
+            }
+            if (fabs(nw) > max_w) max_w = fabs(nw);
+        }
+        double rss = yy - 2.0 * aifd_dot(r, w, d) + aifd_dot(w, q, d), l1 = 0.0;
+        for (int j = 0; j < d; ++j) l1 += fabs(w[j]);
+        if (cb && cb(user, it, o->max_iter, 0.5 * rss + o->alpha * l1, yy > 0 ? 1.0 - rss / yy : 0.0)) {
+            rc = AIFD_CANCELLED; break;
+        }
+        if (max_dw <= o->tol * max_w || max_w == 0.0) break;
+    }
+    free(q);
+    return rc;
+}
+
+/* ajusta w[d] e b; cb recebe (iteração, total, loss, R² de treino) */
+static int aifd_linear_fit(const double *X, int n, int d, const double *y, const aifd_linear_opts *opts,
+                           double *w, double *b, aifd_fit_fn cb, void *user) {
+    if (!X || !y || !w || !b || n < 2 || d < 1) return AIFD_EINVAL;
+    aifd_linear_opts o;
+    if (opts) o = *opts; else aifd_linear_defaults(&o);
+
+    double *G = (double*)malloc(sizeof(double) * (size_t)d * d);
+    double *A = (double*)malloc(sizeof(double) * (size_t)d * d);
+    double *r = (double*)malloc(sizeof(double) * d);
+    double *mu = (double*)malloc(sizeof(double) * d);
+    double yy = 0.0, ymu = 0.0;
+    int rc = AIFD_ENOMEM;
+    if (!G || !A || !r || !mu) goto out;
+    if ((rc = lin_gram(X, y, n, d, o.threads, G, r, &yy, mu, &ymu)) != AIFD_OK) goto out;
+
+    if (o.kind == AIFD_LIN_LASSO) {
+        for (size_t k = 0; k < (size_t)d * d; ++k) G[k] /= n;
+        for (int j = 0; j < d; ++j) r[j] /= n;
+        rc = lin_lasso_cd(G, r, yy / n, d, &o, w, cb, user);
+        if (rc < 0) goto out;
+    } else {
+        /* ridge: + alpha·I; OLS singular (colunas colineares): jitter crescente */
+        double tr = 0.0;
+        for (int j = 0; j < d; ++j) tr += G[(size_t)j * d + j];
+        double jitter = o.kind == AIFD_LIN_RIDGE ? o.alpha : 0.0;
+        for (int attempt = 0; ; ++attempt) {
+            memcpy(A, G, sizeof(double) * d * d);
+            for (int j = 0; j < d; ++j) A[(size_t)j * d + j] += jitter;
+            if (aifd_cholesky(A, d) == 0) break;
+            if (attempt == 8) { rc = AIFD_EINVAL; goto out; }
+            jitter = jitter > 0 ? jitter * 100.0 : 1e-12 * (tr > 0 ? tr / d : 1.0);
+        }
+        aifd_cholesky_solve(A, d, r, w);
+        double rss = lin_rss(G, r, yy, w, d);
+        double loss = rss;
+        if (o.kind == AIFD_LIN_RIDGE) loss += o.alpha * aifd_dot(w, w, d);
+        rc = (cb && cb(user, 1, 1, loss / n, yy > 0 ? 1.0 - rss / yy : 0.0)) ? AIFD_CANCELLED : AIFD_OK;
+    }
+    *b = ymu - aifd_dot(mu, w, d);
+out:
+    free(G); free(A); free(r); free(mu);
+    return rc;
+}
+
+static inline void aifd_linear_predict(const double *X, int n, int d, const double *w, double b, double *out) {
+    for (int i = 0; i < n; ++i) out[i] = aifd_dot(X + (size_t)i * d, w, d) + b;
+}
+
+/* ======================= Regressão logística: L-BFGS / OWL-QN ======================= */
+
+typedef struct {
+    double C;
+    int    l1;         /* 0 = L2, 1 = L1 (OWL-QN) */
+    int    max_iter;
+    double tol;        /* max |gradiente projetado| */
+    int    memory;     /* pares (s, y) guardados */
+    int    threads;
+} aifd_logreg_opts;
+
+static void aifd_logreg_defaults(aifd_logreg_opts *o) {
+    o->C = 1.0; o->l1 = 0; o->max_iter = 200; o->tol = 1e-4; o->memory = 10; o->threads = 0;
+}
+
+/* k classes: k == 2 usa um vetor (sigmoide), k > 2 usa k vetores (softmax).
+   W: nw x (d+1), último elemento de cada linha = intercepto. */
+static int logreg_rows_of(int k) { return k == 2 ? 1 : k; }
+
+typedef struct {
+    const double *X; const int *y; int n, d, k;
+    const double *W;
+    double *grad;      /* por thread: nw x (d+1) */
+    double *loss;      /* por thread */
+    int    *correct;   /* por thread */
+    double *z;         /* por thread: k */
+} logreg_job;
+
+static void logreg_eval_rows(void *arg, int b, int e, int tid) {
+    logreg_job *J = (logreg_job*)arg;
+    int d = J->d, nw = logreg_rows_of(J->k), P = nw * (d + 1);
+    double *g = J->grad + (size_t)tid * P, *z = J->z + (size_t)tid * J->k;
+    double loss = 0.0; int correct = 0;
+    memset(g, 0, sizeof(double) * P);
+    for (int i = b; i < e; ++i) {
+        const double *x = J->X + (size_t)i * d;
+        int yi = J->y[i];
+        if (nw == 1) {
+            double t = aifd_dot(J->W, x, d) + J->W[d];
+            /* log(1 + e^t) - y·t, estável */
+            loss += (t > 0 ? t : 0.0) + log1p(exp(-fabs(t))) - (yi ? t : 0.0);
+            double p = t >= 0 ? 1.0 / (1.0 + exp(-t)) : exp(t) / (1.0 + exp(t));
+            double gi = p - (double)yi;
+            aifd_axpy(gi, x, g, d); g[d] += gi;
+            correct += ((t >= 0.0) == (yi != 0));
+        } else {
+            int arg = 0;
+            for (int c = 0; c < nw; ++c) {
+                z[c] = aifd_dot(J->W + (size_t)c * (d + 1), x, d) + J->W[(size_t)c * (d + 1) + d];
+                if (z[c] > z[arg]) arg = c;
+            }
+            double zmax = z[arg], se = 0.0;
+            for (int c = 0; c < nw; ++c) se += exp(z[c] - zmax);
+            double lse = zmax + log(se);
+            loss += lse - z[yi];
+            for (int c = 0; c < nw; ++c) {
+                double gi = exp(z[c] - lse) - (c == yi ? 1.0 : 0.0);
+                double *gc = g + (size_t)c * (d + 1);
+                aifd_axpy(gi, x, gc, d); gc[d] += gi;
+            }
+            correct += (arg == yi);
+        }
+    }
+    J->loss[tid] = loss; J->correct[tid] = correct;
+}
+
+typedef struct {
+    logreg_job job;
+    int threads, P;
+    double lam;        /* 1/(C·n) */
+    int l1;
+    double acc;        /* acurácia de treino no último ponto avaliado */
+} logreg_ctx;
+
+/* parte suave do objetivo (log-loss média + L2) e seu gradiente; com L1 soma ||W||₁·lam em f */
+static double logreg_eval(logreg_ctx *L, const double *W, double *g) {
+    logreg_job *J = &L->job;
+    int d = J->d, nw = logreg_rows_of(J->k), P = L->P;
+    J->W = W;
+    aifd_parallel_for(J->n, L->threads, logreg_eval_rows, J);
+    int t = L->threads;
+    double loss = 0.0; int correct = 0;
+    memset(g, 0, sizeof(double) * P);
+    for (int k = 0; k < t; ++k) {
+        aifd_axpy(1.0, J->grad + (size_t)k * P, g, P);
+        loss += J->loss[k]; correct += J->correct[k];
+    }
+    double inv = 1.0 / J->n, pen = 0.0;
+    for (int p = 0; p < P; ++p) g[p] *= inv;
+    for (int c = 0; c < nw; ++c)
+        for (int j = 0; j < d; ++j) {
+            double wj = W[(size_t)c * (d + 1) + j];
+            if (L->l1) pen += L->lam * fabs(wj);
+            else { pen += 0.5 * L->lam * wj * wj; g[(size_t)c * (d + 1) + j] += L->lam * wj; }
+        }
+    L->acc = (double)correct * inv;
+    return loss * inv + pen;
+}
+
+/* OWL-QN: gradiente do lado que desce (0 quando nenhum lado desce) */
+static void logreg_pseudo_grad(const logreg_ctx *L, const double *W, const double *g, double *pg) {
+    int d = L->job.d;
+    for (int p = 0; p < L->P; ++p) {
+        double lam = ((p % (d + 1)) == d) ? 0.0 : L->lam;   /* intercepto sem penalidade */
+        if (W[p] > 0)      pg[p] = g[p] + lam;
+        else if (W[p] < 0) pg[p] = g[p] - lam;
+        else if (g[p] + lam < 0) pg[p] = g[p] + lam;
+        else if (g[p] - lam > 0) pg[p] = g[p] - lam;
+        else pg[p] = 0.0;
+    }
+}
+
+/* y em 0..k-1; W (saída) deve ter logreg_rows_of(k)·(d+1) posições. cb: (iter, max_iter, loss, acc) */
+static int aifd_logreg_fit(const double *X, int n, int d, const int *y, int k, const aifd_logreg_opts *opts,
+                           double *W, aifd_fit_fn cb, void *user) {
+    if (!X || !y || !W || n < 1 || d < 1 || k < 2) return AIFD_EINVAL;
+    aifd_logreg_opts o;
+    if (opts) o = *opts; else aifd_logreg_defaults(&o);
+    if (o.memory < 1) o.memory = 10;
+    if (!(o.C > 0)) o.C = 1.0;
+
+    int nw = logreg_rows_of(k), P = nw * (d + 1), m = o.memory;
+    int t = aifd_num_threads(o.threads);
+    if (t > n) t = n;
+
+    logreg_ctx L;
+    memset(&L, 0, sizeof L);
+    L.job.X = X; L.job.y = y; L.job.n = n; L.job.d = d; L.job.k = k;
+    L.threads = t; L.P = P; L.lam = 1.0 / (o.C * n); L.l1 = o.l1;
+    L.job.grad    = (double*)malloc(sizeof(double) * (size_t)t * P);
+    L.job.loss    = (double*)calloc((size_t)t, sizeof(double));
+    L.job.correct = (int*)calloc((size_t)t, sizeof(int));
+    L.job.z       = (double*)malloc(sizeof(double) * (size_t)t * k);
+
+    /* g, pg, dir, Wn, gn, q, S[m], Y[m], rho[m], alpha[m] */
+    double *buf = (double*)malloc(sizeof(double) * ((size_t)P * (6 + 2 * (size_t)m) + 2 * (size_t)m));
+    int rc = AIFD_ENOMEM;
+    if (!L.job.grad || !L.job.loss || !L.job.correct || !L.job.z || !buf) goto out;
+    for (int i = 0; i < n; ++i) if (y[i] < 0 || y[i] >= k) { rc = AIFD_EINVAL; goto out; }
+
+    double *g = buf, *pg = g + P, *dir = pg + P, *Wn = dir + P, *gn = Wn + P, *q = gn + P;
+    double *S = q + P, *Yv = S + (size_t)m * P, *rho = Yv + (size_t)m * P, *al = rho + m;
+    int mem = 0, head = 0;   /* pares válidos; próximo slot */
+
+    memset(W, 0, sizeof(double) * P);
+    double f = logreg_eval(&L, W, g);
+    rc = AIFD_OK;
+    for (int it = 1; it <= o.max_iter; ++it) {
+        if (o.l1) logreg_pseudo_grad(&L, W, g, pg); else memcpy(pg, g, sizeof(double) * P);
+        double gmax = 0.0;
+        for (int p = 0; p < P; ++p) if (fabs(pg[p]) > gmax) gmax = fabs(pg[p]);
+        if (gmax <= o.tol) break;
+
+        /* two-loop recursion: dir = -H·pg */
+        memcpy(q, pg, sizeof(double) * P);
+        for (int c = 0; c < mem; ++c) {
+            int s = (head - 1 - c + m) % m;
+            al[s] = rho[s] * aifd_dot(S + (size_t)s * P, q, P);
+            aifd_axpy(-al[s], Yv + (size_t)s * P, q, P);
+        }
+        if (mem > 0) {
+            int s = (head - 1 + m) % m;
+            double yy = aifd_dot(Yv + (size_t)s * P, Yv + (size_t)s * P, P);
+            double gamma = yy > 0 ? 1.0 / (rho[s] * yy) : 1.0;
+            for (int p = 0; p < P; ++p) q[p] *= gamma;
+        }
+        for (int c = mem - 1; c >= 0; --c) {
+            int s = (head - 1 - c + m) % m;
+            double be = rho[s] * aifd_dot(Yv + (size_t)s * P, q, P);
+            aifd_axpy(al[s] - be, S + (size_t)s * P, q, P);
+        }
+        for (int p = 0; p < P; ++p) dir[p] = -q[p];
+        if (o.l1) for (int p = 0; p < P; ++p) if (dir[p] * pg[p] >= 0) dir[p] = 0.0;
+
+        double gtd = aifd_dot(dir, pg, P);
+        if (!(gtd < 0)) {   /* direção ruim: volta para o gradiente e esquece a curvatura */
+            for (int p = 0; p < P; ++p) dir[p] = -pg[p];
+            gtd = -aifd_dot(pg, pg, P);
+            mem = 0;
+        }
+
+        /* backtracking (Armijo); no OWL-QN projeta no ortante de W */
+        double step = mem == 0 ? fmin(1.0, 1.0 / sqrt(-gtd)) : 1.0, fn = f;
+        int accepted = 0;
+        for (int ls = 0; ls < 40; ++ls) {
+            for (int p = 0; p < P; ++p) Wn[p] = W[p] + step * dir[p];
+            if (o.l1)
+                for (int p = 0; p < P; ++p) {
+                    if ((p % (d + 1)) == d) continue;
+                    double xi = W[p] != 0 ? W[p] : -pg[p];
+                    if (Wn[p] * xi <= 0) Wn[p] = 0.0;
+                }
+            fn = logreg_eval(&L, Wn, gn);
+            double dec = 0.0;
+            for (int p = 0; p < P; ++p) dec += pg[p] * (Wn[p] - W[p]);
+            if (fn <= f + 1e-4 * dec) { accepted = 1; break; }
+            step *= 0.5;
+        }
+        if (!accepted) { logreg_eval(&L, W, g); break; }   /* sem progresso possível em precisão double */
+
+        /* novo par (s, y) só com curvatura positiva */
+        double *sv = S + (size_t)head * P, *yv = Yv + (size_t)head * P;
+        for (int p = 0; p < P; ++p) { sv[p] = Wn[p] - W[p]; yv[p] = gn[p] - g[p]; }
+        double sy = aifd_dot(sv, yv, P);
+        if (sy > 1e-12) { rho[head] = 1.0 / sy; head = (head + 1) % m; if (mem < m) ++mem; }
+
+        double rel = (f - fn) / fmax(1.0, fmax(fabs(f), fabs(fn)));
+        memcpy(W, Wn, sizeof(double) * P);
+        memcpy(g, gn, sizeof(double) * P);
+        f = fn;
+        if (cb && cb(user, it, o.max_iter, f, L.acc)) { rc = AIFD_CANCELLED; break; }
+        if (rel < 1e-10) break;
+    }
+out:
+    free(L.job.grad); free(L.job.loss); free(L.job.correct); free(L.job.z); free(buf);
+    return rc;
+}
+
+/* rótulo previsto (0..k-1) por linha */
+static inline void aifd_logreg_predict(const double *X, int n, int d, const double *W, int k, int *out) {
+    int nw = logreg_rows_of(k);
+    for (int i = 0; i < n; ++i) {
+        const double *x = X + (size_t)i * d;
+        if (nw == 1) { out[i] = (aifd_dot(W, x, d) + W[d]) >= 0.0; continue; }
+        int best = 0; double bz = -INFINITY;
+        for (int c = 0; c < nw; ++c) {
+            double z = aifd_dot(W + (size_t)c * (d + 1), x, d) + W[(size_t)c * (d + 1) + d];
+            if (z > bz) { bz = z; best = c; }
+        }
+        out[i] = best;
+    }
+}
+
+AIFD_NATIVE_END
+
+#endif
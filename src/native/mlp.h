@@ -0,0 +1,286 @@
+#ifndef NATIVE_MLP_H
+#define NATIVE_MLP_H
+
+/* -------- MLP nativo (mesma arquitetura do mlp_reg/mlp_cls do trainer) --------
+   d -> [hidden, act] x layers -> saída. Regressão: 1 saída + MSE; binária:
+   1 logit + BCE; k > 2 classes: k logits + softmax/entropia cruzada.
+   Treino em minibatches embaralhados com Adam ou SGD (momentum); todos os
+   produtos de matriz passam por aifd_sgemm (float32, blocos + AVX2).
+   Parâmetros num vetor float contíguo, camada a camada: W (in x out) e b (out),
+   para o chamador guardar/pickle/retomar sem estruturas opacas. */
+
+#include "gemm.h"
+
+AIFD_NATIVE_BEGIN
+
+enum { AIFD_ACT_RELU = 0, AIFD_ACT_TANH = 1 };
+enum { AIFD_OPT_ADAM = 0, AIFD_OPT_SGD = 1 };
+
+#define MLP_MAX_LAYERS 16
+
+typedef struct {
+    int    hidden, layers, act;
+    int    optimizer;          /* AIFD_OPT_* */
+    double lr, momentum;       /* momentum: só SGD */
+    int    batch;              /* linhas por passo; <= 0 = lote inteiro */
+    int    epochs;
+    unsigned long long seed;   /* init + embaralhamento */
+    int    threads;
+    int    warm;               /* 1 = parte dos parâmetros recebidos */
+} aifd_mlp_opts;
+
+static void aifd_mlp_defaults(aifd_mlp_opts *o) {
+    o->hidden = 64; o->layers = 2; o->act = AIFD_ACT_RELU;
+    o->optimizer = AIFD_OPT_ADAM; o->lr = 1e-3; o->momentum = 0.9;
+    o->batch = 64; o->epochs = 100; o->seed = 42; o->threads = 0; o->warm = 0;
+}
+
+static int aifd_mlp_outputs(int k) { return k > 2 ? k : 1; }
+
+/* larguras das camadas: dims[0] = d ... dims[L] = saídas; retorna L (nº de camadas densas) */
+static int mlp_dims(int d, int hidden, int layers, int k, int *dims) {
+    if (layers < 1) layers = 1;
+    if (layers > MLP_MAX_LAYERS) layers = MLP_MAX_LAYERS;
+    dims[0] = d;
+    for (int l = 1; l <= layers; ++l) dims[l] = hidden;
+    dims[layers + 1] = aifd_mlp_outputs(k);
+    return layers + 1;
+}
+
+static size_t aifd_mlp_param_count(int d, int hidden, int layers, int k) {
+    int dims[MLP_MAX_LAYERS + 2], L = mlp_dims(d, hidden, layers, k, dims);
+    size_t P = 0;
+    for (int l = 0; l < L; ++l) P += (size_t)dims[l] * dims[l + 1] + dims[l + 1];
+    return P;
+}
+
+/* init do torch.nn.Linear: W, b ~ U(-1/sqrt(in), 1/sqrt(in)) */
+static void mlp_init(const int *dims, int L, float *P, unsigned long long seed) {
+    unsigned long long s = seed ? seed : 42;
+    for (int l = 0; l < L; ++l) {
+        size_t cnt = (size_t)dims[l] * dims[l + 1] + dims[l + 1];
+        double bound = 1.0 / sqrt((double)dims[l]);
+        for (size_t p = 0; p < cnt; ++p) P[p] = (float)((2.0 * aifd_rng_uniform(&s) - 1.0) * bound);
+        P += cnt;
+    }
+}
+
+/* A[l+1] = act(A[l]·W_l + b_l); a última camada fica crua (logits / valor) */
+static void mlp_forward(const int *dims, int L, int act, const float *P, float **A, int B, int threads, float *ws) {
+    for (int l = 0; l < L; ++l) {
+        int in = dims[l], out = dims[l + 1];
+        const float *W = P, *b = P + (size_t)in * out;
+        float *Z = A[l + 1];
+        aifd_sgemm(0, 0, B, out, in, 1.0f, A[l], in, W, out, 0.0f, Z, out, threads, ws);
+        int last = l == L - 1;
+        for (int i = 0; i < B; ++i) {
+            float *z = Z + (size_t)i * out;
+            for (int j = 0; j < out; ++j) z[j] += b[j];
+            if (last) continue;
+            if (act == AIFD_ACT_TANH) for (int j = 0; j < out; ++j) z[j] = tanhf(z[j]);
+            else                      for (int j = 0; j < out; ++j) z[j] = z[j] > 0.0f ? z[j] : 0.0f;
+        }
+        P += (size_t)in * out + out;
+    }
+}
+
+/* saída -> previsão: valor (k = 0), P(classe 1) (k = 2) ou softmax (k > 2) */
+static void mlp_output(const float *Z, int B, int k, double *out) {
+    int K = aifd_mlp_outputs(k);
+    for (int i = 0; i < B; ++i) {
+        const float *z = Z + (size_t)i * K;
+        double *o = out + (size_t)i * K;
+        if (k == 0)      { o[0] = z[0]; continue; }
+        if (k == 2)      { o[0] = 1.0 / (1.0 + exp(-(double)z[0])); continue; }
+        double mx = z[0], s = 0.0;
+        for (int c = 1; c < K; ++c) if (z[c] > mx) mx = z[c];
+        for (int c = 0; c < K; ++c) { o[c] = exp((double)z[c] - mx); s += o[c]; }
+        for (int c = 0; c < K; ++c) o[c] /= s;
+    }
+}
+
+/* perda (soma no lote) e dZ = dL/dZ da média; stat: acertos (classificação) ou soma de resíduo² */
+static double mlp_loss_grad(const float *Z, int B, int k, const double *y, const int *rows, float *dZ, double *stat) {
+    int K = aifd_mlp_outputs(k);
+    double loss = 0.0, inv = 1.0 / B;
+    for (int i = 0; i < B; ++i) {
+        const float *z = Z + (size_t)i * K;
+        float *g = dZ + (size_t)i * K;
+        double t = y[rows[i]];
+        if (k == 0) {
+            double e = z[0] - t;
+            loss += e * e; *stat += e * e;
+            g[0] = (float)(2.0 * e * inv);
+        } else if (k == 2) {
+            double x = z[0], p = 1.0 / (1.0 + exp(-x));
+            loss += (x > 0 ? x : 0.0) - x * t + log1p(exp(-fabs(x)));   /* BCE com logits, estável */
+            g[0] = (float)((p - t) * inv);
+            *stat += (x >= 0.0) == (t > 0.5);
+        } else {
+            int c = (int)t, best = 0;
+            double mx = z[0], s = 0.0;
+            for (int j = 1; j < K; ++j) { if (z[j] > mx) { mx = z[j]; best = j; } }
+            for (int j = 0; j < K; ++j) s += exp((double)z[j] - mx);
+            loss += log(s) + mx - z[c];
+            for (int j = 0; j < K; ++j) g[j] = (float)((exp((double)z[j] - mx) / s - (j == c)) * inv);
+            *stat += best == c;
+        }
+    }
+    return loss;
+}
+
+/* gradiente de todas as camadas em G (mesmo layout de P); dZ e dA são buffers B x max(dims) */
+static void mlp_backward(const int *dims, int L, int act, const float *P, float **A, int B,
+                         float *dZ, float *dA, float *G, int threads, float *ws) {
+    size_t off[MLP_MAX_LAYERS + 2];
+    off[0] = 0;
+    for (int l = 0; l < L; ++l) off[l + 1] = off[l] + (size_t)dims[l] * dims[l + 1] + dims[l + 1];
+    for (int l = L - 1; l >= 0; --l) {
+        int in = dims[l], out = dims[l + 1];
+        float *gW = G + off[l], *gb = gW + (size_t)in * out;
+        aifd_sgemm(1, 0, in, out, B, 1.0f, A[l], in, dZ, out, 0.0f, gW, out, threads, ws);
+        memset(gb, 0, sizeof(float) * out);
+        for (int i = 0; i < B; ++i) {
+            const float *g = dZ + (size_t)i * out;
+            for (int j = 0; j < out; ++j) gb[j] += g[j];
+        }
+        if (l == 0) break;
+        /* dA = dZ·W^T, depois a derivada da ativação (em função da saída já ativada) */
+        aifd_sgemm(0, 1, B, in, out, 1.0f, dZ, out, P + off[l], out, 0.0f, dA, in, threads, ws);
+        const float *a = A[l];
+        size_t cnt = (size_t)B * in;
+        if (act == AIFD_ACT_TANH) for (size_t p = 0; p < cnt; ++p) dA[p] *= 1.0f - a[p] * a[p];
+        else                      for (size_t p = 0; p < cnt; ++p) if (a[p] <= 0.0f) dA[p] = 0.0f;
+        float *t = dZ; dZ = dA; dA = t;
+    }
+}
+
+/* X: n x d (double, linha-major); y: alvo (k = 0) ou classe 0..k-1 (k >= 2).
+   P: aifd_mlp_param_count(...) floats (lidos se opts->warm). cb por época:
+   (época, épocas, perda média, score de treino: acurácia ou R² em [0,1]). */
+static int aifd_mlp_fit(const double *X, int n, int d, const double *y, int k,
+                        const aifd_mlp_opts *opts, float *P, aifd_fit_fn cb, void *user) {
+    if (!X || !y || !P || n < 1 || d < 1 || k == 1 || k < 0) return AIFD_EINVAL;
+    aifd_mlp_opts o;
+    if (opts) o = *opts; else aifd_mlp_defaults(&o);
+    if (o.hidden < 1) o.hidden = 1;
+    for (int i = 0; i < n; ++i)
+        if (!isfinite(y[i]) || (k >= 2 && (y[i] < 0 || y[i] >= k || y[i] != floor(y[i])))) return AIFD_EINVAL;
+
+    int dims[MLP_MAX_LAYERS + 2], L = mlp_dims(d, o.hidden, o.layers, k, dims);
+    int B = o.batch > 0 && o.batch < n ? o.batch : n, wmax = 0;
+    for (int l = 0; l <= L; ++l) if (dims[l] > wmax) wmax = dims[l];
+    size_t np = aifd_mlp_param_count(d, o.hidden, o.layers, k), acts = 0;
+    for (int l = 0; l <= L; ++l) acts += (size_t)B * dims[l];
+
+    float *Xf = (float*)malloc(sizeof(float) * (size_t)n * d);
+    float *act = (float*)malloc(sizeof(float) * (acts + 2 * (size_t)B * wmax));
+    float *G = (float*)malloc(sizeof(float) * np * 3);      /* gradiente + 2 momentos */
+    float *ws = (float*)malloc(sizeof(float) * aifd_sgemm_ws_floats(o.threads));
+    int *perm = (int*)malloc(sizeof(int) * n);
+    int rc = AIFD_ENOMEM;
+    if (!Xf || !act || !G || !ws || !perm) goto out;
+
+    for (size_t p = 0; p < (size_t)n * d; ++p) Xf[p] = (float)X[p];
+    float *A[MLP_MAX_LAYERS + 2];
+    A[0] = act;
+    for (int l = 1; l <= L; ++l) A[l] = A[l - 1] + (size_t)B * dims[l - 1];
+    float *dZ = A[L] + (size_t)B * dims[L], *dA = dZ + (size_t)B * wmax;
+    float *M1 = G + np, *M2 = M1 + np;
+    memset(M1, 0, sizeof(float) * np * 2);
+    if (!o.warm) mlp_init(dims, L, P, o.seed);
+
+    /* R² da época: SS_tot fixo do treino */
+    double ymu = 0.0, sst = 0.0;
+    if (k == 0) {
+        for (int i = 0; i < n; ++i) ymu += y[i];
+        ymu /= n;
+        for (int i = 0; i < n; ++i) sst += (y[i] - ymu) * (y[i] - ymu);
+    }
+
+    unsigned long long s = o.seed ^ 0x5DEECE66DULL;
+    for (int i = 0; i < n; ++i) perm[i] = i;
+    const double b1 = 0.9, b2 = 0.999, eps = 1e-8;
+    double b1t = 1.0, b2t = 1.0;
+    rc = AIFD_OK;
+    for (int ep = 1; ep <= o.epochs; ++ep) {
+        if (B < n)
+            for (int i = n - 1; i > 0; --i) {
+                int j = (int)(aifd_rng_next(&s) % (unsigned long long)(i + 1));
+                int t = perm[i]; perm[i] = perm[j]; perm[j] = t;
+            }
+        double loss = 0.0, stat = 0.0;
+        for (int i0 = 0; i0 < n; i0 += B) {
+            int nb = n - i0 < B ? n - i0 : B;
+            for (int i = 0; i < nb; ++i) memcpy(A[0] + (size_t)i * d, Xf + (size_t)perm[i0 + i] * d, sizeof(float) * d);
+            mlp_forward(dims, L, o.act, P, A, nb, o.threads, ws);
+            loss += mlp_loss_grad(A[L], nb, k, y, perm + i0, dZ, &stat);
+            mlp_backward(dims, L, o.act, P, A, nb, dZ, dA, G, o.threads, ws);
+
+            if (o.optimizer == AIFD_OPT_SGD) {
+                float lr = (float)o.lr, mom = (float)o.momentum;
+                for (size_t p = 0; p < np; ++p) { M1[p] = mom * M1[p] + G[p]; P[p] -= lr * M1[p]; }
+            } else {
+                b1t *= b1; b2t *= b2;
+                float c1 = (float)(o.lr / (1.0 - b1t)), c2 = (float)(1.0 / (1.0 - b2t));
+                for (size_t p = 0; p < np; ++p) {
+                    M1[p] = (float)b1 * M1[p] + (float)(1.0 - b1) * G[p];
+                    M2[p] = (float)b2 * M2[p] + (float)(1.0 - b2) * G[p] * G[p];
+                    P[p] -= c1 * M1[p] / (sqrtf(M2[p] * c2) + (float)eps);
+                }
+            }
+        }
+        if (!isfinite(loss)) { rc = AIFD_EINVAL; break; }   /* divergiu: lr alto demais */
+        /* perda/score acumulados durante a época (antes de cada passo), como o log do torch */
+        double score = k == 0 ? (sst > 0 ? fmax(0.0, fmin(1.0, 1.0 - stat / sst)) : 0.0) : stat / n;
+        if (cb && cb(user, ep, o.epochs, loss / n, score)) { rc = AIFD_CANCELLED; break; }
+    }
+out:
+    free(Xf); free(act); free(G); free(ws); free(perm);
+    return rc;
+}
+
+/* ---- previsão em blocos de linhas, um bloco por thread ---- */
+#define MLP_PRED_ROWS 256
+
+typedef struct {
+    const double *X; int n, d, k, act, L;
+    const int *dims; const float *P;
+    double *out;
+    int failed;
+} mlp_pred_job;
+
+static void mlp_pred_rows(void *arg, int b, int e, int tid) {
+    (void)tid;
+    mlp_pred_job *J = (mlp_pred_job*)arg;
+    size_t acts = 0;
+    for (int l = 0; l <= J->L; ++l) acts += (size_t)MLP_PRED_ROWS * J->dims[l];
+    float *buf = (float*)malloc(sizeof(float) * acts);
+    float *ws = (float*)malloc(sizeof(float) * GEMM_WS_PER_THREAD);
+    if (!buf || !ws) { J->failed = 1; free(buf); free(ws); return; }
+    float *A[MLP_MAX_LAYERS + 2];
+    A[0] = buf;
+    for (int l = 1; l <= J->L; ++l) A[l] = A[l - 1] + (size_t)MLP_PRED_ROWS * J->dims[l - 1];
+    for (int blk = b; blk < e; ++blk) {
+        int i0 = blk * MLP_PRED_ROWS, nb = J->n - i0 < MLP_PRED_ROWS ? J->n - i0 : MLP_PRED_ROWS;
+        for (size_t p = 0; p < (size_t)nb * J->d; ++p) A[0][p] = (float)J->X[(size_t)i0 * J->d + p];
+        mlp_forward(J->dims, J->L, J->act, J->P, A, nb, 1, ws);
+        mlp_output(A[J->L], nb, J->k, J->out + (size_t)i0 * aifd_mlp_outputs(J->k));
+    }
+    free(buf); free(ws);
+}
+
+/* out: n x aifd_mlp_outputs(k) (valor, P(classe 1) ou probabilidades por classe) */
+static int aifd_mlp_predict(const double *X, int n, int d, int k, int hidden, int layers, int act,
+                            const float *P, double *out, int threads) {
+    if (!X || !P || !out || n < 0 || d < 1 || k == 1 || k < 0) return AIFD_EINVAL;
+    int dims[MLP_MAX_LAYERS + 2];
+    mlp_pred_job J = { X, n, d, k, act, 0, dims, P, out, 0 };
+    J.L = mlp_dims(d, hidden < 1 ? 1 : hidden, layers, k, dims);
+    aifd_parallel_for((n + MLP_PRED_ROWS - 1) / MLP_PRED_ROWS, threads, mlp_pred_rows, &J);
+    return J.failed ? AIFD_ENOMEM : AIFD_OK;
+}
+
+AIFD_NATIVE_END
+
+#endif
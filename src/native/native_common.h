@@ -0,0 +1,277 @@
+#ifndef NATIVE_COMMON_H
+#define NATIVE_COMMON_H
+
+/* -------- Núcleo nativo (sem GTK): threads, tempo, progresso e kernels SIMD --------
+   Estes headers são incluídos tanto pelo cliente (in-process) quanto por
+   src/native/aifd_native.c, que gera a DLL usada pelo Python via ctypes. */
+
+/* clock_gettime/CLOCK_MONOTONIC com -std=c11 fora do MSYS2 (antes de qualquer include do sistema) */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+  #define _POSIX_C_SOURCE 200809L
+#endif
+#if defined(__APPLE__) && !defined(_DARWIN_C_SOURCE)
+  #define _DARWIN_C_SOURCE   /* sysctl e afins continuam visíveis no macOS */
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+  #ifndef WIN32_LEAN_AND_MEAN
+  #define WIN32_LEAN_AND_MEAN
+  #endif
+  #include <windows.h>
+#else
+  #include <unistd.h>
+  #include <time.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+  #define AIFD_X86 1
+#endif
+
+/* o executável é compilado com -O0 (debug); os kernels numéricos pedem O3 localmente */
+#if defined(__GNUC__) && !defined(__clang__)
+  #define AIFD_NATIVE_BEGIN _Pragma("GCC push_options") _Pragma("GCC optimize(\"O3\")")
+  #define AIFD_NATIVE_END   _Pragma("GCC pop_options")
+#else
+  #define AIFD_NATIVE_BEGIN
+  #define AIFD_NATIVE_END
+#endif
+
+AIFD_NATIVE_BEGIN
+
+/* status de retorno das rotinas nativas */
+enum { AIFD_OK = 0, AIFD_CANCELLED = 1, AIFD_EINVAL = -1, AIFD_ENOMEM = -2 };
+
+/* progresso: chamado na thread que iniciou a rotina; retornar != 0 cancela */
+typedef int (*aifd_progress_fn)(void *user, int step, int total, double value);
+
+/* progresso de treino: uma linha da tabela Fit (iteração/época, loss, score); != 0 cancela */
+typedef int (*aifd_fit_fn)(void *user, int iter, int total, double loss, double score);
+
+static inline double aifd_now(void) {
+#ifdef _WIN32
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f); QueryPerformanceCounter(&c);
+    return (double)c.QuadPart / (double)f.QuadPart;
+#else
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+#endif
+}
+
+/* nº de threads: AIFD_THREADS no ambiente, senão todos os núcleos */
+static int aifd_num_threads(int requested) {
+    if (requested > 0) return requested;
+    const char *env = getenv("AIFD_THREADS");
+    if (env && atoi(env) > 0) return atoi(env);
+#ifdef _WIN32
+    SYSTEM_INFO si; GetSystemInfo(&si);
+    int n = (int)si.dwNumberOfProcessors;
+#else
+    int n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return n > 0 ? (n > 64 ? 64 : n) : 1;
+}
+
+/* ---- parallel for: divide [0,n) em blocos contíguos, um por thread ---- */
+typedef void (*aifd_range_fn)(void *arg, int begin, int end, int tid);
+
+typedef struct {
+    aifd_range_fn fn;
+    void *arg;
+    int begin, end, tid;
+} aifd_range_job;
+
+static void *aifd_range_thread(void *p) {
+    aifd_range_job *j = (aifd_range_job*)p;
+    j->fn(j->arg, j->begin, j->end, j->tid);
+    return NULL;
+}
+
+/* roda fn em até `threads` threads; a thread chamadora processa o primeiro bloco */
+static void aifd_parallel_for(int n, int threads, aifd_range_fn fn, void *arg) {
+    if (n <= 0) return;
+    int t = aifd_num_threads(threads);
+    if (t > n) t = n;
+    if (t <= 1) { fn(arg, 0, n, 0); return; }
+
+    aifd_range_job jobs[64];
+    pthread_t      th[64];
+    int started[64] = {0};
+    for (int k = 0; k < t; ++k) {
+        jobs[k].fn = fn; jobs[k].arg = arg; jobs[k].tid = k;
+        jobs[k].begin = (int)((long long)n * k / t);
+        jobs[k].end   = (int)((long long)n * (k + 1) / t);
+    }
+    for (int k = 1; k < t; ++k)
+        started[k] = (pthread_create(&th[k], NULL, aifd_range_thread, &jobs[k]) == 0);
+    fn(arg, jobs[0].begin, jobs[0].end, 0);
+    for (int k = 1; k < t; ++k) {
+        if (started[k]) pthread_join(th[k], NULL);
+        else            fn(arg, jobs[k].begin, jobs[k].end, k); /* sem thread: roda aqui mesmo */
+    }
+}
+
+/* ---- fila de tarefas: cada thread pega a próxima tarefa livre ----
+   Para tarefas de custo desigual (uma árvore, um fold): quem termina cedo
+   continua puxando trabalho em vez de esperar um bloco fixo. *stop != 0
+   (opcional) impede que novas tarefas comecem. */
+typedef void (*aifd_task_fn)(void *arg, int task, int tid);
+
+typedef struct {
+    aifd_task_fn fn;
+    void *arg;
+    int n, next;
+    volatile int *stop;
+} aifd_task_queue;
+
+static void aifd_task_worker(void *arg, int begin, int end, int tid) {
+    aifd_task_queue *q = (aifd_task_queue*)arg;
+    (void)begin; (void)end;
+    for (;;) {
+        if (q->stop && __atomic_load_n(q->stop, __ATOMIC_ACQUIRE)) break;
+        int t = __atomic_fetch_add(&q->next, 1, __ATOMIC_RELAXED);
+        if (t >= q->n) break;
+        q->fn(q->arg, t, tid);
+    }
+}
+
+/* tid < min(threads, n), como em aifd_parallel_for */
+static void aifd_parallel_tasks(int n, int threads, aifd_task_fn fn, void *arg, volatile int *stop) {
+    if (n <= 0) return;
+    int t = aifd_num_threads(threads);
+    if (t > n) t = n;
+    aifd_task_queue q = { fn, arg, n, 0, stop };
+    aifd_parallel_for(t, t, aifd_task_worker, &q);
+}
+
+/* ---- kernels SIMD com despacho em tempo de execução (AVX2+FMA quando houver) ---- */
+static double aifd_sqdist_scalar(const double *a, const double *b, int d) {
+    double s = 0.0;
+    for (int k = 0; k < d; ++k) { double t = a[k] - b[k]; s += t * t; }
+    return s;
+}
+
+static double aifd_dot_scalar(const double *a, const double *b, int d) {
+    double s = 0.0;
+    for (int k = 0; k < d; ++k) s += a[k] * b[k];
+    return s;
+}
+
+static void aifd_axpy_scalar(double a, const double *x, double *y, int d) {
+    for (int k = 0; k < d; ++k) y[k] += a * x[k];
+}
+
+#ifdef AIFD_X86
+__attribute__((target("avx2,fma")))
+static double aifd_hsum256(__m256d v) {
+    __m128d lo = _mm256_castpd256_pd128(v), hi = _mm256_extractf128_pd(v, 1);
+    lo = _mm_add_pd(lo, hi);
+    return _mm_cvtsd_f64(lo) + _mm_cvtsd_f64(_mm_unpackhi_pd(lo, lo));
+}
+
+__attribute__((target("avx2,fma")))
+static double aifd_sqdist_avx2(const double *a, const double *b, int d) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    int k = 0;
+    for (; k + 8 <= d; k += 8) {
+        __m256d t0 = _mm256_sub_pd(_mm256_loadu_pd(a + k),     _mm256_loadu_pd(b + k));
+        __m256d t1 = _mm256_sub_pd(_mm256_loadu_pd(a + k + 4), _mm256_loadu_pd(b + k + 4));
+        acc0 = _mm256_fmadd_pd(t0, t0, acc0);
+        acc1 = _mm256_fmadd_pd(t1, t1, acc1);
+    }
+    for (; k + 4 <= d; k += 4) {
+        __m256d t0 = _mm256_sub_pd(_mm256_loadu_pd(a + k), _mm256_loadu_pd(b + k));
+        acc0 = _mm256_fmadd_pd(t0, t0, acc0);
+    }
+    double s = aifd_hsum256(_mm256_add_pd(acc0, acc1));
+    for (; k < d; ++k) { double t = a[k] - b[k]; s += t * t; }
+    return s;
+}
+
+__attribute__((target("avx2,fma")))
+static double aifd_dot_avx2(const double *a, const double *b, int d) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    int k = 0;
+    for (; k + 8 <= d; k += 8) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + k),     _mm256_loadu_pd(b + k),     acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + k + 4), _mm256_loadu_pd(b + k + 4), acc1);
+    }
+    for (; k + 4 <= d; k += 4)
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + k), _mm256_loadu_pd(b + k), acc0);
+    double s = aifd_hsum256(_mm256_add_pd(acc0, acc1));
+    for (; k < d; ++k) s += a[k] * b[k];
+    return s;
+}
+
+__attribute__((target("avx2,fma")))
+static void aifd_axpy_avx2(double a, const double *x, double *y, int d) {
+    __m256d va = _mm256_set1_pd(a);
+    int k = 0;
+    for (; k + 8 <= d; k += 8) {
+        _mm256_storeu_pd(y + k,     _mm256_fmadd_pd(va, _mm256_loadu_pd(x + k),     _mm256_loadu_pd(y + k)));
+        _mm256_storeu_pd(y + k + 4, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + k + 4), _mm256_loadu_pd(y + k + 4)));
+    }
+    for (; k + 4 <= d; k += 4)
+        _mm256_storeu_pd(y + k, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + k), _mm256_loadu_pd(y + k)));
+    for (; k < d; ++k) y[k] += a * x[k];
+}
+#endif
+
+static int aifd_has_avx2(void) {
+#ifdef AIFD_X86
+    static int cached = -1;
+    if (cached < 0) {
+        __builtin_cpu_init();
+        cached = (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) ? 1 : 0;
+        const char *env = getenv("AIFD_NO_SIMD");
+        if (env && *env && *env != '0') cached = 0;
+    }
+    return cached;
+#else
+    return 0;
+#endif
+}
+
+static double aifd_sqdist(const double *a, const double *b, int d) {
+#ifdef AIFD_X86
+    if (aifd_has_avx2()) return aifd_sqdist_avx2(a, b, d);
+#endif
+    return aifd_sqdist_scalar(a, b, d);
+}
+
+static double aifd_dot(const double *a, const double *b, int d) {
+#ifdef AIFD_X86
+    if (aifd_has_avx2()) return aifd_dot_avx2(a, b, d);
+#endif
+    return aifd_dot_scalar(a, b, d);
+}
+
+/* y += a * x */
+static void aifd_axpy(double a, const double *x, double *y, int d) {
+#ifdef AIFD_X86
+    if (aifd_has_avx2()) { aifd_axpy_avx2(a, x, y, d); return; }
+#endif
+    aifd_axpy_scalar(a, x, y, d);
+}
+
+/* gerador pseudo-aleatório pequeno e determinístico (xorshift64*) */
+static unsigned long long aifd_rng_next(unsigned long long *s) {
+    unsigned long long x = *s ? *s : 0x9E3779B97F4A7C15ULL;
+    x ^= x >> 12; x ^= x << 25; x ^= x >> 27;
+    *s = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static double aifd_rng_uniform(unsigned long long *s) {
+    return (double)(aifd_rng_next(s) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+AIFD_NATIVE_END
+
+#endif
@@ -0,0 +1,340 @@
+#ifndef NATIVE_PREP_H
+#define NATIVE_PREP_H
+
+/* -------- Pré-processamento (espelho do build_preprocessor do trainer) --------
+   Numéricas: SimpleImputer(mean | median | most_frequent | 0) -> StandardScaler
+   ou MinMaxScaler, com as regras do sklearn: coluna toda ausente some (exceto
+   com zero) e escala ~0 vira 1. As estatísticas saem numa passada só: cada
+   thread resume blocos de linhas (soma, M2, mín, máx) e os resumos são unidos
+   pela fórmula de Chan; a mediana (seleção) e a moda (contagem em hash) rodam
+   uma coluna por thread. A imputação entra nas estatísticas pela mesma fórmula,
+   como se as células ausentes fossem cópias do valor imputado.
+   Texto (códigos de csv.h): SimpleImputer(most_frequent ou "") ->
+   OneHotEncoder(handle_unknown="ignore"), categorias em ordem de string. */
+
+#include "native_common.h"
+#include <float.h>
+
+AIFD_NATIVE_BEGIN
+
+enum { AIFD_IMPUTE_MEAN = 0, AIFD_IMPUTE_MEDIAN = 1, AIFD_IMPUTE_MOST_FREQUENT = 2, AIFD_IMPUTE_ZERO = 3 };
+enum { AIFD_SCALE_NONE = 0, AIFD_SCALE_STANDARD = 1, AIFD_SCALE_MINMAX = 2 };
+
+#define PREP_BLOCK 256          /* linhas por resumo (cabe na cache: 2ª leitura para o M2) */
+
+typedef struct {
+    int d, out_d, scale;
+    int    *out;                /* d: coluna de saída, -1 = descartada (toda ausente) */
+    double *fill;               /* d: valor imputado */
+    double *a, *b;              /* d: standard (x - a) / b; minmax x * a + b */
+} aifd_prep;
+
+static void aifd_prep_free(aifd_prep *P) {
+    free(P->out); free(P->fill); free(P->a); free(P->b);
+    memset(P, 0, sizeof(*P));
+}
+
+/* resumo de uma coluna: contagem, média, M2, mín, máx */
+typedef struct { double n, mean, m2, lo, hi; } prep_moments;
+
+static void prep_merge(prep_moments *A, const prep_moments *B) {
+    if (B->n == 0) return;
+    if (A->n == 0) { *A = *B; return; }
+    double n = A->n + B->n, delta = B->mean - A->mean;
+    A->mean += delta * B->n / n;
+    A->m2   += B->m2 + delta * delta * A->n * B->n / n;
+    A->n = n;
+    if (B->lo < A->lo) A->lo = B->lo;
+    if (B->hi > A->hi) A->hi = B->hi;
+}
+
+typedef struct {
+    const double *X;
+    int n, d, ld, impute;
+    prep_moments *acc;          /* T x d */
+    double *fill;
+    double *buf;                /* T x n (mediana / moda) */
+    int err;
+} prep_job;
+
+static void prep_moments_rows(void *arg, int b, int e, int tid) {
+    prep_job *J = (prep_job*)arg;
+    int d = J->d;
+    prep_moments *acc = J->acc + (size_t)tid * d;
+    double *s = (double*)malloc(sizeof(double) * 5 * (size_t)d);
+    if (!s) { J->err = AIFD_ENOMEM; return; }
+    double *c = s + d, *lo = c + d, *hi = lo + d, *m2 = hi + d;
+    for (int r0 = b; r0 < e; r0 += PREP_BLOCK) {
+        int r1 = r0 + PREP_BLOCK < e ? r0 + PREP_BLOCK : e;
+        for (int j = 0; j < d; ++j) { s[j] = 0.0; c[j] = 0.0; m2[j] = 0.0; lo[j] = INFINITY; hi[j] = -INFINITY; }
+        for (int i = r0; i < r1; ++i) {
+            const double *x = J->X + (size_t)i * J->ld;
+            for (int j = 0; j < d; ++j) {
+                double v = x[j];
+                if (v != v) continue;
+                s[j] += v; c[j] += 1.0;
+                if (v < lo[j]) lo[j] = v;
+                if (v > hi[j]) hi[j] = v;
+            }
+        }
+        for (int j = 0; j < d; ++j) s[j] = c[j] > 0 ? s[j] / c[j] : 0.0;   /* média do bloco */
+        for (int i = r0; i < r1; ++i) {
+            const double *x = J->X + (size_t)i * J->ld;
+            for (int j = 0; j < d; ++j) { double t = x[j] - s[j]; if (t == t) m2[j] += t * t; }
+        }
+        for (int j = 0; j < d; ++j) {
+            prep_moments B = { c[j], s[j], m2[j], lo[j], hi[j] };
+            prep_merge(&acc[j], &B);
+        }
+    }
+    free(s);
+}
+
+static int prep_cmp_double(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* k-ésimo menor de v[0..n) (reordena v) */
+static double prep_select(double *v, int n, int k) {
+    int lo = 0, hi = n - 1;
+    while (hi - lo > 16) {
+        double a = v[lo], b = v[(lo + hi) / 2], c = v[hi];
+        double piv = a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b));
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (v[i] < piv) ++i;
+            while (v[j] > piv) --j;
+            if (i <= j) { double t = v[i]; v[i] = v[j]; v[j] = t; ++i; --j; }
+        }
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else return v[k];
+    }
+    qsort(v + lo, (size_t)(hi - lo + 1), sizeof(double), prep_cmp_double);
+    return v[k];
+}
+
+/* valor mais frequente (empate: o menor), contando num hash aberto */
+static double prep_mode(const double *v, int n, int *err) {
+    unsigned int size = 64;
+    while (size < (unsigned int)n * 2u) size <<= 1;
+    double *key = (double*)malloc(sizeof(double) * size);
+    int *cnt = (int*)calloc(size, sizeof(int));
+    if (!key || !cnt) { free(key); free(cnt); *err = AIFD_ENOMEM; return 0.0; }
+    double best = 0.0; int best_n = 0;
+    for (int i = 0; i < n; ++i) {
+        double x = v[i] == 0.0 ? 0.0 : v[i];          /* -0.0 e 0.0 contam juntos */
+        unsigned long long bits;
+        memcpy(&bits, &x, sizeof(bits));
+        bits ^= bits >> 33; bits *= 0xff51afd7ed558ccdULL; bits ^= bits >> 33;
+        unsigned int h = (unsigned int)bits & (size - 1);
+        while (cnt[h] && key[h] != x) h = (h + 1) & (size - 1);
+        key[h] = x;
+        int c = ++cnt[h];
+        if (c > best_n || (c == best_n && x < best)) { best = x; best_n = c; }
+    }
+    free(key); free(cnt);
+    return best;
+}
+
+static void prep_fill_column(void *arg, int j, int tid) {
+    prep_job *J = (prep_job*)arg;
+    double *v = J->buf + (size_t)tid * J->n;
+    int m = 0;
+    for (int i = 0; i < J->n; ++i) { double x = J->X[(size_t)i * J->ld + j]; if (x == x) v[m++] = x; }
+    if (m == 0) return;
+    if (J->impute == AIFD_IMPUTE_MEDIAN) {
+        double hi = prep_select(v, m, m / 2);
+        if (m % 2) { J->fill[j] = hi; return; }
+        double lo = v[0];                              /* maior da metade de baixo */
+        for (int i = 1; i < m / 2; ++i) if (v[i] > lo) lo = v[i];
+        J->fill[j] = (lo + hi) * 0.5;
+    } else {
+        J->fill[j] = prep_mode(v, m, &J->err);
+    }
+}
+
+/* sklearn _is_constant_feature: variância dentro do erro de arredondamento */
+static int prep_constant(double var, double mean, double n) {
+    double eps = DBL_EPSILON;
+    return var <= n * eps * var + (n * mean * eps) * (n * mean * eps);
+}
+
+/* X: n x d com passo ld (NaN = ausente) */
+static int aifd_prep_fit(const double *X, int n, int d, int ld, int impute, int scale, int threads, aifd_prep *P) {
+    memset(P, 0, sizeof(*P));
+    if (n <= 0 || d <= 0 || ld < d) return AIFD_EINVAL;
+    P->d = d; P->scale = scale;
+    P->out = (int*)malloc(sizeof(int) * d);
+    P->fill = (double*)calloc((size_t)d, sizeof(double));
+    P->a = (double*)malloc(sizeof(double) * d);
+    P->b = (double*)malloc(sizeof(double) * d);
+    int T = aifd_num_threads(threads);
+    if (T > n) T = n;
+    prep_job J = { X, n, d, ld, impute, NULL, P->fill, NULL, AIFD_OK };
+    J.acc = (prep_moments*)calloc((size_t)T * d, sizeof(prep_moments));
+    if (!P->out || !P->fill || !P->a || !P->b || !J.acc) { free(J.acc); aifd_prep_free(P); return AIFD_ENOMEM; }
+
+    aifd_parallel_for(n, T, prep_moments_rows, &J);
+    for (int t = 1; t < T; ++t)
+        for (int j = 0; j < d; ++j) prep_merge(&J.acc[j], &J.acc[(size_t)t * d + j]);
+
+    if (J.err == AIFD_OK && (impute == AIFD_IMPUTE_MEDIAN || impute == AIFD_IMPUTE_MOST_FREQUENT)) {
+        int Tc = T < d ? T : d;
+        J.buf = (double*)malloc(sizeof(double) * (size_t)Tc * n);
+        if (!J.buf) J.err = AIFD_ENOMEM;
+        else aifd_parallel_tasks(d, Tc, prep_fill_column, &J, NULL);
+        free(J.buf);
+    }
+    if (J.err != AIFD_OK) { free(J.acc); aifd_prep_free(P); return J.err; }
+
+    for (int j = 0; j < d; ++j) {
+        prep_moments M = J.acc[j];
+        if (M.n == 0 && impute != AIFD_IMPUTE_ZERO) { P->out[j] = -1; continue; }
+        P->out[j] = P->out_d++;
+        if (impute == AIFD_IMPUTE_MEAN) P->fill[j] = M.mean;
+        else if (impute == AIFD_IMPUTE_ZERO) P->fill[j] = 0.0;
+        double miss = (double)n - M.n;
+        if (miss > 0) {                                 /* ausentes = cópias do valor imputado */
+            prep_moments F = { miss, P->fill[j], 0.0, P->fill[j], P->fill[j] };
+            prep_merge(&M, &F);
+        }
+        if (scale == AIFD_SCALE_STANDARD) {
+            double var = M.m2 / M.n;
+            P->a[j] = M.mean;
+            P->b[j] = prep_constant(var, M.mean, M.n) ? 1.0 : sqrt(var);
+        } else if (scale == AIFD_SCALE_MINMAX) {
+            double range = M.hi - M.lo;
+            P->a[j] = 1.0 / (range < 10.0 * DBL_EPSILON ? 1.0 : range);
+            P->b[j] = -M.lo * P->a[j];
+        } else {
+            P->a[j] = 0.0; P->b[j] = 1.0;
+        }
+    }
+    free(J.acc);
+    return AIFD_OK;
+}
+
+typedef struct {
+    const aifd_prep *P;
+    const double *X;
+    int ld, ldo, f32;
+    void *Y;
+} prep_apply_job;
+
+static void prep_apply_rows(void *arg, int b, int e, int tid) {
+    prep_apply_job *J = (prep_apply_job*)arg;
+    const aifd_prep *P = J->P;
+    (void)tid;
+    for (int i = b; i < e; ++i) {
+        const double *x = J->X + (size_t)i * J->ld;
+        double *yd = J->f32 ? NULL : (double*)J->Y + (size_t)i * J->ldo;
+        float  *yf = J->f32 ? (float*)J->Y + (size_t)i * J->ldo : NULL;
+        for (int j = 0; j < P->d; ++j) {
+            int o = P->out[j];
+            if (o < 0) continue;
+            double v = x[j] == x[j] ? x[j] : P->fill[j];
+            if (P->scale == AIFD_SCALE_STANDARD)    v = (v - P->a[j]) / P->b[j];
+            else if (P->scale == AIFD_SCALE_MINMAX) v = v * P->a[j] + P->b[j];
+            if (yf) yf[o] = (float)v; else yd[o] = v;
+        }
+    }
+}
+
+/* Y: n linhas com passo ldo (double, ou float com f32); escreve as out_d primeiras colunas */
+static void aifd_prep_transform(const aifd_prep *P, const double *X, int n, int ld, void *Y, int ldo, int f32,
+                                int threads) {
+    prep_apply_job J = { P, X, ld, ldo, f32, Y };
+    aifd_parallel_for(n, threads, prep_apply_rows, &J);
+}
+
+/* ---- one-hot de uma coluna de texto ---- */
+typedef struct {
+    int n_levels, width;
+    int *slot;                  /* n_levels + 1: coluna de cada nível (-1 = não visto); [n_levels] = ausente */
+    int *order;                 /* width: nível de cada coluna (-1 = a categoria "" do imputador zero) */
+} aifd_onehot;
+
+static void aifd_onehot_free(aifd_onehot *H) {
+    free(H->slot); free(H->order);
+    memset(H, 0, sizeof(*H));
+}
+
+typedef struct { const char *s; int id; } prep_level;
+
+static int prep_level_cmp(const void *a, const void *b) {
+    return strcmp(((const prep_level*)a)->s, ((const prep_level*)b)->s);
+}
+
+/* codes: n códigos (-1 = ausente); levels: n_levels strings terminadas em '\0' (como em csv.h) */
+static int aifd_onehot_fit(const int *codes, int n, const char *levels, int n_levels, int impute, aifd_onehot *H) {
+    memset(H, 0, sizeof(*H));
+    H->n_levels = n_levels;
+    int *cnt = (int*)calloc((size_t)n_levels + 1, sizeof(int));
+    prep_level *L = (prep_level*)malloc(sizeof(prep_level) * ((size_t)n_levels + 1));
+    H->slot = (int*)malloc(sizeof(int) * ((size_t)n_levels + 1));
+    H->order = (int*)malloc(sizeof(int) * ((size_t)n_levels + 1));
+    if (!cnt || !L || !H->slot || !H->order) { free(cnt); free(L); aifd_onehot_free(H); return AIFD_ENOMEM; }
+    int miss = 0;
+    for (int i = 0; i < n; ++i) {
+        int c = codes[i];
+        if (c < 0 || c >= n_levels) miss++;
+        else cnt[c]++;
+    }
+    int m = 0;
+    const char *s = levels;
+    for (int l = 0; l < n_levels; ++l, s += strlen(s) + 1)
+        if (cnt[l]) { L[m].s = s; L[m].id = l; m++; }
+    if (impute == AIFD_IMPUTE_ZERO && miss) { L[m].s = ""; L[m].id = -1; m++; }
+    qsort(L, (size_t)m, sizeof(prep_level), prep_level_cmp);
+    for (int l = 0; l <= n_levels; ++l) H->slot[l] = -1;
+    for (int k = 0; k < m; ++k) {
+        H->order[k] = L[k].id;
+        if (L[k].id >= 0) H->slot[L[k].id] = k;
+        else H->slot[n_levels] = k;
+    }
+    H->width = m;
+    if (impute != AIFD_IMPUTE_ZERO) {
+        /* mais frequente; empate: a menor string (L já está em ordem) */
+        int best = -1;
+        for (int k = 0; k < m; ++k) if (best < 0 || cnt[L[k].id] > cnt[L[best].id]) best = k;
+        H->slot[n_levels] = best;
+    }
+    free(cnt); free(L);
+    return AIFD_OK;
+}
+
+typedef struct {
+    const int *slot, *codes;
+    int n_levels, width, ldo, f32;
+    void *Y;
+} onehot_job;
+
+static void onehot_rows(void *arg, int b, int e, int tid) {
+    onehot_job *J = (onehot_job*)arg;
+    (void)tid;
+    for (int i = b; i < e; ++i) {
+        int c = J->codes[i];
+        int k = c < 0 ? J->slot[J->n_levels] : (c < J->n_levels ? J->slot[c] : -1);   /* desconhecido: tudo 0 */
+        if (J->f32) {
+            float *y = (float*)J->Y + (size_t)i * J->ldo;
+            for (int t = 0; t < J->width; ++t) y[t] = 0.0f;
+            if (k >= 0) y[k] = 1.0f;
+        } else {
+            double *y = (double*)J->Y + (size_t)i * J->ldo;
+            for (int t = 0; t < J->width; ++t) y[t] = 0.0;
+            if (k >= 0) y[k] = 1.0;
+        }
+    }
+}
+
+/* escreve width colunas a partir de Y (passo ldo); códigos >= n_levels = categoria desconhecida */
+static void aifd_onehot_transform(const aifd_onehot *H, const int *codes, int n, void *Y, int ldo, int f32,
+                                  int threads) {
+    onehot_job J = { H->slot, codes, H->n_levels, H->width, ldo, f32, Y };
+    aifd_parallel_for(n, threads, onehot_rows, &J);
+}
+
+AIFD_NATIVE_END
+#endif
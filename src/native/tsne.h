@@ -0,0 +1,688 @@
+#ifndef NATIVE_TSNE_H
+#define NATIVE_TSNE_H
+
+/* -------- Projeções 2D nativas: PCA exata (top-2) e t-SNE Barnes-Hut --------
+   t-SNE segue o esquema do sklearn/bhtsne: kNN (3*perplexity) por VP-tree,
+   busca binária de sigma por ponto, P simétrica esparsa, exageração inicial,
+   momento + ganhos, e forças repulsivas aproximadas por quadtree (theta).
+   kNN, perplexidade e gradiente rodam em paralelo (aifd_parallel_for). */
+
+#include "native_common.h"
+
+AIFD_NATIVE_BEGIN
+
+/* ======================= PCA (iteração de subespaço) ======================= */
+
+typedef struct {
+    const double *X; int n, d;
+    const double *mean;
+    const double *V;     /* d x 2 (coluna-major: V[k], V[d+k]) */
+    double *W_parts;     /* threads x (d x 2) */
+} pca_job;
+
+/* W += Xc^T (Xc V) para o bloco de linhas [b,e) */
+static void pca_apply_rows(void *arg, int b, int e, int tid) {
+    pca_job *j = (pca_job*)arg;
+    int d = j->d;
+    double *W = j->W_parts + (size_t)tid * 2 * d;
+    memset(W, 0, sizeof(double) * 2 * d);
+    double *xc = (double*)malloc(sizeof(double) * d);
+    if (!xc) return;
+    for (int i = b; i < e; ++i) {
+        const double *x = j->X + (size_t)i * d;
+        for (int k = 0; k < d; ++k) xc[k] = x[k] - j->mean[k];
+        double t0 = aifd_dot(xc, j->V, d), t1 = aifd_dot(xc, j->V + d, d);
+        for (int k = 0; k < d; ++k) { W[k] += xc[k] * t0; W[d + k] += xc[k] * t1; }
+    }
+    free(xc);
+}
+
+static void pca_scores_rows(void *arg, int b, int e, int tid) {
+    (void)tid;
+    pca_job *j = (pca_job*)arg;
+    int d = j->d;
+    double *Z = j->W_parts; /* reaproveitado como saída n x 2 */
+    double *xc = (double*)malloc(sizeof(double) * d);
+    if (!xc) return;
+    for (int i = b; i < e; ++i) {
+        const double *x = j->X + (size_t)i * d;
+        for (int k = 0; k < d; ++k) xc[k] = x[k] - j->mean[k];
+        Z[2 * i]     = aifd_dot(xc, j->V, d);
+        Z[2 * i + 1] = aifd_dot(xc, j->V + d, d);
+    }
+    free(xc);
+}
+
+/* Gram-Schmidt das 2 colunas de V (d x 2); devolve 0 se degenerar */
+static int pca_orthonormalize(double *V, int d) {
+    double n0 = sqrt(aifd_dot(V, V, d));
+    if (n0 < 1e-300) return 0;
+    for (int k = 0; k < d; ++k) V[k] /= n0;
+    double p = aifd_dot(V, V + d, d);
+    for (int k = 0; k < d; ++k) V[d + k] -= p * V[k];
+    double n1 = sqrt(aifd_dot(V + d, V + d, d));
+    if (n1 < 1e-300) return 0;
+    for (int k = 0; k < d; ++k) V[d + k] /= n1;
+    return 1;
+}
+
+/* Z (n x 2, linha-major) = scores das 2 componentes principais de X (n x d) */
+static int aifd_pca2(const double *X, int n, int d, double *Z, int threads) {
+    if (!X || !Z || n <= 0 || d <= 0) return AIFD_EINVAL;
+    int T = aifd_num_threads(threads);
+    double *mean = (double*)calloc((size_t)d, sizeof(double));
+    double *V    = (double*)malloc(sizeof(double) * 2 * d);
+    double *W    = (double*)malloc(sizeof(double) * 2 * d * (size_t)T);
+    if (!mean || !V || !W) { free(mean); free(V); free(W); return AIFD_ENOMEM; }
+
+    for (int i = 0; i < n; ++i) {
+        const double *x = X + (size_t)i * d;
+        for (int k = 0; k < d; ++k) mean[k] += x[k];
+    }
+    for (int k = 0; k < d; ++k) mean[k] /= (double)n;
+
+    if (d == 1) {
+        for (int i = 0; i < n; ++i) { Z[2 * i] = X[i] - mean[0]; Z[2 * i + 1] = 0.0; }
+        free(mean); free(V); free(W);
+        return AIFD_OK;
+    }
+
+    unsigned long long rng = 0x5EEDULL + (unsigned long long)d;
+    for (int k = 0; k < 2 * d; ++k) V[k] = aifd_rng_uniform(&rng) - 0.5;
+    pca_orthonormalize(V, d);
+
+    pca_job job = { X, n, d, mean, V, W };
+    double prev0 = 0.0, prev1 = 0.0;
+    for (int it = 0; it < 500; ++it) {
+        aifd_parallel_for(n, T, pca_apply_rows, &job);
+        for (int t = 1; t < T && t < n; ++t)
+            for (int k = 0; k < 2 * d; ++k) W[k] += W[(size_t)t * 2 * d + k];
+
+        /* Rayleigh-Ritz 2x2: H = V^T C V; roda V para os autovetores de H */
+        double h00 = aifd_dot(V, W, d), h01 = aifd_dot(V, W + d, d), h11 = aifd_dot(V + d, W + d, d);
+        double tr = h00 + h11, df = h00 - h11;
+        double disc = sqrt(df * df + 4.0 * h01 * h01);
+        double l0 = 0.5 * (tr + disc), l1 = 0.5 * (tr - disc);
+
+        memcpy(V, W, sizeof(double) * 2 * d);
+        if (!pca_orthonormalize(V, d)) break;
+        if (it > 2 && fabs(l0 - prev0) <= 1e-12 * fabs(l0) && fabs(l1 - prev1) <= 1e-10 * fabs(l0)) {
+            /* convergiu: alinha as colunas com os autovetores exatos de H */
+            double ang = 0.5 * atan2(2.0 * h01, df);
+            double c = cos(ang), s = sin(ang);
+            for (int k = 0; k < d; ++k) {
+                double a = V[k], bb = V[d + k];
+                V[k] = c * a + s * bb; V[d + k] = -s * a + c * bb;
+            }
+            break;
+        }
+        prev0 = l0; prev1 = l1;
+    }
+
+    /* sinal determinístico: maior componente de cada eixo positiva */
+    for (int c = 0; c < 2; ++c) {
+        int arg = 0;
+        for (int k = 1; k < d; ++k) if (fabs(V[c * d + k]) > fabs(V[c * d + arg])) arg = k;
+        if (V[c * d + arg] < 0) for (int k = 0; k < d; ++k) V[c * d + k] = -V[c * d + k];
+    }
+
+    pca_job sj = { X, n, d, mean, V, Z };
+    aifd_parallel_for(n, T, pca_scores_rows, &sj);
+    free(mean); free(V); free(W);
+    return AIFD_OK;
+}
+
+/* ============================ t-SNE (Barnes-Hut) ============================ */
+
+typedef struct {
+    double perplexity;    /* 30 */
+    double theta;         /* 0.5 (0 = exato, muito lento) */
+    double exaggeration;  /* 12 */
+    double learning_rate; /* <= 0 -> "auto" (n / exag / 4, mín. 50) */
+    int    max_iter;      /* 1000 */
+    int    exag_iter;     /* 250 */
+    int    threads;       /* <= 0 -> todos os núcleos */
+    unsigned long long seed;
+} aifd_tsne_opts;
+
+static void aifd_tsne_defaults(aifd_tsne_opts *o) {
+    o->perplexity = 30.0; o->theta = 0.5; o->exaggeration = 12.0; o->learning_rate = -1.0;
+    o->max_iter = 1000; o->exag_iter = 250; o->threads = 0; o->seed = 42;
+}
+
+/* ---- VP-tree para os k vizinhos mais próximos ---- */
+typedef struct { int idx; double thr; int left, right; } tsne_vp_node;
+
+typedef struct {
+    const double *X; int d;
+    tsne_vp_node *nodes; int count;
+    int *items; double *dist;
+    unsigned long long rng;
+} tsne_vptree;
+
+static void vp_swap(tsne_vptree *t, int a, int b) {
+    int ti = t->items[a]; t->items[a] = t->items[b]; t->items[b] = ti;
+    double td = t->dist[a]; t->dist[a] = t->dist[b]; t->dist[b] = td;
+}
+
+/* quickselect em [lo,hi) por dist; posiciona o k-ésimo (partição em 3 vias:
+   linhas duplicadas geram muitas distâncias iguais) */
+static void vp_select(tsne_vptree *t, int lo, int hi, int k) {
+    while (hi - lo > 1) {
+        int p = lo + (int)(aifd_rng_next(&t->rng) % (unsigned long long)(hi - lo));
+        double pv = t->dist[p];
+        int lt = lo, i = lo, gt = hi;
+        while (i < gt) {
+            if      (t->dist[i] < pv) vp_swap(t, lt++, i++);
+            else if (t->dist[i] > pv) vp_swap(t, i, --gt);
+            else ++i;
+        }
+        if (k < lt) hi = lt;
+        else if (k >= gt) lo = gt;
+        else return;
+    }
+}
+
+static int vp_build(tsne_vptree *t, int lo, int hi) {
+    if (lo >= hi) return -1;
+    int node = t->count++;
+    int r = lo + (int)(aifd_rng_next(&t->rng) % (unsigned long long)(hi - lo));
+    vp_swap(t, lo, r);
+    t->nodes[node].idx = t->items[lo];
+    t->nodes[node].left = t->nodes[node].right = -1;
+    t->nodes[node].thr = 0.0;
+    if (hi - lo == 1) return node;
+
+    const double *vp = t->X + (size_t)t->items[lo] * t->d;
+    for (int i = lo + 1; i < hi; ++i)
+        t->dist[i] = sqrt(aifd_sqdist(vp, t->X + (size_t)t->items[i] * t->d, t->d));
+    int mid = (lo + 1 + hi) / 2;
+    vp_select(t, lo + 1, hi, mid);
+    t->nodes[node].thr = t->dist[mid];
+    int left  = vp_build(t, lo + 1, mid);
+    int right = vp_build(t, mid, hi);
+    t->nodes[node].left = left; t->nodes[node].right = right;
+    return node;
+}
+
+/* max-heap de tamanho k (distância, índice) */
+typedef struct { double *d; int *i; int size, k; } tsne_heap;
+
+static void heap_push(tsne_heap *h, double dist, int idx) {
+    if (h->size < h->k) {
+        int c = h->size++;
+        while (c > 0) {
+            int p = (c - 1) / 2;
+            if (h->d[p] >= dist) break;
+            h->d[c] = h->d[p]; h->i[c] = h->i[p]; c = p;
+        }
+        h->d[c] = dist; h->i[c] = idx;
+    } else if (dist < h->d[0]) {
+        int c = 0;
+        for (;;) {
+            int l = 2 * c + 1, r = l + 1, m = c;
+            double md = dist;
+            if (l < h->size && h->d[l] > md) { m = l; md = h->d[l]; }
+            if (r < h->size && h->d[r] > md) { m = r; }
+            if (m == c) break;
+            h->d[c] = h->d[m]; h->i[c] = h->i[m]; c = m;
+        }
+        h->d[c] = dist; h->i[c] = idx;
+    }
+}
+
+static void vp_search(const tsne_vptree *t, int node, const double *q, int self, tsne_heap *h) {
+    while (node >= 0) {
+        const tsne_vp_node *nd = &t->nodes[node];
+        double dist = sqrt(aifd_sqdist(q, t->X + (size_t)nd->idx * t->d, t->d));
+        if (nd->idx != self) heap_push(h, dist, nd->idx);
+        double tau = (h->size < h->k) ? INFINITY : h->d[0];
+        if (nd->left < 0 && nd->right < 0) return;
+        /* desce primeiro no lado provável; o outro só se a bola de raio tau cruzar o limiar */
+        if (dist < nd->thr) {
+            if (dist + tau >= nd->thr) vp_search(t, nd->right, q, self, h);
+            node = nd->left;
+        } else {
+            if (dist - tau <= nd->thr) vp_search(t, nd->left, q, self, h);
+            node = nd->right;
+        }
+    }
+}
+
+/* ---- estado compartilhado pelas etapas paralelas ---- */
+typedef struct {
+    int n, d, k;
+    const double *X;
+    const tsne_vptree *vp;
+    int    *nn_idx;   /* n x k */
+    double *nn_d2;    /* n x k (distâncias ao quadrado) */
+    float  *nn_p;     /* n x k: p(j|i) */
+    double perplexity;
+} tsne_knn_job;
+
+static void tsne_knn_rows(void *arg, int b, int e, int tid) {
+    (void)tid;
+    tsne_knn_job *j = (tsne_knn_job*)arg;
+    int k = j->k;
+    double *hd = (double*)malloc(sizeof(double) * k);
+    int    *hi = (int*)malloc(sizeof(int) * k);
+    if (!hd || !hi) { free(hd); free(hi); return; }
+    for (int i = b; i < e; ++i) {
+        tsne_heap h = { hd, hi, 0, k };
+        vp_search(j->vp, 0, j->X + (size_t)i * j->d, i, &h);
+        for (int c = 0; c < k; ++c) {
+            int ok = c < h.size;
+            j->nn_idx[(size_t)i * k + c] = ok ? hi[c] : i;
+            j->nn_d2 [(size_t)i * k + c] = ok ? hd[c] * hd[c] : INFINITY;
+        }
+    }
+    free(hd); free(hi);
+}
+
+/* kNN exato por blocos (||a||² + ||b||² - 2a·b): blocos de consultas x blocos de
+   candidatos cabem no cache; em dimensão alta isso bate a VP-tree com folga */
+#define TSNE_BRUTE_QB 32
+#define TSNE_BRUTE_CB 256
+
+static void tsne_knn_brute_rows(void *arg, int b, int e, int tid) {
+    (void)tid;
+    tsne_knn_job *j = (tsne_knn_job*)arg;
+    int k = j->k, d = j->d, n = j->n;
+    const double *nrm = j->nn_d2 + (size_t)n * k; /* normas ao quadrado, após a saída */
+    double *hd = (double*)malloc(sizeof(double) * k * TSNE_BRUTE_QB);
+    int    *hi = (int*)malloc(sizeof(int) * k * TSNE_BRUTE_QB);
+    if (!hd || !hi) { free(hd); free(hi); return; }
+    tsne_heap h[TSNE_BRUTE_QB];
+    for (int qb = b; qb < e; qb += TSNE_BRUTE_QB) {
+        int qe = qb + TSNE_BRUTE_QB < e ? qb + TSNE_BRUTE_QB : e;
+        for (int q = 0; q < qe - qb; ++q) { h[q].d = hd + q * k; h[q].i = hi + q * k; h[q].size = 0; h[q].k = k; }
+        for (int cb = 0; cb < n; cb += TSNE_BRUTE_CB) {
+            int ce = cb + TSNE_BRUTE_CB < n ? cb + TSNE_BRUTE_CB : n;
+            for (int i = qb; i < qe; ++i) {
+                const double *xi = j->X + (size_t)i * d;
+                tsne_heap *hh = &h[i - qb];
+                for (int c = cb; c < ce; ++c) {
+                    if (c == i) continue;
+                    double d2 = nrm[i] + nrm[c] - 2.0 * aifd_dot(xi, j->X + (size_t)c * d, d);
+                    if (d2 < 0.0) d2 = 0.0;
+                    if (hh->size < k || d2 < hh->d[0]) heap_push(hh, d2, c);
+                }
+            }
+        }
+        for (int i = qb; i < qe; ++i)
+            for (int c = 0; c < k; ++c) {
+                int ok = c < h[i - qb].size;
+                j->nn_idx[(size_t)i * k + c] = ok ? h[i - qb].i[c] : i;
+                j->nn_d2 [(size_t)i * k + c] = ok ? h[i - qb].d[c] : INFINITY;
+            }
+    }
+    free(hd); free(hi);
+}
+
+/* busca binária de beta = 1/(2 sigma^2) para atingir log(perplexity) */
+static void tsne_perplexity_rows(void *arg, int b, int e, int tid) {
+    (void)tid;
+    tsne_knn_job *j = (tsne_knn_job*)arg;
+    int k = j->k;
+    double target = log(j->perplexity);
+    double *P = (double*)malloc(sizeof(double) * k);
+    if (!P) return;
+    for (int i = b; i < e; ++i) {
+        const double *d2 = j->nn_d2 + (size_t)i * k;
+        double dmin = INFINITY;
+        for (int c = 0; c < k; ++c) if (d2[c] < dmin) dmin = d2[c];
+        if (!isfinite(dmin)) dmin = 0.0;
+
+        double beta = 1.0, lo = -INFINITY, hi = INFINITY, sum = 0.0;
+        for (int it = 0; it < 100; ++it) {
+            double sdp = 0.0; sum = 0.0;
+            for (int c = 0; c < k; ++c) {
+                double dd = isfinite(d2[c]) ? d2[c] - dmin : INFINITY; /* deslocar não muda P normalizado */
+                P[c] = isfinite(dd) ? exp(-dd * beta) : 0.0;
+                sum += P[c]; if (P[c] > 0.0) sdp += dd * P[c];
+            }
+            if (sum <= 0.0) sum = 1e-300;
+            double H = log(sum) + beta * sdp / sum;
+            double diff = H - target;
+            if (fabs(diff) < 1e-5) break;
+            if (diff > 0) { lo = beta; beta = isfinite(hi) ? 0.5 * (beta + hi) : beta * 2.0; }
+            else          { hi = beta; beta = isfinite(lo) ? 0.5 * (beta + lo) : beta * 0.5; }
+        }
+        for (int c = 0; c < k; ++c) j->nn_p[(size_t)i * k + c] = (float)(P[c] / sum);
+    }
+    free(P);
+}
+
+/* ordena a linha de vizinhos por índice (para busca binária na simetrização) */
+static void tsne_sort_row(int *idx, float *p, int k) {
+    for (int a = 1; a < k; ++a) {
+        int ki = idx[a]; float kp = p[a]; int c = a - 1;
+        while (c >= 0 && idx[c] > ki) { idx[c + 1] = idx[c]; p[c + 1] = p[c]; --c; }
+        idx[c + 1] = ki; p[c + 1] = kp;
+    }
+}
+
+static void tsne_sort_rows(void *arg, int b, int e, int tid) {
+    (void)tid;
+    tsne_knn_job *j = (tsne_knn_job*)arg;
+    for (int i = b; i < e; ++i) tsne_sort_row(j->nn_idx + (size_t)i * j->k, j->nn_p + (size_t)i * j->k, j->k);
+}
+
+/* p(i|j) se i está entre os vizinhos de j, senão -1 */
+static float tsne_lookup(const int *idx, const float *p, int k, int target) {
+    int lo = 0, hi = k - 1;
+    while (lo <= hi) {
+        int m = (lo + hi) / 2;
+        if (idx[m] == target) return p[m];
+        if (idx[m] < target) lo = m + 1; else hi = m - 1;
+    }
+    return -1.0f;
+}
+
+/* ---- quadtree sobre Y (n x 2) ---- */
+typedef struct {
+    double cx, cy, hw;   /* centro e meia-largura */
+    double mx, my;       /* centro de massa */
+    int cnt, child;      /* child: índice do 1º de 4 filhos contíguos, -1 = folha */
+    int start, end;      /* faixa em perm[] */
+} tsne_qnode;
+
+typedef struct {
+    tsne_qnode *nodes; int count, cap;
+    int *perm, *tmp;
+    const double *Y;
+} tsne_qtree;
+
+static int qt_reserve(tsne_qtree *t, int extra) {
+    if (t->count + extra <= t->cap) return 1;
+    int cap = t->cap ? t->cap * 2 : 1024;
+    while (cap < t->count + extra) cap *= 2;
+    tsne_qnode *nn = (tsne_qnode*)realloc(t->nodes, sizeof(tsne_qnode) * cap);
+    if (!nn) return 0;
+    t->nodes = nn; t->cap = cap;
+    return 1;
+}
+
+static int qt_build(tsne_qtree *t, int node, int depth) {
+    tsne_qnode *nd = &t->nodes[node];
+    int s = nd->start, e = nd->end;
+    double mx = 0.0, my = 0.0;
+    for (int p = s; p < e; ++p) { mx += t->Y[2 * t->perm[p]]; my += t->Y[2 * t->perm[p] + 1]; }
+    nd->cnt = e - s;
+    nd->mx = nd->cnt ? mx / nd->cnt : nd->cx;
+    nd->my = nd->cnt ? my / nd->cnt : nd->cy;
+    nd->child = -1;
+    if (nd->cnt <= 1 || depth >= 48 || nd->hw < 1e-12) return 1;
+
+    /* particiona perm[s,e) nos 4 quadrantes (estável, via tmp) */
+    int cnt[4] = {0, 0, 0, 0};
+    double cx = nd->cx, cy = nd->cy, hw = nd->hw;
+    for (int p = s; p < e; ++p) {
+        const double *y = t->Y + 2 * t->perm[p];
+        cnt[(y[0] >= cx) + 2 * (y[1] >= cy)]++;
+    }
+    int off[4] = { s, s + cnt[0], s + cnt[0] + cnt[1], s + cnt[0] + cnt[1] + cnt[2] };
+    int pos[4] = { off[0], off[1], off[2], off[3] };
+    for (int p = s; p < e; ++p) {
+        const double *y = t->Y + 2 * t->perm[p];
+        t->tmp[pos[(y[0] >= cx) + 2 * (y[1] >= cy)]++] = t->perm[p];
+    }
+    memcpy(t->perm + s, t->tmp + s, sizeof(int) * (size_t)(e - s));
+
+    if (!qt_reserve(t, 4)) return 0;
+    int c0 = t->count; t->count += 4;
+    t->nodes[node].child = c0;
+    for (int q = 0; q < 4; ++q) {
+        tsne_qnode *c = &t->nodes[c0 + q];
+        c->hw = 0.5 * hw;
+        c->cx = cx + ((q & 1) ? 0.5 : -0.5) * hw;
+        c->cy = cy + ((q & 2) ? 0.5 : -0.5) * hw;
+        c->start = off[q]; c->end = off[q] + cnt[q];
+        if (cnt[q] > 0) { if (!qt_build(t, c0 + q, depth + 1)) return 0; }
+        else { c->cnt = 0; c->child = -1; c->mx = c->cx; c->my = c->cy; }
+    }
+    return 1;
+}
+
+static int qt_rebuild(tsne_qtree *t, const double *Y, int n) {
+    t->Y = Y; t->count = 0;
+    double x0 = INFINITY, x1 = -INFINITY, y0 = INFINITY, y1 = -INFINITY;
+    for (int i = 0; i < n; ++i) {
+        double a = Y[2 * i], b = Y[2 * i + 1];
+        x0 = fmin(x0, a); x1 = fmax(x1, a);
+        y0 = fmin(y0, b); y1 = fmax(y1, b);
+        t->perm[i] = i;
+    }
+    if (!qt_reserve(t, 1)) return 0;
+    tsne_qnode *r = &t->nodes[t->count++];
+    r->cx = 0.5 * (x0 + x1); r->cy = 0.5 * (y0 + y1);
+    r->hw = 0.5 * fmax(x1 - x0, y1 - y0) + 1e-5;
+    r->start = 0; r->end = n;
+    return qt_build(t, 0, 0);
+}
+
+typedef struct {
+    int n, threads;
+    const int *row_ptr, *col; const float *val;  /* P simétrica (CSR) */
+    const double *Y;
+    const tsne_qtree *qt;
+    double theta2, exag;
+    double *pos, *neg;       /* n x 2 */
+    double *sumq_part;       /* por thread */
+} tsne_grad_job;
+
+static void tsne_grad_rows(void *arg, int b, int e, int tid) {
+    tsne_grad_job *j = (tsne_grad_job*)arg;
+    const tsne_qnode *nodes = j->qt->nodes;
+    const int *perm = j->qt->perm;
+    int stack[256];
+    double sumq = 0.0;
+    for (int i = b; i < e; ++i) {
+        double yx = j->Y[2 * i], yy = j->Y[2 * i + 1];
+
+        /* atração: termos esparsos de P */
+        double px = 0.0, py = 0.0;
+        for (int p = j->row_ptr[i]; p < j->row_ptr[i + 1]; ++p) {
+            int c = j->col[p];
+            double dx = yx - j->Y[2 * c], dy = yy - j->Y[2 * c + 1];
+            double q = 1.0 / (1.0 + dx * dx + dy * dy);
+            px += j->val[p] * q * dx; py += j->val[p] * q * dy;
+        }
+        j->pos[2 * i] = px; j->pos[2 * i + 1] = py;
+
+        /* repulsão: Barnes-Hut */
+        double nx = 0.0, ny = 0.0;
+        int sp = 0; stack[sp++] = 0;
+        while (sp > 0) {
+            const tsne_qnode *nd = &nodes[stack[--sp]];
+            if (nd->cnt == 0) continue;
+            if (nd->child < 0) {
+                for (int p = nd->start; p < nd->end; ++p) {
+                    int c = perm[p];
+                    if (c == i) continue;
+                    double dx = yx - j->Y[2 * c], dy = yy - j->Y[2 * c + 1];
+                    double q = 1.0 / (1.0 + dx * dx + dy * dy);
+                    sumq += q; nx += q * q * dx; ny += q * q * dy;
+                }
+                continue;
+            }
+            double dx = yx - nd->mx, dy = yy - nd->my, d2 = dx * dx + dy * dy;
+            double w = 2.0 * nd->hw;
+            if (w * w < j->theta2 * d2) {
+                double q = 1.0 / (1.0 + d2), m = (double)nd->cnt;
+                sumq += m * q; nx += m * q * q * dx; ny += m * q * q * dy;
+            } else if (sp + 4 <= (int)(sizeof stack / sizeof stack[0])) {
+                for (int q = 0; q < 4; ++q) stack[sp++] = nd->child + q;
+            }
+        }
+        j->neg[2 * i] = nx; j->neg[2 * i + 1] = ny;
+    }
+    j->sumq_part[tid] += sumq;
+}
+
+/* KL(P||Q) com Q normalizado por sumq (só para o relatório de progresso) */
+static double tsne_kl(const tsne_grad_job *j, double sumq) {
+    double kl = 0.0;
+    for (int i = 0; i < j->n; ++i)
+        for (int p = j->row_ptr[i]; p < j->row_ptr[i + 1]; ++p) {
+            int c = j->col[p];
+            double dx = j->Y[2 * i] - j->Y[2 * c], dy = j->Y[2 * i + 1] - j->Y[2 * c + 1];
+            double q = fmax(1.0 / (1.0 + dx * dx + dy * dy) / sumq, 1e-12);
+            double pv = fmax((double)j->val[p], 1e-12);
+            kl += pv * log(pv / q);
+        }
+    return kl;
+}
+
+/* Y (n x 2, linha-major) = embedding t-SNE de X (n x d).
+   Progresso: cb(user, iter, max_iter, kl) a cada 10 iterações; cb != 0 cancela
+   (Y fica com o embedding parcial e o retorno é AIFD_CANCELLED). */
+static int aifd_tsne2(const double *X, int n, int d, double *Y,
+                      const aifd_tsne_opts *opts, aifd_progress_fn cb, void *user) {
+    if (!X || !Y || n <= 0 || d <= 0) return AIFD_EINVAL;
+    aifd_tsne_opts o; aifd_tsne_defaults(&o);
+    if (opts) o = *opts;
+    if (n < 4) { for (int i = 0; i < 2 * n; ++i) Y[i] = 0.0; return AIFD_OK; }
+    int T = aifd_num_threads(o.threads);
+    if (o.perplexity <= 0) o.perplexity = 30.0;
+    if (o.perplexity > (n - 1) / 3.0) o.perplexity = (n - 1) / 3.0;
+    int k = (int)fmin((double)(n - 1), floor(3.0 * o.perplexity + 1.0));
+    if (k < 1) k = 1;
+    double lr = o.learning_rate > 0 ? o.learning_rate : fmax((double)n / o.exaggeration / 4.0, 50.0);
+
+    int rc = AIFD_ENOMEM;
+    tsne_vptree vp = { X, d, NULL, 0, NULL, NULL, o.seed };
+    tsne_qtree  qt = { NULL, 0, 0, NULL, NULL, NULL };
+    int    *nn_idx = (int*)   malloc(sizeof(int)    * (size_t)n * k);
+    double *nn_d2  = (double*)malloc(sizeof(double) * ((size_t)n * k + n)); /* + normas (kNN por blocos) */
+    float  *nn_p   = (float*) malloc(sizeof(float)  * (size_t)n * k);
+    int    *row_ptr = (int*)calloc((size_t)n + 1, sizeof(int));
+    int    *extra   = (int*)calloc((size_t)n, sizeof(int));
+    int    *col = NULL; float *val = NULL;
+    double *pos = NULL, *neg = NULL, *upd = NULL, *gains = NULL, *sumq_part = NULL;
+    vp.nodes = (tsne_vp_node*)malloc(sizeof(tsne_vp_node) * n);
+    vp.items = (int*)malloc(sizeof(int) * n);
+    vp.dist  = (double*)malloc(sizeof(double) * n);
+    if (!nn_idx || !nn_d2 || !nn_p || !row_ptr || !extra || !vp.nodes || !vp.items || !vp.dist) goto done;
+
+    /* 1) kNN + perplexidade: força bruta por blocos enquanto n²·d for moderado,
+          VP-tree acima disso (ganha quando a dimensão intrínseca é baixa) */
+    tsne_knn_job kj = { n, d, k, X, &vp, nn_idx, nn_d2, nn_p, o.perplexity };
+    if ((double)n * n * d <= 3e10) {
+        for (int i = 0; i < n; ++i) nn_d2[(size_t)n * k + i] = aifd_dot(X + (size_t)i * d, X + (size_t)i * d, d);
+        aifd_parallel_for(n, T, tsne_knn_brute_rows, &kj);
+    } else {
+        for (int i = 0; i < n; ++i) vp.items[i] = i;
+        vp_build(&vp, 0, n);
+        aifd_parallel_for(n, T, tsne_knn_rows, &kj);
+    }
+    aifd_parallel_for(n, T, tsne_perplexity_rows, &kj);
+    aifd_parallel_for(n, T, tsne_sort_rows, &kj);
+    free(nn_d2); nn_d2 = NULL;
+    free(vp.nodes); free(vp.items); free(vp.dist); vp.nodes = NULL; vp.items = NULL; vp.dist = NULL;
+
+    /* 2) P = (P + P^T) / soma, em CSR */
+    for (int i = 0; i < n; ++i)
+        for (int c = 0; c < k; ++c) {
+            int jn = nn_idx[(size_t)i * k + c];
+            if (jn == i) continue;
+            if (tsne_lookup(nn_idx + (size_t)jn * k, nn_p + (size_t)jn * k, k, i) < 0.0f) extra[jn]++;
+        }
+    for (int i = 0; i < n; ++i) row_ptr[i + 1] = row_ptr[i] + k + extra[i];
+    col = (int*)malloc(sizeof(int) * (size_t)row_ptr[n]);
+    val = (float*)malloc(sizeof(float) * (size_t)row_ptr[n]);
+    if (!col || !val) goto done;
+    {
+        double total = 0.0;
+        for (int i = 0; i < n; ++i) extra[i] = row_ptr[i] + k; /* cursor das entradas extras */
+        for (int i = 0; i < n; ++i)
+            for (int c = 0; c < k; ++c) {
+                size_t at = (size_t)row_ptr[i] + c;
+                int jn = nn_idx[(size_t)i * k + c];
+                float pij = nn_p[(size_t)i * k + c];
+                if (jn == i) { col[at] = i; val[at] = 0.0f; continue; }
+                float pji = tsne_lookup(nn_idx + (size_t)jn * k, nn_p + (size_t)jn * k, k, i);
+                col[at] = jn; val[at] = pij + (pji > 0.0f ? pji : 0.0f);
+                total += val[at];
+                if (pji < 0.0f) { col[extra[jn]] = i; val[extra[jn]] = pij; extra[jn]++; total += pij; }
+            }
+        float inv = (float)(1.0 / fmax(total, 1e-300));
+        for (int p = 0; p < row_ptr[n]; ++p) val[p] *= inv;
+    }
+    free(nn_idx); nn_idx = NULL; free(nn_p); nn_p = NULL; free(extra); extra = NULL;
+
+    /* 3) inicialização: PCA exata, escalada para std(eixo 0) = 1e-4 (como o sklearn) */
+    if (aifd_pca2(X, n, d, Y, T) != AIFD_OK) goto done;
+    {
+        double m = 0.0, s = 0.0;
+        for (int i = 0; i < n; ++i) m += Y[2 * i];
+        m /= n;
+        for (int i = 0; i < n; ++i) s += (Y[2 * i] - m) * (Y[2 * i] - m);
+        s = sqrt(s / n);
+        if (s < 1e-300) {
+            unsigned long long r = o.seed;
+            for (int i = 0; i < 2 * n; ++i) Y[i] = 1e-4 * (aifd_rng_uniform(&r) - 0.5);
+        } else {
+            for (int i = 0; i < 2 * n; ++i) Y[i] *= 1e-4 / s;
+        }
+    }
+
+    /* 4) descida do gradiente com momento e ganhos */
+    pos   = (double*)malloc(sizeof(double) * 2 * (size_t)n);
+    neg   = (double*)malloc(sizeof(double) * 2 * (size_t)n);
+    upd   = (double*)calloc(2 * (size_t)n, sizeof(double));
+    gains = (double*)malloc(sizeof(double) * 2 * (size_t)n);
+    sumq_part = (double*)malloc(sizeof(double) * (size_t)T);
+    qt.perm = (int*)malloc(sizeof(int) * n);
+    qt.tmp  = (int*)malloc(sizeof(int) * n);
+    if (!pos || !neg || !upd || !gains || !sumq_part || !qt.perm || !qt.tmp) goto done;
+    for (int i = 0; i < 2 * n; ++i) gains[i] = 1.0;
+
+    rc = AIFD_OK;
+    double kl = NAN;
+    for (int it = 0; it < o.max_iter; ++it) {
+        int exag_phase = it < o.exag_iter;
+        if (it == o.exag_iter) { /* fim da exageração: zera momento e ganhos (como o sklearn) */
+            memset(upd, 0, sizeof(double) * 2 * (size_t)n);
+            for (int i = 0; i < 2 * n; ++i) gains[i] = 1.0;
+        }
+        double momentum = exag_phase ? 0.5 : 0.8;
+
+        if (!qt_rebuild(&qt, Y, n)) { rc = AIFD_ENOMEM; break; }
+        for (int t = 0; t < T; ++t) sumq_part[t] = 0.0;
+        tsne_grad_job gj = { n, T, row_ptr, col, val, Y, &qt, o.theta * o.theta,
+                             exag_phase ? o.exaggeration : 1.0, pos, neg, sumq_part };
+        aifd_parallel_for(n, T, tsne_grad_rows, &gj);
+        double sumq = 0.0;
+        for (int t = 0; t < T; ++t) sumq += sumq_part[t];
+        if (sumq <= 0.0) sumq = 1e-300;
+
+        int report = ((it + 1) % 10 == 0) || it + 1 == o.max_iter;
+        if (report && (((it + 1) % 50 == 0) || it + 1 == o.max_iter)) kl = tsne_kl(&gj, sumq);
+
+        for (int i = 0; i < 2 * n; ++i) {
+            double g = 4.0 * (gj.exag * pos[i] - neg[i] / sumq);
+            if (upd[i] * g < 0.0) gains[i] += 0.2; else gains[i] *= 0.8;
+            if (gains[i] < 0.01) gains[i] = 0.01;
+            upd[i] = momentum * upd[i] - lr * gains[i] * g;
+            Y[i] += upd[i];
+        }
+        double mx = 0.0, my = 0.0;
+        for (int i = 0; i < n; ++i) { mx += Y[2 * i]; my += Y[2 * i + 1]; }
+        mx /= n; my /= n;
+        for (int i = 0; i < n; ++i) { Y[2 * i] -= mx; Y[2 * i + 1] -= my; }
+
+        if (report && cb && cb(user, it + 1, o.max_iter, kl)) { rc = AIFD_CANCELLED; break; }
+    }
+
+done:
+    free(nn_idx); free(nn_d2); free(nn_p); free(row_ptr); free(extra);
+    free(col); free(val); free(pos); free(neg); free(upd); free(gains); free(sumq_part);
+    free(vp.nodes); free(vp.items); free(vp.dist);
+    free(qt.nodes); free(qt.perm); free(qt.tmp);
+    return rc;
+}
+
+AIFD_NATIVE_END
+
+#endif